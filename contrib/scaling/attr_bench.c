@@ -0,0 +1,462 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Time attribute lookups on a job, app, node or proc the two ways
+ * src/util/attr.c can find them, and check that the index stays
+ * consistent with the list it covers:
+ *
+ *   scan   - walk the attribute list comparing keys
+ *   index  - probe the open-addressed key table the prte_attr_list_t
+ *            keeps next to the list
+ *
+ * This does not link against PRTE: the index code is a copy of
+ * attr_index/attr_added/attr_removed, so the timings are of that copy.
+ * For each list length, -l lookups of keys picked at random (half of
+ * them absent) are timed. The check then applies -c random sets,
+ * prepends, removes and appends to an indexed list and compares every
+ * lookup against a scan of the same list, including after a direct
+ * append that bypasses the index, which the length check has to catch.
+ *
+ * Last, the attribute traffic of mapping a -m rank job is modeled: for
+ * every proc, the mapping, ranking and binding code queries the job,
+ * app and node attributes a fixed number of times and sets a couple
+ * on the new proc. The counts below are estimates taken from the
+ * prte_get_attribute calls on those paths.
+ *
+ * Usage: attr_bench [-l lookups] [-c check ops] [-m ranks] [-n list length]...
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+/* attributes held by, and queries per proc made on, each object
+ * while mapping */
+#define MAP_JOB_ATTRS 24
+#define MAP_JOB_QUERIES 8
+#define MAP_APP_ATTRS 6
+#define MAP_APP_QUERIES 2
+#define MAP_NODE_ATTRS 8
+#define MAP_NODE_QUERIES 2
+#define MAP_PROC_SETS 2
+#define MAP_PPN 64
+
+typedef struct attr {
+    struct attr *prev, *next;
+    uint16_t key;
+} attr_t;
+
+typedef struct {
+    attr_t head; // sentinel of a circular list, as pmix_list_t
+    size_t len;
+    attr_t **slots;
+    uint32_t nslots, nused;
+    size_t nindexed;
+    int dups;
+} list_t;
+
+static void list_init(list_t *l)
+{
+    memset(l, 0, sizeof(*l));
+    l->head.next = l->head.prev = &l->head;
+}
+
+static void link_after(list_t *l, attr_t *pos, attr_t *kv)
+{
+    kv->prev = pos;
+    kv->next = pos->next;
+    pos->next->prev = kv;
+    pos->next = kv;
+    l->len++;
+}
+
+static void unlink_item(list_t *l, attr_t *kv)
+{
+    kv->prev->next = kv->next;
+    kv->next->prev = kv->prev;
+    l->len--;
+}
+
+static attr_t *scan(list_t *l, uint16_t key)
+{
+    attr_t *kv;
+
+    for (kv = l->head.next; kv != &l->head; kv = kv->next) {
+        if (kv->key == key) {
+            return kv;
+        }
+    }
+    return NULL;
+}
+
+static list_t *attr_index(list_t *al)
+{
+    uint32_t n, nslots, mask;
+    attr_t *kv;
+
+    if (al->len == al->nindexed && 2 * al->nused <= al->nslots) {
+        return al;
+    }
+    nslots = (0 == al->nslots) ? 8 : al->nslots;
+    while (nslots < 2 * (al->len + 1)) {
+        nslots *= 2;
+    }
+    if (nslots != al->nslots) {
+        al->slots = realloc(al->slots, nslots * sizeof(attr_t *));
+        al->nslots = nslots;
+    }
+    memset(al->slots, 0, al->nslots * sizeof(attr_t *));
+    al->nused = 0;
+    al->dups = 0;
+    mask = al->nslots - 1;
+    for (kv = al->head.next; kv != &al->head; kv = kv->next) {
+        for (n = kv->key & mask; NULL != al->slots[n]; n = (n + 1) & mask) {
+            if (al->slots[n]->key == kv->key) {
+                break;
+            }
+        }
+        if (NULL == al->slots[n]) {
+            al->slots[n] = kv;
+            al->nused++;
+        } else {
+            al->dups = 1;
+        }
+    }
+    al->nindexed = al->len;
+    return al;
+}
+
+static uint32_t attr_slot(list_t *al, uint16_t key)
+{
+    uint32_t n, mask = al->nslots - 1;
+
+    for (n = key & mask; NULL != al->slots[n]; n = (n + 1) & mask) {
+        if (al->slots[n]->key == key) {
+            break;
+        }
+    }
+    return n;
+}
+
+static attr_t *attr_find(list_t *al, uint16_t key)
+{
+    attr_index(al);
+    if (0 == al->nused) {
+        return NULL;
+    }
+    return al->slots[attr_slot(al, key)];
+}
+
+static void attr_added(list_t *al, attr_t *kv, int front)
+{
+    uint32_t n;
+
+    if (al->nindexed + 1 != al->len || 2 * (al->nused + 1) > al->nslots) {
+        al->nindexed = SIZE_MAX;
+        return;
+    }
+    n = attr_slot(al, kv->key);
+    if (NULL == al->slots[n]) {
+        al->slots[n] = kv;
+        al->nused++;
+    } else {
+        al->dups = 1;
+        if (front) {
+            al->slots[n] = kv;
+        }
+    }
+    al->nindexed++;
+}
+
+static void attr_removed(list_t *al, attr_t *kv)
+{
+    uint32_t n, j, k, mask;
+
+    if (al->dups || al->nindexed != al->len + 1) {
+        al->nindexed = SIZE_MAX;
+        return;
+    }
+    n = attr_slot(al, kv->key);
+    if (al->slots[n] != kv) {
+        al->nindexed = SIZE_MAX;
+        return;
+    }
+    mask = al->nslots - 1;
+    al->slots[n] = NULL;
+    al->nused--;
+    for (j = (n + 1) & mask; NULL != al->slots[j]; j = (j + 1) & mask) {
+        k = al->slots[j]->key & mask;
+        if ((j > n && (k <= n || k > j)) || (j < n && (k <= n && k > j))) {
+            al->slots[n] = al->slots[j];
+            al->slots[j] = NULL;
+            n = j;
+        }
+    }
+    al->nindexed--;
+}
+
+/* the operations of attr.c, on top of the index */
+static void set_attr(list_t *l, uint16_t key)
+{
+    attr_t *kv;
+
+    if (NULL != attr_find(l, key)) {
+        return;
+    }
+    kv = calloc(1, sizeof(attr_t));
+    kv->key = key;
+    link_after(l, l->head.prev, kv);
+    attr_added(l, kv, 0);
+}
+
+static void prepend_attr(list_t *l, uint16_t key)
+{
+    attr_t *kv = calloc(1, sizeof(attr_t));
+
+    kv->key = key;
+    link_after(l, &l->head, kv);
+    attr_added(l, kv, 1);
+}
+
+static void remove_attr(list_t *l, uint16_t key)
+{
+    attr_t *kv;
+
+    if (NULL != (kv = attr_find(l, key))) {
+        unlink_item(l, kv);
+        attr_removed(l, kv);
+        free(kv);
+    }
+}
+
+static void list_free(list_t *l)
+{
+    attr_t *kv;
+
+    while ((kv = l->head.next) != &l->head) {
+        unlink_item(l, kv);
+        free(kv);
+    }
+    free(l->slots);
+}
+
+/* keys are spread the way PRTE's are - one range per object type */
+static uint16_t pick_key(int nkeys)
+{
+    return (uint16_t) (100 + (random() % nkeys));
+}
+
+static int check(int nops)
+{
+    uint16_t key, k;
+    int op, errors = 0;
+    attr_t *kv;
+    list_t l;
+
+    list_init(&l);
+    srandom(7);
+    for (op = 0; op < nops; op++) {
+        key = pick_key(64);
+        switch (random() % 8) {
+        case 0:
+        case 1:
+        case 2:
+            set_attr(&l, key);
+            break;
+        case 3:
+            prepend_attr(&l, key);
+            break;
+        case 4:
+        case 5:
+            remove_attr(&l, key);
+            break;
+        case 6:
+            /* an append that does not go through attr.c */
+            kv = calloc(1, sizeof(attr_t));
+            kv->key = key;
+            link_after(&l, l.head.prev, kv);
+            break;
+        default:
+            /* and the list emptied behind the index's back */
+            if (0 == random() % 64) {
+                list_free(&l);
+                list_init(&l);
+            }
+            break;
+        }
+        for (k = 100; k < 100 + 64; k++) {
+            if (attr_find(&l, k) != scan(&l, k)) {
+                ++errors;
+            }
+        }
+    }
+    list_free(&l);
+    return errors;
+}
+
+static void run(int len, int nlookups)
+{
+    double t0, tscan, tindex;
+    uint16_t *keys = malloc(nlookups * sizeof(uint16_t));
+    long found = 0;
+    list_t l;
+    int i;
+
+    list_init(&l);
+    for (i = 0; i < len; i++) {
+        set_attr(&l, (uint16_t) (100 + i));
+    }
+    srandom(1);
+    for (i = 0; i < nlookups; i++) {
+        keys[i] = pick_key(2 * len);
+    }
+
+    t0 = bench_now();
+    for (i = 0; i < nlookups; i++) {
+        found += (NULL != scan(&l, keys[i]));
+    }
+    tscan = bench_now() - t0;
+    t0 = bench_now();
+    for (i = 0; i < nlookups; i++) {
+        found -= (NULL != attr_find(&l, keys[i]));
+    }
+    tindex = bench_now() - t0;
+
+    printf("%8d %14.1f %14.1f%s\n", len, tscan / nlookups * 1e9, tindex / nlookups * 1e9,
+           0 == found ? "" : "  MISMATCH");
+    list_free(&l);
+    free(keys);
+}
+
+/* set an attribute the way attr.c did before the index */
+static void set_scan(list_t *l, uint16_t key)
+{
+    attr_t *kv;
+
+    if (NULL != scan(l, key)) {
+        return;
+    }
+    kv = calloc(1, sizeof(attr_t));
+    kv->key = key;
+    link_after(l, l->head.prev, kv);
+}
+
+static double map_job(int nranks, int indexed)
+{
+    attr_t *(*find)(list_t *, uint16_t) = indexed ? attr_find : scan;
+    void (*set)(list_t *, uint16_t) = indexed ? set_attr : set_scan;
+    list_t job, app, node, proc;
+    double t0, t;
+    long found = 0;
+    int r, q;
+
+    list_init(&job);
+    list_init(&app);
+    list_init(&node);
+    for (q = 0; q < MAP_JOB_ATTRS; q++) {
+        set(&job, (uint16_t) (100 + q));
+    }
+    for (q = 0; q < MAP_APP_ATTRS; q++) {
+        set(&app, (uint16_t) (200 + q));
+    }
+    for (q = 0; q < MAP_NODE_ATTRS; q++) {
+        set(&node, (uint16_t) (300 + q));
+    }
+    srandom(3);
+
+    t0 = bench_now();
+    for (r = 0; r < nranks; r++) {
+        for (q = 0; q < MAP_JOB_QUERIES; q++) {
+            found += (NULL != find(&job, pick_key(2 * MAP_JOB_ATTRS)));
+        }
+        for (q = 0; q < MAP_APP_QUERIES; q++) {
+            found += (NULL != find(&app, (uint16_t) (200 + random() % (2 * MAP_APP_ATTRS))));
+        }
+        for (q = 0; q < MAP_NODE_QUERIES; q++) {
+            found += (NULL != find(&node, (uint16_t) (300 + random() % (2 * MAP_NODE_ATTRS))));
+        }
+        list_init(&proc);
+        for (q = 0; q < MAP_PROC_SETS; q++) {
+            set(&proc, (uint16_t) (400 + q));
+        }
+        list_free(&proc);
+        /* procs fill one node before moving to the next */
+        if (0 == (r + 1) % MAP_PPN) {
+            list_free(&node);
+            list_init(&node);
+            for (q = 0; q < MAP_NODE_ATTRS; q++) {
+                set(&node, (uint16_t) (300 + q));
+            }
+        }
+    }
+    t = bench_now() - t0;
+
+    list_free(&job);
+    list_free(&app);
+    list_free(&node);
+    /* use the results so the lookups cannot be optimized away */
+    return 0 <= found ? t : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+    int lens[32] = {2, 5, 10, 20, 50, 100};
+    int nlens = 6, userlens = 0, nlookups = 1000000, nops = 20000, nranks = 1000000;
+    int errors, i, opt;
+    double tscan, tindex;
+
+    while (-1 != (opt = getopt(argc, argv, "l:c:m:n:h"))) {
+        switch (opt) {
+        case 'l':
+            nlookups = atoi(optarg);
+            break;
+        case 'c':
+            nops = atoi(optarg);
+            break;
+        case 'm':
+            nranks = atoi(optarg);
+            break;
+        case 'n':
+            if (0 == userlens) {
+                nlens = 0;
+                userlens = 1;
+            }
+            if (nlens < 32) {
+                lens[nlens++] = atoi(optarg);
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: attr_bench [-l lookups] [-c check ops] [-m ranks] "
+                            "[-n list length]...\n");
+            return 1;
+        }
+    }
+    if (nlookups < 1) {
+        nlookups = 1;
+    }
+
+    printf("%d lookups, half of them for keys not on the list\n", nlookups);
+    printf("%8s %14s %14s\n", "attrs", "scan avg(ns)", "index avg(ns)");
+    for (i = 0; i < nlens; i++) {
+        if (0 < lens[i]) {
+            run(lens[i], nlookups);
+        }
+    }
+    errors = check(nops);
+    printf("consistency: %d random operations, %d mismatched lookups\n", nops, errors);
+
+    if (0 < nranks) {
+        bench_model("the attribute traffic of mapping a job");
+        tscan = map_job(nranks, 0);
+        tindex = map_job(nranks, 1);
+        printf("%d ranks, %d attribute queries and %d sets per rank: scan %.3f s index %.3f s\n",
+               nranks, MAP_JOB_QUERIES + MAP_APP_QUERIES + MAP_NODE_QUERIES, MAP_PROC_SETS,
+               tscan, tindex);
+    }
+    return 0 == errors ? 0 : 1;
+}
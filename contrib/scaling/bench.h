@@ -0,0 +1,82 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Helpers shared by the standalone benchmarks and simulators in this
+ * directory. None of them link against PRTE: the simulators model
+ * the algorithm they are named after and say so in their output, so
+ * the numbers they print are estimates and not measurements of the
+ * PRTE code itself.
+ */
+
+#ifndef PRTE_SCALING_BENCH_H
+#define PRTE_SCALING_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define BENCH_MAX_VALUES 32
+
+/* a list of values to run for, given by repeating an option. The
+ * first value on the command line replaces the defaults */
+typedef struct {
+    double v[BENCH_MAX_VALUES];
+    int n;
+    int user;
+} bench_list_t;
+
+static inline void bench_list_add(bench_list_t *l, const char *arg)
+{
+    if (0 == l->user) {
+        l->n = 0;
+        l->user = 1;
+    }
+    if (l->n < BENCH_MAX_VALUES) {
+        l->v[l->n++] = strtod(arg, NULL);
+    }
+}
+
+static inline double bench_now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static inline long bench_rss_kb(void)
+{
+    long pages = 0, rss = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+
+    if (NULL != fp) {
+        if (2 != fscanf(fp, "%ld %ld", &pages, &rss)) {
+            rss = 0;
+        }
+        fclose(fp);
+    }
+    return rss * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/* the parent of a daemon in the tree built by src/rml/routed_radix.c */
+static inline unsigned bench_radix_parent(unsigned rank, unsigned radix)
+{
+    unsigned Sum = 1, NInLevel = 1, NInPrevLevel;
+
+    while (Sum < (rank + 1)) {
+        NInLevel *= radix;
+        Sum += NInLevel;
+    }
+    Sum -= NInLevel;
+    NInPrevLevel = NInLevel / radix;
+    return (rank - Sum) % NInPrevLevel + (Sum - NInPrevLevel);
+}
+
+/* first line of every simulator's output */
+static inline void bench_model(const char *what)
+{
+    printf("model of %s - estimates, not measurements of PRTE\n", what);
+}
+
+#endif /* PRTE_SCALING_BENCH_H */
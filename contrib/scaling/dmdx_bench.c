@@ -0,0 +1,351 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Drive direct modex traffic between two daemons the ways PRTE can
+ * send it:
+ *
+ *   single   - every request for a remote proc, and every response,
+ *              goes out in its own message
+ *   batched  - requests for the daemon are held while earlier ones are
+ *              outstanding and go out together when a response comes
+ *              back, the batch fills or its window expires; the
+ *              responses to a batch go out together
+ *              (prte_pmix_dmdx_batch_window, prte_pmix_dmdx_batch_max)
+ *   prefetch - batched, and the first request for one of the remote
+ *              daemon's procs brings the data of all of them, which the
+ *              requesting daemon holds until asked (prte_pmix_dmdx_prefetch)
+ *
+ * The requesting daemon hosts -c clients, each fetching the data of
+ * the -n procs of the remote daemon in its own random order, as a rank
+ * does in its first all-to-all. Like the PMIx server, the requesting
+ * daemon asks only once for a proc and keeps what it got. Every message
+ * costs its sender and its receiver -o usec on top of the socket, which
+ * stands for the routing and event handling of a message in the
+ * daemons. Reported are the fetches per second, the messages sent each
+ * way, and the average and longest time a client waits for a fetch.
+ *
+ * Usage: dmdx_bench [-c clients] [-n remote procs] [-s bytes per proc]
+ *                   [-o usec per message] [-w window usec] [-m max batch]
+ */
+
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+enum { SINGLE, BATCHED, PREFETCH };
+
+static int ovh = 20;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* stand in for the cost of handling a message in a daemon */
+static void handle(void)
+{
+    double t = now() + ovh / 1e6;
+
+    while (now() < t);
+}
+
+static int readall(int fd, void *data, size_t len)
+{
+    char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = read(fd, p, len);
+        if (0 >= n) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void writeall(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = write(fd, p, len);
+        if (0 >= n) {
+            exit(1);
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+/* answer each message of requests with one message holding the data
+ * of the procs it asked for - and, when prefetching, that of all the
+ * others the first time */
+static void responder(int fd, int mode, int nprocs, size_t size)
+{
+    uint32_t *procs = NULL, *out = malloc((nprocs + 1) * sizeof(uint32_t)), count, n, nout;
+    char *reply = malloc(sizeof(uint32_t) + nprocs * (sizeof(uint32_t) + size)), *p;
+    int pushed = 0;
+
+    while (0 == readall(fd, &count, sizeof(count))) {
+        procs = realloc(procs, count * sizeof(uint32_t));
+        if (0 != readall(fd, procs, count * sizeof(uint32_t))) {
+            break;
+        }
+        handle();
+        nout = 0;
+        for (n = 0; n < count; n++) {
+            out[nout++] = procs[n];
+        }
+        if (PREFETCH == mode && !pushed) {
+            for (n = 0; n < (uint32_t) nprocs; n++) {
+                if (n != procs[0]) {
+                    out[nout++] = n;
+                }
+            }
+            pushed = 1;
+        }
+        memcpy(reply, &nout, sizeof(nout));
+        p = reply + sizeof(nout);
+        for (n = 0; n < nout; n++) {
+            memcpy(p, &out[n], sizeof(uint32_t));
+            memset(p + sizeof(uint32_t), 'x', size);
+            p += sizeof(uint32_t) + size;
+        }
+        handle();
+        writeall(fd, reply, p - reply);
+    }
+    exit(0);
+}
+
+typedef struct {
+    int fd, mode, window, max;
+    uint32_t *pending;
+    int npending, outstanding;
+    double held;
+    long msgs;
+} req_t;
+
+/* send the requests that are pending as one message */
+static void flush(req_t *r)
+{
+    uint32_t count = r->npending;
+
+    if (0 == count) {
+        return;
+    }
+    handle();
+    writeall(r->fd, &count, sizeof(count));
+    writeall(r->fd, r->pending, count * sizeof(uint32_t));
+    r->outstanding += count;
+    r->npending = 0;
+    ++r->msgs;
+}
+
+/* ask for a proc - on its own, or added to the batch and sent if
+ * nothing is outstanding */
+static void request(req_t *r, uint32_t proc)
+{
+    r->pending[r->npending++] = proc;
+    if (SINGLE == r->mode || 0 == r->outstanding || r->npending >= r->max) {
+        flush(r);
+    } else if (1 == r->npending) {
+        r->held = now();
+    }
+}
+
+static void run(const char *name, int mode, int nclients, int nprocs, size_t size, int window,
+                int max)
+{
+    int *order = malloc((size_t) nclients * nprocs * sizeof(int)), *next = calloc(nclients, sizeof(int));
+    char *have = calloc(nprocs, 1), *asked = calloc(nprocs, 1), *data = malloc(size + 1);
+    int *waiters = malloc((size_t) nclients * sizeof(int)), nwaiters = 0;
+    double *issued = calloc(nclients, sizeof(double));
+    int sv[2], done = 0, c, k, i, j, tmp, status, timeout;
+    uint32_t count, n, proc;
+    double t0, t, lat = 0, maxlat = 0;
+    long respmsgs = 0;
+    struct pollfd pfd;
+    req_t r;
+
+    /* each client goes through the procs in its own order */
+    srandom(1);
+    for (c = 0; c < nclients; c++) {
+        for (k = 0; k < nprocs; k++) {
+            order[c * nprocs + k] = k;
+        }
+        for (k = nprocs - 1; 0 < k; k--) {
+            j = random() % (k + 1);
+            tmp = order[c * nprocs + k];
+            order[c * nprocs + k] = order[c * nprocs + j];
+            order[c * nprocs + j] = tmp;
+        }
+    }
+
+    fflush(stdout);
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+        perror("socketpair");
+        exit(1);
+    }
+    if (0 == fork()) {
+        close(sv[0]);
+        responder(sv[1], mode, nprocs, size);
+    }
+    close(sv[1]);
+
+    memset(&r, 0, sizeof(r));
+    r.fd = sv[0];
+    r.mode = mode;
+    r.window = window;
+    r.max = max;
+    r.pending = malloc(nprocs * sizeof(uint32_t));
+
+    /* a client fetches procs until it needs one we do not have */
+    #define FETCH(cl)                                                   \
+        do {                                                            \
+            while (next[(cl)] < nprocs && have[order[(cl) * nprocs + next[(cl)]]]) { \
+                ++next[(cl)];                                           \
+                ++done;                                                 \
+            }                                                           \
+            if (next[(cl)] < nprocs) {                                  \
+                proc = order[(cl) * nprocs + next[(cl)]];               \
+                issued[(cl)] = now();                                   \
+                waiters[nwaiters++] = (cl);                             \
+                if (!asked[proc]) {                                     \
+                    asked[proc] = 1;                                    \
+                    request(&r, proc);                                  \
+                }                                                       \
+            }                                                           \
+        } while (0)
+
+    t0 = now();
+    for (c = 0; c < nclients; c++) {
+        FETCH(c);
+    }
+    pfd.fd = sv[0];
+    pfd.events = POLLIN;
+    while (done < nclients * nprocs) {
+        timeout = -1;
+        if (0 < r.npending) {
+            timeout = (int) ((r.held + window / 1e6 - now()) * 1000);
+            if (timeout <= 0) {
+                flush(&r);
+                continue;
+            }
+        }
+        if (0 >= poll(&pfd, 1, timeout)) {
+            continue;
+        }
+        if (0 != readall(sv[0], &count, sizeof(count))) {
+            break;
+        }
+        ++respmsgs;
+        handle();
+        for (n = 0; n < count; n++) {
+            if (0 != readall(sv[0], &proc, sizeof(proc)) || 0 != readall(sv[0], data, size)) {
+                exit(1);
+            }
+            if (asked[proc]) {
+                --r.outstanding;
+            }
+            have[proc] = 1;
+        }
+        /* wake the clients whose proc came in */
+        t = now();
+        for (i = 0; i < nwaiters;) {
+            c = waiters[i];
+            if (have[order[c * nprocs + next[c]]]) {
+                lat += t - issued[c];
+                if (maxlat < t - issued[c]) {
+                    maxlat = t - issued[c];
+                }
+                waiters[i] = waiters[--nwaiters];
+                FETCH(c);
+            } else {
+                i++;
+            }
+        }
+        /* the response clocks out whatever was held meanwhile */
+        flush(&r);
+    }
+    t = now() - t0;
+    close(sv[0]);
+    while (0 < wait(&status));
+
+    printf("%-9s %12.0f %10ld %10ld %12.1f %12.1f\n", name, done / t, r.msgs, respmsgs,
+           lat / done * 1e6, maxlat * 1e6);
+    free(order);
+    free(next);
+    free(have);
+    free(asked);
+    free(data);
+    free(waiters);
+    free(issued);
+    free(r.pending);
+}
+
+int main(int argc, char *argv[])
+{
+    int nclients = 64, nprocs = 64, size = 512, window = 1000, max = 1024, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "c:n:s:o:w:m:h"))) {
+        switch (opt) {
+        case 'c':
+            nclients = atoi(optarg);
+            break;
+        case 'n':
+            nprocs = atoi(optarg);
+            break;
+        case 's':
+            size = atoi(optarg);
+            break;
+        case 'o':
+            ovh = atoi(optarg);
+            break;
+        case 'w':
+            window = atoi(optarg);
+            break;
+        case 'm':
+            max = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: dmdx_bench [-c clients] [-n remote procs] "
+                            "[-s bytes per proc]\n"
+                            "                  [-o usec per message] [-w window usec] "
+                            "[-m max batch]\n");
+            return 1;
+        }
+    }
+    if (nclients < 1) {
+        nclients = 1;
+    }
+    if (nprocs < 1) {
+        nprocs = 1;
+    }
+    if (max < 1) {
+        max = 1;
+    }
+    if (window < 1) {
+        window = 1;
+    }
+
+    printf("%d clients each fetching the %d procs of a remote daemon, %d bytes each, "
+           "%d usec per message\n", nclients, nprocs, size, ovh);
+    printf("%-9s %12s %10s %10s %12s %12s\n", "scheme", "fetches/s", "req msgs", "resp msgs",
+           "avg(usec)", "max(usec)");
+    run("single", SINGLE, nclients, nprocs, size, window, max);
+    run("batched", BATCHED, nclients, nprocs, size, window, max);
+    run("prefetch", PREFETCH, nclients, nprocs, size, window, max);
+    return 0;
+}
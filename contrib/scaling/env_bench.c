@@ -0,0 +1,243 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Time how long a daemon spends building the environments of the
+ * procs it starts for one app:
+ *
+ *   copy     - for every proc, copy the launch environment, then add
+ *              each of the app's entries and the PMIx entries of the
+ *              proc with an overwriting setenv that searches the array
+ *              linearly (as pmix_setenv does)
+ *   shared   - merge the launch and app environments once, indexing
+ *              the variable names, then for every proc copy the array
+ *              of pointers and place its own entries through the index
+ *
+ * Usage: env_bench [-n procs] [-l launch vars] [-a app vars] [-p proc vars]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static size_t count(char **env)
+{
+    size_t n = 0;
+
+    while (NULL != env && NULL != env[n]) {
+        ++n;
+    }
+    return n;
+}
+
+static void freeenv(char **env)
+{
+    size_t n;
+
+    for (n = 0; NULL != env[n]; n++) {
+        free(env[n]);
+    }
+    free(env);
+}
+
+static char **copyenv(char **src)
+{
+    size_t n, cnt = count(src);
+    char **env = malloc((cnt + 1) * sizeof(char *));
+
+    for (n = 0; n < cnt; n++) {
+        env[n] = strdup(src[n]);
+    }
+    env[cnt] = NULL;
+    return env;
+}
+
+/* overwriting setenv on an argv-style array */
+static void setenvv(const char *entry, char ***env)
+{
+    size_t n, len = strchr(entry, '=') - entry + 1, cnt;
+
+    for (n = 0; NULL != (*env)[n]; n++) {
+        if (0 == strncmp((*env)[n], entry, len)) {
+            free((*env)[n]);
+            (*env)[n] = strdup(entry);
+            return;
+        }
+    }
+    cnt = n;
+    *env = realloc(*env, (cnt + 2) * sizeof(char *));
+    (*env)[cnt] = strdup(entry);
+    (*env)[cnt + 1] = NULL;
+}
+
+/* open-addressed index of the names in the shared environment */
+typedef struct {
+    char **env;
+    size_t nenv;
+    size_t size;
+    size_t *slots;
+} shared_t;
+
+static uint64_t hash(const char *s, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t n;
+
+    for (n = 0; n < len; n++) {
+        h ^= (uint8_t) s[n];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static size_t *lookup(shared_t *sh, char **env, const char *entry)
+{
+    size_t len = strchr(entry, '=') - entry + 1;
+    size_t i = hash(entry, len) & (sh->size - 1);
+
+    while (0 != sh->slots[i] && 0 != strncmp(env[sh->slots[i] - 1], entry, len)) {
+        i = (i + 1) & (sh->size - 1);
+    }
+    return &sh->slots[i];
+}
+
+static void put(shared_t *sh, const char *entry)
+{
+    size_t *slot = lookup(sh, sh->env, entry);
+
+    if (0 != *slot) {
+        free(sh->env[*slot - 1]);
+        sh->env[*slot - 1] = strdup(entry);
+        return;
+    }
+    sh->env[sh->nenv++] = strdup(entry);
+    *slot = sh->nenv;
+}
+
+static shared_t *build(char **launch, char **app)
+{
+    shared_t *sh = calloc(1, sizeof(shared_t));
+    size_t n, cnt = count(launch) + count(app);
+
+    for (sh->size = 16; sh->size < 2 * cnt; sh->size <<= 1);
+    sh->slots = calloc(sh->size, sizeof(size_t));
+    sh->env = calloc(cnt + 1, sizeof(char *));
+    for (n = 0; NULL != launch[n]; n++) {
+        put(sh, launch[n]);
+    }
+    for (n = 0; NULL != app[n]; n++) {
+        put(sh, app[n]);
+    }
+    return sh;
+}
+
+static char **assemble(shared_t *sh, char **delta)
+{
+    size_t n, cnt = sh->nenv, ndelta = count(delta), *slot;
+    char **env = malloc((cnt + ndelta + 1) * sizeof(char *));
+
+    memcpy(env, sh->env, cnt * sizeof(char *));
+    for (n = 0; n < ndelta; n++) {
+        slot = lookup(sh, sh->env, delta[n]);
+        if (0 != *slot) {
+            env[*slot - 1] = delta[n];
+        } else {
+            env[cnt++] = delta[n];
+        }
+    }
+    env[cnt] = NULL;
+    return env;
+}
+
+static char **mkenv(const char *prefix, int n, int len)
+{
+    char **env = calloc(n + 1, sizeof(char *));
+    int i;
+
+    for (i = 0; i < n; i++) {
+        env[i] = malloc(len + 32);
+        snprintf(env[i], len + 32, "%s_VAR_%d=%0*d", prefix, i, len, i);
+    }
+    return env;
+}
+
+int main(int argc, char *argv[])
+{
+    int nprocs = 256, nlaunch = 300, napp = 20, nproc = 40, opt, i, j;
+    char **launch, **app, **delta, **env;
+    double t0, tcopy, tshared;
+    size_t bytes = 0;
+    shared_t *sh;
+
+    while (-1 != (opt = getopt(argc, argv, "n:l:a:p:h"))) {
+        switch (opt) {
+        case 'n':
+            nprocs = atoi(optarg);
+            break;
+        case 'l':
+            nlaunch = atoi(optarg);
+            break;
+        case 'a':
+            napp = atoi(optarg);
+            break;
+        case 'p':
+            nproc = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: env_bench [-n procs] [-l launch vars] [-a app vars] [-p proc vars]\n");
+            return 1;
+        }
+    }
+
+    launch = mkenv("LAUNCH", nlaunch, 40);
+    /* half of the app entries override the launch environment */
+    app = mkenv("APP", napp, 20);
+    for (i = 0; i < napp / 2 && i < nlaunch; i++) {
+        free(app[i]);
+        app[i] = strdup(launch[i]);
+    }
+    delta = mkenv("PMIX", nproc, 30);
+    for (i = 0; NULL != launch[i]; i++) {
+        bytes += strlen(launch[i]) + 1 + sizeof(char *);
+    }
+
+    t0 = now();
+    for (i = 0; i < nprocs; i++) {
+        env = copyenv(launch);
+        for (j = 0; NULL != app[j]; j++) {
+            setenvv(app[j], &env);
+        }
+        for (j = 0; NULL != delta[j]; j++) {
+            setenvv(delta[j], &env);
+        }
+        freeenv(env);
+    }
+    tcopy = now() - t0;
+
+    t0 = now();
+    sh = build(launch, app);
+    for (i = 0; i < nprocs; i++) {
+        char **mine = copyenv(delta);
+        env = assemble(sh, mine);
+        free(env);
+        freeenv(mine);
+    }
+    tshared = now() - t0;
+
+    printf("%d procs, %d launch + %d app + %d per-proc vars (%zu bytes of launch env)\n", nprocs,
+           nlaunch, napp, nproc, bytes);
+    printf("%-8s %10s %10s\n", "scheme", "total(ms)", "per(us)");
+    printf("%-8s %10.2f %10.1f\n", "copy", 1e3 * tcopy, 1e6 * tcopy / nprocs);
+    printf("%-8s %10.2f %10.1f\n", "shared", 1e3 * tshared, 1e6 * tshared / nprocs);
+    return 0;
+}
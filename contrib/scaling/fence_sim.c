@@ -0,0 +1,232 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Simulate the latency of a fence across N daemons as a function of
+ * the payload each daemon contributes, for the two ways grpcomm can
+ * run the allgather behind it:
+ *
+ *   direct  - contributions roll up the radix tree to the HNP, each
+ *             daemon forwarding the bucket of its whole subtree, and
+ *             the HNP xcasts the complete bucket back down the tree
+ *             (src/mca/grpcomm/direct)
+ *   brucks  - ceil(log2 N) rounds in which every daemon sends what
+ *             it has collected so far to the daemon 2^k below it and
+ *             receives from the one 2^k above (src/mca/grpcomm/brucks)
+ *
+ * Each daemon has a cpu, an outgoing and an incoming link. Every
+ * message costs its sender and receiver a fixed overhead plus a
+ * per-byte copy, occupies both links for its size divided by the
+ * bandwidth, and arrives one latency later. Reported are the fence
+ * latency and the bytes the busiest daemon sends.
+ *
+ * Usage: fence_sim [-n ndaemons] [-r radix] [-l latency_usec] [-o overhead_usec]
+ *                  [-b bandwidth MB/s] [-c copy MB/s] [-p payload bytes]...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+static unsigned radix = 64;
+static double lat = 20.0, ovh = 2.0, wire = 1.0 / 1000, copy = 1.0 / 4000;
+
+typedef struct {
+    double cpu, tx, rx;
+    double sent;
+} daemon_t;
+
+static double max2(double a, double b)
+{
+    return a > b ? a : b;
+}
+
+/* move bytes from src, which has them at time ready, to dst and
+ * return when dst has taken them in */
+static double xfer(daemon_t *d, unsigned src, unsigned dst, double ready, double bytes)
+{
+    double t;
+
+    t = max2(ready, d[src].cpu) + ovh + bytes * copy;
+    d[src].cpu = t;
+    t = max2(t, max2(d[src].tx, d[dst].rx)) + bytes * wire;
+    d[src].tx = t;
+    d[dst].rx = t;
+    d[src].sent += bytes;
+    t = max2(t + lat, d[dst].cpu) + ovh + bytes * copy;
+    d[dst].cpu = t;
+    return t;
+}
+
+static int by_time(const void *a, const void *b)
+{
+    const double *x = a, *y = b;
+
+    return (x[0] > y[0]) - (x[0] < y[0]);
+}
+
+static double direct(unsigned n, double payload, double *busiest)
+{
+    daemon_t *d = calloc(n, sizeof(daemon_t));
+    unsigned *par = calloc(n, sizeof(unsigned)), *size = calloc(n, sizeof(unsigned));
+    unsigned *first = calloc(n + 1, sizeof(unsigned)), *kids = calloc(n, sizeof(unsigned));
+    unsigned *pos = calloc(n, sizeof(unsigned));
+    double *up = calloc(n, sizeof(double)), *arr = calloc(2 * n, sizeof(double));
+    double *down = calloc(n, sizeof(double)), done = 0.0;
+    unsigned r, p, k, nk;
+
+    /* parents precede their children, so the children of each
+     * daemon can be laid out in rank order */
+    for (r = 1; r < n; r++) {
+        par[r] = bench_radix_parent(r, radix);
+        first[par[r] + 1]++;
+    }
+    for (r = 0; r < n; r++) {
+        first[r + 1] += first[r];
+        size[r] = 1;
+    }
+    memcpy(pos, first, n * sizeof(unsigned));
+    for (r = 1; r < n; r++) {
+        kids[pos[par[r]]++] = r;
+    }
+
+    /* rollup: a daemon takes in its children's buckets in the order
+     * they become ready, then sends on the bucket of its subtree */
+    for (r = n - 1; 0 < r; r--) {
+        size[par[r]] += size[r];
+    }
+    for (r = n; 0 < r--;) {
+        nk = first[r + 1] - first[r];
+        for (k = 0; k < nk; k++) {
+            arr[2 * k] = up[kids[first[r] + k]];
+            arr[2 * k + 1] = kids[first[r] + k];
+        }
+        qsort(arr, nk, 2 * sizeof(double), by_time);
+        for (k = 0; k < nk; k++) {
+            p = (unsigned) arr[2 * k + 1];
+            up[r] = max2(up[r], xfer(d, p, r, arr[2 * k], payload * size[p]));
+        }
+    }
+
+    /* release: the complete bucket is relayed down the tree, each
+     * daemon sending it to its children one after the other */
+    down[0] = up[0];
+    for (r = 0; r < n; r++) {
+        for (k = first[r]; k < first[r + 1]; k++) {
+            down[kids[k]] = xfer(d, r, kids[k], down[r], payload * n);
+        }
+        if (done < down[r]) {
+            done = down[r];
+        }
+    }
+
+    for (*busiest = 0.0, r = 0; r < n; r++) {
+        if (*busiest < d[r].sent) {
+            *busiest = d[r].sent;
+        }
+    }
+    free(d);
+    free(par);
+    free(size);
+    free(first);
+    free(kids);
+    free(pos);
+    free(up);
+    free(arr);
+    free(down);
+    return done;
+}
+
+static double brucks(unsigned n, double payload, double *busiest)
+{
+    daemon_t *d = calloc(n, sizeof(daemon_t));
+    double *have = calloc(n, sizeof(double)), *next = calloc(n, sizeof(double));
+    double done = 0.0;
+    unsigned r, dist, cnt;
+
+    /* in step k a daemon holds the contributions of the 2^k daemons
+     * above it, and can send as soon as the previous step came in */
+    for (dist = 1; dist < n; dist <<= 1) {
+        cnt = (dist < n - dist) ? dist : n - dist;
+        for (r = 0; r < n; r++) {
+            next[(r + n - dist) % n] = xfer(d, r, (r + n - dist) % n, have[r], payload * cnt);
+        }
+        for (r = 0; r < n; r++) {
+            have[r] = max2(have[r], next[r]);
+        }
+    }
+    for (*busiest = 0.0, r = 0; r < n; r++) {
+        if (done < have[r]) {
+            done = have[r];
+        }
+        if (*busiest < d[r].sent) {
+            *busiest = d[r].sent;
+        }
+    }
+    free(d);
+    free(have);
+    free(next);
+    return done;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_list_t payloads = {{0, 256, 1024, 4096, 16384, 65536}, 6, 0};
+    double t1, t2, b1, b2;
+    int i, opt;
+    unsigned n = 2048;
+
+    while (-1 != (opt = getopt(argc, argv, "n:r:l:o:b:c:p:h"))) {
+        switch (opt) {
+        case 'n':
+            n = strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            radix = strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            lat = strtod(optarg, NULL);
+            break;
+        case 'o':
+            ovh = strtod(optarg, NULL);
+            break;
+        case 'b':
+            wire = 1.0 / strtod(optarg, NULL);
+            break;
+        case 'c':
+            copy = 1.0 / strtod(optarg, NULL);
+            break;
+        case 'p':
+            bench_list_add(&payloads, optarg);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n ndaemons] [-r radix] [-l latency_usec] [-o overhead_usec]\n"
+                    "          [-b bandwidth MB/s] [-c copy MB/s] [-p payload bytes]...\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (radix < 2) {
+        radix = 2;
+    }
+    if (n < 2) {
+        n = 2;
+    }
+
+    bench_model("fence allgather, direct against brucks");
+    printf("%u daemons, radix %u, latency %.1f usec, overhead %.1f usec, %.0f MB/s wire, "
+           "%.0f MB/s copy\n", n, radix, lat, ovh, 1.0 / wire, 1.0 / copy);
+    printf("%10s %14s %14s %16s %16s\n", "payload(B)", "direct(ms)", "brucks(ms)",
+           "direct max(MB)", "brucks max(MB)");
+    for (i = 0; i < payloads.n; i++) {
+        t1 = direct(n, payloads.v[i], &b1);
+        t2 = brucks(n, payloads.v[i], &b2);
+        printf("%10.0f %14.3f %14.3f %16.1f %16.1f\n", payloads.v[i], t1 / 1000, t2 / 1000,
+               b1 / 1e6, b2 / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,404 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Measure file pre-positioning throughput through a tree of
+ * simulated daemons without having to launch any. Each daemon is a
+ * thread connected to its parent and children by socketpairs laid
+ * out as the radix tree in src/rml/routed_radix.c, and every daemon
+ * writes its copy of the file to a sink.
+ *
+ * Two protocols are modeled, following filem/raw:
+ *
+ *   legacy - 16KB chunks that each carry the file name, broadcast
+ *            without any flow control
+ *   stream - large chunks that carry only a file id, relayed down
+ *            the tree as they arrive, with each daemon acking every
+ *            half window once its whole subtree has the data. The
+ *            root never gets more than a window ahead of the
+ *            slowest daemon.
+ *
+ * Only the framing and flow control are modeled - the OOB and
+ * grpcomm layers are not.
+ *
+ * Usage: filem_stage [-n ndaemons] [-r radix] [-c chunk_kbytes]
+ *                    [-w window] [-d dir] [-p legacy|stream|both]
+ *                    [size_mbytes]...
+ *
+ * Sizes default to 1MB through 4GB. The source file is sparse and
+ * created in /tmp. Copies are written to /dev/null unless -d names a
+ * directory to write them into.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define LEGACY_CHUNK 16384
+#define LEGACY_NAME "a/reasonably/long/path/to/the/container/image.sif"
+
+enum { FRAME_DATA, FRAME_EOF, FRAME_ACK };
+
+typedef struct {
+    uint32_t type;
+    uint32_t seq;
+    uint32_t len;
+} frame_t;
+
+typedef struct {
+    unsigned rank;
+    int up;        // socket to our parent
+    int *down;     // sockets to our children
+    unsigned nchildren;
+    int sink;
+    pthread_t thread;
+} daemon_t;
+
+static unsigned ndaemons = 8;
+static unsigned radix = 64;
+static size_t chunk = 1024 * 1024;
+static unsigned window = 8;
+static const char *dir = NULL;
+static int streaming;
+static daemon_t *daemons;
+
+static unsigned radix_parent(unsigned rank)
+{
+    unsigned Sum = 1, NInLevel = 1, NInPrevLevel;
+
+    while (Sum < (rank + 1)) {
+        NInLevel *= radix;
+        Sum += NInLevel;
+    }
+    Sum -= NInLevel;
+    NInPrevLevel = NInLevel / radix;
+    return (rank - Sum) % NInPrevLevel + (Sum - NInPrevLevel);
+}
+
+static void xfer(int fd, void *buf, size_t len, int out)
+{
+    char *ptr = (char *) buf;
+    ssize_t n;
+
+    while (0 < len) {
+        n = out ? write(fd, ptr, len) : read(fd, ptr, len);
+        if (n < 0 && EINTR == errno) {
+            continue;
+        }
+        if (n <= 0) {
+            perror(out ? "write" : "read");
+            exit(1);
+        }
+        ptr += n;
+        len -= n;
+    }
+}
+
+static void send_frame(int fd, uint32_t type, uint32_t seq, const void *data, uint32_t len)
+{
+    frame_t hdr = {type, seq, len};
+
+    xfer(fd, &hdr, sizeof(hdr), 1);
+    if (0 < len) {
+        xfer(fd, (void *) data, len, 1);
+    }
+}
+
+static unsigned interval(void)
+{
+    return (1 < window) ? window / 2 : 1;
+}
+
+/* count an ack for a window and pass up any window acked by our
+ * whole subtree - returns the number of windows passed up */
+static uint32_t ack(daemon_t *d, uint32_t *acks, unsigned nacks, uint32_t *reported, uint32_t w)
+{
+    uint32_t next;
+
+    acks[w % nacks]++;
+    while (1) {
+        next = (*reported + 1) % nacks;
+        if (acks[next] < d->nchildren + 1) {
+            return *reported;
+        }
+        acks[next] = 0;
+        (*reported)++;
+        if (0 != d->rank) {
+            send_frame(d->up, FRAME_ACK, *reported, NULL, 0);
+        }
+    }
+}
+
+static void *run_daemon(void *arg)
+{
+    daemon_t *d = (daemon_t *) arg;
+    struct pollfd *pfd;
+    unsigned nacks = window / interval() + 1, i, nfds;
+    uint32_t *acks, reported = 0;
+    char *buf;
+    frame_t hdr = {0, 0, 0};
+    int done = 0;
+
+    buf = malloc(chunk + sizeof(LEGACY_NAME));
+    acks = calloc(nacks, sizeof(uint32_t));
+    pfd = calloc(d->nchildren + 1, sizeof(struct pollfd));
+    pfd[0].fd = d->up;
+    pfd[0].events = POLLIN;
+    for (i = 0; i < d->nchildren; i++) {
+        pfd[i + 1].fd = d->down[i];
+        pfd[i + 1].events = POLLIN;
+    }
+    nfds = streaming ? d->nchildren + 1 : 1;
+
+    /* run until we have the whole file and, if acking,
+     * our children have seen the end of it too */
+    while (!done || (streaming && 0 < d->nchildren && reported * interval() < hdr.seq)) {
+        if (poll(pfd, nfds, -1) < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            perror("poll");
+            exit(1);
+        }
+        for (i = 1; i < nfds; i++) {
+            if (pfd[i].revents & POLLIN) {
+                frame_t ackhdr;
+                xfer(pfd[i].fd, &ackhdr, sizeof(ackhdr), 0);
+                ack(d, acks, nacks, &reported, ackhdr.seq);
+            }
+        }
+        if (done || !(pfd[0].revents & POLLIN)) {
+            continue;
+        }
+        xfer(d->up, &hdr, sizeof(hdr), 0);
+        if (0 < hdr.len) {
+            xfer(d->up, buf, hdr.len, 0);
+        }
+        /* relay before handling our own copy */
+        for (i = 0; i < d->nchildren; i++) {
+            send_frame(d->down[i], hdr.type, hdr.seq, buf, hdr.len);
+        }
+        if (FRAME_EOF == hdr.type) {
+            done = 1;
+            /* stop waiting on windows that will never fill */
+            hdr.seq -= hdr.seq % interval();
+            continue;
+        }
+        xfer(d->sink, buf, hdr.len, 1);
+        if (streaming && 0 == (hdr.seq + 1) % interval()) {
+            ack(d, acks, nacks, &reported, (hdr.seq + 1) / interval());
+        }
+    }
+    free(buf);
+    free(acks);
+    free(pfd);
+    return NULL;
+}
+
+static int open_sink(unsigned rank)
+{
+    char path[4096];
+    int fd;
+
+    if (NULL == dir) {
+        fd = open("/dev/null", O_WRONLY);
+    } else {
+        snprintf(path, sizeof(path), "%s/filem_stage.%u", dir, rank);
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    }
+    if (fd < 0) {
+        perror("open");
+        exit(1);
+    }
+    return fd;
+}
+
+static double stage(const char *src)
+{
+    daemon_t root;
+    struct timeval start, stop;
+    unsigned i, j, nacks = window / interval() + 1;
+    uint32_t *acks, reported = 0, seq = 0;
+    size_t cksz = streaming ? chunk : LEGACY_CHUNK, hdrsz, got;
+    char *buf;
+    int sv[2], fd, nfds = 0;
+    struct pollfd *pfd;
+    ssize_t n;
+
+    /* wire up the tree - rank 0 is the root */
+    daemons = calloc(ndaemons, sizeof(daemon_t));
+    for (i = 0; i < ndaemons; i++) {
+        daemons[i].rank = i;
+        daemons[i].down = calloc(ndaemons, sizeof(int));
+        daemons[i].sink = open_sink(i);
+    }
+    for (i = 1; i < ndaemons; i++) {
+        j = radix_parent(i);
+        if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+            perror("socketpair");
+            exit(1);
+        }
+        daemons[j].down[daemons[j].nchildren++] = sv[0];
+        daemons[i].up = sv[1];
+    }
+    root = daemons[0];
+    acks = calloc(nacks, sizeof(uint32_t));
+    pfd = calloc(root.nchildren, sizeof(struct pollfd));
+    for (i = 0; i < root.nchildren; i++) {
+        pfd[i].fd = root.down[i];
+        pfd[i].events = POLLIN;
+    }
+    nfds = streaming ? (int) root.nchildren : 0;
+    /* legacy chunks repack the name into each message */
+    hdrsz = streaming ? 0 : sizeof(LEGACY_NAME);
+    buf = malloc(cksz + hdrsz);
+    memcpy(buf, LEGACY_NAME, hdrsz);
+
+    if (0 > (fd = open(src, O_RDONLY))) {
+        perror("open");
+        exit(1);
+    }
+    gettimeofday(&start, NULL);
+    for (i = 1; i < ndaemons; i++) {
+        pthread_create(&daemons[i].thread, NULL, run_daemon, &daemons[i]);
+    }
+    while (1) {
+        /* wait for the window to open */
+        while (streaming && seq >= reported * interval() + window) {
+            if (poll(pfd, nfds, -1) < 0) {
+                continue;
+            }
+            for (i = 0; i < (unsigned) nfds; i++) {
+                if (pfd[i].revents & POLLIN) {
+                    frame_t ackhdr;
+                    xfer(pfd[i].fd, &ackhdr, sizeof(ackhdr), 0);
+                    ack(&root, acks, nacks, &reported, ackhdr.seq);
+                }
+            }
+        }
+        for (got = 0; got < cksz; got += n) {
+            n = read(fd, buf + hdrsz + got, cksz - got);
+            if (n <= 0) {
+                break;
+            }
+        }
+        if (0 == got) {
+            break;
+        }
+        for (i = 0; i < root.nchildren; i++) {
+            send_frame(root.down[i], FRAME_DATA, seq, buf, hdrsz + got);
+        }
+        xfer(root.sink, buf, hdrsz + got, 1);
+        if (streaming && 0 == (seq + 1) % interval()) {
+            ack(&root, acks, nacks, &reported, (seq + 1) / interval());
+        }
+        seq++;
+    }
+    for (i = 0; i < root.nchildren; i++) {
+        send_frame(root.down[i], FRAME_EOF, seq, NULL, 0);
+    }
+    for (i = 1; i < ndaemons; i++) {
+        pthread_join(daemons[i].thread, NULL);
+    }
+    gettimeofday(&stop, NULL);
+
+    close(fd);
+    free(buf);
+    free(acks);
+    free(pfd);
+    for (i = 0; i < ndaemons; i++) {
+        for (j = 0; j < daemons[i].nchildren; j++) {
+            close(daemons[i].down[j]);
+        }
+        if (0 != i) {
+            close(daemons[i].up);
+        }
+        close(daemons[i].sink);
+        free(daemons[i].down);
+    }
+    free(daemons);
+    return (stop.tv_sec - start.tv_sec) + (stop.tv_usec - start.tv_usec) / 1000000.0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t defaults[] = {1, 4, 16, 64, 256, 1024, 4096};
+    size_t *sizes = defaults, nsizes = sizeof(defaults) / sizeof(defaults[0]), i;
+    char src[] = "/tmp/filem_stage.XXXXXX";
+    int opt, fd, p, first = 0, last = 1;
+    double secs;
+
+    while (-1 != (opt = getopt(argc, argv, "n:r:c:w:d:p:"))) {
+        switch (opt) {
+        case 'n':
+            ndaemons = strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            radix = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            chunk = strtoul(optarg, NULL, 10) * 1024;
+            break;
+        case 'w':
+            window = strtoul(optarg, NULL, 10);
+            break;
+        case 'd':
+            dir = optarg;
+            break;
+        case 'p':
+            if (0 == strcmp(optarg, "legacy")) {
+                last = 0;
+            } else if (0 == strcmp(optarg, "stream")) {
+                first = 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n ndaemons] [-r radix] [-c chunk_kbytes] [-w window] "
+                            "[-d dir] [-p legacy|stream|both] [size_mbytes]...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (0 == ndaemons || radix < 2 || 0 == chunk || 0 == window) {
+        fprintf(stderr, "ndaemons, chunk and window must be positive and radix at least 2\n");
+        return 1;
+    }
+    if (optind < argc) {
+        nsizes = argc - optind;
+        sizes = calloc(nsizes, sizeof(size_t));
+        for (i = 0; i < nsizes; i++) {
+            sizes[i] = strtoul(argv[optind + i], NULL, 10);
+        }
+    }
+
+    printf("%u daemons, radix %u, stream chunk %lu KB, window %u\n", ndaemons, radix,
+           (unsigned long) (chunk / 1024), window);
+    printf("%10s %8s %10s %12s\n", "SIZE(MB)", "PROTO", "SECONDS", "MB/SEC");
+    for (i = 0; i < nsizes; i++) {
+        if (0 > (fd = mkstemp(src))) {
+            perror("mkstemp");
+            return 1;
+        }
+        if (0 != ftruncate(fd, (off_t) sizes[i] * 1024 * 1024)) {
+            perror("ftruncate");
+            return 1;
+        }
+        close(fd);
+        for (p = first; p <= last; p++) {
+            streaming = p;
+            secs = stage(src);
+            printf("%10lu %8s %10.3f %12.1f\n", (unsigned long) sizes[i],
+                   streaming ? "stream" : "legacy", secs, sizes[i] / secs);
+        }
+        unlink(src);
+        strcpy(src, "/tmp/filem_stage.XXXXXX");
+    }
+    return 0;
+}
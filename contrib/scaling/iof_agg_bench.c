@@ -0,0 +1,287 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Compare the two ways a daemon can forward the output of its local
+ * procs to the HNP (iof_prted_aggregate_window):
+ *
+ *   direct     - every fragment read from a child's pipe is sent to
+ *                the HNP as its own message
+ *   aggregate  - fragments from all children are framed into one
+ *                buffer that is sent when it holds -b bytes or when
+ *                its oldest fragment is -w usecs old
+ *
+ * Each of the -n children prints one short line per timestep for -s
+ * timesteps, -t usecs apart. The "HNP" is a separate process reading
+ * length-prefixed messages from a socket and demultiplexing the
+ * frames. The cpu time of both sides, the number of messages and the
+ * latency added by holding output are reported.
+ *
+ * Usage: iof_agg_bench [-n procs] [-s steps] [-t step usec] [-w window usec] [-b bytes]
+ */
+
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define FRAG_MAX 4096
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static double cpu(int who)
+{
+    struct rusage ru;
+
+    getrusage(who, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec
+           + ru.ru_stime.tv_usec / 1e6;
+}
+
+static int writeall(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = write(fd, p, len);
+        if (0 > n) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int readall(int fd, void *data, size_t len)
+{
+    char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = read(fd, p, len);
+        if (0 >= n) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* message: uint32 length, uint32 number of frames, then frames of
+ * uint32 rank, uint32 length, data */
+static void hnp(int sock)
+{
+    uint32_t hdr[2], fhdr[2], off, n;
+    uint64_t msgs = 0, frames = 0, bytes = 0;
+    char *buf = malloc(1 << 24);
+
+    while (0 == readall(sock, hdr, sizeof(hdr))) {
+        if (0 != readall(sock, buf, hdr[0])) {
+            break;
+        }
+        ++msgs;
+        for (n = 0, off = 0; n < hdr[1]; n++) {
+            memcpy(fhdr, buf + off, sizeof(fhdr));
+            off += sizeof(fhdr) + fhdr[1];
+            bytes += fhdr[1];
+            ++frames;
+        }
+    }
+    printf("    hnp: %8lu messages %8lu frames %10lu bytes  cpu %.3f s\n", (unsigned long) msgs,
+           (unsigned long) frames, (unsigned long) bytes, cpu(RUSAGE_SELF));
+    fflush(stdout);
+    exit(0);
+}
+
+static void child(int fd, int rank, int steps, int step)
+{
+    char line[128];
+    int s, len;
+
+    for (s = 0; s < steps; s++) {
+        len = snprintf(line, sizeof(line), "rank %d: timestep %d residual %e\n", rank, s,
+                       1.0 / (s + 1));
+        if (0 != writeall(fd, line, len)) {
+            break;
+        }
+        if (0 < step) {
+            usleep(step);
+        }
+    }
+    exit(0);
+}
+
+static void run(const char *name, int nprocs, int steps, int step, int window, int size)
+{
+    struct pollfd *pfds = calloc(nprocs, sizeof(struct pollfd));
+    int sv[2], p[2], i, open = nprocs, timeout, status;
+    char *agg = malloc(size + FRAG_MAX + 64), frag[FRAG_MAX];
+    uint32_t hdr[2], fhdr[2], aggframes = 0, agglen = 0;
+    uint64_t flushes = 0, frags = 0;
+    double t0, first = 0, latency = 0, maxlat = 0, lat, c0, elapsed;
+    pid_t hpid;
+    ssize_t n;
+
+    fflush(stdout);
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    hpid = fork();
+    if (0 == hpid) {
+        close(sv[0]);
+        hnp(sv[1]);
+    }
+    close(sv[1]);
+
+    t0 = now();
+    c0 = cpu(RUSAGE_SELF);
+    for (i = 0; i < nprocs; i++) {
+        pipe(p);
+        if (0 == fork()) {
+            close(p[0]);
+            close(sv[0]);
+            child(p[1], i, steps, step);
+        }
+        close(p[1]);
+        pfds[i].fd = p[0];
+        pfds[i].events = POLLIN;
+    }
+
+    while (0 < open) {
+        timeout = -1;
+        if (0 < aggframes) {
+            timeout = window / 1000 - (int) (1e3 * (now() - first));
+            if (0 > timeout) {
+                timeout = 0;
+            }
+        }
+        if (0 < poll(pfds, nprocs, timeout)) {
+            for (i = 0; i < nprocs; i++) {
+                if (0 > pfds[i].fd || 0 == pfds[i].revents) {
+                    continue;
+                }
+                n = read(pfds[i].fd, frag, sizeof(frag));
+                if (0 >= n) {
+                    close(pfds[i].fd);
+                    pfds[i].fd = -1;
+                    --open;
+                    continue;
+                }
+                ++frags;
+                fhdr[0] = i;
+                fhdr[1] = n;
+                if (0 == window) {
+                    hdr[0] = sizeof(fhdr) + n;
+                    hdr[1] = 1;
+                    writeall(sv[0], hdr, sizeof(hdr));
+                    writeall(sv[0], fhdr, sizeof(fhdr));
+                    writeall(sv[0], frag, n);
+                    ++flushes;
+                    continue;
+                }
+                if (0 == aggframes) {
+                    first = now();
+                }
+                memcpy(agg + agglen, fhdr, sizeof(fhdr));
+                memcpy(agg + agglen + sizeof(fhdr), frag, n);
+                agglen += sizeof(fhdr) + n;
+                ++aggframes;
+                if (agglen < (uint32_t) size) {
+                    continue;
+                }
+                goto flush;
+            }
+        }
+        if (0 == aggframes || (0 < open && 1e6 * (now() - first) < window)) {
+            continue;
+        }
+    flush:
+        hdr[0] = agglen;
+        hdr[1] = aggframes;
+        writeall(sv[0], hdr, sizeof(hdr));
+        writeall(sv[0], agg, agglen);
+        lat = now() - first;
+        latency += lat;
+        if (lat > maxlat) {
+            maxlat = lat;
+        }
+        ++flushes;
+        aggframes = 0;
+        agglen = 0;
+    }
+    if (0 < aggframes) {
+        hdr[0] = agglen;
+        hdr[1] = aggframes;
+        writeall(sv[0], hdr, sizeof(hdr));
+        writeall(sv[0], agg, agglen);
+        ++flushes;
+    }
+    elapsed = now() - t0;
+
+    printf("%s:\n", name);
+    printf("    daemon: %8lu fragments (%.0f/s) in %lu messages  cpu %.3f s", (unsigned long) frags,
+           frags / elapsed, (unsigned long) flushes, cpu(RUSAGE_SELF) - c0);
+    if (0 < window) {
+        printf("  hold avg %.0f usec max %.0f usec", 1e6 * latency / (flushes ? flushes : 1),
+               1e6 * maxlat);
+    }
+    printf("\n");
+    fflush(stdout);
+    close(sv[0]);
+    waitpid(hpid, &status, 0);
+    while (0 < wait(&status));
+    free(pfds);
+    free(agg);
+}
+
+int main(int argc, char *argv[])
+{
+    int nprocs = 64, steps = 2000, step = 1000, window = 2000, size = 65536, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:t:w:b:h"))) {
+        switch (opt) {
+        case 'n':
+            nprocs = atoi(optarg);
+            break;
+        case 's':
+            steps = atoi(optarg);
+            break;
+        case 't':
+            step = atoi(optarg);
+            break;
+        case 'w':
+            window = atoi(optarg);
+            break;
+        case 'b':
+            size = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: iof_agg_bench [-n procs] [-s steps] [-t step usec] "
+                            "[-w window usec] [-b bytes]\n");
+            return 1;
+        }
+    }
+    if (0 >= window) {
+        window = 1000;
+    }
+    if (size < 64) {
+        size = 64;
+    }
+
+    printf("%d procs, %d timesteps %d usec apart\n", nprocs, steps, step);
+    run("direct", nprocs, steps, step, 0, size);
+    run("aggregate", nprocs, steps, step, window, size);
+    return 0;
+}
@@ -0,0 +1,280 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Feed the same stream of input to N local procs, one of which reads
+ * slowly, under each of the flow control schemes of the IOF:
+ *
+ *   xoff        - a single switch for the whole daemon: once any
+ *                 proc has more than -b bytes queued, no input is
+ *                 accepted for anyone until it drains again
+ *   block       - per-proc budgets (iof_base_overflow_policy=block):
+ *                 a proc over budget holds what it was given, and the
+ *                 source is held off until it is back under half of
+ *                 it, as the HNP holds the tool's stdin push
+ *   drop-oldest - as block, but the oldest data queued for a proc
+ *                 over budget is discarded
+ *   spill       - as block, but the data beyond the budget goes to a
+ *                 file and is read back as the proc catches up
+ *
+ * Reported are the time until the fast procs have all their input,
+ * the time until the slow one does, the most input held in memory at
+ * once, and how much was dropped or spilled.
+ *
+ * Usage: iof_flow_bench [-n procs] [-m MB] [-b budget KB] [-d slow usec per 4k]
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define FRAG 4096
+
+enum { XOFF, BLOCK, DROP, SPILL };
+
+typedef struct frag {
+    struct frag *next;
+    size_t len, off;
+    char data[FRAG];
+} frag_t;
+
+typedef struct {
+    int fd;
+    frag_t *head, *tail;
+    size_t queued;
+    size_t delivered;
+    int spill;
+    off_t rd, wr;
+    int xoff; // over budget, as the sink's xoff flag
+    double done;
+} sink_t;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void child(int fd, int slow)
+{
+    char buf[FRAG];
+    ssize_t n;
+
+    while (0 < (n = read(fd, buf, sizeof(buf)))) {
+        if (0 < slow) {
+            usleep(slow);
+        }
+    }
+    _exit(0);
+}
+
+static void append(sink_t *s, const char *data, size_t len)
+{
+    frag_t *f = malloc(sizeof(frag_t));
+
+    memcpy(f->data, data, len);
+    f->len = len;
+    f->off = 0;
+    f->next = NULL;
+    if (NULL == s->tail) {
+        s->head = f;
+    } else {
+        s->tail->next = f;
+    }
+    s->tail = f;
+    s->queued += len;
+}
+
+static size_t drop_head(sink_t *s)
+{
+    frag_t *f = s->head;
+    size_t len = f->len - f->off;
+
+    s->head = f->next;
+    if (NULL == s->head) {
+        s->tail = NULL;
+    }
+    s->queued -= len;
+    free(f);
+    return len;
+}
+
+static void run(const char *name, int policy, int nprocs, size_t total, size_t budget, int slow)
+{
+    sink_t *sinks = calloc(nprocs, sizeof(sink_t));
+    struct pollfd *pfds = calloc(nprocs, sizeof(struct pollfd));
+    size_t produced = 0, held, peak = 0, dropped = 0, spilled = 0;
+    char data[FRAG], back[FRAG], path[] = "/tmp/iof_flow_bench.XXXXXX";
+    double t0, fast = 0;
+    int i, p[2], open = nprocs, xoff = 0, blocked = 0, status;
+    ssize_t n;
+
+    memset(data, 'x', sizeof(data));
+    fflush(stdout);
+    for (i = 0; i < nprocs; i++) {
+        if (0 != pipe(p)) {
+            perror("pipe");
+            exit(1);
+        }
+        if (0 == fork()) {
+            close(p[1]);
+            child(p[0], (0 == i) ? slow : 0);
+        }
+        close(p[0]);
+        fcntl(p[1], F_SETFL, fcntl(p[1], F_GETFL, 0) | O_NONBLOCK);
+        sinks[i].fd = p[1];
+        sinks[i].spill = -1;
+    }
+
+    t0 = now();
+    while (0 < open) {
+        /* accept the next fragment of input unless told to hold off */
+        if (produced < total && !xoff && !blocked) {
+            for (i = 0; i < nprocs; i++) {
+                sink_t *s = &sinks[i];
+                if (SPILL == policy && (s->rd < s->wr || budget < s->queued + FRAG)) {
+                    if (0 > s->spill) {
+                        s->spill = mkstemp(path);
+                        unlink(path);
+                        strcpy(path, "/tmp/iof_flow_bench.XXXXXX");
+                    }
+                    pwrite(s->spill, data, FRAG, s->wr);
+                    s->wr += FRAG;
+                    spilled += FRAG;
+                    continue;
+                }
+                if (DROP == policy) {
+                    while (NULL != s->head && budget < s->queued + FRAG) {
+                        dropped += drop_head(s);
+                    }
+                }
+                append(s, data, FRAG);
+            }
+            produced += FRAG;
+        }
+        for (held = 0, i = 0; i < nprocs; i++) {
+            held += sinks[i].queued;
+        }
+        if (held > peak) {
+            peak = held;
+        }
+
+        /* write to whoever can take it */
+        for (i = 0; i < nprocs; i++) {
+            pfds[i].fd = (0 <= sinks[i].fd && NULL != sinks[i].head) ? sinks[i].fd : -1;
+            pfds[i].events = POLLOUT;
+        }
+        poll(pfds, nprocs, (produced < total && !xoff && !blocked) ? 0 : 10);
+        for (i = 0; i < nprocs; i++) {
+            sink_t *s = &sinks[i];
+            while (0 <= pfds[i].fd && NULL != s->head) {
+                n = write(s->fd, s->head->data + s->head->off, s->head->len - s->head->off);
+                if (0 >= n) {
+                    break;
+                }
+                s->delivered += n;
+                s->head->off += n;
+                s->queued -= n;
+                if (s->head->off == s->head->len) {
+                    drop_head(s);
+                }
+            }
+            /* bring back spilled data below half the budget */
+            while (s->rd < s->wr && s->queued < budget / 2) {
+                n = pread(s->spill, back, FRAG, s->rd);
+                if (0 >= n) {
+                    break;
+                }
+                append(s, back, n);
+                s->rd += n;
+            }
+            if (0 <= s->fd && produced == total && NULL == s->head && s->rd == s->wr) {
+                close(s->fd);
+                s->fd = -1;
+                s->done = now() - t0;
+                --open;
+                if (0 != i && s->done > fast) {
+                    fast = s->done;
+                }
+            }
+        }
+
+        if (BLOCK == policy) {
+            for (i = 0; i < nprocs; i++) {
+                if (!sinks[i].xoff && budget < sinks[i].queued) {
+                    sinks[i].xoff = 1;
+                    ++blocked;
+                } else if (sinks[i].xoff && sinks[i].queued <= budget / 2) {
+                    sinks[i].xoff = 0;
+                    --blocked;
+                }
+            }
+        }
+        if (XOFF == policy) {
+            xoff = 0;
+            for (i = 0; i < nprocs; i++) {
+                if (budget < sinks[i].queued) {
+                    xoff = 1;
+                }
+            }
+        }
+    }
+    while (0 < wait(&status));
+
+    printf("%-12s %10.3f %10.3f %10.1f %10.1f %10.1f\n", name, fast, sinks[0].done,
+           peak / 1048576.0, dropped / 1048576.0, spilled / 1048576.0);
+    for (i = 0; i < nprocs; i++) {
+        if (0 <= sinks[i].spill) {
+            close(sinks[i].spill);
+        }
+    }
+    free(sinks);
+    free(pfds);
+}
+
+int main(int argc, char *argv[])
+{
+    int nprocs = 8, mb = 32, budget = 256, slow = 100, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:m:b:d:h"))) {
+        switch (opt) {
+        case 'n':
+            nprocs = atoi(optarg);
+            break;
+        case 'm':
+            mb = atoi(optarg);
+            break;
+        case 'b':
+            budget = atoi(optarg);
+            break;
+        case 'd':
+            slow = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: iof_flow_bench [-n procs] [-m MB] [-b budget KB] "
+                            "[-d slow usec per 4k]\n");
+            return 1;
+        }
+    }
+    if (nprocs < 2) {
+        nprocs = 2;
+    }
+
+    printf("%d procs each reading %d MB, one of them sleeping %d usec per 4k, budget %d KB\n",
+           nprocs, mb, slow, budget);
+    printf("%-12s %10s %10s %10s %10s %10s\n", "scheme", "fast(s)", "slow(s)", "peak(MB)",
+           "dropped", "spilled");
+    run("xoff", XOFF, nprocs, (size_t) mb << 20, (size_t) budget << 10, slow);
+    run("block", BLOCK, nprocs, (size_t) mb << 20, (size_t) budget << 10, slow);
+    run("drop-oldest", DROP, nprocs, (size_t) mb << 20, (size_t) budget << 10, slow);
+    run("spill", SPILL, nprocs, (size_t) mb << 20, (size_t) budget << 10, slow);
+    return 0;
+}
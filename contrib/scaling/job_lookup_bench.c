@@ -0,0 +1,197 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Time finding a job by nspace as the number of jobs in a DVM grows,
+ * the two ways prte_get_job_data_object can do it:
+ *
+ *   scan   - walk the prte_job_data array comparing nspaces
+ *   index  - hash the nspace to the job's slot in the array, then
+ *            check the slot still holds that job (prte_job_index)
+ *
+ * For each job count, every job is registered - which first looks the
+ * nspace up to reject duplicates, as prte_set_job_data_object does -
+ * and then -l lookups are made for jobs picked at random. Reported
+ * are the time to register all the jobs and the average lookup.
+ *
+ * Usage: job_lookup_bench [-l lookups] [-j jobs]...
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define NSLEN 256
+
+typedef struct {
+    char nspace[NSLEN];
+    int index;
+} job_t;
+
+typedef struct bucket {
+    struct bucket *next;
+    const char *key;
+    size_t len;
+    int index;
+} bucket_t;
+
+static job_t **jobs;
+static int njobs;
+static bucket_t **table;
+static size_t tsize;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static job_t *scan(const char *nspace)
+{
+    int n;
+
+    for (n = 0; n < njobs; n++) {
+        if (NULL != jobs[n] && 0 == strncmp(jobs[n]->nspace, nspace, NSLEN)) {
+            return jobs[n];
+        }
+    }
+    return NULL;
+}
+
+static size_t hash(const char *key, size_t len)
+{
+    size_t h = 0, n;
+
+    for (n = 0; n < len; n++) {
+        h = h * 31 + (unsigned char) key[n];
+    }
+    return h;
+}
+
+static job_t *lookup(const char *nspace)
+{
+    size_t len = strnlen(nspace, NSLEN);
+    bucket_t *b;
+    job_t *j;
+
+    for (b = table[hash(nspace, len) & (tsize - 1)]; NULL != b; b = b->next) {
+        if (b->len == len && 0 == memcmp(b->key, nspace, len)) {
+            /* the slot may have been reused since */
+            j = jobs[b->index];
+            if (NULL != j && 0 == strncmp(j->nspace, nspace, NSLEN)) {
+                return j;
+            }
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static void insert(job_t *j)
+{
+    size_t len = strnlen(j->nspace, NSLEN), h = hash(j->nspace, len) & (tsize - 1);
+    bucket_t *b = malloc(sizeof(bucket_t));
+
+    b->key = j->nspace;
+    b->len = len;
+    b->index = j->index;
+    b->next = table[h];
+    table[h] = b;
+}
+
+static void run(int n, int nlookups, int indexed)
+{
+    double t0, treg, tlook;
+    bucket_t *b;
+    job_t *j;
+    size_t k;
+    int i;
+
+    jobs = calloc(n, sizeof(job_t *));
+    njobs = 0;
+    for (tsize = 32; tsize < (size_t) n; tsize <<= 1);
+    table = calloc(tsize, sizeof(bucket_t *));
+
+    t0 = now();
+    for (i = 0; i < n; i++) {
+        j = calloc(1, sizeof(job_t));
+        snprintf(j->nspace, NSLEN, "prte-node0042-%d@%d", 31415, i + 1);
+        if (NULL != (indexed ? lookup(j->nspace) : scan(j->nspace))) {
+            exit(1);
+        }
+        j->index = njobs;
+        jobs[njobs++] = j;
+        if (indexed) {
+            insert(j);
+        }
+    }
+    treg = now() - t0;
+
+    srandom(1);
+    t0 = now();
+    for (i = 0; i < nlookups; i++) {
+        j = jobs[random() % n];
+        if (j != (indexed ? lookup(j->nspace) : scan(j->nspace))) {
+            exit(1);
+        }
+    }
+    tlook = now() - t0;
+
+    printf("%8d %-6s %14.3f %16.1f\n", n, indexed ? "index" : "scan", treg * 1e3,
+           tlook / nlookups * 1e9);
+    for (i = 0; i < n; i++) {
+        free(jobs[i]);
+    }
+    for (k = 0; k < tsize; k++) {
+        while (NULL != (b = table[k])) {
+            table[k] = b->next;
+            free(b);
+        }
+    }
+    free(jobs);
+    free(table);
+}
+
+int main(int argc, char *argv[])
+{
+    int counts[32] = {10, 100, 1000, 10000};
+    int ncounts = 4, usercounts = 0, nlookups = 20000, i, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "l:j:h"))) {
+        switch (opt) {
+        case 'l':
+            nlookups = atoi(optarg);
+            break;
+        case 'j':
+            if (0 == usercounts) {
+                ncounts = 0;
+                usercounts = 1;
+            }
+            if (ncounts < 32) {
+                counts[ncounts++] = atoi(optarg);
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: job_lookup_bench [-l lookups] [-j jobs]...\n");
+            return 1;
+        }
+    }
+    if (nlookups < 1) {
+        nlookups = 1;
+    }
+
+    printf("%d lookups of random jobs\n", nlookups);
+    printf("%8s %-6s %14s %16s\n", "jobs", "lookup", "register(ms)", "lookup avg(ns)");
+    for (i = 0; i < ncounts; i++) {
+        if (counts[i] < 1) {
+            continue;
+        }
+        run(counts[i], nlookups, 0);
+        run(counts[i], nlookups, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Time how long a daemon takes to start N no-op children on its
+ * node with each of the process creation schemes available to the
+ * odls default component (odls_default_launch_engine):
+ *
+ *   fork   - fork(), then in the child sweep /proc/self/fd closing
+ *            every descriptor above the error pipe (as
+ *            pmix_close_open_file_descriptors does) and exec. The
+ *            parent blocks on the close-on-exec error pipe until the
+ *            exec happens, as do_parent does
+ *   vfork  - vfork() and exec with a single close_range in the
+ *            child; shown for reference
+ *   spawn  - posix_spawn with precomputed attributes and file
+ *            actions (dup2 of stdio, closefrom), as used by the
+ *            spawn engine
+ *
+ * The cost of fork grows with the size of the parent, so the -m
+ * option sets the resident memory (in MB) of the simulated daemon
+ * and -f the number of descriptors it holds open.
+ *
+ * Usage: launch_bench [-n children] [-m MB] [-f fds] [-x executable]
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+static char *exe = "/bin/true";
+static int devnull;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void sweep(int keep)
+{
+    DIR *dir = opendir("/proc/self/fd");
+    struct dirent *ent;
+    int fd, dfd;
+
+    if (NULL == dir) {
+        return;
+    }
+    dfd = dirfd(dir);
+    while (NULL != (ent = readdir(dir))) {
+        fd = strtol(ent->d_name, NULL, 10);
+        if (fd > 2 && fd != keep && fd != dfd) {
+            close(fd);
+        }
+    }
+    closedir(dir);
+}
+
+static pid_t launch_fork(void)
+{
+    char *argv[] = {exe, NULL}, c;
+    int p[2];
+    pid_t pid;
+
+    if (0 != pipe(p)) {
+        return -1;
+    }
+    pid = fork();
+    if (0 == pid) {
+        close(p[0]);
+        fcntl(p[1], F_SETFD, FD_CLOEXEC);
+        dup2(devnull, 0);
+        dup2(devnull, 1);
+        sweep(p[1]);
+        execve(exe, argv, environ);
+        _exit(1);
+    }
+    close(p[1]);
+    /* wait for the exec to close the pipe */
+    while (0 < read(p[0], &c, 1));
+    close(p[0]);
+    return pid;
+}
+
+static pid_t launch_vfork(void)
+{
+    char *argv[] = {exe, NULL};
+    pid_t pid;
+
+    pid = vfork();
+    if (0 == pid) {
+        dup2(devnull, 0);
+        dup2(devnull, 1);
+        syscall(SYS_close_range, 3, ~0U, 0);
+        execve(exe, argv, environ);
+        _exit(1);
+    }
+    return pid;
+}
+
+static posix_spawnattr_t attr;
+
+static pid_t launch_spawn(void)
+{
+    char *argv[] = {exe, NULL};
+    posix_spawn_file_actions_t fa;
+    pid_t pid;
+    int rc;
+
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, devnull, 0);
+    posix_spawn_file_actions_adddup2(&fa, devnull, 1);
+    posix_spawn_file_actions_addclosefrom_np(&fa, 3);
+    rc = posix_spawn(&pid, exe, &fa, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&fa);
+    return (0 == rc) ? pid : -1;
+}
+
+static void run(const char *name, pid_t (*launch)(void), int n)
+{
+    double t0, tlaunch;
+    int i, status, failed = 0;
+
+    t0 = now();
+    for (i = 0; i < n; i++) {
+        if (0 > launch()) {
+            ++failed;
+        }
+    }
+    tlaunch = now() - t0;
+    while (0 < wait(&status)) {
+        if (!WIFEXITED(status) || 0 != WEXITSTATUS(status)) {
+            ++failed;
+        }
+    }
+    printf("%-6s %6d %10.2f %10.1f %6d\n", name, n, 1e3 * tlaunch, 1e6 * tlaunch / n, failed);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 256, mb = 1024, nfds = 1000, opt, i;
+    sigset_t sigs;
+    char *mem;
+
+    while (-1 != (opt = getopt(argc, argv, "n:m:f:x:h"))) {
+        switch (opt) {
+        case 'n':
+            n = atoi(optarg);
+            break;
+        case 'm':
+            mb = atoi(optarg);
+            break;
+        case 'f':
+            nfds = atoi(optarg);
+            break;
+        case 'x':
+            exe = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: launch_bench [-n children] [-m MB] [-f fds] [-x executable]\n");
+            return 1;
+        }
+    }
+
+    /* look like a daemon of the given size */
+    mem = malloc((size_t) mb << 20);
+    if (NULL == mem && 0 < mb) {
+        fprintf(stderr, "cannot allocate %d MB\n", mb);
+        return 1;
+    }
+    memset(mem, 1, (size_t) mb << 20);
+    devnull = open("/dev/null", O_RDWR);
+    for (i = 0; i < nfds; i++) {
+        if (0 > dup(devnull)) {
+            break;
+        }
+    }
+
+    posix_spawnattr_init(&attr);
+    sigemptyset(&sigs);
+    posix_spawnattr_setsigmask(&attr, &sigs);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETPGROUP);
+
+    printf("daemon RSS %d MB, %d open descriptors, exec %s\n", mb, i, exe);
+    printf("%-6s %6s %10s %10s %6s\n", "engine", "procs", "launch(ms)", "per(us)", "failed");
+    run("fork", launch_fork, n);
+    run("vfork", launch_vfork, n);
+    run("spawn", launch_spawn, n);
+
+    free(mem);
+    return 0;
+}
@@ -0,0 +1,421 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Measure the size and the encode/decode time of the node map that
+ * the HNP sends to every daemon (src/util/nidmap.c) for synthetic
+ * allocations of 1k to 100k hosts, without launching anything.
+ *
+ * Two encodings are compared:
+ *
+ *   legacy - the hostnames joined into one comma-separated string
+ *            and the per-node vpid array, each compressed with zlib
+ *   ranges - hostname ranges (first name plus count, e.g. node00001
+ *            x 4096) and runs of consecutive vpids. Irregular maps
+ *            fall back to the legacy encoding, as the real codec does
+ *
+ * Strings are framed as a 4-byte length followed by the bytes, the
+ * same as the PMIx buffer packing.
+ *
+ * Usage: nidmap_bench [-i iterations] [-n nhosts]...
+ * Build: cc -O -o nidmap_bench nidmap_bench.c -lz
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define RANK_INVALID UINT32_MAX
+#define RANGE_RATIO 4
+
+typedef struct {
+    unsigned char *bytes;
+    size_t size, alloc;
+    size_t pos;
+} buf_t;
+
+static void *xmalloc(size_t sz)
+{
+    void *p = malloc(sz);
+    if (NULL == p) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static void put(buf_t *b, const void *data, size_t sz)
+{
+    if (b->size + sz > b->alloc) {
+        b->alloc = 2 * (b->size + sz);
+        b->bytes = realloc(b->bytes, b->alloc);
+    }
+    memcpy(&b->bytes[b->size], data, sz);
+    b->size += sz;
+}
+
+static void put_u32(buf_t *b, uint32_t v)
+{
+    put(b, &v, sizeof(v));
+}
+
+static void put_str(buf_t *b, const char *s)
+{
+    put_u32(b, strlen(s) + 1);
+    put(b, s, strlen(s) + 1);
+}
+
+static uint32_t get_u32(buf_t *b)
+{
+    uint32_t v;
+    memcpy(&v, &b->bytes[b->pos], sizeof(v));
+    b->pos += sizeof(v);
+    return v;
+}
+
+static const char *get_str(buf_t *b, uint32_t *len)
+{
+    const char *s;
+    *len = get_u32(b);
+    s = (const char *) &b->bytes[b->pos];
+    b->pos += *len;
+    return s;
+}
+
+static void put_zlib(buf_t *b, const void *data, size_t sz)
+{
+    uLongf zsz = compressBound(sz);
+    unsigned char *z = xmalloc(zsz);
+
+    compress2(z, &zsz, data, sz, Z_DEFAULT_COMPRESSION);
+    put_u32(b, sz);
+    put_u32(b, zsz);
+    put(b, z, zsz);
+    free(z);
+}
+
+static void *get_zlib(buf_t *b)
+{
+    uLongf sz = get_u32(b);
+    uint32_t zsz = get_u32(b);
+    unsigned char *out = xmalloc(sz);
+
+    uncompress(out, &sz, &b->bytes[b->pos], zsz);
+    b->pos += zsz;
+    return out;
+}
+
+/* same rules as name_number() in src/util/nidmap.c */
+static int name_number(const char *name, size_t *pos, size_t *nd, uint32_t *num, int *width)
+{
+    size_t end, n;
+
+    for (end = strlen(name); 0 < end && !isdigit((unsigned char) name[end - 1]); end--);
+    if (0 == end) {
+        return 0;
+    }
+    for (n = end; 0 < n && isdigit((unsigned char) name[n - 1]); n--);
+    if (9 < end - n) {
+        return 0;
+    }
+    *pos = n;
+    *nd = end - n;
+    *num = strtoul(&name[n], NULL, 10);
+    *width = ('0' == name[n] && 1 < *nd) ? (int) *nd : 0;
+    return 1;
+}
+
+/* same as next_name() in src/util/nidmap.c */
+static void next_name(char *name, size_t pos, size_t *nd, size_t *len)
+{
+    size_t n = pos + *nd;
+
+    while (pos < n && '9' == name[n - 1]) {
+        name[n - 1] = '0';
+        --n;
+    }
+    if (pos < n) {
+        name[n - 1]++;
+        return;
+    }
+    memmove(&name[pos + 1], &name[pos], *len - pos + 1);
+    name[pos] = '1';
+    ++(*nd);
+    ++(*len);
+}
+
+static void encode_legacy(char **names, uint32_t *vpids, int n, buf_t *b)
+{
+    size_t len = 0, off = 0;
+    char *raw;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        len += strlen(names[i]) + 1;
+    }
+    raw = xmalloc(len);
+    for (i = 0; i < n; i++) {
+        strcpy(&raw[off], names[i]);
+        off += strlen(names[i]);
+        raw[off++] = ',';
+    }
+    raw[len - 1] = '\0';
+    put_zlib(b, raw, len);
+    put_zlib(b, vpids, n * sizeof(uint32_t));
+    free(raw);
+}
+
+static int encode(char **names, uint32_t *vpids, int n, buf_t *b)
+{
+    int max = n / RANGE_RATIO ? n / RANGE_RATIO : 1;
+    int *first = xmalloc(max * sizeof(int)), nr = 0, nv = 0, i;
+    uint32_t *rcnt = xmalloc(max * sizeof(uint32_t));
+    uint32_t *vstart = xmalloc(max * sizeof(uint32_t)), *vcnt = xmalloc(max * sizeof(uint32_t));
+    size_t fpos = 0, fnd = 0, pos, nd;
+    uint32_t fnum = 0, num;
+    int fwidth = 0, width, numbered = 0, fmt = 1;
+
+    for (i = 0; i < n && fmt; i++) {
+        if (numbered && name_number(names[i], &pos, &nd, &num, &width) && pos == fpos
+            && num == fnum + rcnt[nr - 1] && (fwidth ? nd == (size_t) fwidth : 0 == width)
+            && 0 == strncmp(names[i], names[first[nr - 1]], pos)
+            && 0 == strcmp(&names[i][pos + nd], &names[first[nr - 1]][fpos + fnd])) {
+            rcnt[nr - 1]++;
+            continue;
+        }
+        if (nr == max) {
+            fmt = 0;
+            break;
+        }
+        first[nr] = i;
+        rcnt[nr++] = 1;
+        numbered = name_number(names[i], &fpos, &fnd, &fnum, &fwidth);
+    }
+    for (i = 0; i < n && fmt; i++) {
+        if (0 < nv
+            && ((RANK_INVALID == vstart[nv - 1] && RANK_INVALID == vpids[i])
+                || (RANK_INVALID != vstart[nv - 1] && vpids[i] == vstart[nv - 1] + vcnt[nv - 1]))) {
+            vcnt[nv - 1]++;
+            continue;
+        }
+        if (nv == max) {
+            fmt = 0;
+            break;
+        }
+        vstart[nv] = vpids[i];
+        vcnt[nv++] = 1;
+    }
+
+    put_u32(b, fmt);
+    if (fmt) {
+        put_u32(b, n);
+        put_u32(b, nr);
+        for (i = 0; i < nr; i++) {
+            put_str(b, names[first[i]]);
+        }
+        put(b, rcnt, nr * sizeof(uint32_t));
+        put_u32(b, 0); /* no aliases */
+        put_u32(b, nv);
+        put(b, vstart, nv * sizeof(uint32_t));
+        put(b, vcnt, nv * sizeof(uint32_t));
+    } else {
+        encode_legacy(names, vpids, n, b);
+    }
+    free(first);
+    free(rcnt);
+    free(vstart);
+    free(vcnt);
+    return fmt;
+}
+
+static int decode(buf_t *b, char ***names, uint32_t **vpids)
+{
+    uint32_t n, nr, nv, i, j, k = 0, len, num, *rcnt, *vstart, *vcnt;
+    const char **first;
+    size_t pos, nd;
+    int width;
+    char *raw, *p, *tmpl;
+    size_t slen;
+
+    b->pos = 0;
+    if (0 == get_u32(b)) {
+        raw = get_zlib(b);
+        for (n = 1, p = raw; NULL != (p = strchr(p, ',')); p++, n++);
+        *names = xmalloc(n * sizeof(char *));
+        for (p = strtok(raw, ","); NULL != p; p = strtok(NULL, ",")) {
+            (*names)[k++] = strdup(p);
+        }
+        free(raw);
+        *vpids = get_zlib(b);
+        return n;
+    }
+
+    n = get_u32(b);
+    nr = get_u32(b);
+    *names = xmalloc(n * sizeof(char *));
+    *vpids = xmalloc(n * sizeof(uint32_t));
+    first = xmalloc(nr * sizeof(char *));
+    for (i = 0; i < nr; i++) {
+        first[i] = get_str(b, &len);
+    }
+    rcnt = (uint32_t *) &b->bytes[b->pos];
+    b->pos += nr * sizeof(uint32_t);
+    for (i = 0; i < nr; i++) {
+        if (1 == rcnt[i] || !name_number(first[i], &pos, &nd, &num, &width)) {
+            (*names)[k++] = strdup(first[i]);
+            continue;
+        }
+        slen = strlen(first[i]);
+        tmpl = xmalloc(slen + 11);
+        memcpy(tmpl, first[i], slen + 1);
+        for (j = 0; j < rcnt[i]; j++) {
+            (*names)[k] = xmalloc(slen + 1);
+            memcpy((*names)[k++], tmpl, slen + 1);
+            next_name(tmpl, pos, &nd, &slen);
+        }
+        free(tmpl);
+    }
+    free(first);
+    (void) get_u32(b); /* aliases */
+    nv = get_u32(b);
+    vstart = (uint32_t *) &b->bytes[b->pos];
+    vcnt = vstart + nv;
+    for (i = 0, k = 0; i < nv; i++) {
+        for (j = 0; j < vcnt[i]; j++) {
+            (*vpids)[k++] = RANK_INVALID == vstart[i] ? RANK_INVALID : vstart[i] + j;
+        }
+    }
+    return n;
+}
+
+static const char *patterns[] = {"regular", "gaps", "racks", "random"};
+
+/* build a synthetic allocation. The HNP's node is always first and
+ * hosts daemon 0 */
+static char **mkhosts(int pattern, int n, uint32_t *vpids)
+{
+    char **names = xmalloc(n * sizeof(char *)), buf[64];
+    int i;
+
+    srandom(n);
+    for (i = 0; i < n; i++) {
+        vpids[i] = i;
+        switch (pattern) {
+        case 0:
+            snprintf(buf, sizeof(buf), "node%05d", i + 1);
+            break;
+        case 1:
+            /* every 64th node is down and excluded */
+            snprintf(buf, sizeof(buf), "nid%06d", i + 1 + (i + 1) / 63);
+            break;
+        case 2:
+            snprintf(buf, sizeof(buf), "r%03d-c%02d-n%d.cluster", i / 256, (i / 16) % 16, i % 16);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "host-%08lx", random());
+            break;
+        }
+        names[i] = strdup(buf);
+    }
+    return names;
+}
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void run(int pattern, int n, int iters)
+{
+    uint32_t *vpids = xmalloc(n * sizeof(uint32_t)), *dv;
+    char **names = mkhosts(pattern, n, vpids), **dn;
+    buf_t leg = {0}, rng = {0};
+    double t0, tle = 0, tld = 0, tre = 0, trd = 0;
+    int it, i, m, fmt = 0;
+
+    for (it = 0; it < iters; it++) {
+        leg.size = rng.size = 0;
+        t0 = now();
+        put_u32(&leg, 0);
+        encode_legacy(names, vpids, n, &leg);
+        tle += now() - t0;
+        t0 = now();
+        fmt = encode(names, vpids, n, &rng);
+        tre += now() - t0;
+
+        t0 = now();
+        m = decode(&leg, &dn, &dv);
+        tld += now() - t0;
+        for (i = 0; i < m; i++) {
+            free(dn[i]);
+        }
+        free(dn);
+        free(dv);
+
+        t0 = now();
+        m = decode(&rng, &dn, &dv);
+        trd += now() - t0;
+        for (i = 0; i < m; i++) {
+            if (m != n || 0 != strcmp(dn[i], names[i]) || dv[i] != vpids[i]) {
+                fprintf(stderr, "%s %d: mismatch at %d\n", patterns[pattern], n, i);
+                exit(1);
+            }
+            free(dn[i]);
+        }
+        free(dn);
+        free(dv);
+    }
+
+    printf("%-8s %7d %10zu %10zu %7s %9.2f %9.2f %9.2f %9.2f\n", patterns[pattern], n, leg.size,
+           rng.size, fmt ? "ranges" : "legacy", 1e3 * tle / iters, 1e3 * tld / iters,
+           1e3 * tre / iters, 1e3 * trd / iters);
+    for (i = 0; i < n; i++) {
+        free(names[i]);
+    }
+    free(names);
+    free(vpids);
+    free(leg.bytes);
+    free(rng.bytes);
+}
+
+int main(int argc, char *argv[])
+{
+    int sizes[16] = {1000, 10000, 100000}, nsizes = 3, user = 0;
+    int iters = 5, opt, p, i;
+
+    while (-1 != (opt = getopt(argc, argv, "i:n:h"))) {
+        switch (opt) {
+        case 'i':
+            iters = atoi(optarg);
+            break;
+        case 'n':
+            if (0 == user) {
+                nsizes = 0;
+                user = 1;
+            }
+            if (nsizes < 16) {
+                sizes[nsizes++] = atoi(optarg);
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: nidmap_bench [-i iterations] [-n nhosts]...\n");
+            return 1;
+        }
+    }
+
+    printf("%-8s %7s %10s %10s %7s %9s %9s %9s %9s\n", "hosts", "n", "legacy(B)", "ranges(B)",
+           "format", "lenc(ms)", "ldec(ms)", "renc(ms)", "rdec(ms)");
+    for (p = 0; p < 4; p++) {
+        for (i = 0; i < nsizes; i++) {
+            run(p, sizes[i], iters);
+        }
+    }
+    return 0;
+}
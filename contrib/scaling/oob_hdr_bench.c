@@ -0,0 +1,226 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Send small OOB messages between two daemons with the two headers
+ * oob/tcp can put in front of them:
+ *
+ *   full     - the original header, with the origin and dst procs
+ *              (nspace and rank each), tag, seq number, size, type
+ *              and routed module name
+ *   compact  - the header negotiated in the connect ack, with the
+ *              ranks, tag, seq number, size, nspace indices, flags
+ *              and type (oob_tcp_compact_header)
+ *
+ * Like oob/tcp, the sender writes the header and payload of each
+ * message with one writev() and the receiver reads the header, then
+ * the payload. The compact receiver also rebuilds the full header from
+ * its nspace table, as read_hdr() does. Reported for each payload size
+ * are the messages per second and the bytes on the wire per message.
+ *
+ * Usage: oob_hdr_bench [-n messages] [-p payload bytes]...
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* mirrors of the structs in src/mca/oob/tcp/oob_tcp_hdr.h */
+typedef struct {
+    char nspace[256];
+    uint32_t rank;
+} proc_t;
+
+typedef struct {
+    proc_t origin;
+    proc_t dst;
+    uint32_t tag;
+    uint32_t seq_num;
+    uint32_t nbytes;
+    uint8_t type;
+    char routed[32];
+} full_hdr_t;
+
+typedef struct {
+    uint32_t origin;
+    uint32_t dst;
+    uint32_t tag;
+    uint32_t seq_num;
+    uint32_t nbytes;
+    uint8_t origin_ns;
+    uint8_t dst_ns;
+    uint8_t flags;
+    uint8_t type;
+} compact_hdr_t;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int readall(int fd, void *data, size_t len)
+{
+    char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = read(fd, p, len);
+        if (0 >= n) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void writevall(int fd, struct iovec *iov, int cnt)
+{
+    ssize_t n;
+
+    while (0 < cnt) {
+        n = writev(fd, iov, cnt);
+        if (0 >= n) {
+            exit(1);
+        }
+        while (0 < cnt && (size_t) n >= iov->iov_len) {
+            n -= iov->iov_len;
+            ++iov;
+            --cnt;
+        }
+        if (0 < cnt) {
+            iov->iov_base = (char *) iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+static void sender(int fd, int compact, int nmsgs, size_t size)
+{
+    char *data = calloc(1, size + 1);
+    full_hdr_t full;
+    compact_hdr_t chdr;
+    struct iovec iov[2];
+    int m;
+
+    memset(&full, 0, sizeof(full));
+    strcpy(full.origin.nspace, "prte-node01-12345@0");
+    strcpy(full.dst.nspace, "prte-node01-12345@0");
+    strcpy(full.routed, "radix");
+    full.type = 4;
+    memset(&chdr, 0, sizeof(chdr));
+    chdr.type = 4;
+    for (m = 0; m < nmsgs; m++) {
+        if (compact) {
+            chdr.seq_num = m;
+            chdr.nbytes = size;
+            iov[0].iov_base = &chdr;
+            iov[0].iov_len = sizeof(chdr);
+        } else {
+            full.seq_num = m;
+            full.nbytes = size;
+            iov[0].iov_base = &full;
+            iov[0].iov_len = sizeof(full);
+        }
+        iov[1].iov_base = data;
+        iov[1].iov_len = size;
+        writevall(fd, iov, 0 < size ? 2 : 1);
+    }
+    exit(0);
+}
+
+static void run(const char *name, int compact, int nmsgs, size_t size)
+{
+    char *data = malloc(size + 1), *nspaces[1] = {"prte-node01-12345@0"};
+    int sv[2], m, status;
+    full_hdr_t full;
+    compact_hdr_t chdr;
+    double t;
+
+    fflush(stdout);
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+        perror("socketpair");
+        exit(1);
+    }
+    if (0 == fork()) {
+        close(sv[0]);
+        sender(sv[1], compact, nmsgs, size);
+    }
+    close(sv[1]);
+
+    t = now();
+    for (m = 0; m < nmsgs; m++) {
+        if (compact) {
+            if (0 != readall(sv[0], &chdr, sizeof(chdr))) {
+                break;
+            }
+            /* rebuild the full header the rest of the oob expects */
+            strncpy(full.origin.nspace, nspaces[chdr.origin_ns], sizeof(full.origin.nspace));
+            strncpy(full.dst.nspace, nspaces[chdr.dst_ns], sizeof(full.dst.nspace));
+            full.origin.rank = chdr.origin;
+            full.dst.rank = chdr.dst;
+            full.tag = chdr.tag;
+            full.seq_num = chdr.seq_num;
+            full.nbytes = chdr.nbytes;
+            full.type = chdr.type;
+        } else if (0 != readall(sv[0], &full, sizeof(full))) {
+            break;
+        }
+        if (0 < full.nbytes && 0 != readall(sv[0], data, full.nbytes)) {
+            break;
+        }
+    }
+    t = now() - t;
+    close(sv[0]);
+    while (0 < wait(&status));
+
+    printf("%-9s %10lu %14.0f %12lu\n", name, (unsigned long) size, m / t,
+           (unsigned long) ((compact ? sizeof(chdr) : sizeof(full)) + size));
+    free(data);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sizes[32] = {0, 64, 256, 1024, 4096};
+    int nsizes = 5, usersizes = 0, nmsgs = 200000, i, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:p:h"))) {
+        switch (opt) {
+        case 'n':
+            nmsgs = atoi(optarg);
+            break;
+        case 'p':
+            if (0 == usersizes) {
+                nsizes = 0;
+                usersizes = 1;
+            }
+            if (nsizes < 32) {
+                sizes[nsizes++] = strtoul(optarg, NULL, 10);
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: oob_hdr_bench [-n messages] [-p payload bytes]...\n");
+            return 1;
+        }
+    }
+    if (nmsgs < 1) {
+        nmsgs = 1;
+    }
+
+    printf("%d messages, full header %lu bytes, compact header %lu bytes\n", nmsgs,
+           (unsigned long) sizeof(full_hdr_t), (unsigned long) sizeof(compact_hdr_t));
+    printf("%-9s %10s %14s %12s\n", "header", "payload", "msgs/s", "wire bytes");
+    for (i = 0; i < nsizes; i++) {
+        run("full", 0, nmsgs, sizes[i]);
+        run("compact", 1, nmsgs, sizes[i]);
+    }
+    return 0;
+}
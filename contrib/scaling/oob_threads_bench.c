@@ -0,0 +1,304 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Measure how long OOB messages wait on the socket of a busy daemon
+ * the two ways it can progress its peers:
+ *
+ *   inline   - the socket is read by the main event loop, which also
+ *              runs the state machine, so nothing is read while it
+ *              works through a large job
+ *   threaded - an I/O thread reads the socket and hands each message
+ *              to the main loop through a single-producer/single-
+ *              consumer ring, waking it only when it is idle
+ *              (oob_tcp_num_threads, oob_tcp_handoff_size)
+ *
+ * A peer sends -n messages of -s bytes, one every -i usec. The main
+ * loop spends -o usec on each message and, every -p messages, -j usec
+ * on a job. Reported are the time the peer is stuck in write(), how
+ * long a message waits before it is read off the socket, and how long
+ * it then waits for the main loop - both average and longest.
+ *
+ * Usage: oob_threads_bench [-n messages] [-s bytes] [-i usec between]
+ *                          [-o usec per message] [-j usec per job]
+ *                          [-p messages per job] [-q ring size]
+ */
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static int nmsgs = 20000, size = 4096, gap = 20, ovh = 2, job = 20000, per = 2000;
+static unsigned qsize = 1024;
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void spin(int usec)
+{
+    double t = now() + usec / 1e6;
+
+    while (now() < t);
+}
+
+static int readall(int fd, void *data, size_t len)
+{
+    char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = read(fd, p, len);
+        if (0 >= n) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* the remote peer: paced messages, each stamped with its send time */
+static void sender(int fd, int rfd)
+{
+    char *buf = calloc(1, size);
+    double t, next = now(), stuck = 0;
+    const char *p;
+    ssize_t n;
+    size_t len;
+    int m;
+
+    for (m = 0; m < nmsgs; m++) {
+        while (now() < next);
+        next += gap / 1e6;
+        t = now();
+        memcpy(buf, &t, sizeof(t));
+        for (p = buf, len = size; 0 < len; p += n, len -= n) {
+            if (0 >= (n = write(fd, p, len))) {
+                exit(1);
+            }
+        }
+        stuck += now() - t;
+    }
+    if (write(rfd, &stuck, sizeof(stuck)) != sizeof(stuck)) {
+        exit(1);
+    }
+    exit(0);
+}
+
+typedef struct {
+    double sent, read;
+} slot_t;
+
+typedef struct {
+    double wait, maxwait, hand, maxhand;
+    int done;
+} stats_t;
+
+/* the main loop's share of a message */
+static void process(stats_t *st, double sent, double read)
+{
+    double t = now();
+
+    st->wait += read - sent;
+    if (st->maxwait < read - sent) {
+        st->maxwait = read - sent;
+    }
+    st->hand += t - read;
+    if (st->maxhand < t - read) {
+        st->maxhand = t - read;
+    }
+    spin(ovh);
+    if (0 == ++st->done % per) {
+        spin(job);
+    }
+}
+
+static slot_t *ring;
+static volatile unsigned head, tail;
+static volatile int armed;
+static int sockfd, wake[2];
+
+static void *io_thread(void *arg)
+{
+    slot_t *held = malloc(nmsgs * sizeof(slot_t));
+    char *buf = malloc(size);
+    int nheld = 0, first = 0, got = 0;
+    struct pollfd pfd = {.fd = sockfd, .events = POLLIN};
+    char c = 0;
+    (void) arg;
+
+    while (got < nmsgs || first < nheld) {
+        if (got < nmsgs && 0 < poll(&pfd, 1, first < nheld ? 1 : -1)) {
+            if (0 != readall(sockfd, buf, size)) {
+                break;
+            }
+            memcpy(&held[nheld].sent, buf, sizeof(double));
+            held[nheld++].read = now();
+            ++got;
+        } else if (got == nmsgs) {
+            usleep(1000);
+        }
+        /* move what we hold into the ring, in order */
+        while (first < nheld && tail - head < qsize) {
+            ring[tail & (qsize - 1)] = held[first++];
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            ++tail;
+        }
+        if (!armed && __sync_bool_compare_and_swap(&armed, 0, 1)) {
+            if (1 != write(wake[1], &c, 1)) {
+                exit(1);
+            }
+        }
+    }
+    free(held);
+    free(buf);
+    return NULL;
+}
+
+static void run(const char *name, int threaded)
+{
+    char *buf = malloc(size), c;
+    int sv[2], rp[2], status;
+    double stuck, t0, sent;
+    stats_t st;
+    slot_t s;
+    pthread_t tid;
+
+    fflush(stdout);
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv) || 0 != pipe(rp)) {
+        perror("socketpair");
+        exit(1);
+    }
+    if (0 == fork()) {
+        close(sv[0]);
+        close(rp[0]);
+        sender(sv[1], rp[1]);
+    }
+    close(sv[1]);
+    close(rp[1]);
+    memset(&st, 0, sizeof(st));
+    t0 = now();
+
+    if (!threaded) {
+        while (st.done < nmsgs) {
+            if (0 != readall(sv[0], buf, size)) {
+                break;
+            }
+            memcpy(&sent, buf, sizeof(sent));
+            process(&st, sent, now());
+        }
+    } else {
+        ring = calloc(qsize, sizeof(slot_t));
+        head = tail = 0;
+        armed = 0;
+        sockfd = sv[0];
+        if (0 != pipe(wake)) {
+            exit(1);
+        }
+        pthread_create(&tid, NULL, io_thread, NULL);
+        while (st.done < nmsgs) {
+            if (1 != read(wake[0], &c, 1)) {
+                break;
+            }
+            /* drain, then disarm and look once more before sleeping */
+            for (;;) {
+                while (head != tail) {
+                    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                    s = ring[head & (qsize - 1)];
+                    ++head;
+                    process(&st, s.sent, s.read);
+                }
+                armed = 0;
+                __sync_synchronize();
+                if (head == tail || !__sync_bool_compare_and_swap(&armed, 0, 1)) {
+                    break;
+                }
+            }
+        }
+        pthread_join(tid, NULL);
+        close(wake[0]);
+        close(wake[1]);
+        free(ring);
+    }
+    t0 = now() - t0;
+    if (0 != readall(rp[0], &stuck, sizeof(stuck))) {
+        stuck = 0;
+    }
+    close(sv[0]);
+    close(rp[0]);
+    while (0 < wait(&status));
+
+    printf("%-9s %10.1f %12.1f %12.1f %12.1f %12.1f %10.0f\n", name, stuck * 1e3,
+           st.wait / st.done * 1e6, st.maxwait * 1e6, st.hand / st.done * 1e6,
+           st.maxhand * 1e6, t0 * 1e3);
+    free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned q;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:i:o:j:p:q:h"))) {
+        switch (opt) {
+        case 'n':
+            nmsgs = atoi(optarg);
+            break;
+        case 's':
+            size = atoi(optarg);
+            break;
+        case 'i':
+            gap = atoi(optarg);
+            break;
+        case 'o':
+            ovh = atoi(optarg);
+            break;
+        case 'j':
+            job = atoi(optarg);
+            break;
+        case 'p':
+            per = atoi(optarg);
+            break;
+        case 'q':
+            qsize = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "Usage: oob_threads_bench [-n messages] [-s bytes] [-i usec between]\n"
+                            "                         [-o usec per message] [-j usec per job]\n"
+                            "                         [-p messages per job] [-q ring size]\n");
+            return 1;
+        }
+    }
+    if (nmsgs < 1) {
+        nmsgs = 1;
+    }
+    if (size < (int) sizeof(double)) {
+        size = sizeof(double);
+    }
+    if (per < 1) {
+        per = 1;
+    }
+    /* the ring is indexed by mask, as in the component */
+    for (q = 1; q < qsize; q <<= 1);
+    qsize = q;
+
+    printf("%d messages of %d bytes every %d usec, %d usec each, a %d usec job every %d\n",
+           nmsgs, size, gap, ovh, job, per);
+    printf("%-9s %10s %12s %12s %12s %12s %10s\n", "progress", "stuck(ms)", "sock avg(us)",
+           "sock max(us)", "hand avg(us)", "hand max(us)", "total(ms)");
+    run("inline", 0);
+    run("threaded", 1);
+    return 0;
+}
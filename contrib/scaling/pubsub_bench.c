@@ -0,0 +1,398 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Drive publish/lookup traffic from -c clients through the data
+ * server, organized each of the ways PRTE can hold the data:
+ *
+ *   scan    - one server (the HNP) keeps the published values in an
+ *             array that every lookup searches, and the lookups that
+ *             wait for data in a list searched on every publish
+ *   index   - one server with the values and the waiting lookups
+ *             indexed by key
+ *   shard   - -s servers with indexed stores, each holding the keys
+ *             whose hash selects it (prte_data_server_shards)
+ *
+ * Every client publishes -k keys, looks up with a wait the -k keys
+ * published by the next client - which may not be there yet - and
+ * then looks up -l random keys of any client. The requests are sent
+ * one at a time over a socket to the server holding the key. Reported
+ * are the operations per second and, for the busiest server, the
+ * number of requests it handled and the cpu time it needed.
+ *
+ * Usage: pubsub_bench [-c clients] [-k keys] [-l lookups] [-s shards]
+ */
+
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define KEYLEN 64
+#define VALLEN 64
+
+enum { SCAN, INDEX };
+enum { PUBLISH, LOOKUP };
+
+typedef struct {
+    uint32_t cmd;
+    char key[KEYLEN];
+    char val[VALLEN];
+} msg_t;
+
+typedef struct {
+    int32_t status;
+    char val[VALLEN];
+} reply_t;
+
+/* a published value */
+typedef struct entry {
+    struct entry *next;
+    char key[KEYLEN];
+    char val[VALLEN];
+    int published;
+    /* the index keeps the waiting clients with the key */
+    int *waiters;
+    int nwaiters;
+} entry_t;
+
+/* a waiting lookup in the scan server */
+typedef struct {
+    int fd;
+    char key[KEYLEN];
+} wait_t;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static double cpu(int who)
+{
+    struct rusage ru;
+
+    getrusage(who, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec
+           + ru.ru_stime.tv_usec / 1e6;
+}
+
+static uint32_t hash(const char *key)
+{
+    uint32_t h = 2166136261u;
+
+    for (; '\0' != *key; key++) {
+        h ^= (uint8_t) *key;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int readall(int fd, void *data, size_t len)
+{
+    char *p = data;
+    ssize_t n;
+
+    while (0 < len) {
+        n = read(fd, p, len);
+        if (0 >= n) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void answer(int fd, int status, const char *val)
+{
+    reply_t r;
+
+    memset(&r, 0, sizeof(r));
+    r.status = status;
+    if (NULL != val) {
+        memcpy(r.val, val, VALLEN);
+    }
+    if (sizeof(r) != write(fd, &r, sizeof(r))) {
+        exit(1);
+    }
+}
+
+/* serve the requests arriving on the fds until all are closed,
+ * then report to the parent on the result fd */
+static void server(int mode, int *fds, int nfds, int result)
+{
+    struct pollfd *pfds = calloc(nfds, sizeof(struct pollfd));
+    entry_t **array = NULL, **table = NULL, *e;
+    wait_t *pending = NULL;
+    size_t narray = 0, sarray = 0, npending = 0, spending = 0, size = 1 << 16, i;
+    uint64_t requests = 0;
+    int open = nfds, n;
+    double load[2];
+    msg_t m;
+
+    if (INDEX == mode) {
+        table = calloc(size, sizeof(entry_t *));
+    }
+    for (n = 0; n < nfds; n++) {
+        pfds[n].fd = fds[n];
+        pfds[n].events = POLLIN;
+    }
+    while (0 < open) {
+        if (0 >= poll(pfds, nfds, -1)) {
+            continue;
+        }
+        for (n = 0; n < nfds; n++) {
+            if (0 > pfds[n].fd || 0 == pfds[n].revents) {
+                continue;
+            }
+            if (0 != readall(pfds[n].fd, &m, sizeof(m))) {
+                close(pfds[n].fd);
+                pfds[n].fd = -1;
+                --open;
+                continue;
+            }
+            ++requests;
+
+            if (SCAN == mode) {
+                if (PUBLISH == m.cmd) {
+                    e = calloc(1, sizeof(entry_t));
+                    memcpy(e->key, m.key, KEYLEN);
+                    memcpy(e->val, m.val, VALLEN);
+                    if (narray == sarray) {
+                        sarray = sarray ? 2 * sarray : 1024;
+                        array = realloc(array, sarray * sizeof(entry_t *));
+                    }
+                    array[narray++] = e;
+                    answer(pfds[n].fd, 0, NULL);
+                    /* check every pending request */
+                    for (i = 0; i < npending;) {
+                        if (0 == strncmp(pending[i].key, e->key, KEYLEN)) {
+                            answer(pending[i].fd, 0, e->val);
+                            pending[i] = pending[--npending];
+                        } else {
+                            i++;
+                        }
+                    }
+                    continue;
+                }
+                for (i = 0; i < narray; i++) {
+                    if (0 == strncmp(array[i]->key, m.key, KEYLEN)) {
+                        break;
+                    }
+                }
+                if (i < narray) {
+                    answer(pfds[n].fd, 0, array[i]->val);
+                    continue;
+                }
+                if (npending == spending) {
+                    spending = spending ? 2 * spending : 1024;
+                    pending = realloc(pending, spending * sizeof(wait_t));
+                }
+                pending[npending].fd = pfds[n].fd;
+                memcpy(pending[npending].key, m.key, KEYLEN);
+                ++npending;
+                continue;
+            }
+
+            /* indexed */
+            for (e = table[hash(m.key) & (size - 1)]; NULL != e; e = e->next) {
+                if (0 == strncmp(e->key, m.key, KEYLEN)) {
+                    break;
+                }
+            }
+            if (NULL == e) {
+                e = calloc(1, sizeof(entry_t));
+                memcpy(e->key, m.key, KEYLEN);
+                e->next = table[hash(m.key) & (size - 1)];
+                table[hash(m.key) & (size - 1)] = e;
+            }
+            if (PUBLISH == m.cmd) {
+                memcpy(e->val, m.val, VALLEN);
+                e->published = 1;
+                answer(pfds[n].fd, 0, NULL);
+                /* only those waiting for this key */
+                for (i = 0; i < (size_t) e->nwaiters; i++) {
+                    answer(e->waiters[i], 0, e->val);
+                }
+                free(e->waiters);
+                e->waiters = NULL;
+                e->nwaiters = 0;
+            } else if (e->published) {
+                answer(pfds[n].fd, 0, e->val);
+            } else {
+                e->waiters = realloc(e->waiters, (e->nwaiters + 1) * sizeof(int));
+                e->waiters[e->nwaiters++] = pfds[n].fd;
+            }
+        }
+    }
+    load[0] = requests;
+    load[1] = cpu(RUSAGE_SELF);
+    if (sizeof(load) != write(result, load, sizeof(load))) {
+        exit(1);
+    }
+    exit(0);
+}
+
+static void request(int fd, int cmd, const char *key)
+{
+    msg_t m;
+    reply_t r;
+
+    memset(&m, 0, sizeof(m));
+    m.cmd = cmd;
+    snprintf(m.key, KEYLEN, "%s", key);
+    if (PUBLISH == cmd) {
+        snprintf(m.val, VALLEN, "value of %s", key);
+    }
+    if (sizeof(m) != write(fd, &m, sizeof(m)) || 0 != readall(fd, &r, sizeof(r))) {
+        exit(1);
+    }
+}
+
+static void client(int id, int *fds, int nservers, int nclients, int nkeys, int nlookups)
+{
+    char key[KEYLEN];
+    int k;
+
+    srandom(id);
+    for (k = 0; k < nkeys; k++) {
+        snprintf(key, sizeof(key), "client-%d-port-%d", id, k);
+        request(fds[hash(key) % nservers], PUBLISH, key);
+    }
+    for (k = 0; k < nkeys; k++) {
+        snprintf(key, sizeof(key), "client-%d-port-%d", (id + 1) % nclients, k);
+        request(fds[hash(key) % nservers], LOOKUP, key);
+    }
+    for (k = 0; k < nlookups; k++) {
+        snprintf(key, sizeof(key), "client-%d-port-%d", (int) (random() % nclients),
+                 (int) (random() % nkeys));
+        request(fds[hash(key) % nservers], LOOKUP, key);
+    }
+    exit(0);
+}
+
+static void run(const char *name, int mode, int nservers, int nclients, int nkeys, int nlookups)
+{
+    int *sfds = calloc((size_t) nservers * nclients, sizeof(int));
+    int *cfds = calloc((size_t) nservers * nclients, sizeof(int));
+    int res[2], sv[2], s, c, status;
+    double t0, t, load[2], maxreq = 0, maxcpu = 0;
+
+    fflush(stdout);
+    if (0 != pipe(res)) {
+        perror("pipe");
+        exit(1);
+    }
+    for (s = 0; s < nservers; s++) {
+        for (c = 0; c < nclients; c++) {
+            if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+                perror("socketpair");
+                exit(1);
+            }
+            sfds[s * nclients + c] = sv[0];
+            cfds[c * nservers + s] = sv[1];
+        }
+    }
+
+    t0 = now();
+    for (s = 0; s < nservers; s++) {
+        if (0 == fork()) {
+            for (c = 0; c < nservers * nclients; c++) {
+                close(cfds[c]);
+                if (c / nclients != s) {
+                    close(sfds[c]);
+                }
+            }
+            close(res[0]);
+            server(mode, &sfds[s * nclients], nclients, res[1]);
+        }
+    }
+    for (c = 0; c < nclients; c++) {
+        if (0 == fork()) {
+            for (s = 0; s < nservers * nclients; s++) {
+                close(sfds[s]);
+                if (s / nservers != c) {
+                    close(cfds[s]);
+                }
+            }
+            close(res[0]);
+            close(res[1]);
+            client(c, &cfds[c * nservers], nservers, nclients, nkeys, nlookups);
+        }
+    }
+    for (s = 0; s < nservers * nclients; s++) {
+        close(sfds[s]);
+        close(cfds[s]);
+    }
+    close(res[1]);
+    for (s = 0; s < nservers; s++) {
+        if (0 != readall(res[0], load, sizeof(load))) {
+            break;
+        }
+        if (load[0] > maxreq) {
+            maxreq = load[0];
+        }
+        if (load[1] > maxcpu) {
+            maxcpu = load[1];
+        }
+    }
+    t = now() - t0;
+    close(res[0]);
+    while (0 < wait(&status));
+
+    printf("%-6s %7d %12.0f %14.0f %12.3f\n", name, nservers,
+           (double) nclients * (2 * nkeys + nlookups) / t, maxreq, maxcpu);
+    free(sfds);
+    free(cfds);
+}
+
+int main(int argc, char *argv[])
+{
+    int nclients = 64, nkeys = 200, nlookups = 400, nshards = 4, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "c:k:l:s:h"))) {
+        switch (opt) {
+        case 'c':
+            nclients = atoi(optarg);
+            break;
+        case 'k':
+            nkeys = atoi(optarg);
+            break;
+        case 'l':
+            nlookups = atoi(optarg);
+            break;
+        case 's':
+            nshards = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: pubsub_bench [-c clients] [-k keys] [-l lookups] [-s shards]\n");
+            return 1;
+        }
+    }
+    if (nclients < 2) {
+        nclients = 2;
+    }
+    if (nkeys < 1) {
+        nkeys = 1;
+    }
+    if (nshards < 2) {
+        nshards = 2;
+    }
+
+    printf("%d clients, each publishing %d keys and looking up %d with a wait and %d more\n",
+           nclients, nkeys, nkeys, nlookups);
+    printf("%-6s %7s %12s %14s %12s\n", "store", "servers", "ops/s", "busiest(reqs)",
+           "busiest(cpu)");
+    run("scan", SCAN, 1, nclients, nkeys, nlookups);
+    run("index", INDEX, 1, nclients, nkeys, nlookups);
+    run("shard", INDEX, nshards, nclients, nkeys, nlookups);
+    return 0;
+}
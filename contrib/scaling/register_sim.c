@@ -0,0 +1,246 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Simulate the work one daemon does to register a job's namespace
+ * with its embedded PMIx server (src/prted/pmix/pmix_server_register_fns.c)
+ * and report the time taken and the growth in resident memory as
+ * the job size increases.
+ *
+ * This is a model: it does not call the registration code, it
+ * builds records of the same shape. Every proc in the job contributes
+ * a proc-level info array - rank, cpuset, locality string,
+ * global/app/local/node ranks, appnum, node id, reincarnation and
+ * hostname - each entry a pmix_info_t sized record (the key alone is
+ * PMIX_MAX_KEYLEN+1 bytes), plus the distances to -d devices when
+ * pmix_generate_distances is set. Two modes are modeled:
+ *
+ *   eager - the arrays for all procs are built at registration, as
+ *           by default
+ *   lazy  - the device distances of remote procs are left out at
+ *           registration (pmix_lazy_proc_data) and built the first
+ *           time a local client asks for that proc. The -t option
+ *           sets how many distinct remote peers each local proc
+ *           touches afterwards (e.g., its halo neighbors)
+ *
+ * Usage: register_sim [-p ppn] [-d ndevices] [-t touched] [-n nprocs]...
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define KEYLEN 512
+#define NKEYS 12
+
+typedef struct {
+    char key[KEYLEN];
+    uint32_t flags;
+    uint16_t type;
+    union {
+        uint32_t u32;
+        char *string;
+    } data;
+} info_t;
+
+/* as pmix_device_distance_t */
+typedef struct {
+    char *uuid;
+    char *osname;
+    uint16_t type;
+    uint16_t mindist;
+    uint16_t maxdist;
+} dist_t;
+
+typedef struct {
+    info_t *info;
+    size_t ninfo;
+    dist_t *dist;
+} proc_data_t;
+
+static unsigned ppn = 64, ndev = 4;
+
+static void load(info_t *info, const char *key, const char *str, uint32_t u32)
+{
+    strncpy(info->key, key, KEYLEN - 1);
+    info->flags = 0;
+    if (NULL != str) {
+        info->type = 3;
+        info->data.string = strdup(str);
+    } else {
+        info->type = 14;
+        info->data.u32 = u32;
+    }
+}
+
+/* build the info array for one proc, including the locality
+ * string the server would generate from its cpuset */
+static void build(proc_data_t *pd, unsigned rank)
+{
+    unsigned lrank = rank % ppn, node = rank / ppn, n = 0;
+    char cpuset[32], locality[128], host[32];
+
+    snprintf(cpuset, sizeof(cpuset), "%u", lrank);
+    snprintf(locality, sizeof(locality), "SK%u:L3%u:L2%u:L1%u:CR%u:HT%u", lrank / 32, lrank / 8,
+             lrank, lrank, lrank, lrank);
+    snprintf(host, sizeof(host), "node%05u", node);
+
+    pd->info = calloc(NKEYS, sizeof(info_t));
+    load(&pd->info[n++], "pmix.rank", NULL, rank);
+    load(&pd->info[n++], "pmix.cpuset", cpuset, 0);
+    load(&pd->info[n++], "pmix.locstr", locality, 0);
+    load(&pd->info[n++], "pmix.grank", NULL, rank);
+    load(&pd->info[n++], "pmix.appnum", NULL, 0);
+    load(&pd->info[n++], "pmix.apprank", NULL, rank);
+    load(&pd->info[n++], "pmix.lrank", NULL, lrank);
+    load(&pd->info[n++], "pmix.nrank", NULL, lrank);
+    load(&pd->info[n++], "pmix.nodeid", NULL, node);
+    load(&pd->info[n++], "pmix.reinc", NULL, 0);
+    load(&pd->info[n++], "pmix.hname", host, 0);
+    pd->ninfo = n;
+}
+
+/* the distances from one proc's binding to each device on its node */
+static void build_dist(proc_data_t *pd, unsigned rank)
+{
+    char name[64];
+    unsigned d;
+
+    if (0 == ndev) {
+        return;
+    }
+    pd->dist = calloc(ndev, sizeof(dist_t));
+    for (d = 0; d < ndev; d++) {
+        snprintf(name, sizeof(name), "fab://node%05u/dev%u", rank / ppn, d);
+        pd->dist[d].uuid = strdup(name);
+        snprintf(name, sizeof(name), "mlx5_%u", d);
+        pd->dist[d].osname = strdup(name);
+        pd->dist[d].mindist = (uint16_t) ((rank % ppn) / 32 == d % 2 ? 1 : 2);
+        pd->dist[d].maxdist = pd->dist[d].mindist;
+    }
+}
+
+static void release(proc_data_t *pd)
+{
+    size_t n;
+
+    if (NULL == pd->info) {
+        return;
+    }
+    for (n = 0; n < pd->ninfo; n++) {
+        if (3 == pd->info[n].type) {
+            free(pd->info[n].data.string);
+        }
+    }
+    free(pd->info);
+    pd->info = NULL;
+    if (NULL != pd->dist) {
+        for (n = 0; n < ndev; n++) {
+            free(pd->dist[n].uuid);
+            free(pd->dist[n].osname);
+        }
+        free(pd->dist);
+        pd->dist = NULL;
+    }
+}
+
+static void run(unsigned nprocs, int lazy, unsigned touched)
+{
+    proc_data_t *pd = calloc(nprocs, sizeof(proc_data_t));
+    unsigned me = 0, r, n, built = 0;
+    long rss0, rss1, rss2;
+    double t0, treg, tlazy = 0;
+
+    /* we are the daemon on node 0 */
+    rss0 = bench_rss_kb();
+    t0 = bench_now();
+    for (r = 0; r < nprocs; r++) {
+        build(&pd[r], r);
+        if (lazy && r / ppn != me) {
+            continue;
+        }
+        build_dist(&pd[r], r);
+        ++built;
+    }
+    treg = bench_now() - t0;
+    rss1 = bench_rss_kb();
+
+    /* each local proc asks about its nearest remote peers */
+    if (lazy) {
+        t0 = bench_now();
+        for (r = 0; r < ppn && r < nprocs; r++) {
+            for (n = 1; n <= touched; n++) {
+                unsigned peer = (r + n * ppn) % nprocs;
+                if (NULL == pd[peer].dist && peer / ppn != me) {
+                    build_dist(&pd[peer], peer);
+                    ++built;
+                }
+            }
+        }
+        tlazy = bench_now() - t0;
+    }
+    rss2 = bench_rss_kb();
+
+    printf("%-6s %8u %8u %10.2f %10.2f %10ld %10ld\n", lazy ? "lazy" : "eager", nprocs, built,
+           1e3 * treg, 1e3 * tlazy, rss1 - rss0, rss2 - rss0);
+
+    for (r = 0; r < nprocs; r++) {
+        release(&pd[r]);
+    }
+    free(pd);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_list_t sizes = {{1024, 16384, 65536}, 3, 0};
+    unsigned touched = 8;
+    int opt, i, lazy;
+
+    while (-1 != (opt = getopt(argc, argv, "p:d:t:n:h"))) {
+        switch (opt) {
+        case 'p':
+            ppn = strtoul(optarg, NULL, 10);
+            break;
+        case 'd':
+            ndev = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            touched = strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            bench_list_add(&sizes, optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: register_sim [-p ppn] [-d ndevices] [-t touched] [-n nprocs]...\n");
+            return 1;
+        }
+    }
+    if (0 == ppn) {
+        ppn = 1;
+    }
+
+    bench_model("nspace registration on one daemon");
+    printf("ppn %u devices %u touched peers per local proc %u\n", ppn, ndev, touched);
+    printf("%-6s %8s %8s %10s %10s %10s %10s\n", "mode", "nprocs", "dists", "reg(ms)",
+           "ondmd(ms)", "regRSS(KB)", "RSS(KB)");
+    for (i = 0; i < sizes.n; i++) {
+        if (sizes.v[i] < 1) {
+            continue;
+        }
+        for (lazy = 0; lazy < 2; lazy++) {
+            /* each run gets a fresh heap so the RSS growth is its own */
+            fflush(stdout);
+            if (0 == fork()) {
+                run((unsigned) sizes.v[i], lazy, touched);
+                exit(0);
+            }
+            wait(NULL);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Simulate collective completion times over the daemon routing
+ * tree layouts selectable via rml_base_routing (radix, knomial and
+ * binomial) without having to launch any daemons. The tree shapes
+ * follow src/rml/routed_radix.c.
+ *
+ * Each message costs a fixed latency, and a daemon pays a per-message
+ * overhead for every send or receive it handles, so wide trees pay
+ * in serialization what deep trees pay in latency. Two collectives
+ * are modeled:
+ *
+ *   xcast     - the HNP relays a message down the tree, each daemon
+ *               forwarding to its children one after the other
+ *   allgather - contributions roll up the tree to the HNP, each
+ *               daemon waiting on all of its children, followed by
+ *               an xcast of the result
+ *
+ * Usage: routing_sim [-r radix] [-l latency_usec] [-o overhead_usec]
+ *                    [-n ndaemons]...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+static unsigned radix = 64;
+
+static unsigned knomial_parent(unsigned rank, unsigned k)
+{
+    unsigned pw = 1;
+
+    while (pw <= rank / k) {
+        pw *= k;
+    }
+    return rank % pw;
+}
+
+static const char *layouts[] = {"radix", "knomial", "binomial"};
+
+static unsigned parent(int layout, unsigned rank)
+{
+    switch (layout) {
+    case 1:
+        return knomial_parent(rank, radix);
+    case 2:
+        return knomial_parent(rank, 2);
+    default:
+        return bench_radix_parent(rank, radix);
+    }
+}
+
+static void simulate(int layout, unsigned n, double lat, double ovh)
+{
+    unsigned *par, *nkids, *order, r, p, maxdepth = 0, maxkids = 0;
+    unsigned *lvl;
+    double *down, *up, xcast = 0.0, rollup;
+
+    par = calloc(n, sizeof(unsigned));
+    nkids = calloc(n, sizeof(unsigned));
+    order = calloc(n, sizeof(unsigned));
+    lvl = calloc(n, sizeof(unsigned));
+    down = calloc(n, sizeof(double));
+    up = calloc(n, sizeof(double));
+    if (NULL == par || NULL == nkids || NULL == order || NULL == lvl
+        || NULL == down || NULL == up) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    /* parents always precede their children, so everything can be
+     * computed in rank order. The position of a daemon among its
+     * siblings determines when its parent gets around to it */
+    for (r = 1; r < n; r++) {
+        par[r] = parent(layout, r);
+        order[r] = nkids[par[r]]++;
+        lvl[r] = lvl[par[r]] + 1;
+        if (maxdepth < lvl[r]) {
+            maxdepth = lvl[r];
+        }
+    }
+    for (r = 0; r < n; r++) {
+        if (maxkids < nkids[r]) {
+            maxkids = nkids[r];
+        }
+    }
+
+    /* xcast: a daemon has the message once its parent has worked
+     * its way down to it in the list of children */
+    down[0] = 0.0;
+    for (r = 1; r < n; r++) {
+        down[r] = down[par[r]] + ovh * (order[r] + 1) + lat;
+        if (xcast < down[r]) {
+            xcast = down[r];
+        }
+    }
+
+    /* rollup: a daemon is done once the last of its children has
+     * reported in and it has processed every contribution */
+    for (r = n - 1; 0 < r; r--) {
+        up[r] += ovh * nkids[r];
+        p = par[r];
+        if (up[p] < up[r] + lat) {
+            up[p] = up[r] + lat;
+        }
+    }
+    rollup = up[0] + ovh * nkids[0];
+
+    printf("%-9s %6u %6u %8u %12.1f %12.1f\n", layouts[layout], n, maxdepth, maxkids,
+           xcast, rollup + xcast);
+
+    free(par);
+    free(nkids);
+    free(order);
+    free(lvl);
+    free(down);
+    free(up);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_list_t sizes = {{1024, 2048, 4096, 8192, 16384}, 5, 0};
+    int i, layout, opt;
+    double lat = 20.0, ovh = 2.0;
+
+    while (-1 != (opt = getopt(argc, argv, "r:l:o:n:h"))) {
+        switch (opt) {
+        case 'r':
+            radix = strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            lat = strtod(optarg, NULL);
+            break;
+        case 'o':
+            ovh = strtod(optarg, NULL);
+            break;
+        case 'n':
+            bench_list_add(&sizes, optarg);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-r radix] [-l latency_usec] [-o overhead_usec] [-n ndaemons]...\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (radix < 2) {
+        radix = 2;
+    }
+
+    bench_model("collective completion over the routing tree layouts");
+    printf("radix %u latency %.1f usec overhead %.1f usec\n", radix, lat, ovh);
+    printf("%-9s %6s %6s %8s %12s %12s\n", "layout", "ndmns", "depth", "maxkids",
+           "xcast(us)", "allgath(us)");
+    for (i = 0; i < sizes.n; i++) {
+        if (sizes.v[i] < 1) {
+            continue;
+        }
+        for (layout = 0; layout < 3; layout++) {
+            simulate(layout, (unsigned) sizes.v[i], lat, ovh);
+        }
+    }
+    return 0;
+}
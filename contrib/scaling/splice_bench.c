@@ -0,0 +1,191 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Measure how fast a daemon can move the output of a child that
+ * streams at full speed into the child's output file, and what it
+ * costs the daemon, with each of the paths available to the IOF
+ * (iof_base_splice):
+ *
+ *   copy    - read 4k fragments into a stack buffer, copy each into
+ *             a heap buffer and write that to the file, as the data
+ *             does on its way through the PMIx server
+ *   splice  - splice the pipe directly into the file
+ *   tee     - tee the pipe into a private pipe that is spliced into
+ *             the file, then read the data to forward a copy of it
+ *
+ * Usage: splice_bench [-m MB] [-o output file]
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define FRAG 4096
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static double cpu(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec
+           + ru.ru_stime.tv_usec / 1e6;
+}
+
+static void child(int fd, size_t total)
+{
+    static char block[65536];
+    size_t left;
+    ssize_t n;
+
+    memset(block, 'x', sizeof(block));
+    for (left = total; 0 < left; left -= n) {
+        n = write(fd, block, left < sizeof(block) ? left : sizeof(block));
+        if (0 >= n) {
+            _exit(1);
+        }
+    }
+    _exit(0);
+}
+
+static ssize_t move_copy(int in, int out, int *tp)
+{
+    unsigned char data[FRAG];
+    char *heap;
+    ssize_t n;
+
+    (void) tp;
+    n = read(in, data, sizeof(data));
+    if (0 < n) {
+        heap = malloc(n);
+        memcpy(heap, data, n);
+        if (n != write(out, heap, n)) {
+            n = -1;
+        }
+        free(heap);
+    }
+    return n;
+}
+
+static ssize_t move_splice(int in, int out, int *tp)
+{
+    (void) tp;
+    return splice(in, NULL, out, NULL, 65536, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+}
+
+static ssize_t move_tee(int in, int out, int *tp)
+{
+    unsigned char data[FRAG];
+    volatile unsigned char sink;
+    ssize_t n, m, left;
+
+    n = tee(in, tp[1], sizeof(data), SPLICE_F_NONBLOCK);
+    if (0 >= n) {
+        return n;
+    }
+    n = read(in, data, n);
+    for (left = n; 0 < left; left -= m) {
+        m = splice(tp[0], NULL, out, NULL, left, SPLICE_F_MOVE);
+        if (0 >= m) {
+            return -1;
+        }
+    }
+    /* the forwarded copy */
+    sink = data[n - 1];
+    (void) sink;
+    return n;
+}
+
+static void run(const char *name, ssize_t (*move)(int, int, int *), size_t total, const char *path)
+{
+    int p[2], tp[2], out, status, flags;
+    struct pollfd pfd;
+    size_t moved = 0;
+    double t0, c0, t;
+    ssize_t n;
+    pid_t pid;
+
+    out = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (0 > out || 0 != pipe(p) || 0 != pipe(tp)) {
+        perror("setup");
+        exit(1);
+    }
+    pid = fork();
+    if (0 == pid) {
+        close(p[0]);
+        child(p[1], total);
+    }
+    close(p[1]);
+    flags = fcntl(p[0], F_GETFL, 0);
+    fcntl(p[0], F_SETFL, flags | O_NONBLOCK);
+
+    t0 = now();
+    c0 = cpu();
+    pfd.fd = p[0];
+    pfd.events = POLLIN;
+    for (;;) {
+        n = move(p[0], out, tp);
+        if (0 < n) {
+            moved += n;
+            continue;
+        }
+        if (0 == n) {
+            break;
+        }
+        if (EAGAIN != errno && EINTR != errno) {
+            perror(name);
+            break;
+        }
+        poll(&pfd, 1, -1);
+    }
+    t = now() - t0;
+    printf("%-7s %8.0f MB/s  daemon cpu %6.3f s  %s\n", name, moved / t / 1e6, cpu() - c0,
+           moved == total ? "" : "SHORT");
+    waitpid(pid, &status, 0);
+    close(p[0]);
+    close(tp[0]);
+    close(tp[1]);
+    close(out);
+    unlink(path);
+}
+
+int main(int argc, char *argv[])
+{
+    int mb = 1024, opt;
+    const char *path = "splice_bench.out";
+
+    while (-1 != (opt = getopt(argc, argv, "m:o:h"))) {
+        switch (opt) {
+        case 'm':
+            mb = atoi(optarg);
+            break;
+        case 'o':
+            path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: splice_bench [-m MB] [-o output file]\n");
+            return 1;
+        }
+    }
+
+    printf("child streams %d MB into %s\n", mb, path);
+    run("copy", move_copy, (size_t) mb << 20, path);
+    run("splice", move_splice, (size_t) mb << 20, path);
+    run("tee", move_tee, (size_t) mb << 20, path);
+    return 0;
+}
@@ -0,0 +1,188 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Measure what it costs the DVM controller to learn one node
+ * topology during daemon startup, with and without the persistent
+ * topology cache (prte_topo_cache_dir).
+ *
+ * Without the cache, daemon 1 - and, for each additional node type,
+ * one daemon of that type when asked - exports its topology as XML,
+ * compresses it and sends it; the controller decompresses it and
+ * imports it before the daemons of that type are counted as
+ * reported. With the cache, the controller imports the XML from disk
+ * at boot, before any daemon is launched, and the daemons only send
+ * their signature.
+ *
+ * The topology of the local machine is used for every node type. The
+ * -r option sets the round trip (in usec) of the topology request
+ * that precedes every report but the one from daemon 1.
+ *
+ * Usage: topo_cache_bench [-t node types] [-r rtt usec] [-i iterations]
+ */
+
+#include <hwloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static uint64_t fnv(const char *data, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t n;
+
+    for (n = 0; n < len; n++) {
+        hash ^= (uint8_t) data[n];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static hwloc_topology_t import(const char *xml, size_t len)
+{
+    hwloc_topology_t topo;
+
+    hwloc_topology_init(&topo);
+    hwloc_topology_set_xmlbuffer(topo, xml, len + 1);
+    hwloc_topology_set_io_types_filter(topo, HWLOC_TYPE_FILTER_KEEP_IMPORTANT);
+    hwloc_topology_set_flags(topo, HWLOC_TOPOLOGY_FLAG_INCLUDE_DISALLOWED);
+    if (0 != hwloc_topology_load(topo)) {
+        fprintf(stderr, "failed to import topology\n");
+        exit(1);
+    }
+    return topo;
+}
+
+int main(int argc, char *argv[])
+{
+    hwloc_topology_t topo, t2;
+    char *xml, path[] = "/tmp/topo_cache_benchXXXXXX", *buf;
+    int len, xmllen, opt, fd, ntypes = 4, iters = 20, i;
+    unsigned rtt = 200;
+    uLongf clen;
+    unsigned char *cbuf;
+    char *ubuf;
+    uLongf ulen;
+    double t0, tdaemon = 0, thnp = 0, tload = 0, tcheck = 0, ship, cached;
+    FILE *fp;
+
+    while (-1 != (opt = getopt(argc, argv, "t:r:i:h"))) {
+        switch (opt) {
+        case 't':
+            ntypes = atoi(optarg);
+            break;
+        case 'r':
+            rtt = strtoul(optarg, NULL, 10);
+            break;
+        case 'i':
+            iters = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: topo_cache_bench [-t node types] [-r rtt usec] [-i iterations]\n");
+            return 1;
+        }
+    }
+    if (0 >= ntypes) {
+        ntypes = 1;
+    }
+    if (0 >= iters) {
+        iters = 1;
+    }
+
+    hwloc_topology_init(&topo);
+    hwloc_topology_set_io_types_filter(topo, HWLOC_TYPE_FILTER_KEEP_IMPORTANT);
+    hwloc_topology_set_flags(topo, HWLOC_TOPOLOGY_FLAG_INCLUDE_DISALLOWED);
+    hwloc_topology_load(topo);
+
+    /* one cache entry on disk */
+    hwloc_topology_export_xmlbuffer(topo, &xml, &len, 0);
+    xmllen = --len;
+    fd = mkstemp(path);
+    fp = fdopen(fd, "w");
+    fprintf(fp, "PRTE-TOPOLOGY-CACHE 1\nsig\n%016llx %d\n", (unsigned long long) fnv(xml, len), len);
+    fwrite(xml, 1, len, fp);
+    fclose(fp);
+    hwloc_free_xmlbuffer(topo, xml);
+
+    clen = 0;
+    for (i = 0; i < iters; i++) {
+        /* daemon: export and compress */
+        t0 = now();
+        hwloc_topology_export_xmlbuffer(topo, &xml, &len, 0);
+        clen = compressBound(len);
+        cbuf = malloc(clen);
+        compress2(cbuf, &clen, (unsigned char *) xml, len, Z_DEFAULT_COMPRESSION);
+        tdaemon += now() - t0;
+
+        /* controller: decompress and import */
+        t0 = now();
+        ulen = len;
+        ubuf = malloc(ulen);
+        uncompress((unsigned char *) ubuf, &ulen, cbuf, clen);
+        t2 = import(ubuf, ulen - 1);
+        thnp += now() - t0;
+        hwloc_topology_destroy(t2);
+        free(ubuf);
+        free(cbuf);
+        hwloc_free_xmlbuffer(topo, xml);
+
+        /* controller boot: read, validate and import the entry */
+        t0 = now();
+        fp = fopen(path, "r");
+        fseek(fp, 0, SEEK_END);
+        len = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        buf = malloc(len + 1);
+        if ((size_t) len != fread(buf, 1, len, fp)) {
+            fprintf(stderr, "short read\n");
+            return 1;
+        }
+        buf[len] = '\0';
+        fclose(fp);
+        xml = strchr(strchr(strchr(buf, '\n') + 1, '\n') + 1, '\n') + 1;
+        if (strtoull(strchr(strchr(buf, '\n') + 1, '\n') + 1, NULL, 16)
+            != fnv(xml, buf + len - xml)) {
+            fprintf(stderr, "hash mismatch\n");
+            return 1;
+        }
+        t2 = import(xml, buf + len - xml);
+        tload += now() - t0;
+        hwloc_topology_destroy(t2);
+        free(buf);
+
+        /* daemon: hash its signature against the known list */
+        t0 = now();
+        (void) fnv("1N:2S:2L3:64L2:64L1:64C:128H:0-127::x86_64:le", 46);
+        tcheck += now() - t0;
+    }
+    unlink(path);
+
+    tdaemon /= iters;
+    thnp /= iters;
+    tload /= iters;
+    tcheck /= iters;
+    ship = ntypes * (tdaemon + thnp) + (ntypes - 1) * rtt / 1e6;
+    cached = ntypes * tcheck;
+
+    printf("XML %d bytes, %lu compressed\n", xmllen, (unsigned long) clen);
+    printf("per topology: daemon export+compress %.2f ms, controller decompress+import %.2f ms\n",
+           1e3 * tdaemon, 1e3 * thnp);
+    printf("per cached topology: controller load at boot %.2f ms\n", 1e3 * tload);
+    printf("%d node types, %u usec request rtt:\n", ntypes, rtt);
+    printf("  on the report path without cache %8.2f ms\n", 1e3 * ship);
+    printf("  on the report path with cache    %8.2f ms (+%.2f ms at controller boot)\n",
+           1e3 * cached, 1e3 * ntypes * tload);
+    hwloc_topology_destroy(topo);
+    return 0;
+}
@@ -0,0 +1,147 @@
+/* -*- C -*-
+ *
+ * $HEADER$
+ *
+ * Simulate the end-to-end latency of an xcast down the radix routing
+ * tree of src/rml/routed_radix.c against the message size and the
+ * tree radix, with the message relayed whole and cut into segments
+ * (grpcomm_direct_xcast_segment_size):
+ *
+ *   whole     - a daemon receives the complete message, copies it
+ *               once into the shared relay payload and then sends it
+ *               to each of its children in turn
+ *   segmented - the HNP sends every segment to its children as fast
+ *               as its link allows, and a daemon copies and forwards
+ *               each segment as soon as it has arrived, then copies
+ *               it into the reassembly buffer
+ *
+ * Each daemon has a single outgoing link that carries its sends in
+ * the order they were queued. Every send costs the sender a fixed
+ * overhead plus the bytes over the bandwidth, and arrives one latency
+ * later. The xcast is complete when the last daemon holds the whole
+ * message. The simulator RAS does not launch daemons, so there is no
+ * relay tree to time for real.
+ *
+ * Usage: xcast_sim [-n ndaemons] [-l latency_usec] [-o overhead_usec]
+ *                  [-b bandwidth MB/s] [-c copy MB/s] [-S segment bytes]
+ *                  [-r radix]... [-s message bytes]...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+static double lat = 20.0, ovh = 2.0, wire = 1.0 / 1000, copy = 1.0 / 4000;
+
+/* time at which the last daemon holds all nfrags pieces of a message
+ * of the given size. Parents always precede their children, so the
+ * arrival times can be computed in rank order */
+static double xcast(unsigned n, unsigned radix, double size, double seg)
+{
+    unsigned r, p, k, nfrags;
+    double *arr, *tx, piece, t, done = 0.0;
+
+    nfrags = (0 < seg && seg < size) ? (unsigned) ((size + seg - 1) / seg) : 1;
+    piece = size / nfrags;
+    arr = calloc((size_t) n * nfrags, sizeof(double));
+    tx = calloc(n, sizeof(double));
+    if (NULL == arr || NULL == tx) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    /* the HNP has every piece at the start. Everyone else copies each
+     * piece into its relay payload before it can go out */
+    for (r = 1; r < n; r++) {
+        p = bench_radix_parent(r, radix);
+        for (k = 0; k < nfrags; k++) {
+            /* the parent queued this piece for all its children as
+             * soon as it arrived - the link serves them in rank order */
+            t = arr[(size_t) p * nfrags + k];
+            if (0 < p) {
+                t += piece * copy;
+            }
+            if (tx[p] < t) {
+                tx[p] = t;
+            }
+            tx[p] += ovh + piece * wire;
+            arr[(size_t) r * nfrags + k] = tx[p] + lat;
+        }
+    }
+    for (r = 1; r < n; r++) {
+        /* segments are also copied into the reassembly buffer */
+        t = arr[(size_t) r * nfrags + nfrags - 1] + (1 < nfrags ? piece * copy : 0.0);
+        if (done < t) {
+            done = t;
+        }
+    }
+
+    free(arr);
+    free(tx);
+    return done;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_list_t radices = {{8, 16, 32, 64}, 4, 0};
+    bench_list_t sizes = {{65536, 1048576, 4194304, 16777216}, 4, 0};
+    double seg = 65536, t1, t2;
+    unsigned n = 4096, radix;
+    int i, j, opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:l:o:b:c:S:r:s:h"))) {
+        switch (opt) {
+        case 'n':
+            n = strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            lat = strtod(optarg, NULL);
+            break;
+        case 'o':
+            ovh = strtod(optarg, NULL);
+            break;
+        case 'b':
+            wire = 1.0 / strtod(optarg, NULL);
+            break;
+        case 'c':
+            copy = 1.0 / strtod(optarg, NULL);
+            break;
+        case 'S':
+            seg = strtod(optarg, NULL);
+            break;
+        case 'r':
+            bench_list_add(&radices, optarg);
+            break;
+        case 's':
+            bench_list_add(&sizes, optarg);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n ndaemons] [-l latency_usec] [-o overhead_usec]\n"
+                    "          [-b bandwidth MB/s] [-c copy MB/s] [-S segment bytes]\n"
+                    "          [-r radix]... [-s message bytes]...\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (n < 2) {
+        n = 2;
+    }
+
+    bench_model("xcast relay, whole against segmented");
+    printf("%u daemons, latency %.1f usec, overhead %.1f usec, %.0f MB/s wire, %.0f MB/s copy, "
+           "%.0f byte segments\n", n, lat, ovh, 1.0 / wire, 1.0 / copy, seg);
+    printf("%6s %12s %14s %14s\n", "radix", "message(B)", "whole(ms)", "segmented(ms)");
+    for (i = 0; i < radices.n; i++) {
+        radix = radices.v[i] < 2 ? 2 : (unsigned) radices.v[i];
+        for (j = 0; j < sizes.n; j++) {
+            t1 = xcast(n, radix, sizes.v[j], 0);
+            t2 = xcast(n, radix, sizes.v[j], seg);
+            printf("%6u %12.0f %14.3f %14.3f\n", radix, sizes.v[j], t1 / 1000, t2 / 1000);
+        }
+    }
+    return 0;
+}
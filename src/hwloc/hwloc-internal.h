@@ -359,6 +359,10 @@ PRTE_EXPORT hwloc_obj_t prte_hwloc_base_get_pu(hwloc_topology_t topo, bool use_h
  * if responsible for freeing the returned string */
 PRTE_EXPORT char *prte_hwloc_base_get_topo_signature(hwloc_topology_t topo);
 
+/* compute a 64-bit hash of a topology signature or of its XML
+ * representation - used to identify entries in the topology cache */
+PRTE_EXPORT uint64_t prte_hwloc_base_topo_hash(const char *data, size_t len);
+
 /* get a string describing the locality of a given process */
 PRTE_EXPORT char *prte_hwloc_base_get_locality_string(hwloc_topology_t topo, char *bitmap);
 
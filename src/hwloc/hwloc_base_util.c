@@ -1373,6 +1373,19 @@ char *prte_hwloc_base_get_topo_signature(hwloc_topology_t topo)
     return sig;
 }
 
+uint64_t prte_hwloc_base_topo_hash(const char *data, size_t len)
+{
+    /* 64-bit FNV-1a */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t n;
+
+    for (n = 0; n < len; n++) {
+        hash ^= (uint8_t) data[n];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
 static int prte_hwloc_base_get_locality_string_by_depth(hwloc_topology_t topo, int d,
                                                         hwloc_cpuset_t cpuset,
                                                         hwloc_cpuset_t result)
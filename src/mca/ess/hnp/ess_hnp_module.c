@@ -61,6 +61,7 @@
 #include "src/mca/odls/base/base.h"
 #include "src/mca/oob/base/base.h"
 #include "src/mca/plm/base/base.h"
+#include "src/mca/plm/base/plm_private.h"
 #include "src/mca/plm/plm.h"
 #include "src/mca/prtereachable/base/base.h"
 #include "src/mca/ras/base/base.h"
@@ -394,6 +395,8 @@ static int rte_init(int argc, char **argv)
     pmix_pointer_array_add(prte_node_topologies, t);
     node->topology = t;
     node->available = prte_hwloc_base_filter_cpus(prte_hwloc_topology);
+    /* add any topologies our daemons reported in earlier sessions */
+    prte_plm_base_topo_cache_load();
     if (15 < pmix_output_get_verbosity(prte_ess_base_framework.framework_output)) {
         char *output = NULL;
         pmix_output(0, "%s Topology Info:", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
@@ -30,8 +30,12 @@ PRTE_MODULE_EXPORT extern prte_filem_base_component_t prte_mca_filem_raw_compone
 PRTE_EXPORT extern prte_filem_base_module_t prte_filem_raw_module;
 
 extern bool prte_filem_raw_flatten_trees;
+extern int prte_filem_raw_chunk_size;
+extern int prte_filem_raw_window;
+extern bool prte_filem_raw_stream;
 
-#define PRTE_FILEM_RAW_CHUNK_MAX 16384
+#define PRTE_FILEM_RAW_CHUNK_DEFAULT (1024 * 1024)
+#define PRTE_FILEM_RAW_WINDOW_DEFAULT 8
 
 /* local classes */
 typedef struct {
@@ -50,10 +54,15 @@ typedef struct {
     prte_filem_raw_outbound_t *outbound;
     prte_app_idx_t app_idx;
     bool pending;
+    int32_t id;
     char *src;
     char *file;
     int32_t type;
+    unsigned char *data;
     int32_t nchunk;
+    int32_t interval; // chunks between window acks
+    int32_t nacked;   // window acks received from the whole tree
+    bool stalled;     // waiting for the window to open
     int status;
     pmix_rank_t nrecvd;
 } prte_filem_raw_xfer_t;
@@ -64,20 +73,26 @@ typedef struct {
     prte_app_idx_t app_idx;
     prte_event_t ev;
     bool pending;
+    bool failed;
     int fd;
+    int32_t id;
     char *file;
     char *top;
     char *fullpath;
     int32_t type;
     char **link_pts;
     pmix_list_t outputs;
+    int32_t interval;  // chunks between window acks
+    int32_t nreported; // window acks passed up the tree
+    int32_t *acks;     // acks seen for each outstanding window, indexed mod nacks
+    int32_t nacks;
 } prte_filem_raw_incoming_t;
 PMIX_CLASS_DECLARATION(prte_filem_raw_incoming_t);
 
 typedef struct {
     pmix_list_item_t super;
     int numbytes;
-    unsigned char data[PRTE_FILEM_RAW_CHUNK_MAX];
+    unsigned char *data;
 } prte_filem_raw_output_t;
 PMIX_CLASS_DECLARATION(prte_filem_raw_output_t);
 
@@ -37,6 +37,9 @@ static int filem_raw_close(void);
 static int filem_raw_query(pmix_mca_base_module_t **module, int *priority);
 
 bool prte_filem_raw_flatten_trees = false;
+int prte_filem_raw_chunk_size = PRTE_FILEM_RAW_CHUNK_DEFAULT;
+int prte_filem_raw_window = PRTE_FILEM_RAW_WINDOW_DEFAULT;
+bool prte_filem_raw_stream = true;
 
 prte_filem_base_component_t prte_mca_filem_raw_component = {
     PRTE_FILEM_BASE_VERSION_2_0_0,
@@ -65,6 +68,36 @@ static int filem_raw_register(void)
                                                 PMIX_MCA_BASE_VAR_TYPE_BOOL,
                                                 &prte_filem_raw_flatten_trees);
 
+    prte_filem_raw_chunk_size = PRTE_FILEM_RAW_CHUNK_DEFAULT;
+    (void) pmix_mca_base_component_var_register(c, "chunk_size",
+                                                "Number of bytes of a file sent down the routing "
+                                                "tree in each message [default: 1MB]",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &prte_filem_raw_chunk_size);
+    if (prte_filem_raw_chunk_size <= 0) {
+        prte_filem_raw_chunk_size = PRTE_FILEM_RAW_CHUNK_DEFAULT;
+    }
+
+    prte_filem_raw_window = PRTE_FILEM_RAW_WINDOW_DEFAULT;
+    (void) pmix_mca_base_component_var_register(c, "window",
+                                                "Max number of chunks of a file that can be in "
+                                                "flight before all daemons have acknowledged them "
+                                                "[default: 8]",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &prte_filem_raw_window);
+    if (prte_filem_raw_window <= 0) {
+        prte_filem_raw_window = PRTE_FILEM_RAW_WINDOW_DEFAULT;
+    }
+
+    prte_filem_raw_stream = true;
+    (void) pmix_mca_base_component_var_register(c, "stream",
+                                                "Stream files down the routing tree with a window "
+                                                "of acknowledged chunks. If false, each chunk is "
+                                                "xcast to all daemons with no flow control, as "
+                                                "was done originally [default: true]",
+                                                PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                                                &prte_filem_raw_stream);
+
     return PRTE_SUCCESS;
 }
 
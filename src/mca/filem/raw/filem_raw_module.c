@@ -85,12 +85,16 @@ prte_filem_base_module_t prte_filem_raw_module = {.filem_init = raw_init,
 static pmix_list_t outbound_files;
 static pmix_list_t incoming_files;
 static pmix_list_t positioned_files;
+static int32_t next_file_id = 0;
 
 static void send_chunk(int fd, short argc, void *cbdata);
 static void recv_files(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                        prte_rml_tag_t tag, void *cbdata);
 static void recv_ack(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                      prte_rml_tag_t tag, void *cbdata);
+static void recv_window(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                        prte_rml_tag_t tag, void *cbdata);
+static void process_chunk(pmix_data_buffer_t *buffer);
 static void write_handler(int fd, short event, void *cbdata);
 
 static char *filem_session_dir(void)
@@ -111,6 +115,11 @@ static int raw_init(void)
     /* start a recv to catch any files sent to me */
     PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_FILEM_BASE,
                   PRTE_RML_PERSISTENT, recv_files, NULL);
+    PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_FILEM_XCAST,
+                  PRTE_RML_PERSISTENT, recv_files, NULL);
+    /* and the window acks from my children in the routing tree */
+    PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_FILEM_WINDOW,
+                  PRTE_RML_PERSISTENT, recv_window, NULL);
 
     /* if I'm the HNP, start a recv to catch acks sent to me */
     if (PRTE_PROC_IS_MASTER) {
@@ -157,6 +166,10 @@ static void xfer_complete(int status, prte_filem_raw_xfer_t *xfer)
 
     /* this transfer is complete - remove it from list */
     pmix_list_remove_item(&outbound->xfers, &xfer->super);
+    if (NULL != xfer->data) {
+        free(xfer->data);
+        xfer->data = NULL;
+    }
     /* add it to the list of files that have been positioned */
     pmix_list_append(&positioned_files, &xfer->super);
 
@@ -178,12 +191,12 @@ static void recv_ack(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer
     pmix_list_item_t *item, *itm;
     prte_filem_raw_outbound_t *outbound;
     prte_filem_raw_xfer_t *xfer;
-    char *file;
+    int32_t id;
     int st, n, rc;
 
-    /* unpack the file */
+    /* unpack the file id */
     n = 1;
-    rc = PMIx_Data_unpack(NULL, buffer, &file, &n, PMIX_STRING);
+    rc = PMIx_Data_unpack(NULL, buffer, &id, &n, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         return;
@@ -198,8 +211,8 @@ static void recv_ack(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer
     }
 
     PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
-                         "%s filem:raw: recvd ack from %s for file %s status %d",
-                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender), file, st));
+                         "%s filem:raw: recvd ack from %s for file %d status %d",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender), id, st));
 
     /* find the corresponding outbound object */
     for (item = pmix_list_get_first(&outbound_files); item != pmix_list_get_end(&outbound_files);
@@ -208,7 +221,7 @@ static void recv_ack(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer
         for (itm = pmix_list_get_first(&outbound->xfers);
              itm != pmix_list_get_end(&outbound->xfers); itm = pmix_list_get_next(itm)) {
             xfer = (prte_filem_raw_xfer_t *) itm;
-            if (0 == strcmp(file, xfer->file)) {
+            if (id == xfer->id) {
                 /* if the status isn't success, record it */
                 if (0 != st) {
                     xfer->status = st;
@@ -219,10 +232,10 @@ static void recv_ack(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer
                 if (xfer->nrecvd == prte_process_info.num_daemons) {
                     PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
                                          "%s filem:raw: xfer complete for file %s status %d",
-                                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), file, xfer->status));
+                                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), xfer->file,
+                                         xfer->status));
                     xfer_complete(xfer->status, xfer);
                 }
-                free(file);
                 return;
             }
         }
@@ -244,6 +257,7 @@ static int raw_preposition_files(prte_job_t *jdata,
     char *cptr, *nxt, *filestring;
     pmix_list_t fsets;
     bool already_sent;
+    int rc = PRTE_SUCCESS;
 
     PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
                          "%s filem:raw: preposition files for job %s",
@@ -459,9 +473,8 @@ static int raw_preposition_files(prte_job_t *jdata,
             pmix_output(0, "%s CANNOT ACCESS FILE %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
                         fs->local_target);
             PMIX_RELEASE(item);
-            pmix_list_remove_item(&outbound_files, &outbound->super);
-            PMIX_RELEASE(outbound);
-            return PRTE_ERROR;
+            rc = PRTE_ERROR;
+            break;
         }
         /* set the flags to non-blocking */
         if ((flags = fcntl(fd, F_GETFL, 0)) < 0) {
@@ -518,15 +531,36 @@ static int raw_preposition_files(prte_job_t *jdata,
             }
         }
         xfer->fd = fd;
+        xfer->id = next_file_id++;
         xfer->file = strdup(cptr);
+        xfer->data = (unsigned char *) malloc(prte_filem_raw_chunk_size);
+        if (NULL == xfer->data) {
+            PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+            PMIX_RELEASE(xfer);
+            PMIX_RELEASE(item);
+            rc = PRTE_ERR_OUT_OF_RESOURCE;
+            break;
+        }
+        /* ack every half window so the pipe never drains */
+        xfer->interval = prte_filem_raw_window / 2;
+        if (0 == xfer->interval) {
+            xfer->interval = 1;
+        }
         xfer->type = fs->target_flag;
         xfer->app_idx = fs->app_idx;
         xfer->outbound = outbound;
         pmix_list_append(&outbound->xfers, &xfer->super);
-        PMIX_THREADSHIFT(xfer, prte_event_base, send_chunk, PRTE_MSG_PRI);
         PMIX_RELEASE(item);
     }
-    PMIX_DESTRUCT(&fsets);
+    PMIX_LIST_DESTRUCT(&fsets);
+
+    /* nothing has been started yet, so if we could not set up
+     * every file we can just drop the whole set */
+    if (PRTE_SUCCESS != rc) {
+        pmix_list_remove_item(&outbound_files, &outbound->super);
+        PMIX_RELEASE(outbound);
+        return rc;
+    }
 
     /* check to see if anything remains to be sent - if everything
      * is a duplicate, then the list will be empty
@@ -552,6 +586,12 @@ static int raw_preposition_files(prte_job_t *jdata,
         }
     }
 
+    /* start the transfers */
+    PMIX_LIST_FOREACH(xptr, &outbound->xfers, prte_filem_raw_xfer_t)
+    {
+        PMIX_THREADSHIFT(xptr, prte_event_base, send_chunk, PRTE_MSG_PRI);
+    }
+
     return PRTE_SUCCESS;
 }
 
@@ -723,28 +763,93 @@ static int raw_link_local_files(prte_job_t *jdata, prte_app_context_t *app)
     return PRTE_SUCCESS;
 }
 
+/* pass a chunk on to our children in the routing tree - this
+ * must be done before the buffer is unpacked */
+static void relay_chunk(pmix_data_buffer_t *buffer)
+{
+    prte_rml_payload_t *pld;
+    prte_routed_tree_t *child;
+    int rc;
+
+    if (0 == pmix_list_get_size(&prte_rml_base.children)) {
+        return;
+    }
+    /* all the sends share a single copy of the chunk */
+    pld = prte_rml_payload_create(buffer, true);
+    if (NULL == pld) {
+        return;
+    }
+    PMIX_LIST_FOREACH(child, &prte_rml_base.children, prte_routed_tree_t)
+    {
+        PRTE_RML_SEND_PAYLOAD(rc, child->rank, pld, PRTE_RML_TAG_FILEM_BASE);
+        if (PRTE_SUCCESS != rc) {
+            PRTE_ERROR_LOG(rc);
+        }
+    }
+    PMIX_RELEASE(pld);
+}
+
 static void send_chunk(int xxx, short argc, void *cbdata)
 {
     prte_filem_raw_xfer_t *rev = (prte_filem_raw_xfer_t *) cbdata;
     int fd = rev->fd;
-    unsigned char data[PRTE_FILEM_RAW_CHUNK_MAX];
     int32_t numbytes;
+    ssize_t n;
     int rc;
+    int32_t window;
     pmix_data_buffer_t chunk;
+    pmix_byte_object_t bo;
     prte_grpcomm_signature_t *sig;
+    PRTE_HIDE_UNUSED_PARAMS(xxx, argc);
 
     PMIX_ACQUIRE_OBJECT(rev);
 
-    /* read up to the fragment size */
-    numbytes = read(fd, data, sizeof(data));
+    /* note that the event is off */
+    rev->pending = false;
+
+    /* if job termination has been ordered, just ignore the
+     * data and delete the read event
+     */
+    if (prte_job_term_ordered) {
+        PMIX_RELEASE(rev);
+        return;
+    }
 
-    if (numbytes < 0) {
-        /* either we have a connection error or it was a non-blocking read */
+    /* don't get more than a window ahead of the slowest daemon -
+     * we will be restarted when the window opens */
+    if (prte_filem_raw_stream
+        && rev->nchunk >= rev->nacked * rev->interval + prte_filem_raw_window) {
+        PMIX_OUTPUT_VERBOSE((5, prte_filem_base_framework.framework_output,
+                             "%s filem:raw: window full at chunk %d for file %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), rev->nchunk, rev->file));
+        rev->stalled = true;
+        return;
+    }
 
-        /* non-blocking, retry */
-        if (EAGAIN == errno || EINTR == errno) {
+    /* read up to the chunk size */
+    numbytes = 0;
+    while (numbytes < prte_filem_raw_chunk_size) {
+        n = read(fd, rev->data + numbytes, prte_filem_raw_chunk_size - numbytes);
+        if (0 < n) {
+            numbytes += n;
+            continue;
+        }
+        if (0 == n) {
+            /* end of file */
+            break;
+        }
+        if (EINTR == errno) {
+            continue;
+        }
+        if (EAGAIN == errno) {
+            if (0 < numbytes) {
+                /* send what we have */
+                break;
+            }
+            /* non-blocking, retry */
+            rev->pending = true;
             PMIX_POST_OBJECT(rev);
-            prte_event_add(&rev->ev, 0);
+            prte_event_active(&rev->ev, PRTE_EV_WRITE, 1);
             return;
         }
 
@@ -753,72 +858,73 @@ static void send_chunk(int xxx, short argc, void *cbdata)
                              PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
                              strerror(errno), errno, rev->file));
 
-        /* Un-recoverable error. Allow the code to flow as usual in order to
-         * to send the zero bytes message up the stream, and then close the
-         * file descriptor and delete the event.
+        /* Un-recoverable error. Send whatever we have - the next
+         * read will then send the zero bytes message down the tree
+         * so the file descriptor gets closed.
          */
-        numbytes = 0;
-    }
-
-    /* if job termination has been ordered, just ignore the
-     * data and delete the read event
-     */
-    if (prte_job_term_ordered) {
-        PMIX_RELEASE(rev);
-        return;
+        break;
     }
 
     PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
                          "%s filem:raw:read handler sending chunk %d of %d bytes for file %s",
                          PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), rev->nchunk, numbytes, rev->file));
 
-    /* package it for transmission */
+    /* package it for transmission - only the first chunk carries
+     * the name and type of the file, the rest just carry its id */
     PMIX_DATA_BUFFER_CONSTRUCT(&chunk);
-    rc = PMIx_Data_pack(NULL, &chunk, &rev->file, 1, PMIX_STRING);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        close(fd);
-        PMIX_DATA_BUFFER_DESTRUCT(&chunk);
-        return;
+    rc = PMIx_Data_pack(NULL, &chunk, &rev->id, 1, PMIX_INT32);
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, &chunk, &rev->nchunk, 1, PMIX_INT32);
     }
-    rc = PMIx_Data_pack(NULL, &chunk, &rev->nchunk, 1, PMIX_INT32);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        close(fd);
-        PMIX_DATA_BUFFER_DESTRUCT(&chunk);
-        return;
+    if (PMIX_SUCCESS == rc && 0 == rev->nchunk) {
+        rc = PMIx_Data_pack(NULL, &chunk, &rev->file, 1, PMIX_STRING);
+        if (PMIX_SUCCESS == rc) {
+            rc = PMIx_Data_pack(NULL, &chunk, &rev->type, 1, PMIX_INT32);
+        }
+        if (PMIX_SUCCESS == rc) {
+            rc = PMIx_Data_pack(NULL, &chunk, &rev->interval, 1, PMIX_INT32);
+        }
+        if (PMIX_SUCCESS == rc) {
+            /* a zero window tells the daemons not to ack */
+            window = prte_filem_raw_stream ? prte_filem_raw_window : 0;
+            rc = PMIx_Data_pack(NULL, &chunk, &window, 1, PMIX_INT32);
+        }
+    }
+    if (PMIX_SUCCESS == rc) {
+        bo.bytes = (char *) rev->data;
+        bo.size = numbytes;
+        rc = PMIx_Data_pack(NULL, &chunk, &bo, 1, PMIX_BYTE_OBJECT);
     }
-    rc = PMIx_Data_pack(NULL, &chunk, data, numbytes, PMIX_BYTE);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         close(fd);
+        rev->fd = -1;
         PMIX_DATA_BUFFER_DESTRUCT(&chunk);
         return;
     }
-    /* if it is the first chunk, then add file type and index of the app */
-    if (0 == rev->nchunk) {
-        rc = PMIx_Data_pack(NULL, &chunk, &rev->type, 1, PMIX_INT32);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
+
+    /* goes to all daemons - send it down the tree and
+     * then take care of our own copy, or xcast it to
+     * everyone including ourselves */
+    if (prte_filem_raw_stream) {
+        relay_chunk(&chunk);
+        process_chunk(&chunk);
+    } else {
+        sig = PMIX_NEW(prte_grpcomm_signature_t);
+        sig->signature = (pmix_proc_t *) malloc(sizeof(pmix_proc_t));
+        sig->sz = 1;
+        PMIX_LOAD_PROCID(&sig->signature[0], PRTE_PROC_MY_NAME->nspace, PMIX_RANK_WILDCARD);
+        rc = prte_grpcomm.xcast(sig, PRTE_RML_TAG_FILEM_XCAST, &chunk);
+        PMIX_RELEASE(sig);
+        if (PRTE_SUCCESS != rc) {
+            PRTE_ERROR_LOG(rc);
             close(fd);
+            rev->fd = -1;
             PMIX_DATA_BUFFER_DESTRUCT(&chunk);
             return;
         }
     }
-
-    /* goes to all daemons */
-    sig = PMIX_NEW(prte_grpcomm_signature_t);
-    sig->signature = (pmix_proc_t *) malloc(sizeof(pmix_proc_t));
-    sig->sz = 1;
-    PMIX_LOAD_PROCID(&sig->signature[0], PRTE_PROC_MY_NAME->nspace, PMIX_RANK_WILDCARD);
-    if (PRTE_SUCCESS != (rc = prte_grpcomm.xcast(sig, PRTE_RML_TAG_FILEM_BASE, &chunk))) {
-        PRTE_ERROR_LOG(rc);
-        PMIX_DATA_BUFFER_DESTRUCT(&chunk);
-        close(fd);
-        return;
-    }
     PMIX_DATA_BUFFER_DESTRUCT(&chunk);
-    PMIX_RELEASE(sig);
     rev->nchunk++;
 
     /* if num_bytes was zero, then we need to terminate the event
@@ -826,6 +932,7 @@ static void send_chunk(int xxx, short argc, void *cbdata)
      */
     if (0 == numbytes) {
         close(fd);
+        rev->fd = -1;
         return;
     } else {
         /* restart the read event */
@@ -835,13 +942,126 @@ static void send_chunk(int xxx, short argc, void *cbdata)
     }
 }
 
-static void send_complete(char *file, int status)
+/* the whole tree has acked the given number of windows for
+ * a file we are sending - restart it if it was waiting */
+static void window_open(int32_t id, int32_t nacked)
+{
+    prte_filem_raw_outbound_t *outbound;
+    prte_filem_raw_xfer_t *xfer;
+
+    PMIX_LIST_FOREACH(outbound, &outbound_files, prte_filem_raw_outbound_t)
+    {
+        PMIX_LIST_FOREACH(xfer, &outbound->xfers, prte_filem_raw_xfer_t)
+        {
+            if (id != xfer->id) {
+                continue;
+            }
+            xfer->nacked = nacked;
+            if (xfer->stalled) {
+                xfer->stalled = false;
+                xfer->pending = true;
+                PMIX_POST_OBJECT(xfer);
+                prte_event_active(&xfer->ev, PRTE_EV_WRITE, 1);
+            }
+            return;
+        }
+    }
+}
+
+/* count an ack for the next window of a file, either our own or
+ * one from a child, and pass on any window that has now been
+ * acked by our entire subtree */
+static void window_ack(prte_filem_raw_incoming_t *inbnd, int32_t window)
+{
+    pmix_data_buffer_t *buf;
+    int32_t next, nacks;
+    int rc;
+
+    inbnd->acks[window % inbnd->nacks]++;
+    /* we count ourselves as well as our children */
+    nacks = pmix_list_get_size(&prte_rml_base.children) + 1;
+    while (1) {
+        next = (inbnd->nreported + 1) % inbnd->nacks;
+        if (inbnd->acks[next] < nacks) {
+            return;
+        }
+        inbnd->acks[next] = 0;
+        inbnd->nreported++;
+
+        if (PRTE_PROC_IS_MASTER) {
+            window_open(inbnd->id, inbnd->nreported);
+            continue;
+        }
+        PMIX_DATA_BUFFER_CREATE(buf);
+        rc = PMIx_Data_pack(NULL, buf, &inbnd->id, 1, PMIX_INT32);
+        if (PMIX_SUCCESS == rc) {
+            rc = PMIx_Data_pack(NULL, buf, &inbnd->nreported, 1, PMIX_INT32);
+        }
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
+            return;
+        }
+        PRTE_RML_SEND(rc, PRTE_PROC_MY_PARENT->rank, buf, PRTE_RML_TAG_FILEM_WINDOW);
+        if (PRTE_SUCCESS != rc) {
+            PRTE_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
+        }
+    }
+}
+
+static prte_filem_raw_incoming_t *find_incoming(int32_t id)
+{
+    prte_filem_raw_incoming_t *inbnd;
+
+    PMIX_LIST_FOREACH(inbnd, &incoming_files, prte_filem_raw_incoming_t)
+    {
+        if (id == inbnd->id) {
+            return inbnd;
+        }
+    }
+    return NULL;
+}
+
+static void recv_window(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                        prte_rml_tag_t tag, void *cbdata)
+{
+    prte_filem_raw_incoming_t *inbnd;
+    int32_t id, window;
+    int n, rc;
+    PRTE_HIDE_UNUSED_PARAMS(status, tag, cbdata);
+
+    n = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &id, &n, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+    n = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &window, &n, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+
+    PMIX_OUTPUT_VERBOSE((5, prte_filem_base_framework.framework_output,
+                         "%s filem:raw: recvd window %d ack from %s for file %d",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), window, PRTE_NAME_PRINT(sender), id));
+
+    if (NULL == (inbnd = find_incoming(id))) {
+        PRTE_ERROR_LOG(PRTE_ERR_NOT_FOUND);
+        return;
+    }
+    window_ack(inbnd, window);
+}
+
+static void send_complete(int32_t id, int status)
 {
     pmix_data_buffer_t *buf;
     int rc;
 
     PMIX_DATA_BUFFER_CREATE(buf);
-    rc = PMIx_Data_pack(NULL, buf, &file, 1, PMIX_STRING);
+    rc = PMIx_Data_pack(NULL, buf, &id, 1, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         PMIX_DATA_BUFFER_RELEASE(buf);
@@ -921,88 +1141,121 @@ static int link_archive(prte_filem_raw_incoming_t *inbnd)
 static void recv_files(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                        prte_rml_tag_t tag, void *cbdata)
 {
-    char *file, *session_dir;
-    int32_t nchunk, n, nbytes;
-    unsigned char data[PRTE_FILEM_RAW_CHUNK_MAX];
+    PRTE_HIDE_UNUSED_PARAMS(status, sender, cbdata);
+
+    /* keep the chunk moving down the tree before we deal with it -
+     * xcast chunks have already been delivered to everyone */
+    if (PRTE_RML_TAG_FILEM_BASE == tag) {
+        relay_chunk(buffer);
+    }
+    process_chunk(buffer);
+}
+
+static void process_chunk(pmix_data_buffer_t *buffer)
+{
+    char *file = NULL, *session_dir;
+    int32_t id, nchunk, n;
+    int32_t type = PRTE_FILEM_TYPE_FILE, interval = 1, window = 1;
+    pmix_byte_object_t bo;
     int rc;
     prte_filem_raw_output_t *output;
-    prte_filem_raw_incoming_t *ptr, *incoming;
-    pmix_list_item_t *item;
-    int32_t type;
+    prte_filem_raw_incoming_t *incoming;
     char *cptr;
 
     /* unpack the data */
     n = 1;
-    rc = PMIx_Data_unpack(NULL, buffer, &file, &n, PMIX_STRING);
+    rc = PMIx_Data_unpack(NULL, buffer, &id, &n, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        send_complete(NULL, rc);
+        send_complete(-1, rc);
         return;
     }
     n = 1;
     rc = PMIx_Data_unpack(NULL, buffer, &nchunk, &n, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        send_complete(file, rc);
-        free(file);
+        send_complete(id, rc);
         return;
     }
-    /* if the chunk number is < 0, then this is an EOF message */
-    if (nchunk < 0) {
-        /* just set nbytes to zero so we close the fd */
-        nbytes = 0;
-    } else {
-        nbytes = PRTE_FILEM_RAW_CHUNK_MAX;
-        rc = PMIx_Data_unpack(NULL, buffer, data, &nbytes, PMIX_BYTE);
+    /* if the chunk is 0, then the file info should be present */
+    if (0 == nchunk) {
+        n = 1;
+        rc = PMIx_Data_unpack(NULL, buffer, &file, &n, PMIX_STRING);
+        if (PMIX_SUCCESS == rc) {
+            n = 1;
+            rc = PMIx_Data_unpack(NULL, buffer, &type, &n, PMIX_INT32);
+        }
+        if (PMIX_SUCCESS == rc) {
+            n = 1;
+            rc = PMIx_Data_unpack(NULL, buffer, &interval, &n, PMIX_INT32);
+        }
+        if (PMIX_SUCCESS == rc) {
+            n = 1;
+            rc = PMIx_Data_unpack(NULL, buffer, &window, &n, PMIX_INT32);
+        }
         if (PMIX_SUCCESS != rc) {
             PMIX_ERROR_LOG(rc);
-            send_complete(file, rc);
-            free(file);
+            send_complete(id, rc);
+            if (NULL != file) {
+                free(file);
+            }
             return;
         }
     }
-    /* if the chunk is 0, then additional info should be present */
-    if (0 == nchunk) {
-        n = 1;
-        rc = PMIx_Data_unpack(NULL, buffer, &type, &n, PMIX_INT32);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-            send_complete(file, rc);
+    n = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &bo, &n, PMIX_BYTE_OBJECT);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        send_complete(id, rc);
+        if (NULL != file) {
             free(file);
-            return;
         }
+        return;
     }
 
     PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
-                         "%s filem:raw: received chunk %d for file %s containing %d bytes",
-                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), nchunk, file, nbytes));
+                         "%s filem:raw: received chunk %d for file %d containing %d bytes",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), nchunk, id, (int) bo.size));
 
     /* do we already have this file on our list of incoming? */
-    incoming = NULL;
-    for (item = pmix_list_get_first(&incoming_files); item != pmix_list_get_end(&incoming_files);
-         item = pmix_list_get_next(item)) {
-        ptr = (prte_filem_raw_incoming_t *) item;
-        if (0 == strcmp(file, ptr->file)) {
-            incoming = ptr;
-            break;
-        }
-    }
+    incoming = find_incoming(id);
     if (NULL == incoming) {
+        if (0 != nchunk) {
+            /* we missed the start of this file */
+            PRTE_ERROR_LOG(PRTE_ERR_NOT_FOUND);
+            PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+            return;
+        }
         /* nope - add it */
         PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
                              "%s filem:raw: adding file %s to incoming list",
                              PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), file));
         incoming = PMIX_NEW(prte_filem_raw_incoming_t);
-        incoming->file = strdup(file);
+        incoming->id = id;
+        incoming->file = file;
+        file = NULL;
         incoming->type = type;
+        if (0 < window) {
+            incoming->interval = interval;
+            /* the sender never gets more than a window ahead of
+             * the windows we have acked */
+            incoming->nacks = window / interval + 1;
+            incoming->acks = (int32_t *) calloc(incoming->nacks, sizeof(int32_t));
+        } else {
+            /* no flow control */
+            incoming->interval = 0;
+        }
         pmix_list_append(&incoming_files, &incoming->super);
     }
+    if (NULL != file) {
+        free(file);
+    }
 
     /* if this is the first chunk, we need to open the file descriptor */
     if (0 == nchunk) {
         /* separate out the top-level directory of the target */
         char *tmp;
-        tmp = strdup(file);
+        tmp = strdup(incoming->file);
         if (NULL != (cptr = strchr(tmp, '/'))) {
             *cptr = '\0';
         }
@@ -1012,7 +1265,7 @@ static void recv_files(int status, pmix_proc_t *sender, pmix_data_buffer_t *buff
         /* define the full path to where we will put it */
         session_dir = filem_session_dir();
 
-        incoming->fullpath = pmix_os_path(false, session_dir, file, NULL);
+        incoming->fullpath = pmix_os_path(false, session_dir, incoming->file, NULL);
 
         PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
                              "%s filem:raw: opening target file %s",
@@ -1021,60 +1274,50 @@ static void recv_files(int status, pmix_proc_t *sender, pmix_data_buffer_t *buff
         tmp = pmix_dirname(incoming->fullpath);
         if (PMIX_SUCCESS != (rc = pmix_os_dirpath_create(tmp, S_IRWXU))) {
             PMIX_ERROR_LOG(rc);
-            send_complete(file, PRTE_ERR_FILE_WRITE_FAILURE);
-            free(file);
-            free(tmp);
-            PMIX_RELEASE(incoming);
-            return;
-        }
-        /* open the file descriptor for writing */
-        if (PRTE_FILEM_TYPE_EXE == type) {
-            if (0
-                > (incoming->fd = open(incoming->fullpath, O_RDWR | O_CREAT | O_TRUNC, S_IRWXU))) {
-                pmix_output(0, "%s CANNOT CREATE FILE %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                            incoming->fullpath);
-                send_complete(file, PRTE_ERR_FILE_WRITE_FAILURE);
-                free(file);
-                free(tmp);
-                return;
-            }
+            send_complete(id, PRTE_ERR_FILE_WRITE_FAILURE);
+            incoming->failed = true;
+        } else if (0 > (incoming->fd = open(incoming->fullpath, O_RDWR | O_CREAT | O_TRUNC,
+                                            (PRTE_FILEM_TYPE_EXE == type) ? S_IRWXU
+                                                                          : S_IRUSR | S_IWUSR))) {
+            /* open the file descriptor for writing */
+            pmix_output(0, "%s CANNOT CREATE FILE %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                        incoming->fullpath);
+            send_complete(id, PRTE_ERR_FILE_WRITE_FAILURE);
+            incoming->failed = true;
         } else {
-            if (0 > (incoming->fd = open(incoming->fullpath, O_RDWR | O_CREAT | O_TRUNC,
-                                         S_IRUSR | S_IWUSR))) {
-                pmix_output(0, "%s CANNOT CREATE FILE %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                            incoming->fullpath);
-                send_complete(file, PRTE_ERR_FILE_WRITE_FAILURE);
-                free(file);
-                free(tmp);
-                return;
-            }
+            incoming->pending = true;
+            PMIX_THREADSHIFT(incoming, prte_event_base, write_handler, PRTE_MSG_PRI);
         }
         free(tmp);
-        incoming->pending = true;
-        PMIX_THREADSHIFT(incoming, prte_event_base, write_handler, PRTE_MSG_PRI);
-    }
-    /* create an output object for this data */
-    output = PMIX_NEW(prte_filem_raw_output_t);
-    if (0 < nbytes) {
-        /* don't copy 0 bytes - we just need to pass
-         * the zero bytes so the fd can be closed
-         * after it writes everything out
-         */
-        memcpy(output->data, data, nbytes);
     }
-    output->numbytes = nbytes;
 
-    /* add this data to the write list for this fd */
-    pmix_list_append(&incoming->outputs, &output->super);
-
-    if (!incoming->pending) {
-        /* add the event */
-        incoming->pending = true;
-        prte_event_active(&incoming->ev, PRTE_EV_WRITE, 1);
+    if (incoming->failed) {
+        /* nowhere to put the data, but we still have to
+         * keep the window moving for the rest of the tree */
+        PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+    } else {
+        /* hand the data to the writer - a zero-byte chunk tells
+         * it to close the fd after it writes everything out */
+        output = PMIX_NEW(prte_filem_raw_output_t);
+        output->data = (unsigned char *) bo.bytes;
+        output->numbytes = bo.size;
+        bo.bytes = NULL;
+        bo.size = 0;
+
+        /* add this data to the write list for this fd */
+        pmix_list_append(&incoming->outputs, &output->super);
+
+        if (!incoming->pending) {
+            /* add the event */
+            incoming->pending = true;
+            prte_event_active(&incoming->ev, PRTE_EV_WRITE, 1);
+        }
     }
 
-    /* cleanup */
-    free(file);
+    /* ack each completed window */
+    if (0 < incoming->interval && 0 == (nchunk + 1) % incoming->interval) {
+        window_ack(incoming, (nchunk + 1) / incoming->interval);
+    }
 }
 
 static void write_handler(int fd, short event, void *cbdata)
@@ -1111,7 +1354,7 @@ static void write_handler(int fd, short event, void *cbdata)
                  * name we will want in each proc's session dir
                  */
                 pmix_argv_append_nosize(&sink->link_pts, sink->top);
-                send_complete(sink->file, PRTE_SUCCESS);
+                send_complete(sink->id, PRTE_SUCCESS);
             } else {
                 /* unarchive the file */
                 if (PRTE_FILEM_TYPE_TAR == sink->type) {
@@ -1122,18 +1365,18 @@ static void write_handler(int fd, short event, void *cbdata)
                     pmix_asprintf(&cmd, "tar xzf %s", sink->file);
                 } else {
                     PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
-                    send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
+                    send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
                     return;
                 }
                 if (NULL == getcwd(homedir, sizeof(homedir))) {
                     PRTE_ERROR_LOG(PRTE_ERROR);
-                    send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
+                    send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
                     return;
                 }
                 dirname = pmix_dirname(sink->fullpath);
                 if (0 != chdir(dirname)) {
                     PRTE_ERROR_LOG(PRTE_ERROR);
-                    send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
+                    send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
                     return;
                 }
                 PMIX_OUTPUT_VERBOSE((1, prte_filem_base_framework.framework_output,
@@ -1141,12 +1384,12 @@ static void write_handler(int fd, short event, void *cbdata)
                                      PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), sink->file, cmd));
                 if (0 != system(cmd)) {
                     PRTE_ERROR_LOG(PRTE_ERROR);
-                    send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
+                    send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
                     return;
                 }
                 if (0 != chdir(homedir)) {
                     PRTE_ERROR_LOG(PRTE_ERROR);
-                    send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
+                    send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
                     return;
                 }
                 free(dirname);
@@ -1154,9 +1397,9 @@ static void write_handler(int fd, short event, void *cbdata)
                 /* setup the link points */
                 if (PRTE_SUCCESS != (rc = link_archive(sink))) {
                     PRTE_ERROR_LOG(rc);
-                    send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
+                    send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
                 } else {
-                    send_complete(sink->file, PRTE_SUCCESS);
+                    send_complete(sink->id, PRTE_SUCCESS);
                 }
             }
             return;
@@ -1184,13 +1427,20 @@ static void write_handler(int fd, short event, void *cbdata)
                                  "%s write:handler error on write for file %s: %s",
                                  PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), sink->file, strerror(errno)));
             PMIX_RELEASE(output);
-            pmix_list_remove_item(&incoming_files, &sink->super);
-            send_complete(sink->file, PRTE_ERR_FILE_WRITE_FAILURE);
-            PMIX_RELEASE(sink);
+            send_complete(sink->id, PRTE_ERR_FILE_WRITE_FAILURE);
+            /* keep the file on our list so we continue to
+             * ack the rest of its chunks */
+            while (NULL != (item = pmix_list_remove_first(&sink->outputs))) {
+                PMIX_RELEASE(item);
+            }
+            close(sink->fd);
+            sink->fd = -1;
+            sink->failed = true;
             return;
         } else if (num_written < output->numbytes) {
             /* incomplete write - adjust data to avoid duplicate output */
             memmove(output->data, &output->data[num_written], output->numbytes - num_written);
+            output->numbytes -= num_written;
             /* push this item back on the front of the list */
             pmix_list_prepend(&sink->outputs, item);
             /* leave the write event running so it will call us again
@@ -1213,8 +1463,13 @@ static void xfer_construct(prte_filem_raw_xfer_t *ptr)
     ptr->app_idx = 0;
     ptr->pending = false;
     ptr->src = NULL;
+    ptr->id = -1;
     ptr->file = NULL;
+    ptr->data = NULL;
     ptr->nchunk = 0;
+    ptr->interval = 1;
+    ptr->nacked = 0;
+    ptr->stalled = false;
     ptr->status = PRTE_SUCCESS;
     ptr->nrecvd = 0;
 }
@@ -1223,12 +1478,18 @@ static void xfer_destruct(prte_filem_raw_xfer_t *ptr)
     if (ptr->pending) {
         prte_event_del(&ptr->ev);
     }
+    if (0 <= ptr->fd) {
+        close(ptr->fd);
+    }
     if (NULL != ptr->src) {
         free(ptr->src);
     }
     if (NULL != ptr->file) {
         free(ptr->file);
     }
+    if (NULL != ptr->data) {
+        free(ptr->data);
+    }
 }
 PMIX_CLASS_INSTANCE(prte_filem_raw_xfer_t,
                     pmix_list_item_t,
@@ -1253,12 +1514,18 @@ static void in_construct(prte_filem_raw_incoming_t *ptr)
 {
     ptr->app_idx = 0;
     ptr->pending = false;
+    ptr->failed = false;
     ptr->fd = -1;
+    ptr->id = -1;
     ptr->file = NULL;
     ptr->top = NULL;
     ptr->fullpath = NULL;
     ptr->link_pts = NULL;
     PMIX_CONSTRUCT(&ptr->outputs, pmix_list_t);
+    ptr->interval = 1;
+    ptr->nreported = 0;
+    ptr->acks = NULL;
+    ptr->nacks = 0;
 }
 static void in_destruct(prte_filem_raw_incoming_t *ptr)
 {
@@ -1279,6 +1546,9 @@ static void in_destruct(prte_filem_raw_incoming_t *ptr)
     }
     pmix_argv_free(ptr->link_pts);
     PMIX_LIST_DESTRUCT(&ptr->outputs);
+    if (NULL != ptr->acks) {
+        free(ptr->acks);
+    }
 }
 PMIX_CLASS_INSTANCE(prte_filem_raw_incoming_t,
                     pmix_list_item_t,
@@ -1287,7 +1557,14 @@ PMIX_CLASS_INSTANCE(prte_filem_raw_incoming_t,
 static void output_construct(prte_filem_raw_output_t *ptr)
 {
     ptr->numbytes = 0;
+    ptr->data = NULL;
+}
+static void output_destruct(prte_filem_raw_output_t *ptr)
+{
+    if (NULL != ptr->data) {
+        free(ptr->data);
+    }
 }
 PMIX_CLASS_INSTANCE(prte_filem_raw_output_t,
                     pmix_list_item_t,
-                    output_construct, NULL);
+                    output_construct, output_destruct);
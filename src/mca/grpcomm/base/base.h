@@ -71,6 +71,10 @@ PMIX_CLASS_DECLARATION(prte_grpcomm_base_active_t);
 typedef struct {
     pmix_list_t actives;
     pmix_list_t ongoing;
+    /* the ongoing collectives by signature */
+    pmix_hash_table_t trackers;
+    /* the daemons participating in collectives over each signature */
+    pmix_hash_table_t dmns_cache;
     pmix_hash_table_t sig_table;
     char *transports;
     uint32_t context_id;
@@ -92,6 +96,8 @@ PRTE_EXPORT int prte_grpcomm_API_register_cb(prte_grpcomm_rbcast_cb_t callback);
 
 PRTE_EXPORT prte_grpcomm_coll_t *prte_grpcomm_base_get_tracker(prte_grpcomm_signature_t *sig,
                                                                bool create);
+PRTE_EXPORT void prte_grpcomm_base_release_tracker(prte_grpcomm_coll_t *coll);
+PRTE_EXPORT void prte_grpcomm_base_purge_job(const pmix_nspace_t nspace);
 PRTE_EXPORT void prte_grpcomm_base_mark_distance_recv(prte_grpcomm_coll_t *coll, uint32_t distance);
 PRTE_EXPORT unsigned int prte_grpcomm_base_check_distance_recv(prte_grpcomm_coll_t *coll,
                                                                uint32_t distance);
@@ -49,6 +49,8 @@
 prte_grpcomm_base_t prte_grpcomm_base = {
     .actives = PMIX_LIST_STATIC_INIT,
     .ongoing = PMIX_LIST_STATIC_INIT,
+    .trackers = PMIX_HASH_TABLE_STATIC_INIT,
+    .dmns_cache = PMIX_HASH_TABLE_STATIC_INIT,
     .sig_table = PMIX_HASH_TABLE_STATIC_INIT,
     .transports = NULL,
     .context_id = 0
@@ -81,6 +83,7 @@ static int prte_grpcomm_base_close(void)
     void *key;
     size_t size;
     uint32_t *seq_number;
+    void *dmns;
 
     PRTE_RML_CANCEL(PRTE_NAME_WILDCARD, PRTE_RML_TAG_XCAST);
 
@@ -93,6 +96,14 @@ static int prte_grpcomm_base_close(void)
     }
     PMIX_LIST_DESTRUCT(&prte_grpcomm_base.actives);
     PMIX_LIST_DESTRUCT(&prte_grpcomm_base.ongoing);
+    PMIX_DESTRUCT(&prte_grpcomm_base.trackers);
+    for (void *_nptr = NULL;
+         PRTE_SUCCESS
+         == pmix_hash_table_get_next_key_ptr(&prte_grpcomm_base.dmns_cache, &key, &size,
+                                             &dmns, _nptr, &_nptr);) {
+        free(dmns);
+    }
+    PMIX_DESTRUCT(&prte_grpcomm_base.dmns_cache);
     for (void *_nptr = NULL;
          PRTE_SUCCESS
          == pmix_hash_table_get_next_key_ptr(&prte_grpcomm_base.sig_table, &key, &size,
@@ -112,6 +123,10 @@ static int prte_grpcomm_base_open(pmix_mca_base_open_flag_t flags)
 {
     PMIX_CONSTRUCT(&prte_grpcomm_base.actives, pmix_list_t);
     PMIX_CONSTRUCT(&prte_grpcomm_base.ongoing, pmix_list_t);
+    PMIX_CONSTRUCT(&prte_grpcomm_base.trackers, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_grpcomm_base.trackers, 128);
+    PMIX_CONSTRUCT(&prte_grpcomm_base.dmns_cache, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_grpcomm_base.dmns_cache, 128);
     PMIX_CONSTRUCT(&prte_grpcomm_base.sig_table, pmix_hash_table_t);
     pmix_hash_table_init(&prte_grpcomm_base.sig_table, 128);
     prte_grpcomm_base.context_id = UINT32_MAX;
@@ -50,6 +50,13 @@ static int pack_xcast(prte_grpcomm_signature_t *sig, pmix_data_buffer_t *buffer,
                       pmix_data_buffer_t *message, prte_rml_tag_t tag);
 
 static int create_dmns(prte_grpcomm_signature_t *sig, pmix_rank_t **dmns, size_t *ndmns);
+static int get_dmns(prte_grpcomm_signature_t *sig, pmix_rank_t **dmns, size_t *ndmns);
+
+/* participating daemons cached for a signature */
+typedef struct {
+    size_t ndmns;
+    pmix_rank_t dmns[];
+} prte_grpcomm_base_dmns_t;
 
 typedef struct {
     pmix_object_t super;
@@ -97,7 +104,7 @@ int prte_grpcomm_API_xcast(prte_grpcomm_signature_t *sig, prte_rml_tag_t tag,
     PMIX_DATA_BUFFER_CREATE(buf);
 
     /* create the array of participating daemons */
-    if (PRTE_SUCCESS != (rc = create_dmns(sig, &dmns, &ndmns))) {
+    if (PRTE_SUCCESS != (rc = get_dmns(sig, &dmns, &ndmns))) {
         PRTE_ERROR_LOG(rc);
         PMIX_DATA_BUFFER_RELEASE(buf);
         return rc;
@@ -287,24 +294,22 @@ prte_grpcomm_coll_t *prte_grpcomm_base_get_tracker(prte_grpcomm_signature_t *sig
     int rc;
     size_t n;
 
-    /* search the existing tracker list to see if this already exists */
-    PMIX_LIST_FOREACH(coll, &prte_grpcomm_base.ongoing, prte_grpcomm_coll_t) {
-        if (NULL == sig->signature) {
+    if (NULL == sig->signature) {
+        /* only one collective can operate at a time
+         * across every process in the system */
+        PMIX_LIST_FOREACH(coll, &prte_grpcomm_base.ongoing, prte_grpcomm_coll_t) {
             if (NULL == coll->sig->signature) {
-                /* only one collective can operate at a time
-                 * across every process in the system */
                 return coll;
             }
-            /* if only one is NULL, then we can't possibly match */
-            break;
-        }
-        if (sig->sz == coll->sig->sz &&
-            0 == memcmp(sig->signature, coll->sig->signature, sig->sz * sizeof(pmix_proc_t))) {
-            PMIX_OUTPUT_VERBOSE((1, prte_grpcomm_base_framework.framework_output,
-                                 "%s grpcomm:base:returning existing collective",
-                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
-            return coll;
         }
+    } else if (PMIX_SUCCESS
+               == pmix_hash_table_get_value_ptr(&prte_grpcomm_base.trackers,
+                                                (void *) sig->signature,
+                                                sig->sz * sizeof(pmix_proc_t), (void **) &coll)) {
+        PMIX_OUTPUT_VERBOSE((1, prte_grpcomm_base_framework.framework_output,
+                             "%s grpcomm:base:returning existing collective",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
+        return coll;
     }
     /* if we get here, then this is a new collective - so create
      * the tracker for it */
@@ -322,10 +327,15 @@ prte_grpcomm_coll_t *prte_grpcomm_base_get_tracker(prte_grpcomm_signature_t *sig
     memcpy(coll->sig->signature, sig->signature, coll->sig->sz * sizeof(pmix_proc_t));
 
     pmix_list_append(&prte_grpcomm_base.ongoing, &coll->super);
+    if (NULL != sig->signature && 0 < sig->sz) {
+        pmix_hash_table_set_value_ptr(&prte_grpcomm_base.trackers, (void *) coll->sig->signature,
+                                      coll->sig->sz * sizeof(pmix_proc_t), coll);
+    }
 
     /* now get the daemons involved */
-    if (PRTE_SUCCESS != (rc = create_dmns(sig, &coll->dmns, &coll->ndmns))) {
+    if (PRTE_SUCCESS != (rc = get_dmns(sig, &coll->dmns, &coll->ndmns))) {
         PRTE_ERROR_LOG(rc);
+        prte_grpcomm_base_release_tracker(coll);
         return NULL;
     }
 
@@ -345,6 +355,104 @@ prte_grpcomm_coll_t *prte_grpcomm_base_get_tracker(prte_grpcomm_signature_t *sig
     return coll;
 }
 
+void prte_grpcomm_base_release_tracker(prte_grpcomm_coll_t *coll)
+{
+    if (NULL != coll->sig->signature && 0 < coll->sig->sz) {
+        pmix_hash_table_remove_value_ptr(&prte_grpcomm_base.trackers,
+                                         (void *) coll->sig->signature,
+                                         coll->sig->sz * sizeof(pmix_proc_t));
+    }
+    pmix_list_remove_item(&prte_grpcomm_base.ongoing, &coll->super);
+    PMIX_RELEASE(coll);
+}
+
+/* the participants of a collective only depend on where the procs
+ * in its signature live, which does not change for the life of their
+ * job - so they are computed once per signature */
+static int get_dmns(prte_grpcomm_signature_t *sig, pmix_rank_t **dmns, size_t *ndmns)
+{
+    prte_grpcomm_base_dmns_t *cached;
+    int rc;
+
+    if (NULL != sig->signature
+        && PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&prte_grpcomm_base.dmns_cache,
+                                                         (void *) sig->signature,
+                                                         sig->sz * sizeof(pmix_proc_t),
+                                                         (void **) &cached)) {
+        *dmns = (pmix_rank_t *) malloc(cached->ndmns * sizeof(pmix_rank_t));
+        if (NULL == *dmns) {
+            return PRTE_ERR_OUT_OF_RESOURCE;
+        }
+        memcpy(*dmns, cached->dmns, cached->ndmns * sizeof(pmix_rank_t));
+        *ndmns = cached->ndmns;
+        return PRTE_SUCCESS;
+    }
+
+    rc = create_dmns(sig, dmns, ndmns);
+    /* a NULL array means all daemons, which costs nothing to find - and
+     * is also what the HNP gets before the job is mapped */
+    if (PRTE_SUCCESS != rc || NULL == *dmns) {
+        return rc;
+    }
+    cached = (prte_grpcomm_base_dmns_t *) malloc(sizeof(prte_grpcomm_base_dmns_t)
+                                                 + *ndmns * sizeof(pmix_rank_t));
+    if (NULL != cached) {
+        cached->ndmns = *ndmns;
+        memcpy(cached->dmns, *dmns, *ndmns * sizeof(pmix_rank_t));
+        pmix_hash_table_set_value_ptr(&prte_grpcomm_base.dmns_cache, (void *) sig->signature,
+                                      sig->sz * sizeof(pmix_proc_t), cached);
+    }
+    return PRTE_SUCCESS;
+}
+
+void prte_grpcomm_base_purge_job(const pmix_nspace_t nspace)
+{
+    prte_grpcomm_base_active_t *active;
+    prte_grpcomm_base_dmns_t *cached;
+    pmix_pointer_array_t stale;
+    pmix_byte_object_t *bo;
+    pmix_proc_t *key;
+    size_t size, n;
+    int i;
+
+    /* collect the signatures naming the job first - the
+     * table cannot be changed while we walk it */
+    PMIX_CONSTRUCT(&stale, pmix_pointer_array_t);
+    pmix_pointer_array_init(&stale, 8, INT_MAX, 8);
+    for (void *_nptr = NULL;
+         PRTE_SUCCESS
+         == pmix_hash_table_get_next_key_ptr(&prte_grpcomm_base.dmns_cache, (void **) &key, &size,
+                                             (void **) &cached, _nptr, &_nptr);) {
+        for (n = 0; n < size / sizeof(pmix_proc_t); n++) {
+            if (PMIX_CHECK_NSPACE(key[n].nspace, nspace)) {
+                PMIX_BYTE_OBJECT_CREATE(bo, 1);
+                bo->bytes = (char *) malloc(size);
+                memcpy(bo->bytes, key, size);
+                bo->size = size;
+                pmix_pointer_array_add(&stale, bo);
+                free(cached);
+                break;
+            }
+        }
+    }
+    for (i = 0; i < stale.size; i++) {
+        if (NULL == (bo = (pmix_byte_object_t *) pmix_pointer_array_get_item(&stale, i))) {
+            continue;
+        }
+        pmix_hash_table_remove_value_ptr(&prte_grpcomm_base.dmns_cache, bo->bytes, bo->size);
+        PMIX_BYTE_OBJECT_FREE(bo, 1);
+    }
+    PMIX_DESTRUCT(&stale);
+
+    /* and whatever the modules are holding for it */
+    PMIX_LIST_FOREACH(active, &prte_grpcomm_base.actives, prte_grpcomm_base_active_t)
+    {
+        if (NULL != active->module->purge_job) {
+            active->module->purge_job(nspace);
+        }
+    }
+}
+
 static int create_dmns(prte_grpcomm_signature_t *sig, pmix_rank_t **dmns, size_t *ndmns)
 {
     size_t n;
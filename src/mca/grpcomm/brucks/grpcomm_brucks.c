@@ -0,0 +1,690 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * Copyright (c) 2022      Nanook Consulting.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Allgather across the participating daemons with Bruck's algorithm.
+ * With N daemons, daemon i sends in step k what it has collected so
+ * far - the contributions of daemons i..i+2^k-1 - to daemon i-2^k and
+ * receives those of daemons i+2^k..i+2^(k+1)-1 from daemon i+2^k. After
+ * ceil(log2 N) steps every daemon holds every contribution, without
+ * any of them having to pass through the HNP. A contribution is kept
+ * as its own block so the last step of a non-power-of-two N sends only
+ * the blocks the receiver is missing. Blocks that are all empty - as
+ * in a barrier - are not sent at all, only the step header is.
+ *
+ * All daemons in a collective must use the same algorithm, so the
+ * choice against the direct component is made from what they all
+ * know: the average contribution of the previous allgather over the
+ * same procs. Allgathers that need a context id from the HNP are
+ * always passed on.
+ *
+ * A daemon can finish a collective and start the next one over the
+ * same procs while its peers still wait on their last step, so each
+ * message carries the sequence number of its collective, and those
+ * for the next one are held until it starts here.
+ */
+
+#include "prte_config.h"
+#include "constants.h"
+#include "types.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "src/class/pmix_hash_table.h"
+#include "src/class/pmix_list.h"
+#include "src/pmix/pmix-internal.h"
+
+#include "src/mca/errmgr/errmgr.h"
+#include "src/rml/rml.h"
+#include "src/util/name_fns.h"
+#include "src/util/proc_info.h"
+
+#include "grpcomm_brucks.h"
+#include "src/mca/grpcomm/base/base.h"
+
+/* Static API's */
+static int init(void);
+static void finalize(void);
+static int allgather(prte_grpcomm_coll_t *coll,
+                     pmix_data_buffer_t *buf,
+                     int mode, pmix_status_t local_status);
+static void purge_job(const pmix_nspace_t nspace);
+
+/* Module def */
+prte_grpcomm_base_module_t prte_grpcomm_brucks_module = {
+    .init = init,
+    .finalize = finalize,
+    .xcast = NULL,
+    .allgather = allgather,
+    .rbcast = NULL,
+    .register_cb = NULL,
+    .unregister_cb = NULL,
+    .purge_job = purge_job
+};
+
+/* one step of a collective, as received */
+typedef struct {
+    pmix_list_item_t super;
+    prte_grpcomm_signature_t *sig;
+    uint32_t seq;
+    uint32_t step;
+    pmix_status_t status;
+    pmix_data_buffer_t data;
+} prte_grpcomm_brucks_msg_t;
+static void msgcon(prte_grpcomm_brucks_msg_t *p)
+{
+    p->sig = NULL;
+    p->seq = 0;
+    p->step = 0;
+    p->status = PMIX_SUCCESS;
+    PMIX_DATA_BUFFER_CONSTRUCT(&p->data);
+}
+static void msgdes(prte_grpcomm_brucks_msg_t *p)
+{
+    if (NULL != p->sig) {
+        PMIX_RELEASE(p->sig);
+    }
+    PMIX_DATA_BUFFER_DESTRUCT(&p->data);
+}
+static PMIX_CLASS_INSTANCE(prte_grpcomm_brucks_msg_t, pmix_list_item_t, msgcon, msgdes);
+
+/* an allgather passed on to the next component, whose
+ * result we want to see on its way to the caller */
+typedef struct {
+    pmix_object_t super;
+    prte_grpcomm_signature_t *sig;
+    size_t ndmns;
+    prte_grpcomm_cbfunc_t cbfunc;
+    void *cbdata;
+} prte_grpcomm_brucks_caddy_t;
+static void cdcon(prte_grpcomm_brucks_caddy_t *p)
+{
+    p->sig = NULL;
+    p->ndmns = 0;
+    p->cbfunc = NULL;
+    p->cbdata = NULL;
+}
+static void cddes(prte_grpcomm_brucks_caddy_t *p)
+{
+    if (NULL != p->sig) {
+        PMIX_RELEASE(p->sig);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_grpcomm_brucks_caddy_t, pmix_object_t, cdcon, cddes);
+
+/* internal functions */
+static void allgather_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                           prte_rml_tag_t tag, void *cbdata);
+
+/* internal variables */
+static pmix_list_t early;
+/* average contribution of the last allgather over each signature */
+static pmix_hash_table_t sizes;
+
+/**
+ * Initialize the module
+ */
+static int init(void)
+{
+    PMIX_CONSTRUCT(&early, pmix_list_t);
+    PMIX_CONSTRUCT(&sizes, pmix_hash_table_t);
+    pmix_hash_table_init(&sizes, 128);
+
+    PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_ALLGATHER_BRUCKS,
+                  PRTE_RML_PERSISTENT, allgather_recv, NULL);
+    return PRTE_SUCCESS;
+}
+
+/**
+ * Finalize the module
+ */
+static void finalize(void)
+{
+    void *key;
+    size_t size, *avg;
+
+    PRTE_RML_CANCEL(PRTE_NAME_WILDCARD, PRTE_RML_TAG_ALLGATHER_BRUCKS);
+    PMIX_LIST_DESTRUCT(&early);
+    for (void *_nptr = NULL;
+         PRTE_SUCCESS
+         == pmix_hash_table_get_next_key_ptr(&sizes, &key, &size, (void **) &avg, _nptr, &_nptr);) {
+        free(avg);
+    }
+    PMIX_DESTRUCT(&sizes);
+}
+
+static bool names_job(const pmix_proc_t *procs, size_t nprocs, const pmix_nspace_t nspace)
+{
+    size_t n;
+
+    for (n = 0; n < nprocs; n++) {
+        if (PMIX_CHECK_NSPACE(procs[n].nspace, nspace)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* steps held for a collective that will now never start
+ * here, and the sizes recorded for the job's collectives */
+static void purge_job(const pmix_nspace_t nspace)
+{
+    prte_grpcomm_brucks_msg_t *msg, *nxt;
+    pmix_pointer_array_t stale;
+    pmix_byte_object_t *bo;
+    pmix_proc_t *key;
+    size_t size, *avg;
+    int i;
+
+    PMIX_LIST_FOREACH_SAFE(msg, nxt, &early, prte_grpcomm_brucks_msg_t) {
+        if (names_job(msg->sig->signature, msg->sig->sz, nspace)) {
+            PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                                 "%s grpcomm:brucks dropping held step %u for job %s",
+                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), msg->step,
+                                 PRTE_JOBID_PRINT(nspace)));
+            pmix_list_remove_item(&early, &msg->super);
+            PMIX_RELEASE(msg);
+        }
+    }
+
+    /* the table cannot be changed while we walk it */
+    PMIX_CONSTRUCT(&stale, pmix_pointer_array_t);
+    pmix_pointer_array_init(&stale, 8, INT_MAX, 8);
+    for (void *_nptr = NULL;
+         PRTE_SUCCESS
+         == pmix_hash_table_get_next_key_ptr(&sizes, (void **) &key, &size, (void **) &avg,
+                                             _nptr, &_nptr);) {
+        if (names_job(key, size / sizeof(pmix_proc_t), nspace)) {
+            PMIX_BYTE_OBJECT_CREATE(bo, 1);
+            bo->bytes = (char *) malloc(size);
+            memcpy(bo->bytes, key, size);
+            bo->size = size;
+            pmix_pointer_array_add(&stale, bo);
+            free(avg);
+        }
+    }
+    for (i = 0; i < stale.size; i++) {
+        if (NULL == (bo = (pmix_byte_object_t *) pmix_pointer_array_get_item(&stale, i))) {
+            continue;
+        }
+        pmix_hash_table_remove_value_ptr(&sizes, bo->bytes, bo->size);
+        PMIX_BYTE_OBJECT_FREE(bo, 1);
+    }
+    PMIX_DESTRUCT(&stale);
+}
+
+static bool same_sig(prte_grpcomm_signature_t *a, prte_grpcomm_signature_t *b)
+{
+    return a->sz == b->sz && 0 == memcmp(a->signature, b->signature, a->sz * sizeof(pmix_proc_t));
+}
+
+/* the sequence number of the last collective over the
+ * signature that started here */
+static bool last_seq(prte_grpcomm_signature_t *sig, uint32_t *seq)
+{
+    uint32_t *seq_number;
+
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_grpcomm_base.sig_table,
+                                                      (void *) sig->signature,
+                                                      sig->sz * sizeof(pmix_proc_t),
+                                                      (void **) &seq_number)) {
+        return false;
+    }
+    *seq = *seq_number;
+    return true;
+}
+
+static void record(prte_grpcomm_signature_t *sig, size_t avg)
+{
+    size_t *val;
+
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&sizes, (void *) sig->signature,
+                                                      sig->sz * sizeof(pmix_proc_t),
+                                                      (void **) &val)) {
+        *val = avg;
+        return;
+    }
+    val = (size_t *) malloc(sizeof(size_t));
+    *val = avg;
+    pmix_hash_table_set_value_ptr(&sizes, (void *) sig->signature,
+                                  sig->sz * sizeof(pmix_proc_t), val);
+}
+
+/* every daemon in the collective reaches the same answer */
+static bool use_brucks(prte_grpcomm_coll_t *coll)
+{
+    size_t *avg;
+
+    if (0 == prte_grpcomm_brucks_min_size) {
+        return true;
+    }
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&sizes, (void *) coll->sig->signature,
+                                                      coll->sig->sz * sizeof(pmix_proc_t),
+                                                      (void **) &avg)) {
+        /* the first one over these procs */
+        return true;
+    }
+    return prte_grpcomm_brucks_min_size <= *avg;
+}
+
+static void passed_release(int status, pmix_data_buffer_t *buf, void *cbdata)
+{
+    prte_grpcomm_brucks_caddy_t *cd = (prte_grpcomm_brucks_caddy_t *) cbdata;
+    size_t size = 0;
+
+    if (NULL != buf) {
+        size = buf->bytes_used - (buf->unpack_ptr - buf->base_ptr);
+    }
+    record(cd->sig, size / (0 < cd->ndmns ? cd->ndmns : 1));
+    if (NULL != cd->cbfunc) {
+        cd->cbfunc(status, buf, cd->cbdata);
+    }
+    PMIX_RELEASE(cd);
+}
+
+static pmix_rank_t peer(prte_grpcomm_coll_t *coll, size_t idx)
+{
+    return (NULL == coll->dmns) ? (pmix_rank_t) idx : coll->dmns[idx];
+}
+
+static size_t nblocks(prte_grpcomm_coll_t *coll, uint32_t step)
+{
+    size_t dist = (size_t) 1 << step;
+
+    return (dist < coll->ndmns - dist) ? dist : coll->ndmns - dist;
+}
+
+/* prepare a collective for the exchange. The buffers hold one
+ * block per daemon, block j being the contribution of the daemon
+ * j places above us. The base counters are reused: nexpected is
+ * the number of steps and nreported the number we sent */
+static int setup(prte_grpcomm_coll_t *coll)
+{
+    size_t n;
+
+    if (NULL != coll->buffers) {
+        return PRTE_SUCCESS;
+    }
+    if (0 == coll->ndmns) {
+        return PRTE_ERR_NOT_FOUND;
+    }
+    if (NULL == coll->dmns) {
+        coll->my_rank = PRTE_PROC_MY_NAME->rank;
+    } else {
+        for (n = 0; n < coll->ndmns; n++) {
+            if (coll->dmns[n] == PRTE_PROC_MY_NAME->rank) {
+                break;
+            }
+        }
+        if (n == coll->ndmns) {
+            return PRTE_ERR_NOT_FOUND;
+        }
+        coll->my_rank = n;
+    }
+    coll->buffers = (pmix_data_buffer_t **) calloc(coll->ndmns, sizeof(pmix_data_buffer_t *));
+    if (NULL == coll->buffers) {
+        return PRTE_ERR_OUT_OF_RESOURCE;
+    }
+    coll->nexpected = 0;
+    while (((size_t) 1 << coll->nexpected) < coll->ndmns) {
+        coll->nexpected++;
+    }
+    coll->nreported = 0;
+    pmix_bitmap_init(&coll->distance_mask_recv, (int) coll->nexpected + 1);
+    return PRTE_SUCCESS;
+}
+
+static int send_step(prte_grpcomm_coll_t *coll, uint32_t step)
+{
+    pmix_data_buffer_t *msg;
+    pmix_byte_object_t bo;
+    size_t dist = (size_t) 1 << step, cnt = nblocks(coll, step), n;
+    uint32_t seq = 0, nsend = 0;
+    pmix_rank_t dst;
+    int rc;
+
+    (void) last_seq(coll->sig, &seq);
+    for (n = 0; n < cnt; n++) {
+        if (0 < coll->buffers[n]->bytes_used) {
+            nsend = cnt;
+            break;
+        }
+    }
+
+    PMIX_DATA_BUFFER_CREATE(msg);
+    rc = PMIx_Data_pack(NULL, msg, &coll->sig->sz, 1, PMIX_SIZE);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    rc = PMIx_Data_pack(NULL, msg, coll->sig->signature, coll->sig->sz, PMIX_PROC);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    rc = PMIx_Data_pack(NULL, msg, &seq, 1, PMIX_UINT32);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    rc = PMIx_Data_pack(NULL, msg, &step, 1, PMIX_UINT32);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    rc = PMIx_Data_pack(NULL, msg, &coll->status, 1, PMIX_STATUS);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    /* blocks that are all empty are implied */
+    rc = PMIx_Data_pack(NULL, msg, &nsend, 1, PMIX_UINT32);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    for (n = 0; n < nsend; n++) {
+        bo.bytes = coll->buffers[n]->base_ptr;
+        bo.size = coll->buffers[n]->bytes_used;
+        rc = PMIx_Data_pack(NULL, msg, &bo, 1, PMIX_BYTE_OBJECT);
+        if (PMIX_SUCCESS != rc) {
+            goto error;
+        }
+    }
+
+    dst = peer(coll, (coll->my_rank + coll->ndmns - dist) % coll->ndmns);
+    PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:brucks sending step %u with %u blocks to %s",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), step, nsend,
+                         PRTE_VPID_PRINT(dst)));
+    PRTE_RML_SEND(rc, dst, msg, PRTE_RML_TAG_ALLGATHER_BRUCKS);
+    if (PRTE_SUCCESS != rc) {
+        PRTE_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(msg);
+    }
+    return rc;
+
+error:
+    PMIX_ERROR_LOG(rc);
+    PMIX_DATA_BUFFER_RELEASE(msg);
+    return rc;
+}
+
+static void release(prte_grpcomm_coll_t *coll)
+{
+    pmix_data_buffer_t buf, *blk;
+    size_t n, idx, total = 0;
+
+    PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:brucks collective complete",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
+
+    /* deliver the contributions in daemon order so
+     * every daemon hands up the same result */
+    PMIX_DATA_BUFFER_CONSTRUCT(&buf);
+    for (n = 0; n < coll->ndmns; n++) {
+        idx = (n + coll->ndmns - coll->my_rank) % coll->ndmns;
+        blk = coll->buffers[idx];
+        total += blk->bytes_used;
+        if (0 < blk->bytes_used) {
+            PMIx_Data_copy_payload(&buf, blk);
+        }
+        PMIX_DATA_BUFFER_RELEASE(blk);
+        coll->buffers[idx] = NULL;
+    }
+    if (0 < prte_grpcomm_brucks_min_size) {
+        record(coll->sig, total / coll->ndmns);
+    }
+
+    if (NULL != coll->cbfunc) {
+        coll->cbfunc(coll->status, &buf, coll->cbdata);
+    }
+    PMIX_DATA_BUFFER_DESTRUCT(&buf);
+    prte_grpcomm_base_release_tracker(coll);
+}
+
+/* send every step whose blocks are all here - step k needs what
+ * came in during the steps before it - and complete the collective
+ * once the last step has come in */
+static void progress(prte_grpcomm_coll_t *coll)
+{
+    if (NULL == coll->buffers[0]) {
+        /* we have not contributed yet */
+        return;
+    }
+    while (coll->nreported < coll->nexpected
+           && (0 == coll->nreported
+               || prte_grpcomm_base_check_distance_recv(coll, coll->nreported - 1))) {
+        if (PRTE_SUCCESS != send_step(coll, coll->nreported)) {
+            /* our peers will never complete */
+            coll->status = PRTE_ERR_COMM_FAILURE;
+        }
+        coll->nreported++;
+    }
+    if (coll->nreported == coll->nexpected
+        && (0 == coll->nexpected
+            || prte_grpcomm_base_check_distance_recv(coll, coll->nexpected - 1))) {
+        release(coll);
+    }
+}
+
+/* take the blocks of a step into the collective */
+static int deliver(prte_grpcomm_coll_t *coll, prte_grpcomm_brucks_msg_t *msg)
+{
+    pmix_byte_object_t bo;
+    size_t dist, cnt, n;
+    uint32_t nsent;
+    int32_t one = 1;
+    int rc;
+
+    if (msg->step >= coll->nexpected
+        || prte_grpcomm_base_check_distance_recv(coll, msg->step)) {
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        return PRTE_ERR_BAD_PARAM;
+    }
+    rc = PMIx_Data_unpack(NULL, &msg->data, &nsent, &one, PMIX_UINT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
+    }
+    dist = (size_t) 1 << msg->step;
+    cnt = nblocks(coll, msg->step);
+    if (0 != nsent && cnt != nsent) {
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        return PRTE_ERR_BAD_PARAM;
+    }
+    for (n = 0; n < cnt; n++) {
+        PMIX_DATA_BUFFER_CREATE(coll->buffers[dist + n]);
+        if (0 == nsent) {
+            continue;
+        }
+        one = 1;
+        rc = PMIx_Data_unpack(NULL, &msg->data, &bo, &one, PMIX_BYTE_OBJECT);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            coll->status = rc;
+            continue;
+        }
+        if (0 < bo.size) {
+            PMIx_Data_load(coll->buffers[dist + n], &bo);
+        }
+        PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+    }
+    if (PMIX_SUCCESS != msg->status) {
+        coll->status = msg->status;
+    }
+    prte_grpcomm_base_mark_distance_recv(coll, msg->step);
+    return PRTE_SUCCESS;
+}
+
+static int allgather(prte_grpcomm_coll_t *coll, pmix_data_buffer_t *buf,
+                     int mode, pmix_status_t local_status)
+{
+    prte_grpcomm_brucks_caddy_t *cd;
+    prte_grpcomm_brucks_msg_t *msg, *nxt;
+    uint32_t seq = 0;
+    pmix_list_t held;
+    int rc;
+
+    PMIX_OUTPUT_VERBOSE((1, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:brucks: allgather",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
+
+    /* the base functions pushed us into the event library
+     * before calling us, so we can safely access global data
+     * at this point */
+
+    /* only the HNP can hand out a context id */
+    if (0 != mode || 0 == coll->ndmns) {
+        return PRTE_ERR_TAKE_NEXT_OPTION;
+    }
+    /* if a peer already sent us a step, it chose for us */
+    if (NULL == coll->buffers && !use_brucks(coll)) {
+        PMIX_OUTPUT_VERBOSE((2, prte_grpcomm_base_framework.framework_output,
+                             "%s grpcomm:brucks: passing small allgather on",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
+        /* note the size of the result for the next one */
+        cd = PMIX_NEW(prte_grpcomm_brucks_caddy_t);
+        PMIX_RETAIN(coll->sig);
+        cd->sig = coll->sig;
+        cd->ndmns = coll->ndmns;
+        cd->cbfunc = coll->cbfunc;
+        cd->cbdata = coll->cbdata;
+        coll->cbfunc = passed_release;
+        coll->cbdata = cd;
+        return PRTE_ERR_TAKE_NEXT_OPTION;
+    }
+    if (PRTE_SUCCESS != (rc = setup(coll))) {
+        PRTE_ERROR_LOG(rc);
+        return rc;
+    }
+
+    if (PMIX_SUCCESS != local_status) {
+        coll->status = local_status;
+    }
+    PMIX_DATA_BUFFER_CREATE(coll->buffers[0]);
+    rc = PMIx_Data_copy_payload(coll->buffers[0], buf);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        coll->status = rc;
+    }
+
+    /* take in whatever arrived for this collective while
+     * the previous one over these procs was still going */
+    (void) last_seq(coll->sig, &seq);
+    PMIX_CONSTRUCT(&held, pmix_list_t);
+    PMIX_LIST_FOREACH_SAFE(msg, nxt, &early, prte_grpcomm_brucks_msg_t) {
+        if (same_sig(msg->sig, coll->sig)) {
+            pmix_list_remove_item(&early, &msg->super);
+            pmix_list_append(&held, &msg->super);
+        }
+    }
+    while (NULL != (msg = (prte_grpcomm_brucks_msg_t *) pmix_list_remove_first(&held))) {
+        if (msg->seq != seq) {
+            PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        } else {
+            (void) deliver(coll, msg);
+        }
+        PMIX_RELEASE(msg);
+    }
+    PMIX_DESTRUCT(&held);
+
+    progress(coll);
+    return PRTE_SUCCESS;
+}
+
+static void allgather_recv(int status, pmix_proc_t *sender,
+                           pmix_data_buffer_t *buffer,
+                           prte_rml_tag_t tag, void *cbdata)
+{
+    prte_grpcomm_brucks_msg_t *msg;
+    prte_grpcomm_coll_t *coll;
+    uint32_t seq;
+    int32_t cnt;
+    bool found;
+    int rc;
+    PRTE_HIDE_UNUSED_PARAMS(status, tag, cbdata);
+
+    PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:brucks allgather recvd from %s",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender)));
+
+    msg = PMIX_NEW(prte_grpcomm_brucks_msg_t);
+    msg->sig = PMIX_NEW(prte_grpcomm_signature_t);
+    cnt = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &msg->sig->sz, &cnt, PMIX_SIZE);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    PMIX_PROC_CREATE(msg->sig->signature, msg->sig->sz);
+    cnt = msg->sig->sz;
+    rc = PMIx_Data_unpack(NULL, buffer, msg->sig->signature, &cnt, PMIX_PROC);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    cnt = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &msg->seq, &cnt, PMIX_UINT32);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    cnt = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &msg->step, &cnt, PMIX_UINT32);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    cnt = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &msg->status, &cnt, PMIX_STATUS);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+    rc = PMIx_Data_copy_payload(&msg->data, buffer);
+    if (PMIX_SUCCESS != rc) {
+        goto error;
+    }
+
+    found = last_seq(msg->sig, &seq);
+    coll = prte_grpcomm_base_get_tracker(msg->sig, false);
+    if (NULL != coll && NULL != coll->cbfunc) {
+        /* the collective started here - this is either
+         * for it or for the next one over these procs */
+        if (!found || msg->seq != seq) {
+            PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                                 "%s grpcomm:brucks holding step %u of the next collective",
+                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), msg->step));
+            pmix_list_append(&early, &msg->super);
+            return;
+        }
+        if (NULL == coll->buffers) {
+            /* the others chose differently than we did */
+            PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+            PMIX_RELEASE(msg);
+            return;
+        }
+    } else {
+        /* our procs have not called it yet */
+        if (msg->seq != (found ? seq + 1 : 0)) {
+            PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+            PMIX_RELEASE(msg);
+            return;
+        }
+        if (NULL == coll && NULL == (coll = prte_grpcomm_base_get_tracker(msg->sig, true))) {
+            PMIX_RELEASE(msg);
+            return;
+        }
+        if (PRTE_SUCCESS != (rc = setup(coll))) {
+            PRTE_ERROR_LOG(rc);
+            PMIX_RELEASE(msg);
+            return;
+        }
+    }
+
+    if (PRTE_SUCCESS == deliver(coll, msg)) {
+        progress(coll);
+    }
+    PMIX_RELEASE(msg);
+    return;
+
+error:
+    PMIX_ERROR_LOG(rc);
+    PMIX_RELEASE(msg);
+}
@@ -0,0 +1,33 @@
+/* -*- C -*-
+ *
+ * Copyright (c) 2022      Nanook Consulting.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ */
+#ifndef GRPCOMM_BRUCKS_H
+#define GRPCOMM_BRUCKS_H
+
+#include "prte_config.h"
+
+#include "src/mca/grpcomm/grpcomm.h"
+
+BEGIN_C_DECLS
+
+/*
+ * Grpcomm interfaces
+ */
+
+PRTE_MODULE_EXPORT extern prte_grpcomm_base_component_t prte_mca_grpcomm_brucks_component;
+extern prte_grpcomm_base_module_t prte_grpcomm_brucks_module;
+
+/* average contribution per daemon, in bytes, below which an
+ * allgather is left to the next component - zero takes them all */
+extern size_t prte_grpcomm_brucks_min_size;
+
+END_C_DECLS
+
+#endif
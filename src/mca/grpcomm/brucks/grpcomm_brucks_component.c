@@ -0,0 +1,90 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2022      Nanook Consulting.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "prte_config.h"
+#include "constants.h"
+
+#include "src/mca/base/pmix_mca_base_var.h"
+#include "src/mca/mca.h"
+#include "src/runtime/prte_globals.h"
+
+#include "src/util/proc_info.h"
+
+#include "grpcomm_brucks.h"
+
+static int my_priority = 80; /* behind direct unless raised above it */
+static int brucks_open(void);
+static int brucks_close(void);
+static int brucks_query(pmix_mca_base_module_t **module, int *priority);
+static int brucks_register(void);
+
+size_t prte_grpcomm_brucks_min_size = 0;
+
+/*
+ * Struct of function pointers that need to be initialized
+ */
+prte_grpcomm_base_component_t prte_mca_grpcomm_brucks_component = {
+    PRTE_GRPCOMM_BASE_VERSION_3_0_0,
+
+    .pmix_mca_component_name = "brucks",
+    PMIX_MCA_BASE_MAKE_VERSION(component,
+                               PRTE_MAJOR_VERSION,
+                               PRTE_MINOR_VERSION,
+                               PMIX_RELEASE_VERSION),
+    .pmix_mca_open_component = brucks_open,
+    .pmix_mca_close_component = brucks_close,
+    .pmix_mca_query_component = brucks_query,
+    .pmix_mca_register_component_params = brucks_register,
+};
+
+static int brucks_register(void)
+{
+    pmix_mca_base_component_t *c = &prte_mca_grpcomm_brucks_component;
+
+    my_priority = 80;
+    (void) pmix_mca_base_component_var_register(c, "priority",
+                                                "Priority of the grpcomm brucks component - it "
+                                                "is only used if this is above the priority of "
+                                                "the direct component (85), which then takes the "
+                                                "allgathers it passes on",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &my_priority);
+
+    prte_grpcomm_brucks_min_size = 0;
+    (void) pmix_mca_base_component_var_register(c, "min_size",
+                                                "Average contribution per daemon (in bytes) below "
+                                                "which an allgather is passed on to the direct "
+                                                "component rather than exchanged with Bruck's "
+                                                "algorithm. The size is that of the previous "
+                                                "allgather over the same procs, so every daemon "
+                                                "makes the same choice - the first one always uses "
+                                                "Bruck's (0 => always use Bruck's)",
+                                                PMIX_MCA_BASE_VAR_TYPE_SIZE_T,
+                                                &prte_grpcomm_brucks_min_size);
+    return PRTE_SUCCESS;
+}
+
+/* Open the component */
+static int brucks_open(void)
+{
+    return PRTE_SUCCESS;
+}
+
+static int brucks_close(void)
+{
+    return PRTE_SUCCESS;
+}
+
+static int brucks_query(pmix_mca_base_module_t **module, int *priority)
+{
+    *priority = my_priority;
+    *module = (pmix_mca_base_module_t *) &prte_grpcomm_brucks_module;
+    return PRTE_SUCCESS;
+}
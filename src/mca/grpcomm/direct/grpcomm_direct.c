@@ -21,6 +21,9 @@
 #include "types.h"
 
 #include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#    include <sys/time.h>
+#endif
 
 #include "src/class/pmix_list.h"
 #include "src/pmix/pmix-internal.h"
@@ -52,19 +55,61 @@ prte_grpcomm_base_module_t prte_grpcomm_direct_module = {
     .allgather = allgather,
     .rbcast = NULL,
     .register_cb = NULL,
-    .unregister_cb = NULL
+    .unregister_cb = NULL,
+    .purge_job = NULL
 };
 
 /* internal functions */
 static void xcast_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                        prte_rml_tag_t tag, void *cbdata);
+static void xcast_segment_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                               prte_rml_tag_t tag, void *cbdata);
+static void xcast_process(pmix_data_buffer_t *buffer, bool forward);
+static int relay_to_children(prte_rml_payload_t *rly, prte_rml_tag_t tag);
+static void send_segments(prte_rml_payload_t *rly);
 static void allgather_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                            prte_rml_tag_t tag, void *cbdata);
 static void barrier_release(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                             prte_rml_tag_t tag, void *cbdata);
 
+/* object for reassembling a segmented xcast */
+typedef struct {
+    pmix_list_item_t super;
+    uint32_t id;
+    char *bytes;
+    size_t size;
+    size_t piece;
+    /* one flag per piece, so a resent piece is only counted once */
+    uint8_t *have;
+    size_t npieces;
+    size_t nrecvd;
+    struct timeval start;
+} prte_grpcomm_direct_segment_t;
+static void segcon(prte_grpcomm_direct_segment_t *p)
+{
+    p->id = 0;
+    p->bytes = NULL;
+    p->size = 0;
+    p->piece = 0;
+    p->have = NULL;
+    p->npieces = 0;
+    p->nrecvd = 0;
+}
+static void segdes(prte_grpcomm_direct_segment_t *p)
+{
+    if (NULL != p->bytes) {
+        free(p->bytes);
+    }
+    if (NULL != p->have) {
+        free(p->have);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_grpcomm_direct_segment_t, pmix_list_item_t, segcon, segdes);
+
 /* internal variables */
 static pmix_list_t tracker;
+static pmix_list_t segments;
+static uint32_t next_segment_id = 0;
 
 /**
  * Initialize the module
@@ -72,10 +117,13 @@ static pmix_list_t tracker;
 static int init(void)
 {
     PMIX_CONSTRUCT(&tracker, pmix_list_t);
+    PMIX_CONSTRUCT(&segments, pmix_list_t);
 
     /* post the receives */
     PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_XCAST,
                   PRTE_RML_PERSISTENT, xcast_recv, NULL);
+    PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_XCAST_SEGMENT,
+                  PRTE_RML_PERSISTENT, xcast_segment_recv, NULL);
     PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_ALLGATHER_DIRECT,
                   PRTE_RML_PERSISTENT, allgather_recv, NULL);
     /* setup recv for barrier release */
@@ -91,6 +139,7 @@ static int init(void)
 static void finalize(void)
 {
     PMIX_LIST_DESTRUCT(&tracker);
+    PMIX_LIST_DESTRUCT(&segments);
     return;
 }
 
@@ -368,10 +417,259 @@ static void allgather_recv(int status, pmix_proc_t *sender,
 static void xcast_recv(int status, pmix_proc_t *sender,
                        pmix_data_buffer_t *buffer,
                        prte_rml_tag_t tg, void *cbdata)
+{
+    PRTE_HIDE_UNUSED_PARAMS(status, sender, tg, cbdata);
+
+    xcast_process(buffer, true);
+}
+
+static void xcast_segment_recv(int status, pmix_proc_t *sender,
+                               pmix_data_buffer_t *buffer,
+                               prte_rml_tag_t tg, void *cbdata)
+{
+    prte_grpcomm_direct_segment_t *seg, *sptr;
+    prte_rml_payload_t *rly;
+    pmix_data_buffer_t datbuf;
+    pmix_byte_object_t bo;
+    struct timeval now;
+    uint32_t id;
+    size_t size, piece, offset, idx;
+    int ret, cnt;
+    PRTE_HIDE_UNUSED_PARAMS(status, sender, tg, cbdata);
+
+    /* pass the segment down the tree before we do anything else
+     * with it so our children can work on it while we wait for
+     * the next one to arrive. The RML owns the buffer, so we
+     * need one copy of it that all the sends can share */
+    if (0 < pmix_list_get_size(&prte_rml_base.children)) {
+        rly = prte_rml_payload_create(buffer, true);
+        if (NULL == rly) {
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+            return;
+        }
+        ret = relay_to_children(rly, PRTE_RML_TAG_XCAST_SEGMENT);
+        PMIX_RELEASE(rly);
+        if (PRTE_SUCCESS != ret) {
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+            return;
+        }
+    }
+
+    /* unpack the segment header */
+    cnt = 1;
+    ret = PMIx_Data_unpack(NULL, buffer, &id, &cnt, PMIX_UINT32);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+    cnt = 1;
+    ret = PMIx_Data_unpack(NULL, buffer, &size, &cnt, PMIX_SIZE);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+    cnt = 1;
+    ret = PMIx_Data_unpack(NULL, buffer, &piece, &cnt, PMIX_SIZE);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+    cnt = 1;
+    ret = PMIx_Data_unpack(NULL, buffer, &offset, &cnt, PMIX_SIZE);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+    cnt = 1;
+    ret = PMIx_Data_unpack(NULL, buffer, &bo, &cnt, PMIX_BYTE_OBJECT);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+
+    /* find the matching reassembly tracker */
+    seg = NULL;
+    PMIX_LIST_FOREACH(sptr, &segments, prte_grpcomm_direct_segment_t) {
+        if (sptr->id == id) {
+            seg = sptr;
+            break;
+        }
+    }
+    /* the header comes off the wire, so check it before we
+     * size anything by it. Only the sender's last piece may be
+     * short, and every piece must start on a piece boundary */
+    if (0 == size || PRTE_GRPCOMM_DIRECT_XCAST_MAX_SIZE < size || 0 == piece || size < piece
+        || size <= offset || 0 != offset % piece
+        || bo.size != (piece < size - offset ? piece : size - offset)
+        || (NULL != seg && (size != seg->size || piece != seg->piece))) {
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+        if (NULL != seg) {
+            pmix_list_remove_item(&segments, &seg->super);
+            PMIX_RELEASE(seg);
+        }
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+    if (NULL == seg) {
+        seg = PMIX_NEW(prte_grpcomm_direct_segment_t);
+        seg->id = id;
+        seg->size = size;
+        seg->piece = piece;
+        seg->npieces = (size + piece - 1) / piece;
+        seg->bytes = (char *) malloc(size);
+        seg->have = (uint8_t *) calloc(seg->npieces, sizeof(uint8_t));
+        if (NULL == seg->bytes || NULL == seg->have) {
+            PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+            PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+            PMIX_RELEASE(seg);
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+            return;
+        }
+        gettimeofday(&seg->start, NULL);
+        pmix_list_append(&segments, &seg->super);
+    }
+    idx = offset / piece;
+    if (seg->have[idx]) {
+        /* a duplicate - we already hold these bytes */
+        PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+        return;
+    }
+    memcpy(seg->bytes + offset, bo.bytes, bo.size);
+    seg->have[idx] = 1;
+    ++seg->nrecvd;
+    PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+
+    PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:direct:xcast:segment id %u recvd %lu of %lu pieces",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), id,
+                         (unsigned long) seg->nrecvd, (unsigned long) seg->npieces));
+
+    if (seg->nrecvd < seg->npieces) {
+        return;
+    }
+
+    /* the message is complete - process it locally. Our children
+     * already have all the pieces, so don't relay it again */
+    gettimeofday(&now, NULL);
+    PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:direct:xcast:segment id %u complete: %lu bytes in %ld usec "
+                         "(payload totals: copied %lu sent %lu bytes)",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), id, (unsigned long) seg->size,
+                         (long) ((now.tv_sec - seg->start.tv_sec) * 1000000
+                                 + (now.tv_usec - seg->start.tv_usec)),
+                         (unsigned long) prte_rml_base.payload_copied,
+                         (unsigned long) prte_rml_base.payload_sent));
+    pmix_list_remove_item(&segments, &seg->super);
+    PMIX_DATA_BUFFER_CONSTRUCT(&datbuf);
+    bo.bytes = seg->bytes;
+    bo.size = seg->size;
+    seg->bytes = NULL;
+    ret = PMIx_Data_load(&datbuf, &bo);
+    PMIX_RELEASE(seg);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+        PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+        return;
+    }
+    xcast_process(&datbuf, false);
+    PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
+}
+
+static int relay_to_children(prte_rml_payload_t *rly, prte_rml_tag_t tag)
 {
     prte_routed_tree_t *nm;
+    int ret, rc = PRTE_SUCCESS;
+
+    /* all the sends share the same payload - it will be released
+     * when the last of them completes */
+    PMIX_LIST_FOREACH(nm, &prte_rml_base.children, prte_routed_tree_t)
+    {
+        PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                             "%s grpcomm:direct:send_relay sending relay msg of %d bytes to %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (int) rly->size,
+                             PRTE_VPID_PRINT(nm->rank)));
+        PRTE_RML_SEND_PAYLOAD(ret, nm->rank, rly, tag);
+        if (PRTE_SUCCESS != ret) {
+            PRTE_ERROR_LOG(ret);
+            rc = ret;
+            continue;
+        }
+    }
+    return rc;
+}
+
+static void send_segments(prte_rml_payload_t *rly)
+{
+    pmix_data_buffer_t frag;
+    prte_rml_payload_t *pld;
+    pmix_byte_object_t bo;
+    uint32_t id;
+    size_t offset, size, piece;
+    int ret;
+
+    id = next_segment_id++;
+    size = rly->size;
+    piece = prte_grpcomm_direct_xcast_segment_size;
+
+    PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
+                         "%s grpcomm:direct:xcast segmenting id %u of %lu bytes into %lu byte pieces",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), id, (unsigned long) size,
+                         (unsigned long) prte_grpcomm_direct_xcast_segment_size));
+
+    for (offset = 0; offset < size; offset += bo.size) {
+        bo.bytes = rly->bytes + offset;
+        bo.size = size - offset;
+        if (piece < bo.size) {
+            bo.size = piece;
+        }
+        PMIX_DATA_BUFFER_CONSTRUCT(&frag);
+        ret = PMIx_Data_pack(NULL, &frag, &id, 1, PMIX_UINT32);
+        if (PMIX_SUCCESS == ret) {
+            ret = PMIx_Data_pack(NULL, &frag, &size, 1, PMIX_SIZE);
+        }
+        if (PMIX_SUCCESS == ret) {
+            ret = PMIx_Data_pack(NULL, &frag, &piece, 1, PMIX_SIZE);
+        }
+        if (PMIX_SUCCESS == ret) {
+            ret = PMIx_Data_pack(NULL, &frag, &offset, 1, PMIX_SIZE);
+        }
+        if (PMIX_SUCCESS == ret) {
+            ret = PMIx_Data_pack(NULL, &frag, &bo, 1, PMIX_BYTE_OBJECT);
+        }
+        if (PMIX_SUCCESS != ret) {
+            PMIX_ERROR_LOG(ret);
+            PMIX_DATA_BUFFER_DESTRUCT(&frag);
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+            return;
+        }
+        /* packing the segment was the copy - hand the result
+         * to the payload as it is */
+        prte_rml_base.payload_copied += frag.bytes_used;
+        pld = prte_rml_payload_create(&frag, false);
+        PMIX_DATA_BUFFER_DESTRUCT(&frag);
+        ret = relay_to_children(pld, PRTE_RML_TAG_XCAST_SEGMENT);
+        PMIX_RELEASE(pld);
+        if (PRTE_SUCCESS != ret) {
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+            return;
+        }
+    }
+}
+
+static void xcast_process(pmix_data_buffer_t *buffer, bool forward)
+{
     int ret, cnt;
-    pmix_data_buffer_t *relay = NULL, *rly, *rlycopy;
+    pmix_data_buffer_t *relay = NULL;
+    prte_rml_payload_t *rly;
+    char *start;
+    size_t copied, sent;
     pmix_data_buffer_t datbuf, *data;
     bool compressed;
     prte_job_t *jdata, *daemons;
@@ -387,15 +685,9 @@ static void xcast_recv(int status, pmix_proc_t *sender,
                          "%s grpcomm:direct:xcast:recv: with %d bytes",
                          PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (int) buffer->bytes_used));
 
-    /* we need a passthru buffer to send to our children - we leave it
-     * as compressed data */
-    PMIX_DATA_BUFFER_CREATE(rly);
-    ret = PMIx_Data_copy_payload(rly, buffer);
-    if (PMIX_SUCCESS != ret) {
-        PMIX_ERROR_LOG(ret);
-        PMIX_DATA_BUFFER_RELEASE(rly);
-        return;
-    }
+    /* remember where the passthru payload starts - we only take a copy
+     * of it once we know we have children to relay it to */
+    start = buffer->unpack_ptr;
     PMIX_DATA_BUFFER_CONSTRUCT(&datbuf);
     /* setup the relay list */
     PMIX_CONSTRUCT(&coll, pmix_list_t);
@@ -408,7 +700,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
         PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
         PMIX_DESTRUCT(&coll);
-        PMIX_DATA_BUFFER_RELEASE(rly);
         return;
     }
     /* unpack the data blob */
@@ -418,7 +709,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
         PMIX_ERROR_LOG(ret);
         PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         PMIX_DESTRUCT(&coll);
-        PMIX_DATA_BUFFER_RELEASE(rly);
         return;
     }
     if (compressed) {
@@ -432,7 +722,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
                 PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
                 PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
                 PMIX_DESTRUCT(&coll);
-                PMIX_DATA_BUFFER_RELEASE(rly);
                 return;
             }
         } else {
@@ -442,7 +731,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
             PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
             PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
             PMIX_DESTRUCT(&coll);
-            PMIX_DATA_BUFFER_RELEASE(rly);
             return;
         }
     } else {
@@ -452,7 +740,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
             PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
             PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
             PMIX_DESTRUCT(&coll);
-            PMIX_DATA_BUFFER_RELEASE(rly);
             return;
         }
     }
@@ -467,7 +754,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
         PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
         PMIX_DESTRUCT(&coll);
-        PMIX_DATA_BUFFER_RELEASE(rly);
         return;
     }
     PMIX_PROC_CREATE(sig.signature, sig.sz);
@@ -478,7 +764,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
         PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
         PMIX_DESTRUCT(&coll);
-        PMIX_DATA_BUFFER_RELEASE(rly);
         PMIX_PROC_FREE(sig.signature, sig.sz);
         return;
     }
@@ -492,7 +777,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
         PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
         PMIX_DESTRUCT(&coll);
-        PMIX_DATA_BUFFER_RELEASE(rly);
         return;
     }
 
@@ -504,7 +788,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
         PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
         PMIX_DESTRUCT(&coll);
-        PMIX_DATA_BUFFER_RELEASE(rly);
         PMIX_DATA_BUFFER_RELEASE(relay);
         return;
     }
@@ -515,7 +798,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
             PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
             PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
             PMIX_DESTRUCT(&coll);
-            PMIX_DATA_BUFFER_RELEASE(rly);
             PMIX_DATA_BUFFER_RELEASE(relay);
             return;
         }
@@ -531,7 +813,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
                 PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
                 PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
                 PMIX_DESTRUCT(&coll);
-                PMIX_DATA_BUFFER_RELEASE(rly);
                 PMIX_DATA_BUFFER_RELEASE(relay);
                 return;
             }
@@ -547,7 +828,6 @@ static void xcast_recv(int status, pmix_proc_t *sender,
                     PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
                     PMIX_DATA_BUFFER_DESTRUCT(&datbuf);
                     PMIX_DESTRUCT(&coll);
-                    PMIX_DATA_BUFFER_RELEASE(rly);
                     PMIX_DATA_BUFFER_RELEASE(relay);
                     return;
                 }
@@ -559,37 +839,44 @@ static void xcast_recv(int status, pmix_proc_t *sender,
     }
 
     daemons = prte_get_job_data_object(PRTE_PROC_MY_NAME->nspace);
-    if (!prte_get_attribute(&daemons->attributes, PRTE_JOB_DO_NOT_LAUNCH, NULL, PMIX_BOOL)) {
-        /* send the message to each of our children */
-        PMIX_LIST_FOREACH(nm, &prte_rml_base.children, prte_routed_tree_t)
-        {
-            PMIX_OUTPUT_VERBOSE((5, prte_grpcomm_base_framework.framework_output,
-                                 "%s grpcomm:direct:send_relay sending relay msg of %d bytes to %s",
-                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (int) rly->bytes_used,
-                                 PRTE_VPID_PRINT(nm->rank)));
-            /* copy the buffer for send */
-            PMIX_DATA_BUFFER_CREATE(rlycopy);
-            ret = PMIx_Data_copy_payload(rlycopy, rly);
-            if (PMIX_SUCCESS != ret) {
-                PRTE_ERROR_LOG(ret);
-                PMIX_DATA_BUFFER_RELEASE(rlycopy);
-                PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
-                continue;
-            }
-            PRTE_RML_SEND(ret, nm->rank, rlycopy, PRTE_RML_TAG_XCAST);
-            if (PRTE_SUCCESS != ret) {
-                PRTE_ERROR_LOG(ret);
-                PMIX_DATA_BUFFER_RELEASE(rlycopy);
-                PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
-                continue;
-            }
+    if (forward && 0 < pmix_list_get_size(&prte_rml_base.children) &&
+        !prte_get_attribute(&daemons->attributes, PRTE_JOB_DO_NOT_LAUNCH, NULL, PMIX_BOOL)) {
+        /* we need a passthru payload to send to our children - we leave it
+         * as compressed data. A single copy is shared by all the sends */
+        buffer->unpack_ptr = start;
+        rly = prte_rml_payload_create(buffer, true);
+        if (NULL == rly) {
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
+            goto CLEANUP;
+        }
+        copied = prte_rml_base.payload_copied - rly->size;
+        sent = prte_rml_base.payload_sent;
+        if (PRTE_PROC_IS_MASTER && PRTE_RML_TAG_WIREUP != tag &&
+            0 < prte_grpcomm_direct_xcast_segment_size &&
+            prte_grpcomm_direct_xcast_segment_size < rly->size &&
+            PRTE_GRPCOMM_DIRECT_XCAST_MAX_SIZE >= rly->size) {
+            /* pipeline the message down the tree in pieces. Wireup
+             * messages are always sent whole as the daemons must decode
+             * the nidmap before they can relay */
+            send_segments(rly);
+        } else if (PRTE_SUCCESS != relay_to_children(rly, PRTE_RML_TAG_XCAST)) {
+            /* send the message to each of our children */
+            PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_FORCED_EXIT);
         }
+        pmix_output_verbose(5, prte_grpcomm_base_framework.framework_output,
+                            "%s grpcomm:direct:xcast relay of %lu bytes: copied %lu sent %lu bytes "
+                            "(payload totals: copied %lu sent %lu bytes)",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (unsigned long) rly->size,
+                            (unsigned long) (prte_rml_base.payload_copied - copied),
+                            (unsigned long) (prte_rml_base.payload_sent - sent),
+                            (unsigned long) prte_rml_base.payload_copied,
+                            (unsigned long) prte_rml_base.payload_sent);
+        PMIX_RELEASE(rly); // retain accounting
     }
 
 CLEANUP:
     /* cleanup */
     PMIX_LIST_DESTRUCT(&coll);
-    PMIX_DATA_BUFFER_RELEASE(rly); // retain accounting
 
     /* now pass the relay buffer to myself for processing IFF it
      * wasn't just a wireup message - don't
@@ -662,7 +949,6 @@ static void barrier_release(int status, pmix_proc_t *sender, pmix_data_buffer_t
     if (NULL != coll->cbfunc) {
         coll->cbfunc(ret, buffer, coll->cbdata);
     }
-    pmix_list_remove_item(&prte_grpcomm_base.ongoing, &coll->super);
-    PMIX_RELEASE(coll);
+    prte_grpcomm_base_release_tracker(coll);
     PMIX_PROC_FREE(sig.signature, sig.sz);
 }
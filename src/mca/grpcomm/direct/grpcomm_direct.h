@@ -28,6 +28,14 @@ BEGIN_C_DECLS
 PRTE_MODULE_EXPORT extern prte_grpcomm_base_component_t prte_mca_grpcomm_direct_component;
 extern prte_grpcomm_base_module_t prte_grpcomm_direct_module;
 
+/* size of the pieces a large xcast is cut into for
+ * pipelined relay - zero disables segmentation */
+extern size_t prte_grpcomm_direct_xcast_segment_size;
+
+/* largest xcast we will reassemble from segments - anything
+ * bigger is relayed whole */
+#define PRTE_GRPCOMM_DIRECT_XCAST_MAX_SIZE ((size_t) INT32_MAX)
+
 END_C_DECLS
 
 #endif
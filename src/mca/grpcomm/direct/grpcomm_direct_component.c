@@ -31,6 +31,8 @@ static int direct_close(void);
 static int direct_query(pmix_mca_base_module_t **module, int *priority);
 static int direct_register(void);
 
+size_t prte_grpcomm_direct_xcast_segment_size = 0;
+
 /*
  * Struct of function pointers that need to be initialized
  */
@@ -60,6 +62,15 @@ static int direct_register(void)
                                                 "Priority of the grpcomm direct component",
                                                 PMIX_MCA_BASE_VAR_TYPE_INT,
                                                 &my_priority);
+
+    prte_grpcomm_direct_xcast_segment_size = 0;
+    (void) pmix_mca_base_component_var_register(c, "xcast_segment_size",
+                                                "Size (in bytes) of the segments into which large xcast "
+                                                "messages are cut so that each daemon can relay one "
+                                                "segment while receiving the next (0 => always relay "
+                                                "the complete message)",
+                                                PMIX_MCA_BASE_VAR_TYPE_SIZE_T,
+                                                &prte_grpcomm_direct_xcast_segment_size);
     return PRTE_SUCCESS;
 }
 
@@ -135,6 +135,10 @@ typedef int (*prte_grpcomm_base_module_rbcast_register_cb_fn_t)(prte_grpcomm_rbc
 
 typedef int (*prte_grpcomm_base_module_rbcast_unregister_cb_fn_t)(int type);
 
+/* forget anything held for collectives over the given job once
+ * it has been cleaned up - optional */
+typedef void (*prte_grpcomm_base_module_purge_job_fn_t)(const pmix_nspace_t nspace);
+
 /*
  * Ver 3.0 - internal modules
  */
@@ -147,6 +151,7 @@ typedef struct {
     prte_grpcomm_base_module_rbcast_fn_t rbcast;
     prte_grpcomm_base_module_rbcast_register_cb_fn_t register_cb;
     prte_grpcomm_base_module_rbcast_unregister_cb_fn_t unregister_cb;
+    prte_grpcomm_base_module_purge_job_fn_t purge_job;
 } prte_grpcomm_base_module_t;
 
 /* the Public APIs */
@@ -78,7 +78,6 @@ PRTE_EXPORT int prte_iof_base_select(void);
 #define PRTE_IOF_BASE_MSG_MAX        4096
 #define PRTE_IOF_BASE_TAG_MAX        1024
 #define PRTE_IOF_BASE_TAGGED_OUT_MAX 8192
-#define PRTE_IOF_MAX_INPUT_BUFFERS   50
 
 typedef struct {
     pmix_list_item_t super;
@@ -91,15 +90,57 @@ typedef struct {
 } prte_iof_write_event_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_write_event_t);
 
+/* what to do with data for a sink that has used up its budget */
+typedef enum {
+    PRTE_IOF_POLICY_BLOCK,
+    PRTE_IOF_POLICY_DROP_OLDEST,
+    PRTE_IOF_POLICY_SPILL
+} prte_iof_base_policy_t;
+
+/* the acknowledgement of a stdin push, held back until the
+ * sinks it took over budget have drained */
+typedef struct {
+    pmix_list_item_t super;
+    pmix_op_cbfunc_t cbfunc;
+    void *cbdata;
+} prte_iof_stdin_hold_t;
+PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_stdin_hold_t);
+
+/* the data held for the sinks of one job */
+typedef struct {
+    pmix_list_item_t super;
+    pmix_nspace_t nspace;
+    size_t buffered;    // bytes queued in the sinks of the job
+    size_t outstanding; // bytes sent to daemons and not yet credited back
+    size_t peak;
+    size_t dropped;
+    size_t spilled;
+    int nblocked;       // sinks over their budget
+} prte_iof_job_buffer_t;
+PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_job_buffer_t);
+
 typedef struct {
     pmix_list_item_t super;
     pmix_proc_t name;
     pmix_proc_t daemon;
     prte_iof_tag_t tag;
     prte_iof_write_event_t *wev;
-    bool xoff;
+    bool xoff;          // over budget
     bool exclusive;
     bool closed;
+    /* flow control - the bytes queued and the job they count
+     * against, the bytes the daemon hosting a remote sink can
+     * still take, and the bytes written out (or dropped) that
+     * have not yet been credited back to the sender */
+    size_t nbytes;
+    prte_iof_job_buffer_t *jbuf;
+    size_t credit;
+    size_t returned;
+    /* data that did not fit, in the order it arrived */
+    int spill_fd;
+    off_t spill_rd;
+    off_t spill_wr;
+    bool spill_close;
 } prte_iof_sink_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_sink_t);
 
@@ -115,6 +156,11 @@ typedef struct {
     bool activated;
     bool always_readable;
     prte_iof_sink_t *sink;
+    /* file the output is spliced into, and the pipe holding the
+     * copy that is still to be forwarded */
+    int splice_fd;
+    int splice_pipe[2];
+    uint32_t splice_gen; // the tool requests the pipe was last set up for
 } prte_iof_read_event_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_read_event_t);
 
@@ -131,6 +177,7 @@ typedef struct {
     pmix_list_item_t super;
     char data[PRTE_IOF_BASE_TAGGED_OUT_MAX];
     int numbytes;
+    int charged; // bytes counted against the budgets
 } prte_iof_write_output_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_write_output_t);
 
@@ -141,8 +188,26 @@ typedef struct{
 } prte_iof_deliver_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_deliver_t);
 
+/* the streams of a proc (or job) a tool has asked for */
+typedef struct {
+    pmix_list_item_t super;
+    pmix_proc_t name;
+    prte_iof_tag_t tags;
+    pmix_rank_t origin; // daemon the tool is attached to
+} prte_iof_pull_t;
+PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_iof_pull_t);
+
 /* Write event macro's */
 
+/* is anything held back for this sink? Data for it must then
+ * queue behind what is held */
+static inline bool prte_iof_base_sink_holding(prte_iof_sink_t *sink)
+{
+    return (NULL != sink->wev && !pmix_list_is_empty(&sink->wev->outputs))
+           || sink->spill_rd < sink->spill_wr
+           || sink->spill_close;
+}
+
 static inline bool prte_iof_base_fd_always_ready(int fd)
 {
     return pmix_fd_is_regular(fd) || (pmix_fd_is_chardev(fd) && !isatty(fd))
@@ -243,17 +308,58 @@ static inline bool prte_iof_base_fd_always_ready(int fd)
 PRTE_EXPORT int prte_iof_base_flush(void);
 
 PRTE_EXPORT extern int prte_iof_base_output_limit;
+PRTE_EXPORT extern bool prte_iof_base_splice;
+PRTE_EXPORT extern size_t prte_iof_base_sink_budget;
+PRTE_EXPORT extern size_t prte_iof_base_job_budget;
+PRTE_EXPORT extern prte_iof_base_policy_t prte_iof_base_policy;
+PRTE_EXPORT extern pmix_list_t prte_iof_base_jobs;
+PRTE_EXPORT extern pmix_list_t prte_iof_base_pulls;
+PRTE_EXPORT extern uint32_t prte_iof_base_pull_gen;
+PRTE_EXPORT extern int prte_iof_base_nblocked;
+PRTE_EXPORT extern pmix_list_t prte_iof_base_stdin_holds;
+
+/* query for the data held for each job, and its entries */
+#define PRTE_IOF_QUERY_OCCUPANCY "prte.iof.occupancy"
+#define PRTE_IOF_BUFFERED        "prte.iof.buffered"    // size_t
+#define PRTE_IOF_OUTSTANDING     "prte.iof.outstanding" // size_t
+#define PRTE_IOF_PEAK            "prte.iof.peak"        // size_t
+#define PRTE_IOF_DROPPED         "prte.iof.dropped"     // size_t
+#define PRTE_IOF_SPILLED         "prte.iof.spilled"     // size_t
+#define PRTE_IOF_BLOCKED         "prte.iof.blocked"     // uint32_t - sinks over budget
 
 /* base functions */
 PRTE_EXPORT int prte_iof_base_write_output(const pmix_proc_t *name, prte_iof_tag_t stream,
                                            const unsigned char *data, int numbytes,
-                                           prte_iof_write_event_t *channel);
+                                           prte_iof_sink_t *sink);
 PRTE_EXPORT void prte_iof_base_write_handler(int fd, short event, void *cbdata);
 
+/* flow control */
+PRTE_EXPORT prte_iof_job_buffer_t *prte_iof_base_sink_job(prte_iof_sink_t *sink);
+PRTE_EXPORT void prte_iof_base_sink_release(prte_iof_sink_t *sink,
+                                            prte_iof_write_output_t *output);
+PRTE_EXPORT void prte_iof_base_sink_sent(prte_iof_sink_t *sink, size_t nbytes);
+PRTE_EXPORT void prte_iof_base_sink_credit(prte_iof_sink_t *sink, size_t nbytes);
+PRTE_EXPORT void prte_iof_base_job_complete(const pmix_nspace_t nspace);
+PRTE_EXPORT bool prte_iof_base_stdin_hold(pmix_op_cbfunc_t cbfunc, void *cbdata);
+PRTE_EXPORT void prte_iof_base_stdin_release(pmix_status_t status);
+PRTE_EXPORT void prte_iof_base_query_occupancy(pmix_info_t *info);
+
 PRTE_EXPORT void prte_iof_base_output(const pmix_proc_t *source,
                                       pmix_iof_channel_t channel,
                                       char *string);
 
+/* moving output of local procs directly into their output files */
+PRTE_EXPORT bool prte_iof_base_splice_job(prte_job_t *jdata);
+PRTE_EXPORT int prte_iof_base_splice_setup(prte_iof_proc_t *proct);
+PRTE_EXPORT int32_t prte_iof_base_splice_read(prte_iof_read_event_t *rev, unsigned char *data,
+                                              size_t size);
+/* track the tool requests for output, on every daemon */
+PRTE_EXPORT void prte_iof_base_pull(const pmix_proc_t procs[], size_t nprocs,
+                                    pmix_iof_channel_t channels, bool stop);
+PRTE_EXPORT void prte_iof_base_pull_recv(pmix_data_buffer_t *buffer);
+PRTE_EXPORT void prte_iof_base_pull_purge(void);
+PRTE_EXPORT void prte_iof_base_pull_job_complete(const pmix_nspace_t nspace);
+
 END_C_DECLS
 
 #endif /* MCA_IOF_BASE_H */
@@ -60,6 +60,18 @@ prte_iof_base_module_t prte_iof = {0};
  */
 
 int prte_iof_base_output_limit = 0;
+bool prte_iof_base_splice = false;
+size_t prte_iof_base_sink_budget = 0;
+size_t prte_iof_base_job_budget = 0;
+prte_iof_base_policy_t prte_iof_base_policy = PRTE_IOF_POLICY_BLOCK;
+pmix_list_t prte_iof_base_jobs = PMIX_LIST_STATIC_INIT;
+pmix_list_t prte_iof_base_pulls = PMIX_LIST_STATIC_INIT;
+pmix_list_t prte_iof_base_stdin_holds = PMIX_LIST_STATIC_INIT;
+int prte_iof_base_nblocked = 0;
+
+static int sink_budget = 256 * 1024;
+static int job_budget = 4 * 1024 * 1024;
+static char *policy = NULL;
 
 static int prte_iof_base_register(pmix_mca_base_register_flag_t flags)
 {
@@ -72,6 +84,52 @@ static int prte_iof_base_register(pmix_mca_base_register_flag_t flags)
                                       PMIX_MCA_BASE_VAR_TYPE_INT,
                                       &prte_iof_base_output_limit);
 
+    prte_iof_base_splice = false;
+    (void) pmix_mca_base_var_register("prte", "iof", "base", "splice",
+                                      "Move the output of procs whose output goes to files directly "
+                                      "from their pipes into the files with splice(2), instead of "
+                                      "passing it through the daemon's buffers [default: false]",
+                                      PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                                      &prte_iof_base_splice);
+
+    sink_budget = 256 * 1024;
+    (void) pmix_mca_base_var_register("prte", "iof", "base", "sink_budget",
+                                      "Bytes of input that may be held for one process before "
+                                      "the overflow policy applies. Daemons return credit for "
+                                      "what they write out, so the HNP never sends a sink more "
+                                      "than this [default: 256k]",
+                                      PMIX_MCA_BASE_VAR_TYPE_INT,
+                                      &sink_budget);
+    prte_iof_base_sink_budget = (0 < sink_budget) ? (size_t) sink_budget : PRTE_IOF_BASE_MSG_MAX;
+
+    job_budget = 4 * 1024 * 1024;
+    (void) pmix_mca_base_var_register("prte", "iof", "base", "job_budget",
+                                      "Bytes of input that may be held for all processes of a "
+                                      "job before the overflow policy applies [default: 4m]",
+                                      PMIX_MCA_BASE_VAR_TYPE_INT,
+                                      &job_budget);
+    prte_iof_base_job_budget = (0 < job_budget) ? (size_t) job_budget : prte_iof_base_sink_budget;
+
+    policy = NULL;
+    (void) pmix_mca_base_var_register("prte", "iof", "base", "overflow_policy",
+                                      "What to do with input for a process whose budget is used "
+                                      "up - block (hold it for that process alone and hold off "
+                                      "the tool pushing it until it drains, the default), "
+                                      "drop-oldest (discard the oldest held data) or spill (hold "
+                                      "it in a file in the session directory)",
+                                      PMIX_MCA_BASE_VAR_TYPE_STRING,
+                                      &policy);
+    if (NULL == policy || 0 == strcasecmp(policy, "block")) {
+        prte_iof_base_policy = PRTE_IOF_POLICY_BLOCK;
+    } else if (0 == strcasecmp(policy, "drop-oldest")) {
+        prte_iof_base_policy = PRTE_IOF_POLICY_DROP_OLDEST;
+    } else if (0 == strcasecmp(policy, "spill")) {
+        prte_iof_base_policy = PRTE_IOF_POLICY_SPILL;
+    } else {
+        pmix_output(0, "iof: unknown overflow policy \"%s\" - using block", policy);
+        prte_iof_base_policy = PRTE_IOF_POLICY_BLOCK;
+    }
+
     return PRTE_SUCCESS;
 }
 
@@ -81,6 +139,11 @@ static int prte_iof_base_close(void)
     if (NULL != prte_iof.finalize) {
         prte_iof.finalize();
     }
+    /* nothing will drain now - let the tools go */
+    prte_iof_base_stdin_release(PMIX_ERR_IOF_FAILURE);
+    PMIX_LIST_DESTRUCT(&prte_iof_base_stdin_holds);
+    PMIX_LIST_DESTRUCT(&prte_iof_base_jobs);
+    PMIX_LIST_DESTRUCT(&prte_iof_base_pulls);
     return pmix_mca_base_framework_components_close(&prte_iof_base_framework, NULL);
 }
 
@@ -90,6 +153,11 @@ static int prte_iof_base_close(void)
  */
 static int prte_iof_base_open(pmix_mca_base_open_flag_t flags)
 {
+    PMIX_CONSTRUCT(&prte_iof_base_jobs, pmix_list_t);
+    PMIX_CONSTRUCT(&prte_iof_base_pulls, pmix_list_t);
+    PMIX_CONSTRUCT(&prte_iof_base_stdin_holds, pmix_list_t);
+    prte_iof_base_nblocked = 0;
+
     /* Open up all available components */
     return pmix_mca_base_framework_components_open(&prte_iof_base_framework, flags);
 }
@@ -163,9 +231,31 @@ static void prte_iof_base_sink_construct(prte_iof_sink_t *ptr)
     ptr->xoff = false;
     ptr->exclusive = false;
     ptr->closed = false;
+    ptr->nbytes = 0;
+    ptr->jbuf = NULL;
+    ptr->credit = prte_iof_base_sink_budget;
+    ptr->returned = 0;
+    ptr->spill_fd = -1;
+    ptr->spill_rd = 0;
+    ptr->spill_wr = 0;
+    ptr->spill_close = false;
 }
 static void prte_iof_base_sink_destruct(prte_iof_sink_t *ptr)
 {
+    if (NULL != ptr->jbuf) {
+        /* whatever is still held goes away with us */
+        ptr->jbuf->buffered -= ptr->nbytes;
+        if (ptr->xoff) {
+            --ptr->jbuf->nblocked;
+            if (0 == --prte_iof_base_nblocked) {
+                prte_iof_base_stdin_release(PMIX_SUCCESS);
+            }
+        }
+        PMIX_RELEASE(ptr->jbuf);
+    }
+    if (0 <= ptr->spill_fd) {
+        close(ptr->spill_fd);
+    }
     if (NULL != ptr->wev) {
         PMIX_OUTPUT_VERBOSE((20, prte_iof_base_framework.framework_output,
                              "%s iof: closing sink for process %s on fd %d",
@@ -189,6 +279,10 @@ static void prte_iof_base_read_event_construct(prte_iof_read_event_t *rev)
     rev->sink = NULL;
     rev->tv.tv_sec = 0;
     rev->tv.tv_usec = 0;
+    rev->splice_fd = -1;
+    rev->splice_pipe[0] = -1;
+    rev->splice_pipe[1] = -1;
+    rev->splice_gen = 0;
 }
 static void prte_iof_base_read_event_destruct(prte_iof_read_event_t *rev)
 {
@@ -208,6 +302,13 @@ static void prte_iof_base_read_event_destruct(prte_iof_read_event_t *rev)
     if (NULL != rev->sink) {
         PMIX_RELEASE(rev->sink);
     }
+    if (0 <= rev->splice_fd) {
+        close(rev->splice_fd);
+    }
+    if (0 <= rev->splice_pipe[0]) {
+        close(rev->splice_pipe[0]);
+        close(rev->splice_pipe[1]);
+    }
     if (NULL != proct) {
         PMIX_RELEASE(proct);
     }
@@ -245,7 +346,26 @@ PMIX_CLASS_INSTANCE(prte_iof_write_event_t, pmix_list_item_t,
                     prte_iof_base_write_event_construct,
                     prte_iof_base_write_event_destruct);
 
-PMIX_CLASS_INSTANCE(prte_iof_write_output_t, pmix_list_item_t, NULL, NULL);
+static void prte_iof_base_write_output_construct(prte_iof_write_output_t *ptr)
+{
+    ptr->numbytes = 0;
+    ptr->charged = 0;
+}
+PMIX_CLASS_INSTANCE(prte_iof_write_output_t, pmix_list_item_t,
+                    prte_iof_base_write_output_construct, NULL);
+
+static void prte_iof_base_job_buffer_construct(prte_iof_job_buffer_t *ptr)
+{
+    PMIX_LOAD_NSPACE(ptr->nspace, NULL);
+    ptr->buffered = 0;
+    ptr->outstanding = 0;
+    ptr->peak = 0;
+    ptr->dropped = 0;
+    ptr->spilled = 0;
+    ptr->nblocked = 0;
+}
+PMIX_CLASS_INSTANCE(prte_iof_job_buffer_t, pmix_list_item_t,
+                    prte_iof_base_job_buffer_construct, NULL);
 
 static void pdcon(prte_iof_deliver_t *p)
 {
@@ -260,3 +380,12 @@ static void pddes(prte_iof_deliver_t *p)
 }
 PMIX_CLASS_INSTANCE(prte_iof_deliver_t, pmix_object_t,
                     pdcon, pddes);
+
+static void plcon(prte_iof_pull_t *p)
+{
+    p->tags = 0;
+    p->origin = PMIX_RANK_INVALID;
+}
+PMIX_CLASS_INSTANCE(prte_iof_pull_t, pmix_list_item_t,
+                    plcon, NULL);
+PMIX_CLASS_INSTANCE(prte_iof_stdin_hold_t, pmix_list_item_t, NULL, NULL);
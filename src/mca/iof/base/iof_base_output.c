@@ -35,9 +35,12 @@
 #    include <unistd.h>
 #endif
 #include <errno.h>
+#include <fcntl.h>
 #include <time.h>
 
+#include "src/util/pmix_os_path.h"
 #include "src/util/pmix_output.h"
+#include "src/util/proc_info.h"
 
 #include "src/mca/errmgr/errmgr.h"
 #include "src/mca/state/state.h"
@@ -47,22 +50,390 @@
 
 #include "src/mca/iof/base/base.h"
 
+prte_iof_job_buffer_t *prte_iof_base_sink_job(prte_iof_sink_t *sink)
+{
+    prte_iof_job_buffer_t *jbuf;
+
+    if (NULL != sink->jbuf) {
+        return sink->jbuf;
+    }
+    PMIX_LIST_FOREACH(jbuf, &prte_iof_base_jobs, prte_iof_job_buffer_t)
+    {
+        if (PMIX_CHECK_NSPACE(jbuf->nspace, sink->name.nspace)) {
+            goto found;
+        }
+    }
+    jbuf = PMIX_NEW(prte_iof_job_buffer_t);
+    PMIX_LOAD_NSPACE(jbuf->nspace, sink->name.nspace);
+    pmix_list_append(&prte_iof_base_jobs, &jbuf->super);
+
+found:
+    PMIX_RETAIN(jbuf);
+    sink->jbuf = jbuf;
+    return jbuf;
+}
+
+void prte_iof_base_job_complete(const pmix_nspace_t nspace)
+{
+    prte_iof_job_buffer_t *jbuf;
+
+    prte_iof_base_pull_job_complete(nspace);
+
+    /* sinks still holding data keep their own reference */
+    PMIX_LIST_FOREACH(jbuf, &prte_iof_base_jobs, prte_iof_job_buffer_t)
+    {
+        if (PMIX_CHECK_NSPACE(jbuf->nspace, nspace)) {
+            pmix_list_remove_item(&prte_iof_base_jobs, &jbuf->super);
+            PMIX_RELEASE(jbuf);
+            return;
+        }
+    }
+}
+
+/* hold off acknowledging a stdin push while any sink is over
+ * budget - the tool waits for it before pushing more. Returns
+ * false if nothing is blocked and the caller should ack now */
+bool prte_iof_base_stdin_hold(pmix_op_cbfunc_t cbfunc, void *cbdata)
+{
+    prte_iof_stdin_hold_t *hold;
+
+    if (0 == prte_iof_base_nblocked || NULL == cbfunc) {
+        return false;
+    }
+    hold = PMIX_NEW(prte_iof_stdin_hold_t);
+    hold->cbfunc = cbfunc;
+    hold->cbdata = cbdata;
+    pmix_list_append(&prte_iof_base_stdin_holds, &hold->super);
+    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                         "%s iof: holding stdin ack - %d sinks over budget",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), prte_iof_base_nblocked));
+    return true;
+}
+
+void prte_iof_base_stdin_release(pmix_status_t status)
+{
+    prte_iof_stdin_hold_t *hold;
+
+    while (NULL != (hold = (prte_iof_stdin_hold_t *)
+                        pmix_list_remove_first(&prte_iof_base_stdin_holds))) {
+        hold->cbfunc(status, hold->cbdata);
+        PMIX_RELEASE(hold);
+    }
+}
+
+static bool over_budget(prte_iof_sink_t *sink, size_t numbytes)
+{
+    return prte_iof_base_sink_budget < sink->nbytes + numbytes
+           || prte_iof_base_job_budget < sink->jbuf->buffered + sink->jbuf->outstanding + numbytes;
+}
+
+static void charge(prte_iof_sink_t *sink, prte_iof_write_output_t *output)
+{
+    prte_iof_job_buffer_t *jbuf = sink->jbuf;
+
+    output->charged = output->numbytes;
+    sink->nbytes += output->charged;
+    jbuf->buffered += output->charged;
+    if (jbuf->peak < jbuf->buffered + jbuf->outstanding) {
+        jbuf->peak = jbuf->buffered + jbuf->outstanding;
+    }
+}
+
+static void set_blocked(prte_iof_sink_t *sink, bool blocked)
+{
+    if (blocked == sink->xoff) {
+        return;
+    }
+    sink->xoff = blocked;
+    if (blocked) {
+        ++sink->jbuf->nblocked;
+        ++prte_iof_base_nblocked;
+    } else {
+        --sink->jbuf->nblocked;
+        if (0 == --prte_iof_base_nblocked) {
+            prte_iof_base_stdin_release(PMIX_SUCCESS);
+        }
+    }
+    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                         "%s iof: sink for %s %s - %lu bytes held, job holds %lu and has "
+                         "%lu outstanding", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                         PRTE_NAME_PRINT(&sink->name), blocked ? "over budget" : "drained",
+                         (unsigned long) sink->nbytes, (unsigned long) sink->jbuf->buffered,
+                         (unsigned long) sink->jbuf->outstanding));
+}
+
+/* the session directory is the natural home of the spill file,
+ * but we may be asked to spill before it exists */
+static int spill_open(prte_iof_sink_t *sink)
+{
+    char *path;
+    int fd;
+
+    if (NULL != prte_process_info.proc_session_dir) {
+        path = pmix_os_path(false, prte_process_info.proc_session_dir, "iof.spill.XXXXXX", NULL);
+    } else {
+        path = strdup("/tmp/prte.iof.spill.XXXXXX");
+    }
+    fd = mkstemp(path);
+    if (0 > fd) {
+        PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                             "%s iof: cannot create spill file %s: %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), path, strerror(errno)));
+        free(path);
+        return PRTE_ERR_FILE_OPEN_FAILURE;
+    }
+    /* nobody else needs to find it */
+    unlink(path);
+    free(path);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    sink->spill_fd = fd;
+    sink->spill_rd = 0;
+    sink->spill_wr = 0;
+    return PRTE_SUCCESS;
+}
+
+/* we can no longer trust the spill file to match our offsets -
+ * whatever it still held is lost, and the next spill starts
+ * a new one */
+static void spill_drop(prte_iof_sink_t *sink)
+{
+    prte_iof_write_output_t *output;
+
+    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                         "%s iof: cannot truncate spill file: %s - dropping %lu bytes",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), strerror(errno),
+                         (unsigned long) (sink->spill_wr - sink->spill_rd)));
+    sink->jbuf->dropped += sink->spill_wr - sink->spill_rd;
+    close(sink->spill_fd);
+    sink->spill_fd = -1;
+    sink->spill_rd = 0;
+    sink->spill_wr = 0;
+    if (sink->spill_close) {
+        sink->spill_close = false;
+        if (NULL != sink->wev) {
+            output = PMIX_NEW(prte_iof_write_output_t);
+            pmix_list_append(&sink->wev->outputs, &output->super);
+        }
+    }
+}
+
+static int spill(prte_iof_sink_t *sink, const unsigned char *data, int numbytes)
+{
+    ssize_t n;
+    int left;
+
+    if (0 > sink->spill_fd && PRTE_SUCCESS != spill_open(sink)) {
+        return PRTE_ERR_FILE_OPEN_FAILURE;
+    }
+    /* the data only counts as spilled once all of it is out */
+    for (left = numbytes; 0 < left; left -= n) {
+        n = pwrite(sink->spill_fd, data + numbytes - left, left,
+                   sink->spill_wr + numbytes - left);
+        if (0 > n) {
+            if (EINTR == errno) {
+                n = 0;
+                continue;
+            }
+            PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                 "%s iof: cannot write spill file: %s",
+                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), strerror(errno)));
+            /* forget whatever part of this made it out */
+            if (0 != ftruncate(sink->spill_fd, sink->spill_wr)) {
+                spill_drop(sink);
+            }
+            return PRTE_ERR_FILE_WRITE_FAILURE;
+        }
+    }
+    sink->spill_wr += numbytes;
+    sink->jbuf->spilled += numbytes;
+    return PRTE_SUCCESS;
+}
+
+/* bring spilled data back while the sink is below half its budget */
+static void unspill(prte_iof_sink_t *sink)
+{
+    prte_iof_write_output_t *output;
+    size_t want;
+    ssize_t n;
+
+    while (sink->spill_rd < sink->spill_wr && sink->nbytes < prte_iof_base_sink_budget / 2) {
+        want = sink->spill_wr - sink->spill_rd;
+        if (PRTE_IOF_BASE_MSG_MAX < want) {
+            want = PRTE_IOF_BASE_MSG_MAX;
+        }
+        output = PMIX_NEW(prte_iof_write_output_t);
+        n = pread(sink->spill_fd, output->data, want, sink->spill_rd);
+        if (0 >= n) {
+            if (0 > n && EINTR == errno) {
+                PMIX_RELEASE(output);
+                continue;
+            }
+            PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                 "%s iof: cannot read spill file - dropping %lu bytes",
+                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                                 (unsigned long) (sink->spill_wr - sink->spill_rd)));
+            sink->jbuf->dropped += sink->spill_wr - sink->spill_rd;
+            PMIX_RELEASE(output);
+            sink->spill_rd = sink->spill_wr;
+            break;
+        }
+        sink->spill_rd += n;
+        output->numbytes = n;
+        charge(sink, output);
+        pmix_list_append(&sink->wev->outputs, &output->super);
+    }
+    if (sink->spill_rd == sink->spill_wr) {
+        if (0 < sink->spill_wr) {
+            if (0 != ftruncate(sink->spill_fd, 0)) {
+                spill_drop(sink);
+            }
+            sink->spill_rd = 0;
+            sink->spill_wr = 0;
+        }
+        if (sink->spill_close) {
+            /* the close can now follow the data */
+            sink->spill_close = false;
+            output = PMIX_NEW(prte_iof_write_output_t);
+            pmix_list_append(&sink->wev->outputs, &output->super);
+        }
+    }
+}
+
+/* a fragment has left the sink - written out, sent on or dropped */
+void prte_iof_base_sink_release(prte_iof_sink_t *sink, prte_iof_write_output_t *output)
+{
+    if (0 == output->charged || NULL == sink->jbuf) {
+        return;
+    }
+    sink->nbytes -= output->charged;
+    sink->jbuf->buffered -= output->charged;
+    sink->returned += output->charged;
+    output->charged = 0;
+    if (0 <= sink->spill_fd && NULL != sink->wev) {
+        unspill(sink);
+    }
+    if (sink->xoff && sink->nbytes <= prte_iof_base_sink_budget / 2
+        && sink->spill_rd == sink->spill_wr) {
+        set_blocked(sink, false);
+    }
+}
+
+/* bytes handed to the daemon hosting a remote sink */
+void prte_iof_base_sink_sent(prte_iof_sink_t *sink, size_t nbytes)
+{
+    prte_iof_job_buffer_t *jbuf = prte_iof_base_sink_job(sink);
+
+    sink->credit -= (nbytes < sink->credit) ? nbytes : sink->credit;
+    jbuf->outstanding += nbytes;
+    if (jbuf->peak < jbuf->buffered + jbuf->outstanding) {
+        jbuf->peak = jbuf->buffered + jbuf->outstanding;
+    }
+}
+
+/* ...and taken off it again */
+void prte_iof_base_sink_credit(prte_iof_sink_t *sink, size_t nbytes)
+{
+    prte_iof_job_buffer_t *jbuf = prte_iof_base_sink_job(sink);
+
+    sink->credit += nbytes;
+    jbuf->outstanding -= (nbytes < jbuf->outstanding) ? nbytes : jbuf->outstanding;
+}
+
+static void drop_oldest(prte_iof_sink_t *sink, size_t numbytes)
+{
+    prte_iof_write_output_t *output;
+
+    while (over_budget(sink, numbytes)) {
+        output = (prte_iof_write_output_t *) pmix_list_get_first(&sink->wev->outputs);
+        if (output == (prte_iof_write_output_t *) pmix_list_get_end(&sink->wev->outputs)
+            || 0 == output->numbytes) {
+            return;
+        }
+        pmix_list_remove_item(&sink->wev->outputs, &output->super);
+        sink->jbuf->dropped += output->charged;
+        prte_iof_base_sink_release(sink, output);
+        PMIX_RELEASE(output);
+    }
+}
+
+/* queue data for a sink, applying the overflow policy if that
+ * takes the sink or its job over budget. Returns
+ * PRTE_ERR_TEMP_OUT_OF_RESOURCE if the data was held beyond the
+ * budget so the caller can stop feeding this sink */
 int prte_iof_base_write_output(const pmix_proc_t *name, prte_iof_tag_t stream,
                                const unsigned char *data, int numbytes,
-                               prte_iof_write_event_t *channel)
+                               prte_iof_sink_t *sink)
 {
     prte_iof_write_output_t *output;
-    int num_buffered;
+    prte_iof_write_event_t *channel;
+    bool over;
     PRTE_HIDE_UNUSED_PARAMS(stream);
 
     PMIX_OUTPUT_VERBOSE(
         (1, prte_iof_base_framework.framework_output,
          "%s write:output setting up to write %d bytes to stdin for %s on fd %d",
          PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), numbytes,
-         PRTE_NAME_PRINT(name), (NULL == channel) ? -1 : channel->fd));
+         PRTE_NAME_PRINT(name), (NULL == sink || NULL == sink->wev) ? -1 : sink->wev->fd));
+
+    if (NULL == sink) {
+        return PRTE_SUCCESS;
+    }
+    if (NULL == sink->wev) {
+        /* nowhere to put it - but the sender can have the room back */
+        sink->returned += numbytes;
+        return PRTE_SUCCESS;
+    }
+    channel = sink->wev;
+    prte_iof_base_sink_job(sink);
 
-    if (NULL == channel) {
-        return 0;
+    if (0 == numbytes) {
+        /* the close has to wait for anything spilled */
+        if (sink->spill_rd < sink->spill_wr) {
+            sink->spill_close = true;
+            return PRTE_SUCCESS;
+        }
+    } else if (sink->spill_rd < sink->spill_wr) {
+        /* keep the data in order behind what is already spilled */
+        if (PRTE_SUCCESS == spill(sink, data, numbytes)) {
+            return PRTE_SUCCESS;
+        }
+        if (sink->spill_rd < sink->spill_wr) {
+            /* older data is still on disk - queueing this in memory
+             * would deliver it first, so it is lost instead */
+            pmix_output(0, "%s iof: cannot spill input for %s - dropping %d bytes",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(name), numbytes);
+            sink->jbuf->dropped += numbytes;
+            sink->returned += numbytes;
+            return PRTE_ERR_TEMP_OUT_OF_RESOURCE;
+        }
+        /* the spill file was dropped with what it held, so
+         * nothing older is pending */
+    }
+
+    over = (0 < numbytes && over_budget(sink, numbytes));
+    if (over) {
+        switch (prte_iof_base_policy) {
+        case PRTE_IOF_POLICY_DROP_OLDEST:
+            drop_oldest(sink, numbytes);
+            if (over_budget(sink, numbytes)) {
+                /* the rest of the job holds the budget - this
+                 * is the oldest data this sink has */
+                sink->jbuf->dropped += numbytes;
+                sink->returned += numbytes;
+                return PRTE_SUCCESS;
+            }
+            over = false;
+            break;
+        case PRTE_IOF_POLICY_SPILL:
+            if (PRTE_SUCCESS == spill(sink, data, numbytes)) {
+                set_blocked(sink, true);
+                return PRTE_SUCCESS;
+            }
+            /* hold it in memory instead */
+            break;
+        default:
+            break;
+        }
     }
 
     /* setup output object */
@@ -77,14 +448,13 @@ int prte_iof_base_write_output(const pmix_proc_t *name, prte_iof_tag_t stream,
         memcpy(output->data, data, numbytes);
     }
     output->numbytes = numbytes;
+    charge(sink, output);
     /* add this data to the write list for this fd */
     pmix_list_append(&channel->outputs, &output->super);
 
-    /* record how big the buffer is */
-    num_buffered = pmix_list_get_size(&channel->outputs);
-
-    /* is the write event issued? */
-    if (!channel->pending) {
+    /* is the write event issued? A remote sink has no fd -
+     * its data waits for credit from the daemon */
+    if (!channel->pending && 0 <= channel->fd) {
         /* issue it */
         PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
                              "%s write:output adding write event",
@@ -92,7 +462,44 @@ int prte_iof_base_write_output(const pmix_proc_t *name, prte_iof_tag_t stream,
         PRTE_IOF_SINK_ACTIVATE(channel);
     }
 
-    return num_buffered;
+    if (over) {
+        set_blocked(sink, true);
+        return PRTE_ERR_TEMP_OUT_OF_RESOURCE;
+    }
+    return PRTE_SUCCESS;
+}
+
+void prte_iof_base_query_occupancy(pmix_info_t *info)
+{
+    prte_iof_job_buffer_t *jbuf;
+    pmix_data_array_t *darray, *stats;
+    pmix_info_t *jobs, *iptr;
+    uint32_t nblocked;
+    size_t n;
+
+    PMIX_DATA_ARRAY_CREATE(darray, pmix_list_get_size(&prte_iof_base_jobs), PMIX_INFO);
+    jobs = (pmix_info_t *) darray->array;
+    n = 0;
+    PMIX_LIST_FOREACH(jbuf, &prte_iof_base_jobs, prte_iof_job_buffer_t)
+    {
+        /* one entry per job, named for it */
+        PMIX_DATA_ARRAY_CREATE(stats, 6, PMIX_INFO);
+        iptr = (pmix_info_t *) stats->array;
+        PMIX_INFO_LOAD(&iptr[0], PRTE_IOF_BUFFERED, &jbuf->buffered, PMIX_SIZE);
+        PMIX_INFO_LOAD(&iptr[1], PRTE_IOF_OUTSTANDING, &jbuf->outstanding, PMIX_SIZE);
+        PMIX_INFO_LOAD(&iptr[2], PRTE_IOF_PEAK, &jbuf->peak, PMIX_SIZE);
+        PMIX_INFO_LOAD(&iptr[3], PRTE_IOF_DROPPED, &jbuf->dropped, PMIX_SIZE);
+        PMIX_INFO_LOAD(&iptr[4], PRTE_IOF_SPILLED, &jbuf->spilled, PMIX_SIZE);
+        nblocked = jbuf->nblocked;
+        PMIX_INFO_LOAD(&iptr[5], PRTE_IOF_BLOCKED, &nblocked, PMIX_UINT32);
+        PMIX_LOAD_KEY(jobs[n].key, jbuf->nspace);
+        jobs[n].value.type = PMIX_DATA_ARRAY;
+        jobs[n].value.data.darray = stats;
+        ++n;
+    }
+    PMIX_LOAD_KEY(info->key, PRTE_IOF_QUERY_OCCUPANCY);
+    info->value.type = PMIX_DATA_ARRAY;
+    info->value.data.darray = darray;
 }
 
 void prte_iof_base_write_handler(int _fd, short event, void *cbdata)
@@ -158,6 +565,7 @@ void prte_iof_base_write_handler(int _fd, short event, void *cbdata)
              */
             goto NEXT_CALL;
         }
+        prte_iof_base_sink_release(sink, output);
         PMIX_RELEASE(output);
 
         total_written += num_written;
@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2021-2022 Nanook Consulting.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * When the output of a job goes to files, the data read from the
+ * pipes of its local procs only passes through the daemon to be
+ * written out again by the PMIx server. With iof_base_splice set,
+ * the daemon opens the files itself and moves the data from the
+ * pipes into them with splice(2), so it never enters user space.
+ * While anything else wants the output - the stdout/err of the
+ * launcher unless the job said nocopy, or a tool that asked for it
+ * on any daemon - the pipe is first duplicated with tee(2) and only
+ * the copy is read and forwarded. The tee starts and stops as tools
+ * come and go. The files are laid out as documented for --output:
+ *
+ *     DIR=dirname     dirname/<job>/rank.<rank>/stdout, stderr
+ *     FILE=filename   filename.<rank>
+ *
+ * with stderr going into the stdout file when the streams are merged.
+ * Output the PMIx server has to annotate (tagged, timestamped, xml)
+ * is not spliced.
+ */
+
+#include "prte_config.h"
+#include "constants.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#ifdef HAVE_SYS_STAT_H
+#    include <sys/stat.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#endif
+
+#include "src/mca/grpcomm/grpcomm.h"
+#include "src/pmix/pmix-internal.h"
+#include "src/rml/rml.h"
+#include "src/runtime/prte_globals.h"
+#include "src/util/attr.h"
+#include "src/util/name_fns.h"
+#include "src/util/pmix_os_dirpath.h"
+#include "src/util/pmix_os_path.h"
+#include "src/util/pmix_output.h"
+#include "src/util/pmix_printf.h"
+
+#include "src/mca/iof/base/base.h"
+
+#if defined(HAVE_SPLICE) && defined(HAVE_TEE)
+#    define PRTE_IOF_HAVE_SPLICE 1
+#else
+#    define PRTE_IOF_HAVE_SPLICE 0
+#endif
+
+/* most a pipe holds by default */
+#define PRTE_IOF_SPLICE_MAX 65536
+
+/* bumped whenever the tool requests change, so the spliced
+ * pipes know to check whether their copy is still wanted */
+uint32_t prte_iof_base_pull_gen = 0;
+
+/* a tool request, on its way to the event base */
+typedef struct {
+    pmix_object_t super;
+    prte_event_t ev;
+    pmix_proc_t *procs;
+    size_t nprocs;
+    prte_iof_tag_t tags;
+    bool stop;
+} prte_iof_pull_caddy_t;
+static void pcdcon(prte_iof_pull_caddy_t *p)
+{
+    p->procs = NULL;
+    p->nprocs = 0;
+    p->tags = 0;
+    p->stop = false;
+}
+static void pcddes(prte_iof_pull_caddy_t *p)
+{
+    if (NULL != p->procs) {
+        PMIX_PROC_FREE(p->procs, p->nprocs);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_iof_pull_caddy_t, pmix_object_t, pcdcon, pcddes);
+
+/* a stop for no procs at all means the tools attached to the
+ * origin daemon have all gone */
+static void pull_update(const pmix_proc_t *procs, size_t nprocs, prte_iof_tag_t tags, bool stop,
+                        pmix_rank_t origin)
+{
+    prte_iof_pull_t *pull, *next;
+    size_t n;
+
+    if (0 == nprocs && stop) {
+        PMIX_LIST_FOREACH_SAFE(pull, next, &prte_iof_base_pulls, prte_iof_pull_t)
+        {
+            if (pull->origin == origin) {
+                pmix_list_remove_item(&prte_iof_base_pulls, &pull->super);
+                PMIX_RELEASE(pull);
+            }
+        }
+    }
+    for (n = 0; n < nprocs; n++) {
+        /* compare exactly - stopping one rank must not
+         * touch a request for the whole job */
+        PMIX_LIST_FOREACH(pull, &prte_iof_base_pulls, prte_iof_pull_t)
+        {
+            if (pull->origin == origin && PMIX_CHECK_NSPACE(pull->name.nspace, procs[n].nspace)
+                && pull->name.rank == procs[n].rank) {
+                break;
+            }
+        }
+        if (stop) {
+            if ((pmix_list_item_t *) pull == pmix_list_get_end(&prte_iof_base_pulls)) {
+                continue;
+            }
+            pull->tags &= ~tags;
+            if (0 == pull->tags) {
+                pmix_list_remove_item(&prte_iof_base_pulls, &pull->super);
+                PMIX_RELEASE(pull);
+            }
+        } else {
+            if ((pmix_list_item_t *) pull == pmix_list_get_end(&prte_iof_base_pulls)) {
+                pull = PMIX_NEW(prte_iof_pull_t);
+                PMIX_XFER_PROCID(&pull->name, &procs[n]);
+                pull->origin = origin;
+                pmix_list_append(&prte_iof_base_pulls, &pull->super);
+            }
+            pull->tags |= tags;
+        }
+    }
+    ++prte_iof_base_pull_gen;
+    PMIX_OUTPUT_VERBOSE((5, prte_iof_base_framework.framework_output,
+                         "%s iof: %s output of %lu procs for a tool - %lu requests held",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), stop ? "stopped" : "started",
+                         (unsigned long) nprocs,
+                         (unsigned long) pmix_list_get_size(&prte_iof_base_pulls)));
+}
+
+static void pull_shift(int sd, short args, void *cbdata)
+{
+    prte_iof_pull_caddy_t *cd = (prte_iof_pull_caddy_t *) cbdata;
+    prte_grpcomm_signature_t sig;
+    pmix_data_buffer_t *buf;
+    prte_iof_tag_t stream = PRTE_IOF_PULL;
+    int rc;
+    PRTE_HIDE_UNUSED_PARAMS(sd, args);
+
+    PMIX_ACQUIRE_OBJECT(cd);
+
+    if (!PRTE_PROC_IS_MASTER) {
+        /* only our own procs' output reaches a tool connected here */
+        pull_update(cd->procs, cd->nprocs, cd->tags, cd->stop, PRTE_PROC_MY_NAME->rank);
+        PMIX_RELEASE(cd);
+        return;
+    }
+
+    /* the output of every daemon's procs comes through us, so they
+     * all have to know - we hear it back with everyone else */
+    PMIX_DATA_BUFFER_CREATE(buf);
+    rc = PMIx_Data_pack(NULL, buf, &stream, 1, PMIX_UINT16);
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, buf, &cd->tags, 1, PMIX_UINT16);
+    }
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, buf, &cd->stop, 1, PMIX_BOOL);
+    }
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, buf, &cd->nprocs, 1, PMIX_SIZE);
+    }
+    if (PMIX_SUCCESS == rc && 0 < cd->nprocs) {
+        rc = PMIx_Data_pack(NULL, buf, cd->procs, cd->nprocs, PMIX_PROC);
+    }
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(buf);
+        PMIX_RELEASE(cd);
+        return;
+    }
+    PMIX_PROC_CREATE(sig.signature, 1);
+    sig.sz = 1;
+    PMIX_LOAD_PROCID(&sig.signature[0], PRTE_PROC_MY_NAME->nspace, PMIX_RANK_WILDCARD);
+    rc = prte_grpcomm.xcast(&sig, PRTE_RML_TAG_IOF_PROXY, buf);
+    if (PRTE_SUCCESS != rc) {
+        PRTE_ERROR_LOG(rc);
+    }
+    PMIX_DATA_BUFFER_RELEASE(buf);
+    PMIX_PROC_FREE(sig.signature, 1);
+    PMIX_RELEASE(cd);
+}
+
+/* called from the PMIx server when a tool starts or stops
+ * pulling the output of some procs */
+void prte_iof_base_pull(const pmix_proc_t procs[], size_t nprocs,
+                        pmix_iof_channel_t channels, bool stop)
+{
+    prte_iof_pull_caddy_t *cd;
+
+    if (0 == nprocs) {
+        return;
+    }
+    cd = PMIX_NEW(prte_iof_pull_caddy_t);
+    PMIX_PROC_CREATE(cd->procs, nprocs);
+    memcpy(cd->procs, procs, nprocs * sizeof(pmix_proc_t));
+    cd->nprocs = nprocs;
+    if (channels & PMIX_FWD_STDOUT_CHANNEL) {
+        cd->tags |= PRTE_IOF_STDOUT;
+    }
+    if (channels & PMIX_FWD_STDERR_CHANNEL) {
+        cd->tags |= PRTE_IOF_STDERR;
+    }
+    if (channels & PMIX_FWD_STDDIAG_CHANNEL) {
+        cd->tags |= PRTE_IOF_STDDIAG;
+    }
+    cd->stop = stop;
+    PMIX_THREADSHIFT(cd, prte_event_base, pull_shift, PRTE_MSG_PRI);
+}
+
+/* called from the PMIx server when the last tool attached
+ * to us has gone - whatever they asked for is dropped */
+void prte_iof_base_pull_purge(void)
+{
+    prte_iof_pull_caddy_t *cd;
+
+    cd = PMIX_NEW(prte_iof_pull_caddy_t);
+    cd->stop = true;
+    PMIX_THREADSHIFT(cd, prte_event_base, pull_shift, PRTE_MSG_PRI);
+}
+
+/* nobody can want the output of a job that is done */
+void prte_iof_base_pull_job_complete(const pmix_nspace_t nspace)
+{
+    prte_iof_pull_t *pull, *next;
+    bool found = false;
+
+    PMIX_LIST_FOREACH_SAFE(pull, next, &prte_iof_base_pulls, prte_iof_pull_t)
+    {
+        if (PMIX_CHECK_NSPACE(pull->name.nspace, nspace)) {
+            pmix_list_remove_item(&prte_iof_base_pulls, &pull->super);
+            PMIX_RELEASE(pull);
+            found = true;
+        }
+    }
+    if (found) {
+        ++prte_iof_base_pull_gen;
+    }
+}
+
+/* a tool request relayed by the HNP - the stream has
+ * already been unpacked */
+void prte_iof_base_pull_recv(pmix_data_buffer_t *buffer)
+{
+    prte_iof_tag_t tags;
+    pmix_proc_t *procs;
+    size_t nprocs;
+    bool stop;
+    int32_t cnt;
+    int rc;
+
+    cnt = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &tags, &cnt, PMIX_UINT16);
+    if (PMIX_SUCCESS == rc) {
+        cnt = 1;
+        rc = PMIx_Data_unpack(NULL, buffer, &stop, &cnt, PMIX_BOOL);
+    }
+    if (PMIX_SUCCESS == rc) {
+        cnt = 1;
+        rc = PMIx_Data_unpack(NULL, buffer, &nprocs, &cnt, PMIX_SIZE);
+    }
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+    /* the HNP relays the requests of the tools attached to it */
+    if (0 == nprocs) {
+        pull_update(NULL, 0, tags, stop, PRTE_PROC_MY_HNP->rank);
+        return;
+    }
+    PMIX_PROC_CREATE(procs, nprocs);
+    cnt = nprocs;
+    rc = PMIx_Data_unpack(NULL, buffer, procs, &cnt, PMIX_PROC);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+    } else {
+        pull_update(procs, nprocs, tags, stop, PRTE_PROC_MY_HNP->rank);
+    }
+    PMIX_PROC_FREE(procs, nprocs);
+}
+
+bool prte_iof_base_splice_job(prte_job_t *jdata)
+{
+#if PRTE_IOF_HAVE_SPLICE
+    prte_attribute_key_t annotate[] = {PRTE_JOB_TAG_OUTPUT, PRTE_JOB_TAG_OUTPUT_DETAILED,
+                                       PRTE_JOB_TAG_OUTPUT_FULLNAME, PRTE_JOB_RANK_OUTPUT,
+                                       PRTE_JOB_TIMESTAMP_OUTPUT, PRTE_JOB_XML_OUTPUT};
+    size_t n;
+
+    if (!prte_iof_base_splice || NULL == jdata) {
+        return false;
+    }
+    if (!prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_FILE, NULL, PMIX_STRING)
+        && !prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_DIRECTORY, NULL, PMIX_STRING)) {
+        return false;
+    }
+    for (n = 0; n < sizeof(annotate) / sizeof(annotate[0]); n++) {
+        if (prte_get_attribute(&jdata->attributes, annotate[n], NULL, PMIX_BOOL)) {
+            return false;
+        }
+    }
+    return true;
+#else
+    PRTE_HIDE_UNUSED_PARAMS(jdata);
+    return false;
+#endif
+}
+
+#if PRTE_IOF_HAVE_SPLICE
+/* does anything besides the output file want this stream? */
+static bool splice_copy(const pmix_proc_t *name, prte_iof_tag_t tag)
+{
+    prte_iof_pull_t *pull;
+    prte_job_t *jdata;
+
+    jdata = prte_get_job_data_object(name->nspace);
+    if (NULL != jdata
+        && !prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_NOCOPY, NULL, PMIX_BOOL)) {
+        return true;
+    }
+    PMIX_LIST_FOREACH(pull, &prte_iof_base_pulls, prte_iof_pull_t)
+    {
+        if (PMIX_CHECK_NSPACE(pull->name.nspace, name->nspace)
+            && PMIX_CHECK_RANK(pull->name.rank, name->rank) && (pull->tags & tag)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* start or stop the tee to match what is wanted now - the copy
+ * pipe is always empty between reads, so it can simply go */
+static void splice_retee(prte_iof_read_event_t *rev)
+{
+    prte_iof_proc_t *proct = (prte_iof_proc_t *) rev->proc;
+    bool copy;
+
+    rev->splice_gen = prte_iof_base_pull_gen;
+    copy = (NULL != proct && splice_copy(&proct->name, rev->tag));
+    if (copy && 0 > rev->splice_pipe[0]) {
+        if (0 != pipe2(rev->splice_pipe, O_CLOEXEC)) {
+            pmix_output(0, "%s iof:splice cannot start copying output of %s: %s",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&proct->name),
+                        strerror(errno));
+            rev->splice_pipe[0] = -1;
+            rev->splice_pipe[1] = -1;
+        }
+    } else if (!copy && 0 <= rev->splice_pipe[0]) {
+        close(rev->splice_pipe[0]);
+        close(rev->splice_pipe[1]);
+        rev->splice_pipe[0] = -1;
+        rev->splice_pipe[1] = -1;
+    }
+}
+
+static int open_output(const char *path)
+{
+    int fd;
+
+    /* splice cannot write to a file opened for append */
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (0 > fd) {
+        pmix_output(0, "%s iof:splice could not open output file %s: %s",
+                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), path, strerror(errno));
+    }
+    return fd;
+}
+
+static int setup_rev(prte_iof_read_event_t *rev, int fd, bool copy)
+{
+    rev->splice_gen = prte_iof_base_pull_gen;
+    if (copy && 0 != pipe2(rev->splice_pipe, O_CLOEXEC)) {
+        rev->splice_pipe[0] = -1;
+        rev->splice_pipe[1] = -1;
+        close(fd);
+        return PRTE_ERR_SYS_LIMITS_PIPES;
+    }
+    rev->splice_fd = fd;
+    return PRTE_SUCCESS;
+}
+#endif
+
+int prte_iof_base_splice_setup(prte_iof_proc_t *proct)
+{
+#if PRTE_IOF_HAVE_SPLICE
+    prte_job_t *jdata;
+    char *dir = NULL, *file = NULL, *path, *tmp;
+    bool merge;
+    int outfd, errfd = -1, rc;
+
+    jdata = prte_get_job_data_object(proct->name.nspace);
+    if (!prte_iof_base_splice_job(jdata)) {
+        return PRTE_SUCCESS;
+    }
+    merge = prte_get_attribute(&jdata->attributes, PRTE_JOB_MERGE_STDERR_STDOUT, NULL, PMIX_BOOL);
+
+    if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_DIRECTORY, (void **) &dir,
+                           PMIX_STRING) && NULL != dir) {
+        pmix_asprintf(&tmp, "rank.%u", proct->name.rank);
+        path = pmix_os_path(false, dir, PRTE_LOCAL_JOBID_PRINT(proct->name.nspace), tmp, NULL);
+        free(tmp);
+        free(dir);
+        if (PMIX_SUCCESS != pmix_os_dirpath_create(path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) {
+            pmix_output(0, "%s iof:splice could not create output directory %s",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), path);
+            free(path);
+            return PRTE_ERR_FILE_OPEN_FAILURE;
+        }
+        tmp = pmix_os_path(false, path, "stdout", NULL);
+        outfd = open_output(tmp);
+        free(tmp);
+        if (0 <= outfd && !merge) {
+            tmp = pmix_os_path(false, path, "stderr", NULL);
+            errfd = open_output(tmp);
+            free(tmp);
+            if (0 > errfd) {
+                close(outfd);
+                outfd = -1;
+            }
+        }
+        free(path);
+    } else if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_FILE, (void **) &file,
+                                  PMIX_STRING) && NULL != file) {
+        pmix_asprintf(&path, "%s.%u", file, proct->name.rank);
+        free(file);
+        outfd = open_output(path);
+        free(path);
+    } else {
+        return PRTE_SUCCESS;
+    }
+    if (0 > outfd) {
+        return PRTE_ERR_FILE_OPEN_FAILURE;
+    }
+    if (0 > errfd) {
+        /* both streams go into the one file - share its offset */
+        errfd = dup(outfd);
+    }
+
+    rc = PRTE_SUCCESS;
+    if (NULL != proct->revstdout) {
+        rc = setup_rev(proct->revstdout, outfd, splice_copy(&proct->name, PRTE_IOF_STDOUT));
+        outfd = -1;
+    }
+    if (PRTE_SUCCESS == rc && NULL != proct->revstderr) {
+        rc = setup_rev(proct->revstderr, errfd, splice_copy(&proct->name, PRTE_IOF_STDERR));
+        errfd = -1;
+    }
+    if (0 <= outfd) {
+        close(outfd);
+    }
+    if (0 <= errfd) {
+        close(errfd);
+    }
+    PMIX_OUTPUT_VERBOSE((5, prte_iof_base_framework.framework_output,
+                         "%s iof:splice output of %s spliced into files%s",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&proct->name),
+                         (NULL != proct->revstdout && 0 <= proct->revstdout->splice_pipe[0])
+                             ? " with a forwarded copy" : ""));
+    return rc;
+#else
+    PRTE_HIDE_UNUSED_PARAMS(proct);
+    return PRTE_SUCCESS;
+#endif
+}
+
+/* move what is available on the pipe into the file. If a copy is to
+ * be forwarded, it is placed in data and its size returned -
+ * otherwise the number of bytes moved is returned. As with read, 0
+ * indicates the proc closed the pipe */
+int32_t prte_iof_base_splice_read(prte_iof_read_event_t *rev, unsigned char *data, size_t size)
+{
+#if PRTE_IOF_HAVE_SPLICE
+    ssize_t n, m, left;
+
+    if (rev->splice_gen != prte_iof_base_pull_gen) {
+        splice_retee(rev);
+    }
+    if (0 > rev->splice_pipe[0]) {
+        return splice(rev->fd, NULL, rev->splice_fd, NULL, PRTE_IOF_SPLICE_MAX,
+                      SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    }
+
+    /* duplicate the data without consuming it, then consume
+     * exactly that much into the buffer to be forwarded */
+    n = tee(rev->fd, rev->splice_pipe[1], size, SPLICE_F_NONBLOCK);
+    if (0 >= n) {
+        return n;
+    }
+    n = read(rev->fd, data, n);
+    for (left = n; 0 < left; left -= m) {
+        m = splice(rev->splice_pipe[0], NULL, rev->splice_fd, NULL, left, SPLICE_F_MOVE);
+        if (0 >= m) {
+            PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                 "%s iof:splice failed to write output file: %s",
+                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), strerror(errno)));
+            /* drain the rest of the copy so the pipes stay in step -
+             * it holds the same bytes already in data */
+            while (0 < left && 0 < (m = read(rev->splice_pipe[0], data + n - left, left))) {
+                left -= m;
+            }
+            break;
+        }
+    }
+    return n;
+#else
+    return read(rev->fd, data, size);
+#endif
+}
@@ -100,6 +100,9 @@ static int init(void)
      */
     PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_IOF_HNP,
                   PRTE_RML_PERSISTENT, prte_iof_hnp_recv, NULL);
+    /* and our own copy of what we xcast to them */
+    PRTE_RML_RECV(PRTE_NAME_WILDCARD, PRTE_RML_TAG_IOF_PROXY,
+                  PRTE_RML_PERSISTENT, prte_iof_hnp_recv_proxy, NULL);
 
     PMIX_CONSTRUCT(&prte_mca_iof_hnp_component.procs, pmix_list_t);
 
@@ -163,6 +166,15 @@ SETUP:
      */
     if (NULL != proct->revstdout &&
         NULL != proct->revstderr) {
+        if (!proct->revstdout->activated && !proct->revstderr->activated) {
+            /* output going to files may bypass us */
+            if (PRTE_SUCCESS != prte_iof_base_splice_setup(proct)) {
+                PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                     "%s iof:hnp cannot splice output of %s",
+                                     PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                                     PRTE_NAME_PRINT(&proct->name)));
+            }
+        }
         if (!proct->revstdout->activated) {
             PRTE_IOF_READ_ACTIVATE(proct->revstdout);
             proct->revstdout->activated = true;
@@ -186,7 +198,7 @@ static int push_stdin(const pmix_proc_t *dst_name, uint8_t *data, size_t sz)
 {
     pmix_proc_t p;
     prte_iof_proc_t *proct;
-    int rc;
+    int rc, ret = PRTE_SUCCESS;
 
     /* don't do this if the dst vpid is invalid */
     if (PMIX_RANK_INVALID == dst_name->rank) {
@@ -230,16 +242,31 @@ static int push_stdin(const pmix_proc_t *dst_name, uint8_t *data, size_t sz)
                  * down the pipe so it forces out any preceding data before
                  * closing the output stream
                  */
-                if (NULL != proct->stdinev->wev) {
-                    if (PRTE_IOF_MAX_INPUT_BUFFERS < prte_iof_base_write_output(&proct->name,
-                                                                                PRTE_IOF_STDIN, data, sz,
-                                                                                proct->stdinev->wev)) {
-                        /* getting too backed up - stop the read event for now if it is still active */
-
-                        PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
-                                             "buffer backed up - holding"));
-                        return PRTE_ERR_OUT_OF_RESOURCE;
-                    }
+                if (PRTE_ERR_TEMP_OUT_OF_RESOURCE
+                    == prte_iof_base_write_output(&proct->name, PRTE_IOF_STDIN, data, sz,
+                                                  proct->stdinev)) {
+                    /* getting too backed up - the data is held for this
+                     * proc alone, the others continue to get theirs */
+                    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                         "%s buffer for %s backed up - holding",
+                                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                                         PRTE_NAME_PRINT(&proct->name)));
+                    ret = PRTE_ERR_TEMP_OUT_OF_RESOURCE;
+                }
+            } else if (prte_iof_base_sink_holding(proct->stdinev)
+                       || proct->stdinev->credit < sz) {
+                /* the daemon has no room for this yet - hold it
+                 * until it returns credit */
+                PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                     "%s holding %d bytes of stdin for %s - daemon %s has credit "
+                                     "for %lu", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (int) sz,
+                                     PRTE_NAME_PRINT(&proct->name),
+                                     PRTE_NAME_PRINT(&proct->stdinev->daemon),
+                                     (unsigned long) proct->stdinev->credit));
+                if (PRTE_ERR_TEMP_OUT_OF_RESOURCE
+                    == prte_iof_base_write_output(&proct->name, PRTE_IOF_STDIN, data, sz,
+                                                  proct->stdinev)) {
+                    ret = PRTE_ERR_TEMP_OUT_OF_RESOURCE;
                 }
             } else {
                 PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
@@ -259,7 +286,9 @@ static int push_stdin(const pmix_proc_t *dst_name, uint8_t *data, size_t sz)
                                                         &proct->stdinev->name,
                                                         PRTE_IOF_STDIN,
                                                         data, sz);
-                if (PRTE_SUCCESS != rc) {
+                if (PRTE_SUCCESS == rc) {
+                    prte_iof_base_sink_sent(proct->stdinev, sz);
+                } else {
                     /* if the addressee is unknown, remove the sink from the list */
                     if (PRTE_ERR_ADDRESSEE_UNKNOWN == rc) {
                         PMIX_RELEASE(proct->stdinev);
@@ -269,7 +298,8 @@ static int push_stdin(const pmix_proc_t *dst_name, uint8_t *data, size_t sz)
         }
     }
 
-    return PRTE_SUCCESS;
+    /* tell the caller if anything is now held past its budget */
+    return ret;
 }
 
 /*
@@ -387,10 +417,12 @@ static void hnp_complete(const prte_job_t *jdata)
             PMIX_RELEASE(proct);
         }
     }
+    prte_iof_base_job_complete(jdata->nspace);
 }
 
 static int finalize(void)
 {
+    PRTE_RML_CANCEL(PRTE_NAME_WILDCARD, PRTE_RML_TAG_IOF_PROXY);
     PMIX_DESTRUCT(&prte_mca_iof_hnp_component.procs);
     return PRTE_SUCCESS;
 }
@@ -421,6 +453,7 @@ static void stdin_write_handler(int fd, short event, void *cbdata)
          * this data as we are aborting
          */
         if (prte_abnormal_term_ordered) {
+            prte_iof_base_sink_release(sink, output);
             PMIX_RELEASE(output);
             continue;
         }
@@ -468,6 +501,7 @@ static void stdin_write_handler(int fd, short event, void *cbdata)
              */
             goto re_enter;
         }
+        prte_iof_base_sink_release(sink, output);
         PMIX_RELEASE(output);
 
         total_written += num_written;
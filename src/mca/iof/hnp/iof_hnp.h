@@ -73,6 +73,8 @@ extern prte_iof_base_module_t prte_iof_hnp_module;
 
 void prte_iof_hnp_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                        prte_rml_tag_t tag, void *cbdata);
+void prte_iof_hnp_recv_proxy(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                             prte_rml_tag_t tag, void *cbdata);
 
 void prte_iof_hnp_read_local_handler(int fd, short event, void *cbdata);
 void prte_iof_hnp_stdin_cb(int fd, short event, void *cbdata);
@@ -82,6 +84,7 @@ int prte_iof_hnp_send_data_to_endpoint(const pmix_proc_t *host,
                                        const pmix_proc_t *target,
                                        prte_iof_tag_t tag,
                                        unsigned char *data, int numbytes);
+void prte_iof_hnp_send_held(prte_iof_proc_t *proct);
 
 END_C_DECLS
 
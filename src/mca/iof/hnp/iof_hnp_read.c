@@ -83,7 +83,11 @@ void prte_iof_hnp_read_local_handler(int fd, short event, void *cbdata)
 
     /* read up to the fragment size */
     memset(data, 0, PRTE_IOF_BASE_MSG_MAX);
-    numbytes = read(fd, data, sizeof(data));
+    if (0 <= rev->splice_fd) {
+        numbytes = prte_iof_base_splice_read(rev, data, sizeof(data));
+    } else {
+        numbytes = read(fd, data, sizeof(data));
+    }
 
     PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
                          "%s read %d bytes from %s of %s",
@@ -112,6 +116,13 @@ void prte_iof_hnp_read_local_handler(int fd, short event, void *cbdata)
         goto CLEAN_RETURN;
     }
 
+    if (0 <= rev->splice_fd && 0 > rev->splice_pipe[0]) {
+        /* it went straight into the output file and is not
+         * to be copied anywhere else */
+        PRTE_IOF_READ_ACTIVATE(rev);
+        return;
+    }
+
    /* this must be output from one of my local procs */
     pchan = 0;
     if (PRTE_IOF_STDOUT & rev->tag) {
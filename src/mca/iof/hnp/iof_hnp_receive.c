@@ -65,11 +65,8 @@ static void lkcbfunc(pmix_status_t status, void *cbdata)
     PMIX_RELEASE(p);
 }
 
-void prte_iof_hnp_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
-                       prte_rml_tag_t tag, void *cbdata)
+static int deliver(pmix_data_buffer_t *buffer, prte_iof_tag_t stream, pmix_proc_t *origin)
 {
-    pmix_proc_t origin;
-    prte_iof_tag_t stream;
     int32_t count, numbytes;
     int rc;
     prte_iof_proc_t *proct;
@@ -77,60 +74,40 @@ void prte_iof_hnp_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buff
     prte_iof_deliver_t *p;
     pmix_status_t prc;
 
-    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
-                         "%s received IOF msg from proc %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                         PRTE_NAME_PRINT(sender)));
-
-    /* unpack the stream first as this may be flow control info */
-    count = 1;
-    rc = PMIx_Data_unpack(NULL, buffer, &stream, &count, PMIX_UINT16);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        goto CLEAN_RETURN;
-    }
-
-    /* get name of the process whose io we are discussing */
-    count = 1;
-    rc = PMIx_Data_unpack(NULL, buffer, &origin, &count, PMIX_PROC);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        goto CLEAN_RETURN;
-    }
-
     PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
                          "%s received IOF cmd for source %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                         PRTE_NAME_PRINT(&origin)));
+                         PRTE_NAME_PRINT(origin)));
 
     /* this must have come from a daemon forwarding output - unpack the data */
     count = 1;
     rc = PMIx_Data_unpack(NULL, buffer, &numbytes, &count, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        goto CLEAN_RETURN;
+        return rc;
     }
     if (0 == numbytes) {
         /* nothing to do - shouldn't have been sent */
-        goto CLEAN_RETURN;
+        return PRTE_SUCCESS;
     }
     p = PMIX_NEW(prte_iof_deliver_t);
-    PMIX_XFER_PROCID(&p->source, &origin);
+    PMIX_XFER_PROCID(&p->source, origin);
     p->bo.bytes = (char*)malloc(numbytes);
     rc = PMIx_Data_unpack(NULL, buffer, p->bo.bytes, &numbytes, PMIX_BYTE);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         PMIX_RELEASE(p);
-        goto CLEAN_RETURN;
+        return rc;
     }
     p->bo.size = numbytes;
 
     PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
                          "%s unpacked %d bytes from remote proc %s",
-                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), numbytes, PRTE_NAME_PRINT(&origin)));
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), numbytes, PRTE_NAME_PRINT(origin)));
 
     /* do we already have this process in our list? */
     PMIX_LIST_FOREACH(proct, &prte_mca_iof_hnp_component.procs, prte_iof_proc_t)
     {
-        if (PMIX_CHECK_PROCID(&proct->name, &origin)) {
+        if (PMIX_CHECK_PROCID(&proct->name, origin)) {
             /* found it */
             goto NSTEP;
         }
@@ -138,7 +115,7 @@ void prte_iof_hnp_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buff
 
     /* if we get here, then we don't yet have this proc in our list */
     proct = PMIX_NEW(prte_iof_proc_t);
-    PMIX_XFER_PROCID(&proct->name, &origin);
+    PMIX_XFER_PROCID(&proct->name, origin);
     pmix_list_append(&prte_mca_iof_hnp_component.procs, &proct->super);
 
 NSTEP:
@@ -158,7 +135,120 @@ NSTEP:
         PMIX_ERROR_LOG(prc);
         PMIX_RELEASE(p);
     }
+    return PRTE_SUCCESS;
+}
+
+void prte_iof_hnp_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                       prte_rml_tag_t tag, void *cbdata)
+{
+    pmix_proc_t origin;
+    prte_iof_tag_t stream;
+    prte_iof_proc_t *proct;
+    int32_t count, nframes, n;
+    size_t credit;
+    int rc;
+
+    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                         "%s received IOF msg from proc %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                         PRTE_NAME_PRINT(sender)));
 
-CLEAN_RETURN:
-    return;
+    /* unpack the stream first as this may be flow control info */
+    count = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &stream, &count, PMIX_UINT16);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+
+    if (PRTE_IOF_CREDIT == stream) {
+        /* a daemon has taken stdin off one of its sinks */
+        count = 1;
+        rc = PMIx_Data_unpack(NULL, buffer, &origin, &count, PMIX_PROC);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            return;
+        }
+        count = 1;
+        rc = PMIx_Data_unpack(NULL, buffer, &credit, &count, PMIX_SIZE);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            return;
+        }
+        PMIX_OUTPUT_VERBOSE((5, prte_iof_base_framework.framework_output,
+                             "%s received credit for %lu bytes to %s from %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (unsigned long) credit,
+                             PRTE_NAME_PRINT(&origin), PRTE_NAME_PRINT(sender)));
+        PMIX_LIST_FOREACH(proct, &prte_mca_iof_hnp_component.procs, prte_iof_proc_t)
+        {
+            if (PMIX_CHECK_PROCID(&proct->name, &origin) && NULL != proct->stdinev) {
+                prte_iof_base_sink_credit(proct->stdinev, credit);
+                prte_iof_hnp_send_held(proct);
+                break;
+            }
+        }
+        return;
+    }
+
+    if (PRTE_IOF_FRAMES == stream) {
+        /* output aggregated by the daemon - each frame carries its
+         * own stream and source */
+        count = 1;
+        rc = PMIx_Data_unpack(NULL, buffer, &nframes, &count, PMIX_INT32);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            return;
+        }
+        PMIX_OUTPUT_VERBOSE((5, prte_iof_base_framework.framework_output,
+                             "%s received %d IOF frames from %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                             nframes, PRTE_NAME_PRINT(sender)));
+        for (n = 0; n < nframes; n++) {
+            count = 1;
+            rc = PMIx_Data_unpack(NULL, buffer, &stream, &count, PMIX_UINT16);
+            if (PMIX_SUCCESS != rc) {
+                PMIX_ERROR_LOG(rc);
+                return;
+            }
+            count = 1;
+            rc = PMIx_Data_unpack(NULL, buffer, &origin, &count, PMIX_PROC);
+            if (PMIX_SUCCESS != rc) {
+                PMIX_ERROR_LOG(rc);
+                return;
+            }
+            if (PRTE_SUCCESS != deliver(buffer, stream, &origin)) {
+                return;
+            }
+        }
+        return;
+    }
+
+    /* get name of the process whose io we are discussing */
+    count = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &origin, &count, PMIX_PROC);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+    deliver(buffer, stream, &origin);
+}
+
+/* we see everything we xcast to the daemons - the stdin is
+ * already written to our own procs, but the tool requests
+ * have to be applied here too */
+void prte_iof_hnp_recv_proxy(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
+                             prte_rml_tag_t tag, void *cbdata)
+{
+    prte_iof_tag_t stream;
+    int32_t count;
+    int rc;
+    PRTE_HIDE_UNUSED_PARAMS(status, sender, tag, cbdata);
+
+    count = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &stream, &count, PMIX_UINT16);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+    if (PRTE_IOF_PULL == stream) {
+        prte_iof_base_pull_recv(buffer);
+    }
 }
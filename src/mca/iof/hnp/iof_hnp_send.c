@@ -117,3 +117,33 @@ int prte_iof_hnp_send_data_to_endpoint(const pmix_proc_t *host,
 
     return PRTE_SUCCESS;
 }
+
+/* send the stdin held for a proc on another node for as long as
+ * its daemon has room for it */
+void prte_iof_hnp_send_held(prte_iof_proc_t *proct)
+{
+    prte_iof_sink_t *sink = proct->stdinev;
+    prte_iof_write_output_t *output;
+    int rc;
+
+    while (NULL != sink && NULL != sink->wev) {
+        output = (prte_iof_write_output_t *) pmix_list_get_first(&sink->wev->outputs);
+        if (output == (prte_iof_write_output_t *) pmix_list_get_end(&sink->wev->outputs)
+            || sink->credit < (size_t) output->numbytes) {
+            return;
+        }
+        pmix_list_remove_item(&sink->wev->outputs, &output->super);
+        rc = prte_iof_hnp_send_data_to_endpoint(&sink->daemon, &sink->name, PRTE_IOF_STDIN,
+                                                (unsigned char *) output->data, output->numbytes);
+        if (PRTE_SUCCESS == rc) {
+            prte_iof_base_sink_sent(sink, output->numbytes);
+        }
+        /* this may bring back data that was spilled */
+        prte_iof_base_sink_release(sink, output);
+        PMIX_RELEASE(output);
+        if (PRTE_ERR_ADDRESSEE_UNKNOWN == rc) {
+            PMIX_RELEASE(proct->stdinev);
+            return;
+        }
+    }
+}
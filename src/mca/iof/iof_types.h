@@ -43,9 +43,11 @@ typedef uint16_t prte_iof_tag_t;
 #define PRTE_IOF_STDALL    0x000f
 #define PRTE_IOF_EXCLUSIVE 0x0100
 
-/* flow control flags */
-#define PRTE_IOF_XON  0x1000
-#define PRTE_IOF_XOFF 0x2000
+/* aggregated output from a daemon */
+#define PRTE_IOF_FRAMES 0x0800
+
+/* flow control - bytes of stdin a daemon has taken off its sinks */
+#define PRTE_IOF_CREDIT 0x1000
 /* tool requests */
 #define PRTE_IOF_PULL  0x4000
 #define PRTE_IOF_CLOSE 0x8000
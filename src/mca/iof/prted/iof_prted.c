@@ -99,7 +99,10 @@ static int init(void)
 
     /* setup the local global variables */
     PMIX_CONSTRUCT(&prte_mca_iof_prted_component.procs, pmix_list_t);
-    prte_mca_iof_prted_component.xoff = false;
+    prte_mca_iof_prted_component.agg = NULL;
+    prte_mca_iof_prted_component.agg_frames = 0;
+    prte_mca_iof_prted_component.agg_bytes = 0;
+    prte_mca_iof_prted_component.agg_armed = false;
 
     return PRTE_SUCCESS;
 }
@@ -165,6 +168,15 @@ SETUP:
      */
     if (NULL != proct->revstdout &&
         NULL != proct->revstderr) {
+        if (!proct->revstdout->activated && !proct->revstderr->activated) {
+            /* output going to files may bypass us */
+            if (PRTE_SUCCESS != prte_iof_base_splice_setup(proct)) {
+                PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                     "%s iof:prted cannot splice output of %s",
+                                     PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                                     PRTE_NAME_PRINT(&proct->name)));
+            }
+        }
         if (!proct->revstdout->activated) {
             PRTE_IOF_READ_ACTIVATE(proct->revstdout);
             proct->revstdout->activated = true;
@@ -285,10 +297,21 @@ static void prted_complete(const prte_job_t *jdata)
             PMIX_RELEASE(proct);
         }
     }
+    prte_iof_base_job_complete(jdata->nspace);
 }
 
 static int finalize(void)
 {
+    /* anything still held belongs to procs that never completed */
+    if (prte_mca_iof_prted_component.agg_armed) {
+        prte_event_evtimer_del(&prte_mca_iof_prted_component.agg_ev);
+        prte_mca_iof_prted_component.agg_armed = false;
+    }
+    if (NULL != prte_mca_iof_prted_component.agg) {
+        PMIX_DATA_BUFFER_RELEASE(prte_mca_iof_prted_component.agg);
+    }
+    prte_iof_prted_report();
+
     PMIX_LIST_DESTRUCT(&prte_mca_iof_prted_component.procs);
 
     /* Cancel the RML receive */
@@ -343,18 +366,21 @@ static void stdin_write_handler(int _fd, short event, void *cbdata)
             /* otherwise, something bad happened so all we can do is declare an
              * error and abort
              */
+            prte_iof_base_sink_release(sink, output);
             PMIX_RELEASE(output);
             PMIX_OUTPUT_VERBOSE(
                 (20, prte_iof_base_framework.framework_output,
                  "%s iof:prted closing fd %d on write event due to negative bytes written",
                  PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), wev->fd));
+            /* whatever is left will never be written - give the
+             * HNP back its room so nothing is held for this proc */
+            while (NULL != (item = pmix_list_remove_first(&wev->outputs))) {
+                prte_iof_base_sink_release(sink, (prte_iof_write_output_t *) item);
+                PMIX_RELEASE(item);
+            }
             PMIX_RELEASE(wev);
             sink->wev = NULL;
-            /* tell the HNP to stop sending us stuff */
-            if (!prte_mca_iof_prted_component.xoff) {
-                prte_mca_iof_prted_component.xoff = true;
-                prte_iof_prted_send_xonxoff(PRTE_IOF_XOFF);
-            }
+            prte_iof_prted_return_credit(sink, true);
             return;
         } else if (num_written < output->numbytes) {
             PMIX_OUTPUT_VERBOSE(
@@ -371,24 +397,12 @@ static void stdin_write_handler(int _fd, short event, void *cbdata)
             PRTE_IOF_SINK_ACTIVATE(wev);
             goto CHECK;
         }
+        prte_iof_base_sink_release(sink, output);
         PMIX_RELEASE(output);
     }
 
 CHECK:
-    if (prte_mca_iof_prted_component.xoff) {
-        /* if we have told the HNP to stop reading stdin, see if
-         * the proc has absorbed enough to justify restart
-         *
-         * RHC: Note that when multiple procs want stdin, we
-         * can get into a fight between a proc turnin stdin
-         * back "on" and other procs turning it "off". There
-         * is no clear way to resolve this as different procs
-         * may take input at different rates.
-         */
-        if (pmix_list_get_size(&wev->outputs) < PRTE_IOF_MAX_INPUT_BUFFERS) {
-            /* restart the read */
-            prte_mca_iof_prted_component.xoff = false;
-            prte_iof_prted_send_xonxoff(PRTE_IOF_XON);
-        }
-    }
+    /* let the HNP know how much room this proc has made - in
+     * batches, unless it has caught up */
+    prte_iof_prted_return_credit(sink, pmix_list_is_empty(&wev->outputs));
 }
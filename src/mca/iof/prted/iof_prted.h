@@ -53,6 +53,7 @@
 #include "prte_config.h"
 
 #include "src/class/pmix_list.h"
+#include "src/event/event-internal.h"
 
 #include "src/mca/iof/iof.h"
 #include "src/rml/rml_types.h"
@@ -65,7 +66,24 @@ BEGIN_C_DECLS
 struct prte_mca_iof_prted_component_t {
     prte_iof_base_component_t super;
     pmix_list_t procs;
-    bool xoff;
+    /* output aggregation - fragments from all local procs are
+     * held for up to agg_window usecs or agg_size bytes and
+     * sent to the HNP as one framed message */
+    int agg_window;
+    int agg_size;
+    pmix_data_buffer_t *agg;
+    int32_t agg_frames;
+    size_t agg_bytes;
+    struct timeval agg_first;
+    prte_event_t agg_ev;
+    bool agg_armed;
+    /* instrumentation */
+    uint64_t stat_frames;
+    uint64_t stat_bytes;
+    uint64_t stat_flushes;
+    double stat_latency;
+    double stat_max_latency;
+    struct timeval stat_start;
 };
 typedef struct prte_mca_iof_prted_component_t prte_mca_iof_prted_component_t;
 
@@ -76,7 +94,9 @@ void prte_iof_prted_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *bu
                          prte_rml_tag_t tag, void *cbdata);
 
 void prte_iof_prted_read_handler(int fd, short event, void *data);
-void prte_iof_prted_send_xonxoff(prte_iof_tag_t tag);
+void prte_iof_prted_return_credit(prte_iof_sink_t *sink, bool force);
+void prte_iof_prted_flush(void);
+void prte_iof_prted_report(void);
 
 END_C_DECLS
 
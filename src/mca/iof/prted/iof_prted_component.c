@@ -30,6 +30,7 @@
 
 #include "src/util/proc_info.h"
 
+#include "src/mca/iof/base/base.h"
 #include "iof_prted.h"
 
 /*
@@ -38,6 +39,7 @@
 static int prte_iof_prted_open(void);
 static int prte_iof_prted_close(void);
 static int prte_iof_prted_query(pmix_mca_base_module_t **module, int *priority);
+static int prte_iof_prted_register(void);
 
 /*
  * Public string showing the iof prted component version number
@@ -59,9 +61,37 @@ prte_mca_iof_prted_component_t prte_mca_iof_prted_component = {
         .pmix_mca_open_component = prte_iof_prted_open,
         .pmix_mca_close_component = prte_iof_prted_close,
         .pmix_mca_query_component = prte_iof_prted_query,
+        .pmix_mca_register_component_params = prte_iof_prted_register,
     }
 };
 
+static int prte_iof_prted_register(void)
+{
+    pmix_mca_base_component_t *c = &prte_mca_iof_prted_component.super;
+
+    prte_mca_iof_prted_component.agg_window = 0;
+    (void) pmix_mca_base_component_var_register(c, "aggregate_window",
+                                                "Time (in usecs) to hold output from local procs so that "
+                                                "it can be sent to the HNP in a single message (default: 0, "
+                                                "send each fragment as it is read)",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &prte_mca_iof_prted_component.agg_window);
+    if (0 > prte_mca_iof_prted_component.agg_window) {
+        prte_mca_iof_prted_component.agg_window = 0;
+    }
+
+    prte_mca_iof_prted_component.agg_size = 65536;
+    (void) pmix_mca_base_component_var_register(c, "aggregate_size",
+                                                "Number of bytes of held output that triggers an immediate "
+                                                "send to the HNP when aggregating output (default: 65536)",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &prte_mca_iof_prted_component.agg_size);
+    if (0 >= prte_mca_iof_prted_component.agg_size) {
+        prte_mca_iof_prted_component.agg_size = PRTE_IOF_BASE_MSG_MAX;
+    }
+    return PRTE_SUCCESS;
+}
+
 /**
  * component open/close/init function
  */
@@ -25,10 +25,12 @@
 #include "constants.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #endif /* HAVE_UNISTD_H */
 #include <string.h>
+#include <sys/time.h>
 
 #include "src/pmix/pmix-internal.h"
 
@@ -57,6 +59,141 @@ static void lkcbfunc(pmix_status_t status, void *cbdata)
     PMIX_RELEASE(p);
 }
 
+static double elapsed(struct timeval *start)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    return (double) (now.tv_sec - start->tv_sec) + 1e-6 * (double) (now.tv_usec - start->tv_usec);
+}
+
+/* send everything held to the HNP as one message: the FRAMES
+ * stream tag and the number of frames, followed by the frames -
+ * each laid out as a regular IOF message would be */
+void prte_iof_prted_flush(void)
+{
+    prte_mca_iof_prted_component_t *c = &prte_mca_iof_prted_component;
+    pmix_data_buffer_t *buf;
+    prte_iof_tag_t stream = PRTE_IOF_FRAMES;
+    double latency;
+    int rc;
+
+    if (c->agg_armed) {
+        prte_event_evtimer_del(&c->agg_ev);
+        c->agg_armed = false;
+    }
+    if (NULL == c->agg || 0 == c->agg_frames) {
+        return;
+    }
+
+    PMIX_DATA_BUFFER_CREATE(buf);
+    rc = PMIx_Data_pack(NULL, buf, &stream, 1, PMIX_UINT16);
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, buf, &c->agg_frames, 1, PMIX_INT32);
+    }
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_copy_payload(buf, c->agg);
+    }
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(buf);
+    } else {
+        latency = elapsed(&c->agg_first);
+        ++c->stat_flushes;
+        c->stat_latency += latency;
+        if (latency > c->stat_max_latency) {
+            c->stat_max_latency = latency;
+        }
+        PMIX_OUTPUT_VERBOSE((5, prte_iof_base_framework.framework_output,
+                             "%s iof:prted flushing %d frames (%lu bytes) to HNP after %.1f usec",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), c->agg_frames,
+                             (unsigned long) c->agg_bytes, 1e6 * latency));
+        PRTE_RML_SEND(rc, PRTE_PROC_MY_HNP->rank, buf, PRTE_RML_TAG_IOF_HNP);
+        if (PRTE_SUCCESS != rc) {
+            PRTE_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
+        }
+    }
+    PMIX_DATA_BUFFER_RELEASE(c->agg);
+    c->agg_frames = 0;
+    c->agg_bytes = 0;
+}
+
+static void flush_timeout(int fd, short event, void *cbdata)
+{
+    PRTE_HIDE_UNUSED_PARAMS(fd, event, cbdata);
+
+    prte_mca_iof_prted_component.agg_armed = false;
+    prte_iof_prted_flush();
+}
+
+static int aggregate(prte_iof_tag_t tag, pmix_proc_t *name, unsigned char *data, int32_t numbytes)
+{
+    prte_mca_iof_prted_component_t *c = &prte_mca_iof_prted_component;
+    struct timeval tv;
+    int rc;
+
+    if (NULL == c->agg) {
+        PMIX_DATA_BUFFER_CREATE(c->agg);
+        gettimeofday(&c->agg_first, NULL);
+    }
+    if (0 == c->stat_frames) {
+        gettimeofday(&c->stat_start, NULL);
+    }
+    rc = PMIx_Data_pack(NULL, c->agg, &tag, 1, PMIX_UINT16);
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, c->agg, name, 1, PMIX_PROC);
+    }
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, c->agg, &numbytes, 1, PMIX_INT32);
+    }
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, c->agg, data, numbytes, PMIX_BYTE);
+    }
+    if (PMIX_SUCCESS != rc) {
+        /* the frames already held may be damaged - drop them */
+        PMIX_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(c->agg);
+        c->agg_frames = 0;
+        c->agg_bytes = 0;
+        return rc;
+    }
+    ++c->agg_frames;
+    c->agg_bytes += numbytes;
+    ++c->stat_frames;
+    c->stat_bytes += numbytes;
+
+    if (c->agg_bytes >= (size_t) c->agg_size) {
+        prte_iof_prted_flush();
+    } else if (!c->agg_armed) {
+        prte_event_evtimer_set(prte_event_base, &c->agg_ev, flush_timeout, NULL);
+        tv.tv_sec = c->agg_window / 1000000;
+        tv.tv_usec = c->agg_window % 1000000;
+        prte_event_evtimer_add(&c->agg_ev, &tv);
+        c->agg_armed = true;
+    }
+    return PRTE_SUCCESS;
+}
+
+void prte_iof_prted_report(void)
+{
+    prte_mca_iof_prted_component_t *c = &prte_mca_iof_prted_component;
+    double span;
+
+    if (0 == c->stat_frames) {
+        return;
+    }
+    span = elapsed(&c->stat_start);
+    pmix_output_verbose(1, prte_iof_base_framework.framework_output,
+                        "%s iof:prted aggregated %" PRIu64 " fragments (%.1f/sec) and %" PRIu64
+                        " bytes into %" PRIu64 " messages - flush latency avg %.1f usec max %.1f usec",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), c->stat_frames,
+                        (0.0 < span) ? (double) c->stat_frames / span : 0.0, c->stat_bytes,
+                        c->stat_flushes,
+                        (0 < c->stat_flushes) ? 1e6 * c->stat_latency / (double) c->stat_flushes : 0.0,
+                        1e6 * c->stat_max_latency);
+}
+
 void prte_iof_prted_read_handler(int fd, short event, void *cbdata)
 {
     prte_iof_read_event_t *rev = (prte_iof_read_event_t *) cbdata;
@@ -77,7 +214,11 @@ void prte_iof_prted_read_handler(int fd, short event, void *cbdata)
     fd = rev->fd;
 
     /* read up to the fragment size */
-    numbytes = read(fd, data, sizeof(data));
+    if (0 <= rev->splice_fd) {
+        numbytes = prte_iof_base_splice_read(rev, data, sizeof(data));
+    } else {
+        numbytes = read(fd, data, sizeof(data));
+    }
 
     PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
                          "%s read %d bytes from %s of %s",
@@ -105,6 +246,13 @@ void prte_iof_prted_read_handler(int fd, short event, void *cbdata)
         goto CLEAN_RETURN;
     }
 
+    if (0 <= rev->splice_fd && 0 > rev->splice_pipe[0]) {
+        /* it went straight into the output file and is not
+         * to be copied anywhere else */
+        PRTE_IOF_READ_ACTIVATE(rev);
+        return;
+    }
+
     /* give the PMIx lib a chance to output it if requested */
     pchan = 0;
     if (PRTE_IOF_STDOUT & rev->tag) {
@@ -128,6 +276,13 @@ void prte_iof_prted_read_handler(int fd, short event, void *cbdata)
         PMIX_RELEASE(p);
     }
 
+    if (0 < prte_mca_iof_prted_component.agg_window) {
+        /* hold it for the next flush */
+        aggregate(rev->tag, &proct->name, data, numbytes);
+        PRTE_IOF_READ_ACTIVATE(rev);
+        return;
+    }
+
     /* prep the buffer */
     PMIX_DATA_BUFFER_CREATE(buf);
 
@@ -192,6 +347,9 @@ CLEAN_RETURN:
     }
     /* check to see if they are all done */
     if (NULL == proct->revstdout && NULL == proct->revstderr) {
+        /* the HNP must see any output still held before it
+         * learns that this proc's iof is complete */
+        prte_iof_prted_flush();
         /* this proc's iof is complete */
         PRTE_ACTIVATE_PROC_STATE(&proct->name, PRTE_PROC_STATE_IOF_COMPLETE);
     }
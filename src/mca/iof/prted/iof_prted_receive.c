@@ -44,15 +44,24 @@
 
 #include "iof_prted.h"
 
-void prte_iof_prted_send_xonxoff(prte_iof_tag_t tag)
+/* tell the HNP how many bytes of stdin for this sink have been
+ * written out (or dropped) since we last told it, so it can send
+ * that much more. Credit goes back in batches of a quarter of the
+ * budget unless forced */
+void prte_iof_prted_return_credit(prte_iof_sink_t *sink, bool force)
 {
     pmix_data_buffer_t *buf;
+    prte_iof_tag_t tag = PRTE_IOF_CREDIT;
     int rc;
 
+    if (0 == sink->returned || (!force && sink->returned < prte_iof_base_sink_budget / 4)) {
+        return;
+    }
+
     PMIX_DATA_BUFFER_CREATE(buf);
 
     /* pack the tag - we do this first so that flow control messages can
-     * consist solely of the tag
+     * be told apart from forwarded output
      */
     rc = PMIx_Data_pack(NULL, buf, &tag, 1, PMIX_UINT16);
     if (PMIX_SUCCESS != rc) {
@@ -60,17 +69,32 @@ void prte_iof_prted_send_xonxoff(prte_iof_tag_t tag)
         PMIX_DATA_BUFFER_RELEASE(buf);
         return;
     }
+    rc = PMIx_Data_pack(NULL, buf, &sink->name, 1, PMIX_PROC);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(buf);
+        return;
+    }
+    rc = PMIx_Data_pack(NULL, buf, &sink->returned, 1, PMIX_SIZE);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(buf);
+        return;
+    }
 
-    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output, "%s sending %s",
-                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                         (PRTE_IOF_XON == tag) ? "xon" : "xoff"));
+    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                         "%s returning credit for %lu bytes to %s",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (unsigned long) sink->returned,
+                         PRTE_NAME_PRINT(&sink->name)));
 
     /* send the buffer to the HNP */
     PRTE_RML_SEND(rc, PRTE_PROC_MY_HNP->rank, buf, PRTE_RML_TAG_IOF_HNP);
     if (PRTE_SUCCESS != rc) {
         PRTE_ERROR_LOG(rc);
         PMIX_DATA_BUFFER_RELEASE(buf);
+        return;
     }
+    sink->returned = 0;
 }
 
 /*
@@ -80,6 +104,9 @@ void prte_iof_prted_send_xonxoff(prte_iof_tag_t tag)
  *     procs "pull'd" a copy
  *
  * (b) flow control messages
+ *
+ * (c) the streams a tool has started or stopped pulling,
+ *     relayed by the HNP
  */
 void prte_iof_prted_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                          prte_rml_tag_t tag, void *cbdata)
@@ -99,6 +126,11 @@ void prte_iof_prted_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *bu
         return;
     }
 
+    if (PRTE_IOF_PULL == stream) {
+        prte_iof_base_pull_recv(buffer);
+        return;
+    }
+
     /* if this isn't stdin, then we have an error */
     if (PRTE_IOF_STDIN != stream) {
         PRTE_ERROR_LOG(PRTE_ERR_COMM_FAILURE);
@@ -144,17 +176,19 @@ void prte_iof_prted_recv(int status, pmix_proc_t *sender, pmix_data_buffer_t *bu
                  * down the pipe so it forces out any preceding data before
                  * closing the output stream
                  */
-                if (PRTE_IOF_MAX_INPUT_BUFFERS < prte_iof_base_write_output(&target, stream, data,
-                                                                            numbytes,
-                                                                            proct->stdinev->wev)) {
-                    /* getting too backed up - tell the HNP to hold off any more input if we
-                     * haven't already told it
-                     */
-                    if (!prte_mca_iof_prted_component.xoff) {
-                        prte_mca_iof_prted_component.xoff = true;
-                        prte_iof_prted_send_xonxoff(PRTE_IOF_XOFF);
-                    }
+                if (PRTE_ERR_TEMP_OUT_OF_RESOURCE
+                    == prte_iof_base_write_output(&target, stream, data, numbytes,
+                                                  proct->stdinev)) {
+                    /* the HNP sends no more than our credit, so only
+                     * input sent to all procs gets here - it is held
+                     * for this proc alone */
+                    PMIX_OUTPUT_VERBOSE((1, prte_iof_base_framework.framework_output,
+                                         "%s stdin for %s backed up - holding",
+                                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                                         PRTE_NAME_PRINT(&proct->name)));
                 }
+                /* anything dropped or discarded can be credited now */
+                prte_iof_prted_return_credit(proct->stdinev, false);
             }
         }
     }
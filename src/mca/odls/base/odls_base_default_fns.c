@@ -914,6 +914,85 @@ static int compute_num_procs_alive(pmix_nspace_t job)
     return num_procs_alive;
 }
 
+static void env_put(prte_odls_env_t *base, char *entry, char **env, size_t *n)
+{
+    char *eq = strchr(entry, '=');
+    void *slot;
+
+    if (NULL == eq) {
+        /* nothing can replace it, so it needs no index */
+        env[(*n)++] = entry;
+        return;
+    }
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&base->index, entry, eq - entry, &slot)) {
+        /* same semantics as pmix_setenv with overwrite */
+        free(env[(uintptr_t) slot - 1]);
+        env[(uintptr_t) slot - 1] = entry;
+        return;
+    }
+    env[*n] = entry;
+    ++(*n);
+    pmix_hash_table_set_value_ptr(&base->index, entry, eq - entry, (void *) (uintptr_t) *n);
+}
+
+/* merge the launch environment and the app's environment once, so
+ * that each proc of the app only needs its own entries added */
+prte_odls_env_t *prte_odls_base_build_env(prte_app_context_t *app)
+{
+    prte_odls_env_t *base;
+    size_t n, nlaunch, napp;
+
+    nlaunch = pmix_argv_count(prte_launch_environ);
+    napp = pmix_argv_count(app->env);
+    for (n = 0; n < napp; n++) {
+        if (NULL == strchr(app->env[n], '=')) {
+            PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+            return NULL;
+        }
+    }
+
+    base = PMIX_NEW(prte_odls_env_t);
+    base->env = (char **) calloc(nlaunch + napp + 1, sizeof(char *));
+    if (NULL == base->env) {
+        PMIX_RELEASE(base);
+        return NULL;
+    }
+    pmix_hash_table_init(&base->index, 2 * (nlaunch + napp) + 1);
+    for (n = 0; n < nlaunch; n++) {
+        env_put(base, strdup(prte_launch_environ[n]), base->env, &base->nenv);
+    }
+    for (n = 0; n < napp; n++) {
+        env_put(base, strdup(app->env[n]), base->env, &base->nenv);
+    }
+    return base;
+}
+
+char **prte_odls_base_assemble_env(prte_odls_env_t *base, char **delta)
+{
+    char **env, *eq;
+    size_t n, ndelta, nenv;
+    void *slot;
+
+    ndelta = pmix_argv_count(delta);
+    env = (char **) malloc((base->nenv + ndelta + 1) * sizeof(char *));
+    if (NULL == env) {
+        return NULL;
+    }
+    memcpy(env, base->env, base->nenv * sizeof(char *));
+    nenv = base->nenv;
+    for (n = 0; n < ndelta; n++) {
+        eq = strchr(delta[n], '=');
+        if (NULL != eq
+            && PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&base->index, delta[n], eq - delta[n], &slot)) {
+            env[(uintptr_t) slot - 1] = delta[n];
+        } else {
+            env[nenv++] = delta[n];
+        }
+    }
+    env[nenv] = NULL;
+    return env;
+}
+
 void prte_odls_base_spawn_proc(int fd, short sd, void *cbdata)
 {
     prte_odls_spawn_caddy_t *cd = (prte_odls_spawn_caddy_t *) cbdata;
@@ -932,27 +1011,14 @@ void prte_odls_base_spawn_proc(int fd, short sd, void *cbdata)
 
     PMIX_ACQUIRE_OBJECT(cd);
 
-    /* thread-protect common values */
-    cd->env = pmix_argv_copy(prte_launch_environ);
-    if (NULL != app->env) {
-        for (i = 0; NULL != app->env[i]; i++) {
-            /* find the '=' sign.
-             * strdup the env string to a tmp variable,
-             * since it is shared among apps.
-             */
-            char *tmp = strdup(app->env[i]);
-            ptr = strchr(tmp, '=');
-            if (NULL == ptr) {
-                PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
-                rc = PRTE_ERR_BAD_PARAM;
-                state = PRTE_PROC_STATE_FAILED_TO_LAUNCH;
-                free(tmp);
-                goto errorout;
-            }
-            *ptr = '\0';
-            ++ptr;
-            pmix_setenv(tmp, ptr, true, &cd->env);
-            free(tmp);
+    /* the launch and app environments are shared by all procs of
+     * the app - only the per-proc entries are added here */
+    if (NULL == cd->baseenv) {
+        cd->baseenv = prte_odls_base_build_env(app);
+        if (NULL == cd->baseenv) {
+            rc = PRTE_ERR_BAD_PARAM;
+            state = PRTE_PROC_STATE_FAILED_TO_LAUNCH;
+            goto errorout;
         }
     }
 
@@ -964,12 +1030,18 @@ void prte_odls_base_spawn_proc(int fd, short sd, void *cbdata)
 
     /* setup the pmix environment */
     PMIX_LOAD_PROCID(&pproc, child->job->nspace, child->name.rank);
-    if (PMIX_SUCCESS != (ret = PMIx_server_setup_fork(&pproc, &cd->env))) {
+    if (PMIX_SUCCESS != (ret = PMIx_server_setup_fork(&pproc, &cd->delta))) {
         PMIX_ERROR_LOG(ret);
         rc = PRTE_ERROR;
         state = PRTE_PROC_STATE_FAILED_TO_LAUNCH;
         goto errorout;
     }
+    cd->env = prte_odls_base_assemble_env(cd->baseenv, cd->delta);
+    if (NULL == cd->env) {
+        rc = PRTE_ERR_OUT_OF_RESOURCE;
+        state = PRTE_PROC_STATE_FAILED_TO_LAUNCH;
+        goto errorout;
+    }
 
     /* if we are not forwarding output for this job, then
      * flag iof as complete
@@ -1082,6 +1154,8 @@ void prte_odls_base_spawn_proc(int fd, short sd, void *cbdata)
         state = PRTE_PROC_STATE_FAILED_TO_START;
         goto errorout;
     }
+    /* let the wait system know the pid */
+    prte_wait_cb_started(child);
     if (PRTE_PROC_IS_MASTER) {
         /* locally store the pid */
         pidval.type = PMIX_PID;
@@ -1120,6 +1194,7 @@ void prte_odls_base_default_launch_local(int fd, short sd, void *cbdata)
     prte_odls_spawn_caddy_t *cd;
     prte_event_base_t *evb;
     prte_schizo_base_module_t *schizo;
+    prte_odls_env_t *baseenv = NULL;
 
     PRTE_HIDE_UNUSED_PARAMS(fd, sd);
 
@@ -1337,6 +1412,10 @@ void prte_odls_base_default_launch_local(int fd, short sd, void *cbdata)
             goto GETOUT;
         }
 
+        /* merge the environment shared by the procs of this app - if
+         * this fails, each proc will report it when spawned */
+        baseenv = prte_odls_base_build_env(app);
+
         /* okay, now let's launch all the local procs for this app using the provided fork_local fn
          */
         for (idx = 0; idx < prte_local_children->size; idx++) {
@@ -1408,6 +1487,10 @@ void prte_odls_base_default_launch_local(int fd, short sd, void *cbdata)
             cd->child = child;
             cd->fork_local = fork_local;
             cd->index_argv = index_argv;
+            if (NULL != baseenv) {
+                PMIX_RETAIN(baseenv);
+                cd->baseenv = baseenv;
+            }
             /* setup any IOF */
             cd->opts.usepty = PRTE_ENABLE_PTY_SUPPORT;
 
@@ -1443,9 +1526,16 @@ void prte_odls_base_default_launch_local(int fd, short sd, void *cbdata)
             prte_event_set_priority(&cd->ev, PRTE_MSG_PRI);
             prte_event_active(&cd->ev, PRTE_EV_WRITE, 1);
         }
+        if (NULL != baseenv) {
+            PMIX_RELEASE(baseenv);
+            baseenv = NULL;
+        }
     }
 
 GETOUT:
+    if (NULL != baseenv) {
+        PMIX_RELEASE(baseenv);
+    }
 
 ERROR_OUT:
     /* ensure we reset our working directory back to our default location  */
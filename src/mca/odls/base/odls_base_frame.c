@@ -340,6 +340,8 @@ static void sccon(prte_odls_spawn_caddy_t *p)
     p->wdir = NULL;
     p->argv = NULL;
     p->env = NULL;
+    p->baseenv = NULL;
+    p->delta = NULL;
 }
 static void scdes(prte_odls_spawn_caddy_t *p)
 {
@@ -352,8 +354,32 @@ static void scdes(prte_odls_spawn_caddy_t *p)
     if (NULL != p->argv) {
         pmix_argv_free(p->argv);
     }
-    if (NULL != p->env) {
+    if (NULL != p->baseenv) {
+        /* the strings belong to the base and the delta */
+        if (NULL != p->env) {
+            free(p->env);
+        }
+        PMIX_RELEASE(p->baseenv);
+    } else if (NULL != p->env) {
         pmix_argv_free(p->env);
     }
+    if (NULL != p->delta) {
+        pmix_argv_free(p->delta);
+    }
 }
 PMIX_CLASS_INSTANCE(prte_odls_spawn_caddy_t, pmix_object_t, sccon, scdes);
+
+static void envcon(prte_odls_env_t *p)
+{
+    p->env = NULL;
+    p->nenv = 0;
+    PMIX_CONSTRUCT(&p->index, pmix_hash_table_t);
+}
+static void envdes(prte_odls_env_t *p)
+{
+    if (NULL != p->env) {
+        pmix_argv_free(p->env);
+    }
+    PMIX_DESTRUCT(&p->index);
+}
+PMIX_CLASS_INSTANCE(prte_odls_env_t, pmix_object_t, envcon, envdes);
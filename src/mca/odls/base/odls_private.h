@@ -36,6 +36,7 @@
 #include "types.h"
 
 #include "src/class/pmix_bitmap.h"
+#include "src/class/pmix_hash_table.h"
 #include "src/class/pmix_list.h"
 #include "src/class/pmix_pointer_array.h"
 #include "src/mca/iof/base/iof_base_setup.h"
@@ -84,6 +85,23 @@ PRTE_EXPORT int prte_odls_base_default_construct_child_list(pmix_data_buffer_t *
 
 PRTE_EXPORT void prte_odls_base_spawn_proc(int fd, short sd, void *cbdata);
 
+/* the environment shared by all procs of an app - the launch
+ * environment with the app's entries applied, and an index of
+ * the variable names into it */
+typedef struct {
+    pmix_object_t super;
+    char **env;
+    size_t nenv;
+    pmix_hash_table_t index;
+} prte_odls_env_t;
+PMIX_CLASS_DECLARATION(prte_odls_env_t);
+
+PRTE_EXPORT prte_odls_env_t *prte_odls_base_build_env(prte_app_context_t *app);
+/* return the environment of a proc - the base entries with the
+ * per-proc delta applied. The strings are shared with base and
+ * delta, so only the array itself belongs to the caller */
+PRTE_EXPORT char **prte_odls_base_assemble_env(prte_odls_env_t *base, char **delta);
+
 /* define a function that will fork a local proc */
 typedef int (*prte_odls_base_fork_local_proc_fn_t)(void *cd);
 
@@ -95,6 +113,8 @@ typedef struct {
     char *wdir;
     char **argv;
     char **env;
+    prte_odls_env_t *baseenv;
+    char **delta;
     prte_job_t *jdata;
     prte_app_context_t *app;
     prte_proc_t *child;
@@ -28,6 +28,10 @@ AC_DEFUN([MCA_prte_odls_default_CONFIG],[
 
     AC_CHECK_FUNC([fork], [odls_default_happy="yes"], [odls_default_happy="no"])
 
+    # optional posix_spawn launch engine
+    AC_CHECK_HEADERS([spawn.h])
+    AC_CHECK_FUNCS([posix_spawn posix_spawn_file_actions_addchdir_np posix_spawn_file_actions_addclosefrom_np])
+
     AS_IF([test "$odls_default_happy" = "yes"], [$1], [$2])
 
 ])dnl
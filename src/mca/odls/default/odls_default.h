@@ -42,6 +42,26 @@ int prte_mca_odls_default_component_open(void);
 int prte_mca_odls_default_component_close(void);
 int prte_mca_odls_default_component_query(pmix_mca_base_module_t **module, int *priority);
 
+/*
+ * Launch engines - "fork" runs the child-side setup after a full
+ * fork(), "spawn" prepares everything in the daemon and starts the
+ * child with posix_spawn, falling back to fork for any proc whose
+ * setup cannot be expressed that way
+ */
+#if defined(HAVE_SPAWN_H) && defined(HAVE_POSIX_SPAWN) \
+    && defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP)
+#    define PRTE_ODLS_DEFAULT_HAVE_SPAWN 1
+#else
+#    define PRTE_ODLS_DEFAULT_HAVE_SPAWN 0
+#endif
+
+typedef enum {
+    PRTE_ODLS_DEFAULT_ENGINE_FORK,
+    PRTE_ODLS_DEFAULT_ENGINE_SPAWN
+} prte_odls_default_engine_t;
+
+extern prte_odls_default_engine_t prte_odls_default_engine;
+
 /*
  * ODLS Default module
  */
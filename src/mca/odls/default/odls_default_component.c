@@ -38,6 +38,7 @@
 #    include <unistd.h>
 #endif
 #include <ctype.h>
+#include <string.h>
 
 #include "src/mca/base/pmix_base.h"
 #include "src/mca/mca.h"
@@ -45,6 +46,9 @@
 #include "src/mca/odls/base/odls_private.h"
 #include "src/mca/odls/default/odls_default.h"
 #include "src/mca/odls/odls.h"
+#include "src/util/pmix_output.h"
+
+static int component_register(void);
 
 /*
  * Instantiate the public struct with all of our public information
@@ -64,8 +68,40 @@ prte_odls_base_component_t prte_mca_odls_default_component = {
     .pmix_mca_open_component = prte_mca_odls_default_component_open,
     .pmix_mca_close_component = prte_mca_odls_default_component_close,
     .pmix_mca_query_component = prte_mca_odls_default_component_query,
+    .pmix_mca_register_component_params = component_register,
 };
 
+prte_odls_default_engine_t prte_odls_default_engine = PRTE_ODLS_DEFAULT_ENGINE_FORK;
+static char *engine = NULL;
+
+static int component_register(void)
+{
+    pmix_mca_base_component_t *c = &prte_mca_odls_default_component;
+
+    engine = "fork";
+    (void) pmix_mca_base_component_var_register(c, "launch_engine",
+                                                "How to start local procs - fork (default) or spawn. "
+                                                "The spawn engine uses posix_spawn, avoiding the copy of "
+                                                "the daemon's page tables and the descriptor sweep in "
+                                                "every child",
+                                                PMIX_MCA_BASE_VAR_TYPE_STRING,
+                                                &engine);
+    if (NULL == engine || 0 == strcasecmp(engine, "fork")) {
+        prte_odls_default_engine = PRTE_ODLS_DEFAULT_ENGINE_FORK;
+    } else if (0 == strcasecmp(engine, "spawn")) {
+#if PRTE_ODLS_DEFAULT_HAVE_SPAWN
+        prte_odls_default_engine = PRTE_ODLS_DEFAULT_ENGINE_SPAWN;
+#else
+        pmix_output(0, "odls:default: the spawn launch engine is not supported on this system - using fork");
+        prte_odls_default_engine = PRTE_ODLS_DEFAULT_ENGINE_FORK;
+#endif
+    } else {
+        pmix_output(0, "odls:default: unknown launch engine \"%s\" - using fork", engine);
+        prte_odls_default_engine = PRTE_ODLS_DEFAULT_ENGINE_FORK;
+    }
+    return PRTE_SUCCESS;
+}
+
 int prte_mca_odls_default_component_open(void)
 {
     return PRTE_SUCCESS;
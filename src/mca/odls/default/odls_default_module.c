@@ -113,6 +113,12 @@
 #ifdef HAVE_SYS_PTRACE_H
 #    include <sys/ptrace.h>
 #endif
+#ifdef HAVE_SPAWN_H
+#    include <spawn.h>
+#endif
+#ifdef HAVE_TERMIOS_H
+#    include <termios.h>
+#endif
 
 #include "src/class/pmix_pointer_array.h"
 #include "src/hwloc/hwloc-internal.h"
@@ -596,6 +602,198 @@ static int do_parent(prte_odls_spawn_caddy_t *cd, int read_fd)
     return PRTE_SUCCESS;
 }
 
+#if PRTE_ODLS_DEFAULT_HAVE_SPAWN
+/* the attributes are the same for every proc, so they are built
+ * once and shared by all launches */
+static posix_spawnattr_t spawn_attr;
+static bool spawn_attr_ready = false;
+
+static int setup_spawn_attr(void)
+{
+    sigset_t sigs;
+    short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+
+    if (spawn_attr_ready) {
+        return PRTE_SUCCESS;
+    }
+    if (0 != posix_spawnattr_init(&spawn_attr)) {
+        return PRTE_ERR_OUT_OF_RESOURCE;
+    }
+#if HAVE_SETPGID
+    /* put the child in its own process group, as do_child does */
+    flags |= POSIX_SPAWN_SETPGROUP;
+    posix_spawnattr_setpgroup(&spawn_attr, 0);
+#endif
+    /* same signal handlers do_child resets, and nothing blocked */
+    sigemptyset(&sigs);
+    sigaddset(&sigs, SIGTERM);
+    sigaddset(&sigs, SIGINT);
+    sigaddset(&sigs, SIGHUP);
+    sigaddset(&sigs, SIGPIPE);
+    sigaddset(&sigs, SIGCHLD);
+    sigaddset(&sigs, SIGTRAP);
+    posix_spawnattr_setsigdefault(&spawn_attr, &sigs);
+    sigemptyset(&sigs);
+    posix_spawnattr_setsigmask(&spawn_attr, &sigs);
+    posix_spawnattr_setflags(&spawn_attr, flags);
+    spawn_attr_ready = true;
+    return PRTE_SUCCESS;
+}
+
+/* can everything do_child would do for this proc be done
+ * from the daemon? */
+static bool can_spawn(prte_odls_spawn_caddy_t *cd)
+{
+    if (NULL == cd->child) {
+        return false;
+    }
+    /* freeing a proc from the daemon's binding and reporting
+     * bindings are left to the rtc framework */
+    if ((NULL == cd->child->cpuset || 0 == strlen(cd->child->cpuset))
+        && NULL != prte_daemon_cores) {
+        return false;
+    }
+    if (prte_get_attribute(&cd->jdata->attributes, PRTE_JOB_REPORT_BINDINGS, NULL, PMIX_BOOL)) {
+        return false;
+    }
+#if PRTE_HAVE_STOP_ON_EXEC
+    if (prte_get_attribute(&cd->jdata->attributes, PRTE_JOB_STOP_ON_EXEC, NULL, PMIX_PROC_RANK)) {
+        return false;
+    }
+#endif
+#ifndef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP
+    if (NULL != cd->wdir) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+/**
+ * Start the specified process with posix_spawn. The stdio plumbing,
+ * working directory, descriptor cleanup, process group and signal
+ * state that do_child sets up after a fork are expressed as spawn
+ * file actions and attributes, and the binding is inherited from the
+ * launching thread. Returns PRTE_ERR_TAKE_NEXT_OPTION if the proc
+ * has to be started with fork instead.
+ */
+static int odls_default_spawn_local_proc(prte_odls_spawn_caddy_t *cd)
+{
+    prte_proc_t *child = cd->child;
+    posix_spawn_file_actions_t fa;
+    hwloc_cpuset_t cpuset = NULL, saved = NULL;
+    char dir[MAXPATHLEN], *msg;
+    struct stat stats;
+    pid_t pid;
+    int rc, i;
+
+    if (PRTE_SUCCESS != setup_spawn_attr()) {
+        return PRTE_ERR_TAKE_NEXT_OPTION;
+    }
+
+    /* bind the launching thread so the child inherits the binding */
+    if (NULL != child->cpuset && 0 < strlen(child->cpuset)) {
+        cpuset = hwloc_bitmap_alloc();
+        saved = hwloc_bitmap_alloc();
+        if (0 != hwloc_bitmap_list_sscanf(cpuset, child->cpuset)
+            || 0 != hwloc_get_cpubind(prte_hwloc_topology, saved, HWLOC_CPUBIND_THREAD)
+            || 0 != hwloc_set_cpubind(prte_hwloc_topology, cpuset, HWLOC_CPUBIND_THREAD)) {
+            /* let the rtc framework deal with it */
+            hwloc_bitmap_free(cpuset);
+            hwloc_bitmap_free(saved);
+            return PRTE_ERR_TAKE_NEXT_OPTION;
+        }
+    }
+
+    posix_spawn_file_actions_init(&fa);
+    if (PRTE_FLAG_TEST(cd->jdata, PRTE_JOB_FLAG_FORWARD_OUTPUT)) {
+        if (cd->opts.usepty) {
+            /* the terminal settings belong to the pty, not to the
+             * process, so they can be made from here */
+            struct termios term_attrs;
+            if (0 == tcgetattr(cd->opts.p_stdout[1], &term_attrs)) {
+                term_attrs.c_lflag &= ~(ECHO | ECHOE | ECHOK | ECHOCTL | ECHOKE | ECHONL);
+                term_attrs.c_iflag &= ~(ICRNL | INLCR | ISTRIP | INPCK | IXON);
+                term_attrs.c_oflag &= ~(
+#ifdef OCRNL
+                    OCRNL |
+#endif
+                    ONLCR);
+                (void) tcsetattr(cd->opts.p_stdout[1], TCSANOW, &term_attrs);
+            }
+        }
+        if (cd->opts.connect_stdin) {
+            posix_spawn_file_actions_adddup2(&fa, cd->opts.p_stdin[0], 0);
+        } else {
+            posix_spawn_file_actions_addopen(&fa, 0, "/dev/null", O_RDONLY, 0);
+        }
+        posix_spawn_file_actions_adddup2(&fa, cd->opts.p_stdout[1], 1);
+        posix_spawn_file_actions_adddup2(&fa, cd->opts.p_stderr[1], 2);
+    } else {
+        for (i = 0; i < 3; i++) {
+            posix_spawn_file_actions_addopen(&fa, i, "/dev/null", O_RDONLY, 0);
+        }
+    }
+    /* a single close_range in the child instead of a descriptor sweep */
+    posix_spawn_file_actions_addclosefrom_np(&fa, 3);
+#ifdef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP
+    if (NULL != cd->wdir) {
+        posix_spawn_file_actions_addchdir_np(&fa, cd->wdir);
+    }
+#endif
+
+    if (cd->argv == NULL) {
+        cd->argv = malloc(sizeof(char *) * 2);
+        cd->argv[0] = strdup(cd->app->app);
+        cd->argv[1] = NULL;
+    }
+
+    rc = posix_spawn(&pid, cd->cmd, &fa, &spawn_attr, cd->argv, cd->env);
+    posix_spawn_file_actions_destroy(&fa);
+    if (NULL != cpuset) {
+        hwloc_set_cpubind(prte_hwloc_topology, saved, HWLOC_CPUBIND_THREAD);
+        hwloc_bitmap_free(cpuset);
+        hwloc_bitmap_free(saved);
+    }
+
+    /* close the child's ends of the pipes, as do_parent does */
+    if (cd->opts.connect_stdin) {
+        close(cd->opts.p_stdin[0]);
+    }
+    close(cd->opts.p_stdout[1]);
+    close(cd->opts.p_stderr[1]);
+
+    if (0 != rc) {
+        /* report it the way do_child would have */
+        if (NULL != cd->wdir && 0 != stat(cd->wdir, &stats)) {
+            pmix_show_help("help-prun.txt", "prun:wdir-not-found", true, "prted", cd->wdir,
+                           prte_process_info.nodename, child->app_rank);
+        } else {
+            if (NULL == getcwd(dir, sizeof(dir))) {
+                dir[0] = '\0';
+            }
+            if (ENOENT == rc && 0 == stat(cd->app->app, &stats)) {
+                pmix_asprintf(&msg, "%s has a bad interpreter on the first line.", cd->app->app);
+            } else {
+                msg = strdup(strerror(rc));
+            }
+            pmix_show_help("help-prte-odls-default.txt", "execve error", true,
+                           prte_process_info.nodename, (NULL == cd->wdir) ? dir : cd->wdir,
+                           cd->app->app, msg);
+            free(msg);
+        }
+        child->state = PRTE_PROC_STATE_FAILED_TO_START;
+        PRTE_FLAG_UNSET(child, PRTE_PROC_FLAG_ALIVE);
+        return PRTE_ERR_FAILED_TO_START;
+    }
+
+    child->pid = pid;
+    child->state = PRTE_PROC_STATE_RUNNING;
+    PRTE_FLAG_SET(child, PRTE_PROC_FLAG_ALIVE);
+    return PRTE_SUCCESS;
+}
+#endif
+
 /**
  *  Fork/exec the specified processes
  */
@@ -606,6 +804,15 @@ static int odls_default_fork_local_proc(void *cdptr)
     pid_t pid;
     prte_proc_t *child = cd->child;
 
+#if PRTE_ODLS_DEFAULT_HAVE_SPAWN
+    if (PRTE_ODLS_DEFAULT_ENGINE_SPAWN == prte_odls_default_engine && can_spawn(cd)) {
+        int rc = odls_default_spawn_local_proc(cd);
+        if (PRTE_ERR_TAKE_NEXT_OPTION != rc) {
+            return rc;
+        }
+    }
+#endif
+
     /* A pipe is used to communicate between the parent and child to
        indicate whether the exec ultimately succeeded or failed.  The
        child sets the pipe to be close-on-exec; the child only ever
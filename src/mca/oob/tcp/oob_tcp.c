@@ -82,6 +82,8 @@ prte_oob_tcp_module_t prte_oob_tcp_module = {.accept_connection = accept_connect
  * Local utility functions
  */
 static void recv_handler(int sd, short flags, void *user);
+static void process_ping(int fd, short args, void *cbdata);
+static void accept_peer(int fd, short args, void *cbdata);
 
 /* Called by prte_oob_tcp_accept() and connection_handler() on
  * a socket that has been accepted.  This call finishes processing the
@@ -127,12 +129,25 @@ static void ping(const pmix_proc_t *proc)
         return;
     }
 
+    /* the state of the peer belongs to the event base progressing it */
+    PRTE_ACTIVATE_TCP_CONN_STATE(peer, process_ping);
+}
+
+static void process_ping(int fd, short args, void *cbdata)
+{
+    prte_oob_tcp_conn_op_t *op = (prte_oob_tcp_conn_op_t *) cbdata;
+    prte_oob_tcp_peer_t *peer;
+
+    PMIX_ACQUIRE_OBJECT(op);
+    peer = op->peer;
+
     /* if we are already connected, there is nothing to do */
     if (MCA_OOB_TCP_CONNECTED == peer->state) {
         pmix_output_verbose(2, prte_oob_base_framework.framework_output,
                             "%s:[%s:%d] already connected to peer %s",
                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), __FILE__, __LINE__,
-                            PRTE_NAME_PRINT(proc));
+                            PRTE_NAME_PRINT(&peer->name));
+        PMIX_RELEASE(op);
         return;
     }
 
@@ -141,13 +156,14 @@ static void ping(const pmix_proc_t *proc)
         pmix_output_verbose(2, prte_oob_base_framework.framework_output,
                             "%s:[%s:%d] already connecting to peer %s",
                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), __FILE__, __LINE__,
-                            PRTE_NAME_PRINT(proc));
+                            PRTE_NAME_PRINT(&peer->name));
+        PMIX_RELEASE(op);
         return;
     }
 
     /* attempt the connection */
     peer->state = MCA_OOB_TCP_CONNECTING;
-    PRTE_ACTIVATE_TCP_CONN_STATE(peer, prte_oob_tcp_peer_try_connect);
+    prte_oob_tcp_peer_try_connect(fd, args, op);
 }
 
 static void send_nb(prte_rml_send_t *msg)
@@ -180,32 +196,9 @@ static void send_nb(prte_rml_send_t *msg)
                         PRTE_NAME_PRINT(&msg->dst), msg->tag, msg->seq_num,
                         PRTE_NAME_PRINT(&peer->name));
 
-    /* add the msg to the hop's send queue */
-    if (MCA_OOB_TCP_CONNECTED == peer->state) {
-        pmix_output_verbose(2, prte_oob_base_framework.framework_output,
-                            "%s tcp:send_nb: already connected to %s - queueing for send",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name));
-        MCA_OOB_TCP_QUEUE_SEND(msg, peer);
-        return;
-    }
-
-    /* add the message to the queue for sending after the
-     * connection is formed
-     */
-    MCA_OOB_TCP_QUEUE_PENDING(msg, peer);
-
-    if (MCA_OOB_TCP_CONNECTING != peer->state && MCA_OOB_TCP_CONNECT_ACK != peer->state) {
-        /* we have to initiate the connection - again, we do not
-         * want to block while the connection is created.
-         * So throw us into an event that will create
-         * the connection via a mini-state-machine :-)
-         */
-        pmix_output_verbose(2, prte_oob_base_framework.framework_output,
-                            "%s tcp:send_nb: initiating connection to %s",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name));
-        peer->state = MCA_OOB_TCP_CONNECTING;
-        PRTE_ACTIVATE_TCP_CONN_STATE(peer, prte_oob_tcp_peer_try_connect);
-    }
+    /* add the msg to the hop's send queue - whatever progresses
+     * the hop starts connecting to it if need be */
+    MCA_OOB_TCP_QUEUE_SEND(msg, peer);
 }
 
 /*
@@ -218,55 +211,92 @@ static void send_nb(prte_rml_send_t *msg)
 static void recv_handler(int sd, short flg, void *cbdata)
 {
     prte_oob_tcp_conn_op_t *op = (prte_oob_tcp_conn_op_t *) cbdata;
-    int flags;
+    prte_oob_tcp_conn_op_t *cop;
     prte_oob_tcp_hdr_t hdr;
     prte_oob_tcp_peer_t *peer;
+    char *msg;
 
     PMIX_ACQUIRE_OBJECT(op);
 
     pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
                         "%s:tcp:recv:handler called", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
 
-    /* get the handshake */
-    if (PRTE_SUCCESS != prte_oob_tcp_peer_recv_connect_ack(NULL, sd, &hdr)) {
+    /* get the handshake - only the socket is ours to touch here */
+    if (PRTE_SUCCESS != prte_oob_tcp_peer_recv_ident_hdr(sd, &hdr, &msg)) {
         goto cleanup;
     }
 
     /* finish processing ident */
     if (MCA_OOB_TCP_IDENT == hdr.type) {
         if (NULL == (peer = prte_oob_tcp_peer_lookup(&hdr.origin))) {
-            /* should never happen */
-            prte_oob_tcp_peer_close(peer);
-            goto cleanup;
+            pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                                "%s prte_oob_tcp_recv_connect: connection from new peer",
+                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
+            peer = PMIX_NEW(prte_oob_tcp_peer_t);
+            PMIX_XFER_PROCID(&peer->name, &hdr.origin);
+            peer->state = MCA_OOB_TCP_ACCEPTING;
+            pmix_list_append(&prte_mca_oob_tcp_component.peers, &peer->super);
         }
-        /* set socket up to be non-blocking */
-        if ((flags = fcntl(sd, F_GETFL, 0)) < 0) {
-            pmix_output(0, "%s prte_oob_tcp_recv_connect: fcntl(F_GETFL) failed: %s (%d)",
+        /* the peer's state belongs to the event base progressing
+         * it, so the rest of the handshake is done there */
+        cop = PMIX_NEW(prte_oob_tcp_conn_op_t);
+        cop->peer = peer;
+        cop->sd = sd;
+        cop->msg = msg;
+        cop->nbytes = hdr.nbytes;
+        PMIX_THREADSHIFT(cop, peer->ev_base, accept_peer, PRTE_MSG_PRI);
+    }
+
+cleanup:
+    PMIX_RELEASE(op);
+}
+
+/* finish accepting a connection on the event base progressing
+ * the peer, now that the handshake identified it */
+static void accept_peer(int fd, short args, void *cbdata)
+{
+    prte_oob_tcp_conn_op_t *op = (prte_oob_tcp_conn_op_t *) cbdata;
+    prte_oob_tcp_peer_t *peer;
+    int sd, flags;
+    PRTE_HIDE_UNUSED_PARAMS(fd, args);
+
+    PMIX_ACQUIRE_OBJECT(op);
+    peer = op->peer;
+    sd = op->sd;
+
+    /* check the ack flag, the version and for a race with our
+     * own connection to the peer */
+    if (PRTE_SUCCESS != prte_oob_tcp_peer_recv_ident(peer, sd, op->msg, op->nbytes)) {
+        PMIX_RELEASE(op);
+        return;
+    }
+
+    /* set socket up to be non-blocking */
+    if ((flags = fcntl(sd, F_GETFL, 0)) < 0) {
+        pmix_output(0, "%s prte_oob_tcp_recv_connect: fcntl(F_GETFL) failed: %s (%d)",
+                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), strerror(prte_socket_errno),
+                    prte_socket_errno);
+    } else {
+        flags |= O_NONBLOCK;
+        if (fcntl(sd, F_SETFL, flags) < 0) {
+            pmix_output(0, "%s prte_oob_tcp_recv_connect: fcntl(F_SETFL) failed: %s (%d)",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), strerror(prte_socket_errno),
                         prte_socket_errno);
-        } else {
-            flags |= O_NONBLOCK;
-            if (fcntl(sd, F_SETFL, flags) < 0) {
-                pmix_output(0, "%s prte_oob_tcp_recv_connect: fcntl(F_SETFL) failed: %s (%d)",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), strerror(prte_socket_errno),
-                            prte_socket_errno);
-            }
         }
-        /* is the peer instance willing to accept this connection */
-        peer->sd = sd;
-        if (prte_oob_tcp_peer_accept(peer) == false) {
-            if (OOB_TCP_DEBUG_CONNECT
-                <= pmix_output_get_verbosity(prte_oob_base_framework.framework_output)) {
-                pmix_output(0,
-                            "%s-%s prte_oob_tcp_recv_connect: "
-                            "rejected connection from %s connection state %d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&(peer->name)),
-                            PRTE_NAME_PRINT(&(hdr.origin)), peer->state);
-            }
-            CLOSE_THE_SOCKET(sd);
+    }
+    /* is the peer instance willing to accept this connection */
+    peer->sd = sd;
+    if (prte_oob_tcp_peer_accept(peer) == false) {
+        if (OOB_TCP_DEBUG_CONNECT
+            <= pmix_output_get_verbosity(prte_oob_base_framework.framework_output)) {
+            pmix_output(0,
+                        "%s-%s prte_oob_tcp_recv_connect: "
+                        "rejected connection state %d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&(peer->name)),
+                        peer->state);
         }
+        CLOSE_THE_SOCKET(sd);
     }
 
-cleanup:
     PMIX_RELEASE(op);
 }
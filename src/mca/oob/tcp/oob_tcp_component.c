@@ -101,6 +101,7 @@ static int tcp_component_close(void);
 
 static int component_available(void);
 static int component_startup(void);
+static void start_threads(void);
 static void component_shutdown(void);
 static int component_send(prte_rml_send_t *msg);
 static char *component_get_addr(void);
@@ -163,9 +164,20 @@ static int tcp_component_open(void)
  */
 static int tcp_component_close(void)
 {
+    int i;
+
     PMIX_LIST_DESTRUCT(&prte_mca_oob_tcp_component.local_ifs);
     PMIX_LIST_DESTRUCT(&prte_mca_oob_tcp_component.peers);
 
+    /* the peers are gone, so their progress threads can go too */
+    if (NULL != prte_mca_oob_tcp_component.io) {
+        for (i = 0; i < prte_mca_oob_tcp_component.num_threads; i++) {
+            PMIX_RELEASE(prte_mca_oob_tcp_component.io[i]);
+        }
+        free(prte_mca_oob_tcp_component.io);
+        prte_mca_oob_tcp_component.io = NULL;
+    }
+
     if (NULL != prte_mca_oob_tcp_component.ipv4conns) {
         pmix_argv_free(prte_mca_oob_tcp_component.ipv4conns);
     }
@@ -379,6 +391,24 @@ static int tcp_component_register(void)
                                                 PMIX_MCA_BASE_VAR_TYPE_INT,
                                                 &prte_mca_oob_tcp_component.max_recon_attempts);
 
+    prte_mca_oob_tcp_component.compact_hdr = true;
+    (void) pmix_mca_base_component_var_register(component, "compact_header",
+                                                "Use a compact message header on connections to peers that also support it",
+                                                PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                                                &prte_mca_oob_tcp_component.compact_hdr);
+
+    prte_mca_oob_tcp_component.num_threads = 0;
+    (void) pmix_mca_base_component_var_register(component, "num_threads",
+                                                "Number of progress threads daemons spread the I/O of their peer connections across (0 => progress it on the main event base)",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &prte_mca_oob_tcp_component.num_threads);
+
+    prte_mca_oob_tcp_component.handoff_size = 1024;
+    (void) pmix_mca_base_component_var_register(component, "handoff_size",
+                                                "Number of messages a progress thread can queue for the main event base before it holds further ones back (rounded up to a power of two)",
+                                                PMIX_MCA_BASE_VAR_TYPE_INT,
+                                                &prte_mca_oob_tcp_component.handoff_size);
+
     return PRTE_SUCCESS;
 }
 
@@ -493,6 +523,40 @@ static int component_available(void)
     return PRTE_SUCCESS;
 }
 
+static void start_threads(void)
+{
+    prte_oob_tcp_io_t *io;
+    int i, rc;
+
+    prte_mca_oob_tcp_component.io = (prte_oob_tcp_io_t **)
+        calloc(prte_mca_oob_tcp_component.num_threads, sizeof(prte_oob_tcp_io_t *));
+    if (NULL == prte_mca_oob_tcp_component.io) {
+        PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+        prte_mca_oob_tcp_component.num_threads = 0;
+        return;
+    }
+    for (i = 0; i < prte_mca_oob_tcp_component.num_threads; i++) {
+        io = PMIX_NEW(prte_oob_tcp_io_t);
+        if (PRTE_SUCCESS != (rc = prte_oob_tcp_io_start(io, i))) {
+            PRTE_ERROR_LOG(rc);
+            PMIX_RELEASE(io);
+            break;
+        }
+        prte_mca_oob_tcp_component.io[i] = io;
+    }
+    if (0 == i) {
+        /* progress them on the main event base after all */
+        free(prte_mca_oob_tcp_component.io);
+        prte_mca_oob_tcp_component.io = NULL;
+    }
+    prte_mca_oob_tcp_component.num_threads = i;
+    prte_mca_oob_tcp_component.next_io = 0;
+
+    pmix_output_verbose(2, prte_oob_base_framework.framework_output,
+                        "%s TCP PEER I/O ON %d PROGRESS THREADS",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), i);
+}
+
 /* Start all modules */
 static int component_startup(void)
 {
@@ -511,6 +575,11 @@ static int component_startup(void)
         if (PRTE_SUCCESS != (rc = prte_oob_tcp_start_listening())) {
             PRTE_ERROR_LOG(rc);
         }
+        /* spread the I/O of our peers across progress threads
+         * of its own, if requested */
+        if (0 < prte_mca_oob_tcp_component.num_threads) {
+            start_threads();
+        }
     }
 
     return rc;
@@ -518,6 +587,7 @@ static int component_startup(void)
 
 static void component_shutdown(void)
 {
+    prte_oob_tcp_io_t *io;
     int i = 0, rc;
 
     pmix_output_verbose(2, prte_oob_base_framework.framework_output, "%s TCP SHUTDOWN",
@@ -541,6 +611,23 @@ static void component_shutdown(void)
     /* cleanup listen event list */
     PMIX_LIST_DESTRUCT(&prte_mca_oob_tcp_component.listeners);
 
+    /* stop progressing the peers - the threads go away with
+     * them when the component closes */
+    for (i = 0; i < prte_mca_oob_tcp_component.num_threads; i++) {
+        io = prte_mca_oob_tcp_component.io[i];
+        prte_progress_thread_pause(io->name);
+        pmix_output_verbose(1, prte_oob_base_framework.framework_output,
+                            "%s %s: %" PRIu64 " handoffs to the main event base, delay avg %" PRIu64
+                            " max %" PRIu64 " usec, %" PRIu64 " held back for a full queue; %"
+                            PRIu64 " sends handed to the thread, delay avg %" PRIu64 " max %"
+                            PRIu64 " usec",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), io->name, io->to_main.count,
+                            (0 == io->to_main.count) ? 0 : io->to_main.total / io->to_main.count,
+                            io->to_main.max, io->held, io->to_io.count,
+                            (0 == io->to_io.count) ? 0 : io->to_io.total / io->to_io.count,
+                            io->to_io.max);
+    }
+
     pmix_output_verbose(2, prte_oob_base_framework.framework_output, "%s TCP SHUTDOWN done",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
 }
@@ -650,6 +737,26 @@ static int parse_uri(const uint16_t af_family, const char *host, const char *por
     return PRTE_SUCCESS;
 }
 
+/* an address for a peer progressed by an I/O thread */
+typedef struct {
+    pmix_object_t super;
+    prte_event_t ev;
+    prte_oob_tcp_peer_t *peer;
+    prte_oob_tcp_addr_t *addr;
+} prte_oob_tcp_addr_op_t;
+static PMIX_CLASS_INSTANCE(prte_oob_tcp_addr_op_t, pmix_object_t, NULL, NULL);
+
+static void add_addr(int sd, short args, void *cbdata)
+{
+    prte_oob_tcp_addr_op_t *op = (prte_oob_tcp_addr_op_t *) cbdata;
+    PRTE_HIDE_UNUSED_PARAMS(sd, args);
+
+    PMIX_ACQUIRE_OBJECT(op);
+    pmix_list_append(&op->peer->addrs, &op->addr->super);
+    PMIX_RELEASE(op->peer);
+    PMIX_RELEASE(op);
+}
+
 static int component_set_addr(pmix_proc_t *peer, char **uris)
 {
     char **addrs, **masks, *hptr;
@@ -657,9 +764,10 @@ static int component_set_addr(pmix_proc_t *peer, char **uris)
     int i, j, rc;
     uint16_t af_family = AF_UNSPEC;
     uint64_t ui64;
-    bool found;
+    bool found, created;
     prte_oob_tcp_peer_t *pr;
     prte_oob_tcp_addr_t *maddr;
+    prte_oob_tcp_addr_op_t *op;
 
     memcpy(&ui64, (char *) peer, sizeof(uint64_t));
     /* cycle across component parts and see if one belongs to us */
@@ -772,7 +880,9 @@ static int component_set_addr(pmix_proc_t *peer, char **uris)
                 host = addrs[j];
             }
 
+            created = false;
             if (NULL == (pr = prte_oob_tcp_peer_lookup(peer))) {
+                created = true;
                 pr = PMIX_NEW(prte_oob_tcp_peer_t);
                 PMIX_XFER_PROCID(&pr->name, peer);
                 pmix_output_verbose(20, prte_oob_base_framework.framework_output,
@@ -788,8 +898,11 @@ static int component_set_addr(pmix_proc_t *peer, char **uris)
                                    (struct sockaddr_storage *) &(maddr->addr)))) {
                 PRTE_ERROR_LOG(rc);
                 PMIX_RELEASE(maddr);
-                pmix_list_remove_item(&prte_mca_oob_tcp_component.peers, &pr->super);
-                PMIX_RELEASE(pr);
+                if (created) {
+                    /* a known peer may be in use by its I/O thread */
+                    pmix_list_remove_item(&prte_mca_oob_tcp_component.peers, &pr->super);
+                    PMIX_RELEASE(pr);
+                }
                 return PRTE_ERR_TAKE_NEXT_OPTION;
             }
             maddr->if_mask = atoi(masks[j]);
@@ -798,7 +911,16 @@ static int component_set_addr(pmix_proc_t *peer, char **uris)
                                 "%s set_peer: peer %s is listening on net %s port %s",
                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(peer),
                                 (NULL == host) ? "NULL" : host, (NULL == ports) ? "NULL" : ports);
-            pmix_list_append(&pr->addrs, &maddr->super);
+            if (pr->ev_base == prte_event_base) {
+                pmix_list_append(&pr->addrs, &maddr->super);
+            } else {
+                /* the peer's addresses are walked by its I/O thread */
+                op = PMIX_NEW(prte_oob_tcp_addr_op_t);
+                PMIX_RETAIN(pr);
+                op->peer = pr;
+                op->addr = maddr;
+                PMIX_THREADSHIFT(op, pr->ev_base, add_addr, PRTE_MSG_PRI);
+            }
 
             found = true;
         }
@@ -1028,12 +1150,29 @@ static void peer_cons(prte_oob_tcp_peer_t *peer)
     peer->send_ev_active = false;
     peer->recv_ev_active = false;
     peer->timer_ev_active = false;
+    peer->compact = false;
+    peer->nspaces = NULL;
+    /* spread the peers across the progress threads, if we have them */
+    if (NULL != prte_mca_oob_tcp_component.io) {
+        peer->io = prte_mca_oob_tcp_component.io[prte_mca_oob_tcp_component.next_io];
+        ++prte_mca_oob_tcp_component.next_io;
+        if (prte_mca_oob_tcp_component.num_threads <= prte_mca_oob_tcp_component.next_io) {
+            prte_mca_oob_tcp_component.next_io = 0;
+        }
+        peer->ev_base = peer->io->ev_base;
+    } else {
+        peer->io = NULL;
+        peer->ev_base = prte_event_base;
+    }
 }
 static void peer_des(prte_oob_tcp_peer_t *peer)
 {
     if (NULL != peer->auth_method) {
         free(peer->auth_method);
     }
+    if (NULL != peer->nspaces) {
+        pmix_argv_free(peer->nspaces);
+    }
     if (peer->send_ev_active) {
         prte_event_del(&peer->send_event);
     }
@@ -1079,7 +1218,20 @@ PMIX_CLASS_INSTANCE(prte_oob_tcp_peer_op_t, pmix_object_t, pop_cons, pop_des);
 
 PMIX_CLASS_INSTANCE(prte_oob_tcp_msg_op_t, pmix_object_t, NULL, NULL);
 
-PMIX_CLASS_INSTANCE(prte_oob_tcp_conn_op_t, pmix_object_t, NULL, NULL);
+static void cop_cons(prte_oob_tcp_conn_op_t *cop)
+{
+    cop->peer = NULL;
+    cop->sd = -1;
+    cop->msg = NULL;
+    cop->nbytes = 0;
+}
+static void cop_des(prte_oob_tcp_conn_op_t *cop)
+{
+    if (NULL != cop->msg) {
+        free(cop->msg);
+    }
+}
+PMIX_CLASS_INSTANCE(prte_oob_tcp_conn_op_t, pmix_object_t, cop_cons, cop_des);
 
 static void nicaddr_cons(prte_oob_tcp_nicaddr_t *ptr)
 {
@@ -40,6 +40,7 @@
 #include "src/event/event-internal.h"
 
 #include "oob_tcp.h"
+#include "oob_tcp_sendrecv.h"
 #include "src/mca/oob/oob.h"
 
 /**
@@ -88,6 +89,13 @@ typedef struct {
     int retry_delay;        /**< time to wait before retrying connection */
     int max_recon_attempts; /**< maximum number of times to attempt connect before giving up (-1 for
                                never) */
+    bool compact_hdr;       /**< offer the compact message header to peers */
+
+    /* peer I/O progress threads */
+    int num_threads;        /**< number of threads to spread peers across (0 => PRTE event base) */
+    int handoff_size;       /**< messages a thread can queue for the PRTE event base */
+    prte_oob_tcp_io_t **io; /**< the threads, NULL if none */
+    int next_io;            /**< counter to load-level the threads */
 } prte_mca_oob_tcp_component_t;
 
 PRTE_MODULE_EXPORT extern prte_mca_oob_tcp_component_t prte_mca_oob_tcp_component;
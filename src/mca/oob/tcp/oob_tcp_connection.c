@@ -59,6 +59,7 @@
 #include "src/event/event-internal.h"
 #include "src/mca/prtebacktrace/prtebacktrace.h"
 #include "src/util/error.h"
+#include "src/util/pmix_argv.h"
 #include "src/util/pmix_fd.h"
 #include "src/util/pmix_if.h"
 #include "src/util/pmix_net.h"
@@ -499,11 +500,18 @@ static int tcp_peer_send_connect_ack(prte_oob_tcp_peer_t *peer)
     char *msg;
     prte_oob_tcp_hdr_t hdr;
     uint16_t ack_flag = htons(1);
+    uint32_t caps = 0;
+    uint8_t nns = 1;
     size_t sdsize, offset = 0;
 
     pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
                         "%s SEND CONNECT ACK", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
 
+    if (prte_mca_oob_tcp_component.compact_hdr) {
+        caps |= MCA_OOB_TCP_CAP_COMPACT;
+    }
+    caps = htonl(caps);
+
     /* load the header */
     hdr.origin = *PRTE_PROC_MY_NAME;
     hdr.dst = peer->name;
@@ -512,8 +520,10 @@ static int tcp_peer_send_connect_ack(prte_oob_tcp_peer_t *peer)
     hdr.seq_num = 0;
     memset(hdr.routed, 0, PRTE_MAX_RTD_SIZE + 1);
 
-    /* payload size */
+    /* payload size - the capabilities and nspace table follow the
+     * version string so that they are ignored by older peers */
     sdsize = sizeof(ack_flag) + strlen(prte_version_string) + 1;
+    sdsize += sizeof(caps) + sizeof(nns) + strlen(PRTE_PROC_MY_NAME->nspace) + 1;
     hdr.nbytes = sdsize;
     MCA_OOB_TCP_HDR_HTON(&hdr);
 
@@ -531,6 +541,14 @@ static int tcp_peer_send_connect_ack(prte_oob_tcp_peer_t *peer)
     offset += sizeof(ack_flag);
     memcpy(msg + offset, prte_version_string, strlen(prte_version_string) + 1);
     offset += strlen(prte_version_string) + 1;
+    memcpy(msg + offset, &caps, sizeof(caps));
+    offset += sizeof(caps);
+    /* our nspace table - compact headers we send reference
+     * nspaces by their index in it */
+    memcpy(msg + offset, &nns, sizeof(nns));
+    offset += sizeof(nns);
+    memcpy(msg + offset, PRTE_PROC_MY_NAME->nspace, strlen(PRTE_PROC_MY_NAME->nspace) + 1);
+    offset += strlen(PRTE_PROC_MY_NAME->nspace) + 1;
 
     /* send it */
     if (PRTE_SUCCESS != tcp_peer_send_blocking(peer->sd, msg, sdsize)) {
@@ -603,7 +621,7 @@ static void tcp_peer_event_init(prte_oob_tcp_peer_t *peer)
 {
     if (peer->sd >= 0) {
         assert(!peer->send_ev_active && !peer->recv_ev_active);
-        prte_event_set(prte_event_base, &peer->recv_event, peer->sd, PRTE_EV_READ | PRTE_EV_PERSIST,
+        prte_event_set(peer->ev_base, &peer->recv_event, peer->sd, PRTE_EV_READ | PRTE_EV_PERSIST,
                        prte_oob_tcp_recv_handler, peer);
         prte_event_set_priority(&peer->recv_event, PRTE_MSG_PRI);
         if (peer->recv_ev_active) {
@@ -611,7 +629,7 @@ static void tcp_peer_event_init(prte_oob_tcp_peer_t *peer)
             peer->recv_ev_active = false;
         }
 
-        prte_event_set(prte_event_base, &peer->send_event, peer->sd,
+        prte_event_set(peer->ev_base, &peer->send_event, peer->sd,
                        PRTE_EV_WRITE | PRTE_EV_PERSIST, prte_oob_tcp_send_handler, peer);
         prte_event_set_priority(&peer->send_event, PRTE_MSG_PRI);
         if (peer->send_ev_active) {
@@ -791,123 +809,80 @@ static bool retry(prte_oob_tcp_peer_t *peer, int sd, bool fatal)
     }
 }
 
-int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *pr, int sd, prte_oob_tcp_hdr_t *dhdr)
+/* process the capabilities and nspace table that follow the
+ * version string in a connect ack. Peers that don't send them
+ * simply get the full header */
+static void tcp_peer_recv_caps(prte_oob_tcp_peer_t *peer, char *msg, size_t offset, size_t nbytes)
 {
-    char *msg;
-    char *version;
-    size_t offset = 0, cnt;
-    prte_oob_tcp_hdr_t hdr;
-    prte_oob_tcp_peer_t *peer;
-    uint16_t ack_flag;
-    bool is_new = (NULL == pr);
-
-    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
-                        "%s RECV CONNECT ACK FROM %s ON SOCKET %d",
-                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                        (NULL == pr) ? "UNKNOWN" : PRTE_NAME_PRINT(&pr->name), sd);
+    uint32_t caps;
+    uint8_t n, nns;
+    size_t len;
+
+    peer->compact = false;
+    if (NULL != peer->nspaces) {
+        pmix_argv_free(peer->nspaces);
+        peer->nspaces = NULL;
+    }
 
-    peer = pr;
-    /* get the header */
-    if (tcp_peer_recv_blocking(peer, sd, &hdr, sizeof(prte_oob_tcp_hdr_t))) {
-        if (NULL != peer) {
-            /* If the peer state is CONNECT_ACK, then we were waiting for
-             * the connection to be ack'd
-             */
-            if (peer->state != MCA_OOB_TCP_CONNECT_ACK) {
-                /* handshake broke down - abort this connection */
-                pmix_output(0, "%s RECV CONNECT BAD HANDSHAKE (%d) FROM %s ON SOCKET %d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), peer->state,
-                            PRTE_NAME_PRINT(&(peer->name)), sd);
-                prte_oob_tcp_peer_close(peer);
-                return PRTE_ERR_UNREACH;
-            }
+    if (nbytes < offset + sizeof(caps) + sizeof(nns)) {
+        return;
+    }
+    memcpy(&caps, msg + offset, sizeof(caps));
+    offset += sizeof(caps);
+    caps = ntohl(caps);
+    memcpy(&nns, msg + offset, sizeof(nns));
+    offset += sizeof(nns);
+
+    for (n = 0; n < nns && offset < nbytes; n++) {
+        len = strnlen(msg + offset, nbytes - offset);
+        if (len == nbytes - offset) {
+            /* unterminated entry - ignore the table */
+            pmix_argv_free(peer->nspaces);
+            peer->nspaces = NULL;
+            return;
         }
-    } else {
-        /* unable to complete the recv */
-        pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
-                            "%s unable to complete recv of connect-ack from %s ON SOCKET %d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                            (NULL == peer) ? "UNKNOWN" : PRTE_NAME_PRINT(&peer->name), sd);
-        return PRTE_ERR_UNREACH;
+        pmix_argv_append_nosize(&peer->nspaces, msg + offset);
+        offset += len + 1;
     }
-
-    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
-                        "%s connect-ack recvd from %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                        (NULL == peer) ? "UNKNOWN" : PRTE_NAME_PRINT(&peer->name));
-
-    /* convert the header */
-    MCA_OOB_TCP_HDR_NTOH(&hdr);
-    /* if the requestor wanted the header returned, then do so now */
-    if (NULL != dhdr) {
-        *dhdr = hdr;
+    if (n < nns) {
+        pmix_argv_free(peer->nspaces);
+        peer->nspaces = NULL;
+        return;
     }
 
-    if (MCA_OOB_TCP_PROBE == hdr.type) {
-        /* send a header back */
-        hdr.type = MCA_OOB_TCP_PROBE;
-        hdr.dst = hdr.origin;
-        hdr.origin = *PRTE_PROC_MY_NAME;
-        MCA_OOB_TCP_HDR_HTON(&hdr);
-        tcp_peer_send_blocking(sd, &hdr, sizeof(prte_oob_tcp_hdr_t));
-        CLOSE_THE_SOCKET(sd);
-        return PRTE_SUCCESS;
+    if (prte_mca_oob_tcp_component.compact_hdr && (MCA_OOB_TCP_CAP_COMPACT & caps)) {
+        peer->compact = true;
     }
 
-    if (hdr.type != MCA_OOB_TCP_IDENT) {
-        pmix_output(0, "tcp_peer_recv_connect_ack: invalid header type: %d\n", hdr.type);
-        if (NULL != peer) {
-            peer->state = MCA_OOB_TCP_FAILED;
-            prte_oob_tcp_peer_close(peer);
-        } else {
-            CLOSE_THE_SOCKET(sd);
-        }
-        return PRTE_ERR_COMM_FAILURE;
-    }
+    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                        "%s connection to %s using %s header of %lu bytes",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name),
+                        peer->compact ? "compact" : "full",
+                        peer->compact ? (unsigned long) sizeof(prte_oob_tcp_chdr_t)
+                                      : (unsigned long) sizeof(prte_oob_tcp_hdr_t));
+}
 
-    /* if we don't already have it, get the peer */
-    if (NULL == peer) {
-        peer = prte_oob_tcp_peer_lookup(&hdr.origin);
-        if (NULL == peer) {
-            pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
-                                "%s prte_oob_tcp_recv_connect: connection from new peer",
-                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
-            peer = PMIX_NEW(prte_oob_tcp_peer_t);
-            PMIX_XFER_PROCID(&peer->name, &hdr.origin);
-            peer->state = MCA_OOB_TCP_ACCEPTING;
-            pmix_list_append(&prte_mca_oob_tcp_component.peers, &peer->super);
-        }
-    } else {
-        /* compare the peers name to the expected value */
-        if (!PMIX_CHECK_PROCID(&peer->name, &hdr.origin)) {
-            pmix_output(0,
-                        "%s tcp_peer_recv_connect_ack: "
-                        "received unexpected process identifier %s from %s\n",
-                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&(hdr.origin)),
-                        PRTE_NAME_PRINT(&(peer->name)));
+/* check the ack flag, version and capabilities in the payload of a
+ * connect ack. This runs on the event base progressing the peer, as
+ * it may change the peer's state or close it */
+static int tcp_peer_check_ack(prte_oob_tcp_peer_t *peer, int sd, char *msg, size_t nbytes,
+                              bool is_new)
+{
+    char *version;
+    size_t offset = 0, cnt;
+    uint16_t ack_flag;
+
+    if (nbytes < sizeof(ack_flag) + 1) {
+        pmix_output(0, "%s connect-ack from %s is too short (%lu bytes)",
+                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name),
+                    (unsigned long) nbytes);
+        if (is_new) {
+            CLOSE_THE_SOCKET(sd);
+        } else {
             peer->state = MCA_OOB_TCP_FAILED;
             prte_oob_tcp_peer_close(peer);
-            return PRTE_ERR_CONNECTION_REFUSED;
         }
-    }
-
-    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
-                        "%s connect-ack header from %s is okay", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                        PRTE_NAME_PRINT(&peer->name));
-
-    /* get the authentication and version payload */
-    if (NULL == (msg = (char *) malloc(hdr.nbytes))) {
-        peer->state = MCA_OOB_TCP_FAILED;
-        prte_oob_tcp_peer_close(peer);
-        return PRTE_ERR_OUT_OF_RESOURCE;
-    }
-    if (!tcp_peer_recv_blocking(peer, sd, msg, hdr.nbytes)) {
-        /* unable to complete the recv but should never happen */
-        pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
-                            "%s unable to complete recv of connect-ack from %s ON SOCKET %d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name),
-                            peer->sd);
-        free(msg);
-        return PRTE_ERR_UNREACH;
+        return PRTE_ERR_COMM_FAILURE;
     }
 
     /* Check the type of acknowledgement */
@@ -945,7 +920,9 @@ int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *pr, int sd, prte_oob
              */
             prte_oob_tcp_peer_close(peer);
         }
-        free(msg);
+        if (is_new) {
+            CLOSE_THE_SOCKET(sd);
+        }
         return PRTE_ERR_UNREACH;
     }
 
@@ -959,7 +936,6 @@ int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *pr, int sd, prte_oob
         && (MCA_OOB_TCP_CONNECTED == peer->state || MCA_OOB_TCP_CONNECTING == peer->state
             || MCA_OOB_TCP_CONNECT_ACK == peer->state)) {
         if (retry(peer, sd, false)) {
-            free(msg);
             return PRTE_ERR_UNREACH;
         }
     }
@@ -967,10 +943,10 @@ int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *pr, int sd, prte_oob
     /* check that this is from a matching version */
     version = (char *) ((char *) msg + offset);
     cnt = 0;
-    while ('\0' != version[cnt] && cnt < (hdr.nbytes - offset)) {
+    while ('\0' != version[cnt] && cnt < (nbytes - offset)) {
         ++cnt;
     }
-    if (cnt == (hdr.nbytes - offset)) {
+    if (cnt == (nbytes - offset)) {
         version[cnt-1] = '\0';
         --cnt;
     }
@@ -978,24 +954,108 @@ int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *pr, int sd, prte_oob
     if (0 != strcmp(version, prte_version_string)) {
         pmix_show_help("help-oob-tcp.txt", "version mismatch", true, prte_process_info.nodename,
                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), prte_version_string,
-                       pmix_fd_get_peer_name(peer->sd), PRTE_NAME_PRINT(&(peer->name)), version);
+                       pmix_fd_get_peer_name(sd), PRTE_NAME_PRINT(&(peer->name)), version);
 
-        peer->state = MCA_OOB_TCP_FAILED;
-        prte_oob_tcp_peer_close(peer);
-        free(msg);
+        if (is_new) {
+            CLOSE_THE_SOCKET(sd);
+        } else {
+            peer->state = MCA_OOB_TCP_FAILED;
+            prte_oob_tcp_peer_close(peer);
+        }
         return PRTE_ERR_CONNECTION_REFUSED;
     }
-    free(msg);
 
     pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
                         "%s connect-ack version from %s matches ours",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name));
 
-    /* if the requestor wanted the header returned, then they
-     * will complete their processing
+    /* see if they offered the compact header */
+    tcp_peer_recv_caps(peer, msg, offset, nbytes);
+    return PRTE_SUCCESS;
+}
+
+/* receive the connect ack the peer sends back on a connection we
+ * started - runs on the event base progressing the peer */
+int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *peer, int sd)
+{
+    char *msg;
+    prte_oob_tcp_hdr_t hdr;
+    int rc;
+
+    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                        "%s RECV CONNECT ACK FROM %s ON SOCKET %d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name), sd);
+
+    /* get the header */
+    if (!tcp_peer_recv_blocking(peer, sd, &hdr, sizeof(prte_oob_tcp_hdr_t))) {
+        /* unable to complete the recv */
+        pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                            "%s unable to complete recv of connect-ack from %s ON SOCKET %d",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name), sd);
+        return PRTE_ERR_UNREACH;
+    }
+    /* If the peer state is CONNECT_ACK, then we were waiting for
+     * the connection to be ack'd
      */
-    if (NULL != dhdr) {
-        return PRTE_SUCCESS;
+    if (peer->state != MCA_OOB_TCP_CONNECT_ACK) {
+        /* handshake broke down - abort this connection */
+        pmix_output(0, "%s RECV CONNECT BAD HANDSHAKE (%d) FROM %s ON SOCKET %d",
+                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), peer->state,
+                    PRTE_NAME_PRINT(&(peer->name)), sd);
+        prte_oob_tcp_peer_close(peer);
+        return PRTE_ERR_UNREACH;
+    }
+
+    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                        "%s connect-ack recvd from %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                        PRTE_NAME_PRINT(&peer->name));
+
+    /* convert the header */
+    MCA_OOB_TCP_HDR_NTOH(&hdr);
+
+    if (hdr.type != MCA_OOB_TCP_IDENT) {
+        pmix_output(0, "tcp_peer_recv_connect_ack: invalid header type: %d\n", hdr.type);
+        peer->state = MCA_OOB_TCP_FAILED;
+        prte_oob_tcp_peer_close(peer);
+        return PRTE_ERR_COMM_FAILURE;
+    }
+
+    /* compare the peers name to the expected value */
+    if (!PMIX_CHECK_PROCID(&peer->name, &hdr.origin)) {
+        pmix_output(0,
+                    "%s tcp_peer_recv_connect_ack: "
+                    "received unexpected process identifier %s from %s\n",
+                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&(hdr.origin)),
+                    PRTE_NAME_PRINT(&(peer->name)));
+        peer->state = MCA_OOB_TCP_FAILED;
+        prte_oob_tcp_peer_close(peer);
+        return PRTE_ERR_CONNECTION_REFUSED;
+    }
+
+    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                        "%s connect-ack header from %s is okay", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                        PRTE_NAME_PRINT(&peer->name));
+
+    /* get the authentication and version payload */
+    if (NULL == (msg = (char *) malloc(hdr.nbytes))) {
+        peer->state = MCA_OOB_TCP_FAILED;
+        prte_oob_tcp_peer_close(peer);
+        return PRTE_ERR_OUT_OF_RESOURCE;
+    }
+    if (!tcp_peer_recv_blocking(peer, sd, msg, hdr.nbytes)) {
+        /* unable to complete the recv but should never happen */
+        pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                            "%s unable to complete recv of connect-ack from %s ON SOCKET %d",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name),
+                            peer->sd);
+        free(msg);
+        return PRTE_ERR_UNREACH;
+    }
+
+    rc = tcp_peer_check_ack(peer, sd, msg, hdr.nbytes, false);
+    free(msg);
+    if (PRTE_SUCCESS != rc) {
+        return rc;
     }
 
     /* set the peer into the component and OOB-level peer tables to indicate
@@ -1012,6 +1072,71 @@ int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *pr, int sd, prte_oob
     return PRTE_SUCCESS;
 }
 
+/* read the handshake on a newly accepted socket. This runs on the
+ * main event base and touches nothing but the socket - the peer the
+ * ident names may be progressed by another thread, so its payload is
+ * returned for prte_oob_tcp_peer_recv_ident to check there. Probes
+ * are answered and their socket closed here */
+int prte_oob_tcp_peer_recv_ident_hdr(int sd, prte_oob_tcp_hdr_t *hdr, char **msg)
+{
+    *msg = NULL;
+
+    pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                        "%s RECV CONNECT ACK FROM UNKNOWN ON SOCKET %d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), sd);
+
+    /* get the header */
+    if (!tcp_peer_recv_blocking(NULL, sd, hdr, sizeof(prte_oob_tcp_hdr_t))) {
+        pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                            "%s unable to complete recv of connect-ack from UNKNOWN ON SOCKET %d",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), sd);
+        return PRTE_ERR_UNREACH;
+    }
+    MCA_OOB_TCP_HDR_NTOH(hdr);
+
+    if (MCA_OOB_TCP_PROBE == hdr->type) {
+        prte_oob_tcp_hdr_t reply = *hdr;
+
+        /* send a header back */
+        reply.dst = reply.origin;
+        reply.origin = *PRTE_PROC_MY_NAME;
+        MCA_OOB_TCP_HDR_HTON(&reply);
+        tcp_peer_send_blocking(sd, &reply, sizeof(prte_oob_tcp_hdr_t));
+        CLOSE_THE_SOCKET(sd);
+        return PRTE_SUCCESS;
+    }
+
+    if (hdr->type != MCA_OOB_TCP_IDENT) {
+        pmix_output(0, "tcp_peer_recv_connect_ack: invalid header type: %d\n", hdr->type);
+        CLOSE_THE_SOCKET(sd);
+        return PRTE_ERR_COMM_FAILURE;
+    }
+
+    /* get the authentication and version payload */
+    if (NULL == (*msg = (char *) malloc(hdr->nbytes))) {
+        CLOSE_THE_SOCKET(sd);
+        return PRTE_ERR_OUT_OF_RESOURCE;
+    }
+    if (!tcp_peer_recv_blocking(NULL, sd, *msg, hdr->nbytes)) {
+        pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
+                            "%s unable to complete recv of connect-ack from %s ON SOCKET %d",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&hdr->origin),
+                            sd);
+        free(*msg);
+        *msg = NULL;
+        return PRTE_ERR_UNREACH;
+    }
+    return PRTE_SUCCESS;
+}
+
+/* check the ident payload of an accepted socket on the event base
+ * progressing the peer it names. On success the caller hands the
+ * socket to the peer - otherwise the socket is gone */
+int prte_oob_tcp_peer_recv_ident(prte_oob_tcp_peer_t *peer, int sd, char *msg, size_t nbytes)
+{
+    return tcp_peer_check_ack(peer, sd, msg, nbytes, true);
+}
+
 /*
  *  Setup peer state to reflect that connection has been established,
  *  and start any pending sends.
@@ -43,6 +43,9 @@
 typedef struct {
     pmix_object_t super;
     prte_oob_tcp_peer_t *peer;
+    int sd; // accepted socket, if any
+    char *msg; // and the payload of its ident
+    size_t nbytes;
     prte_event_t ev;
 } prte_oob_tcp_conn_op_t;
 PMIX_CLASS_DECLARATION(prte_oob_tcp_conn_op_t);
@@ -61,7 +64,7 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_conn_op_t);
                             __FILE__, __LINE__, PRTE_NAME_PRINT((&(p)->name)));             \
         cop = PMIX_NEW(prte_oob_tcp_conn_op_t);                                             \
         cop->peer = (p);                                                                    \
-        PMIX_THREADSHIFT(cop, prte_event_base, (cbfunc), PRTE_MSG_PRI);                     \
+        PMIX_THREADSHIFT(cop, (p)->ev_base, (cbfunc), PRTE_MSG_PRI);                        \
     } while (0);
 
 #define PRTE_ACTIVATE_TCP_ACCEPT_STATE(s, a, cbfunc)                               \
@@ -82,7 +85,7 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_conn_op_t);
                             __FILE__, __LINE__, PRTE_NAME_PRINT((&(p)->name)));                   \
         cop = PMIX_NEW(prte_oob_tcp_conn_op_t);                                                   \
         cop->peer = (p);                                                                          \
-        prte_event_evtimer_set(prte_event_base, &cop->ev, (cbfunc), cop);                         \
+        prte_event_evtimer_set((p)->ev_base, &cop->ev, (cbfunc), cop);                            \
         PMIX_POST_OBJECT(cop);                                                                    \
         prte_event_evtimer_add(&cop->ev, (tv));                                                   \
     } while (0);
@@ -91,8 +94,10 @@ PRTE_MODULE_EXPORT void prte_oob_tcp_peer_try_connect(int fd, short args, void *
 PRTE_MODULE_EXPORT void prte_oob_tcp_peer_dump(prte_oob_tcp_peer_t *peer, const char *msg);
 PRTE_MODULE_EXPORT bool prte_oob_tcp_peer_accept(prte_oob_tcp_peer_t *peer);
 PRTE_MODULE_EXPORT void prte_oob_tcp_peer_complete_connect(prte_oob_tcp_peer_t *peer);
-PRTE_MODULE_EXPORT int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *peer, int sd,
-                                                          prte_oob_tcp_hdr_t *dhdr);
+PRTE_MODULE_EXPORT int prte_oob_tcp_peer_recv_connect_ack(prte_oob_tcp_peer_t *peer, int sd);
+PRTE_MODULE_EXPORT int prte_oob_tcp_peer_recv_ident_hdr(int sd, prte_oob_tcp_hdr_t *hdr, char **msg);
+PRTE_MODULE_EXPORT int prte_oob_tcp_peer_recv_ident(prte_oob_tcp_peer_t *peer, int sd, char *msg,
+                                                    size_t nbytes);
 PRTE_MODULE_EXPORT void prte_oob_tcp_peer_close(prte_oob_tcp_peer_t *peer);
 
 #endif /* _MCA_OOB_TCP_CONNECTION_H_ */
@@ -86,4 +86,39 @@ typedef struct {
     (h)->tag = PRTE_RML_TAG_HTON((h)->tag);     \
     (h)->nbytes = htonl((h)->nbytes);
 
+/* capabilities advertised in the connection handshake */
+#define MCA_OOB_TCP_CAP_COMPACT 0x00000001
+
+/* flags carried in the compact header */
+#define MCA_OOB_TCP_CHDR_EXTENDED 0x01 // full origin/dst procs follow the header
+
+/* max number of nspaces that can be referenced by index
+ * from a compact header */
+#define MCA_OOB_TCP_MAX_NSIDX 255
+
+/* compact header used once both sides of a connection have
+ * agreed to it during the handshake. Procs are identified by
+ * rank, and their nspace by an index into the table the sender
+ * of the header advertised in its connect ack. Messages whose
+ * procs cannot be described that way set the EXTENDED flag and
+ * follow the header with the full origin and dst pmix_proc_t */
+typedef struct {
+    uint32_t origin;     // rank of the originator
+    uint32_t dst;        // rank of the final recipient
+    prte_rml_tag_t tag;  // rml tag
+    uint32_t seq_num;    // seq number of this message
+    uint32_t nbytes;     // number of bytes in message
+    uint8_t origin_ns;   // index of the origin nspace
+    uint8_t dst_ns;      // index of the dst nspace
+    uint8_t flags;
+    prte_oob_tcp_msg_type_t type; // type of message
+} prte_oob_tcp_chdr_t;
+
+/* compact header plus room for the extended proc info */
+typedef struct {
+    prte_oob_tcp_chdr_t hdr;
+    pmix_proc_t origin;
+    pmix_proc_t dst;
+} prte_oob_tcp_xhdr_t;
+
 #endif /* _MCA_OOB_TCP_HDR_H_ */
@@ -58,6 +58,8 @@ typedef struct {
     prte_oob_tcp_addr_t *active_addr;
     prte_oob_tcp_state_t state;
     int num_retries;
+    prte_event_base_t *ev_base; /**< event base progressing this peer */
+    prte_oob_tcp_io_t *io;      /**< progress thread behind it, NULL if the PRTE event base */
     prte_event_t send_event; /**< registration with event thread for send events */
     bool send_ev_active;
     prte_event_t recv_event; /**< registration with event thread for recv events */
@@ -67,6 +69,8 @@ typedef struct {
     pmix_list_t send_queue;        /**< list of messages to send */
     prte_oob_tcp_send_t *send_msg; /**< current send in progress */
     prte_oob_tcp_recv_t *recv_msg; /**< current recv in progress */
+    bool compact;                  /**< use the compact header on this connection */
+    char **nspaces;                /**< nspace table advertised by the peer */
 } prte_oob_tcp_peer_t;
 PMIX_CLASS_DECLARATION(prte_oob_tcp_peer_t);
 
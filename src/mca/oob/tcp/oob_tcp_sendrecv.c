@@ -59,14 +59,17 @@
 #include "src/event/event-internal.h"
 #include "src/mca/prtebacktrace/prtebacktrace.h"
 #include "src/util/error.h"
+#include "src/util/pmix_argv.h"
 #include "src/util/pmix_net.h"
 #include "src/util/pmix_output.h"
+#include "src/util/pmix_printf.h"
 #include "types.h"
 
 #include "src/mca/errmgr/errmgr.h"
 #include "src/mca/ess/ess.h"
 #include "src/mca/state/state.h"
 #include "src/runtime/prte_globals.h"
+#include "src/runtime/prte_progress_threads.h"
 #include "src/runtime/prte_wait.h"
 #include "src/threads/pmix_threads.h"
 #include "src/util/name_fns.h"
@@ -87,6 +90,10 @@ void prte_oob_tcp_queue_msg(int sd, short args, void *cbdata)
     PMIX_ACQUIRE_OBJECT(snd);
     peer = (prte_oob_tcp_peer_t *) snd->peer;
 
+    if (NULL != peer->io) {
+        prte_oob_tcp_delay_record(&peer->io->to_io, &snd->queued);
+    }
+
     /* if there is no message on-deck, put this one there */
     if (NULL == peer->send_msg) {
         peer->send_msg = snd;
@@ -95,26 +102,115 @@ void prte_oob_tcp_queue_msg(int sd, short args, void *cbdata)
         pmix_list_append(&peer->send_queue, &snd->super);
     }
     if (snd->activate) {
-        /* if we aren't connected, then start connecting */
-        if (MCA_OOB_TCP_CONNECTED != peer->state) {
-            peer->state = MCA_OOB_TCP_CONNECTING;
-            PRTE_ACTIVATE_TCP_CONN_STATE(peer, prte_oob_tcp_peer_try_connect);
-        } else {
+        if (MCA_OOB_TCP_CONNECTED == peer->state) {
             /* ensure the send event is active */
             if (!peer->send_ev_active) {
                 peer->send_ev_active = true;
                 PMIX_POST_OBJECT(peer);
                 prte_event_add(&peer->send_event, 0);
             }
+        } else if (MCA_OOB_TCP_CONNECTING != peer->state
+                   && MCA_OOB_TCP_CONNECT_ACK != peer->state) {
+            /* start connecting - the message goes out once
+             * the connection completes */
+            peer->state = MCA_OOB_TCP_CONNECTING;
+            PRTE_ACTIVATE_TCP_CONN_STATE(peer, prte_oob_tcp_peer_try_connect);
         }
     }
 }
 
+/* tell the RML that a send completed - a peer progressed by a
+ * thread of its own hands that to the PRTE event base */
+static void send_complete(prte_oob_tcp_peer_t *peer, prte_rml_send_t *msg)
+{
+    if (NULL == peer->io) {
+        PRTE_RML_SEND_COMPLETE(msg);
+    } else {
+        prte_oob_tcp_handoff(peer->io, NULL, msg);
+    }
+}
+
+/* pass a message that is for us to the RML */
+static void deliver(prte_oob_tcp_peer_t *peer, prte_oob_tcp_recv_t *rmsg)
+{
+    prte_rml_recv_t *msg;
+    pmix_byte_object_t bo;
+    pmix_status_t rc;
+
+    if (NULL == peer->io) {
+        PRTE_RML_POST_MESSAGE(&rmsg->hdr.origin, rmsg->hdr.tag, rmsg->hdr.seq_num, rmsg->data,
+                              rmsg->hdr.nbytes);
+        return;
+    }
+
+    msg = PMIX_NEW(prte_rml_recv_t);
+    PMIX_XFER_PROCID(&msg->sender, &rmsg->hdr.origin);
+    msg->tag = rmsg->hdr.tag;
+    msg->seq_num = rmsg->hdr.seq_num;
+    bo.bytes = rmsg->data;
+    bo.size = rmsg->hdr.nbytes;
+    rc = PMIx_Data_load(&msg->dbuf, &bo);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+    }
+    prte_oob_tcp_handoff(peer->io, msg, NULL);
+}
+
+/* index of an nspace in the table we advertise in our connect
+ * ack, or -1 if it isn't in there */
+static int nspace_index(const pmix_nspace_t nspace)
+{
+    if (0 == strncmp(nspace, PRTE_PROC_MY_NAME->nspace, PMIX_MAX_NSLEN)) {
+        return 0;
+    }
+    return -1;
+}
+
+/* switch a message that has not yet started transmission over to
+ * the compact header. The full header is already in network byte
+ * order, so the rank, tag and size fields can be copied as-is */
+static void compact_hdr(prte_oob_tcp_send_t *msg)
+{
+    prte_oob_tcp_chdr_t *c = &msg->xhdr.hdr;
+    int oidx, didx;
+
+    c->origin = msg->hdr.origin.rank;
+    c->dst = msg->hdr.dst.rank;
+    c->tag = msg->hdr.tag;
+    c->seq_num = htonl(msg->hdr.seq_num);
+    c->nbytes = msg->hdr.nbytes;
+    c->flags = 0;
+    c->type = msg->hdr.type;
+
+    oidx = nspace_index(msg->hdr.origin.nspace);
+    didx = nspace_index(msg->hdr.dst.nspace);
+    if (0 <= oidx && 0 <= didx) {
+        c->origin_ns = (uint8_t) oidx;
+        c->dst_ns = (uint8_t) didx;
+        msg->sdbytes = sizeof(prte_oob_tcp_chdr_t);
+    } else {
+        c->origin_ns = 0;
+        c->dst_ns = 0;
+        c->flags |= MCA_OOB_TCP_CHDR_EXTENDED;
+        msg->xhdr.origin = msg->hdr.origin;
+        msg->xhdr.dst = msg->hdr.dst;
+        msg->sdbytes = sizeof(prte_oob_tcp_xhdr_t);
+    }
+    msg->sdptr = (char *) &msg->xhdr;
+}
+
 static int send_msg(prte_oob_tcp_peer_t *peer, prte_oob_tcp_send_t *msg)
 {
     struct iovec iov[2];
     int iov_count, retries = 0;
-    ssize_t remain = msg->sdbytes, rc;
+    ssize_t remain, rc;
+
+    /* use the compact header if the peer agreed to it and
+     * we haven't started sending the full one */
+    if (peer->compact && !msg->hdr_sent && msg->sdptr == (char *) &msg->hdr) {
+        compact_hdr(msg);
+    }
+    remain = msg->sdbytes;
 
     iov[0].iov_base = msg->sdptr;
     iov[0].iov_len = msg->sdbytes;
@@ -124,7 +220,7 @@ static int send_msg(prte_oob_tcp_peer_t *peer, prte_oob_tcp_send_t *msg)
             iov[1].iov_base = msg->data;
         } else {
             /* buffer send */
-            iov[1].iov_base = msg->msg->dbuf.base_ptr;
+            iov[1].iov_base = PRTE_RML_SEND_DATA(msg->msg);
         }
         iov[1].iov_len = ntohl(msg->hdr.nbytes);
         remain += ntohl(msg->hdr.nbytes);
@@ -248,7 +344,7 @@ void prte_oob_tcp_send_handler(int sd, short flags, void *cbdata)
                                         PRTE_NAME_PRINT(&(peer->name)),
                                         (int) ntohl(msg->hdr.nbytes), peer->sd);
                     msg->msg->status = PRTE_SUCCESS;
-                    PRTE_RML_SEND_COMPLETE(msg->msg);
+                    send_complete(peer, msg->msg);
                     PMIX_RELEASE(msg);
                     peer->send_msg = NULL;
                 }
@@ -263,7 +359,7 @@ void prte_oob_tcp_send_handler(int sd, short flags, void *cbdata)
                     PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&(peer->name)), peer->sd);
                 prte_event_del(&peer->send_event);
                 msg->msg->status = rc;
-                PRTE_RML_SEND_COMPLETE(msg->msg);
+                send_complete(peer, msg->msg);
                 PMIX_RELEASE(msg);
                 peer->send_msg = NULL;
                 PRTE_ACTIVATE_JOB_STATE(NULL, PRTE_JOB_STATE_COMM_FAILED);
@@ -373,6 +469,59 @@ static int read_bytes(prte_oob_tcp_peer_t *peer)
     return PRTE_SUCCESS;
 }
 
+/* read the message header and leave it in host byte order in
+ * the recv's hdr field. On connections using the compact header,
+ * the full header is reconstructed from it and the nspace table
+ * the peer sent in its connect ack */
+static int read_hdr(prte_oob_tcp_peer_t *peer)
+{
+    prte_oob_tcp_recv_t *rcv = peer->recv_msg;
+    prte_oob_tcp_chdr_t *c = &rcv->xhdr.hdr;
+    int rc, nns;
+
+    if (PRTE_SUCCESS != (rc = read_bytes(peer))) {
+        return rc;
+    }
+    if (!peer->compact) {
+        MCA_OOB_TCP_HDR_NTOH(&rcv->hdr);
+        return PRTE_SUCCESS;
+    }
+
+    if (!rcv->xhdr_recvd) {
+        rcv->xhdr_recvd = true;
+        if (MCA_OOB_TCP_CHDR_EXTENDED & c->flags) {
+            /* the full procs follow */
+            rcv->rdptr = (char *) &rcv->xhdr.origin;
+            rcv->rdbytes = 2 * sizeof(pmix_proc_t);
+            if (PRTE_SUCCESS != (rc = read_bytes(peer))) {
+                return rc;
+            }
+        }
+    }
+
+    if (MCA_OOB_TCP_CHDR_EXTENDED & c->flags) {
+        PMIX_XFER_PROCID(&rcv->hdr.origin, &rcv->xhdr.origin);
+        PMIX_XFER_PROCID(&rcv->hdr.dst, &rcv->xhdr.dst);
+    } else {
+        nns = pmix_argv_count(peer->nspaces);
+        if (c->origin_ns >= nns || c->dst_ns >= nns) {
+            pmix_output(0, "%s-%s prte_oob_tcp_recv: unknown nspace index %u/%u",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&peer->name),
+                        c->origin_ns, c->dst_ns);
+            return PRTE_ERR_COMM_FAILURE;
+        }
+        PMIX_LOAD_NSPACE(rcv->hdr.origin.nspace, peer->nspaces[c->origin_ns]);
+        PMIX_LOAD_NSPACE(rcv->hdr.dst.nspace, peer->nspaces[c->dst_ns]);
+    }
+    rcv->hdr.origin.rank = ntohl(c->origin);
+    rcv->hdr.dst.rank = ntohl(c->dst);
+    rcv->hdr.tag = PRTE_RML_TAG_NTOH(c->tag);
+    rcv->hdr.seq_num = ntohl(c->seq_num);
+    rcv->hdr.nbytes = ntohl(c->nbytes);
+    rcv->hdr.type = c->type;
+    return PRTE_SUCCESS;
+}
+
 /*
  * Dispatch to the appropriate action routine based on the state
  * of the connection with the peer.
@@ -393,7 +542,7 @@ void prte_oob_tcp_recv_handler(int sd, short flags, void *cbdata)
 
     switch (peer->state) {
     case MCA_OOB_TCP_CONNECT_ACK:
-        if (PRTE_SUCCESS == (rc = prte_oob_tcp_peer_recv_connect_ack(peer, peer->sd, NULL))) {
+        if (PRTE_SUCCESS == (rc = prte_oob_tcp_peer_recv_connect_ack(peer, peer->sd))) {
             pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
                                 "%s:tcp:recv:handler starting send/recv events",
                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
@@ -446,18 +595,21 @@ void prte_oob_tcp_recv_handler(int sd, short flags, void *cbdata)
                 return;
             }
             /* start by reading the header */
-            peer->recv_msg->rdptr = (char *) &peer->recv_msg->hdr;
-            peer->recv_msg->rdbytes = sizeof(prte_oob_tcp_hdr_t);
+            if (peer->compact) {
+                peer->recv_msg->rdptr = (char *) &peer->recv_msg->xhdr.hdr;
+                peer->recv_msg->rdbytes = sizeof(prte_oob_tcp_chdr_t);
+            } else {
+                peer->recv_msg->rdptr = (char *) &peer->recv_msg->hdr;
+                peer->recv_msg->rdbytes = sizeof(prte_oob_tcp_hdr_t);
+            }
         }
         /* if the header hasn't been completely read, read it */
         if (!peer->recv_msg->hdr_recvd) {
             pmix_output_verbose(OOB_TCP_DEBUG_CONNECT, prte_oob_base_framework.framework_output,
                                 "%s:tcp:recv:handler read hdr", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
-            if (PRTE_SUCCESS == (rc = read_bytes(peer))) {
+            if (PRTE_SUCCESS == (rc = read_hdr(peer))) {
                 /* completed reading the header */
                 peer->recv_msg->hdr_recvd = true;
-                /* convert the header */
-                MCA_OOB_TCP_HDR_NTOH(&peer->recv_msg->hdr);
                 /* if this is a zero-byte message, then we are done */
                 if (0 == peer->recv_msg->hdr.nbytes) {
                     pmix_output_verbose(OOB_TCP_DEBUG_CONNECT,
@@ -514,9 +666,7 @@ void prte_oob_tcp_recv_handler(int sd, short flags, void *cbdata)
                                         "%s DELIVERING TO RML tag = %d seq_num = %d",
                                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), peer->recv_msg->hdr.tag,
                                         peer->recv_msg->hdr.seq_num);
-                    PRTE_RML_POST_MESSAGE(&peer->recv_msg->hdr.origin, peer->recv_msg->hdr.tag,
-                                          peer->recv_msg->hdr.seq_num, peer->recv_msg->data,
-                                          peer->recv_msg->hdr.nbytes);
+                    deliver(peer, peer->recv_msg);
                     PMIX_RELEASE(peer->recv_msg);
                 } else {
                     /* promote this to the OOB as some other transport might
@@ -569,9 +719,174 @@ void prte_oob_tcp_recv_handler(int sd, short flags, void *cbdata)
     }
 }
 
+void prte_oob_tcp_delay_record(prte_oob_tcp_delay_t *delay, struct timeval *since)
+{
+    struct timeval now;
+    int64_t usec;
+
+    gettimeofday(&now, NULL);
+    usec = (int64_t) (now.tv_sec - since->tv_sec) * 1000000 + (now.tv_usec - since->tv_usec);
+    if (usec < 0) {
+        usec = 0;
+    }
+    ++delay->count;
+    delay->total += usec;
+    if (delay->max < (uint64_t) usec) {
+        delay->max = usec;
+    }
+}
+
+/* runs on the PRTE event base - take everything the thread queued */
+static void handoff_drain(int sd, short args, void *cbdata)
+{
+    prte_oob_tcp_io_t *io = (prte_oob_tcp_io_t *) cbdata;
+    prte_oob_tcp_slot_t slot;
+    uint32_t tail = io->tail;
+    int32_t armed;
+    PRTE_HIDE_UNUSED_PARAMS(sd, args);
+
+    for (;;) {
+        while (tail != io->head) {
+            /* read the slot only after the head that covers it */
+            PRTE_OOB_TCP_MB();
+            slot = io->ring[tail & io->mask];
+            ++tail;
+            /* finish copying the slot before giving it back - a
+             * write barrier would not hold back the load above */
+            PRTE_OOB_TCP_MB();
+            io->tail = tail;
+
+            prte_oob_tcp_delay_record(&io->to_main, &slot.queued);
+            if (NULL != slot.recv) {
+                prte_rml_base_process_msg(-1, PRTE_EV_WRITE, slot.recv);
+            } else {
+                PRTE_RML_SEND_COMPLETE(slot.send);
+            }
+        }
+        /* let the thread activate us again, then take whatever it
+         * queued before it could see that we were done */
+        armed = 1;
+        (void) pmix_atomic_compare_exchange_strong_32(&io->armed, &armed, 0);
+        /* the disarm has to be seen before we look at the head */
+        PRTE_OOB_TCP_MB();
+        if (tail == io->head) {
+            break;
+        }
+        armed = 0;
+        if (!pmix_atomic_compare_exchange_strong_32(&io->armed, &armed, 1)) {
+            /* it already did */
+            break;
+        }
+    }
+}
+
+/* runs on the thread - activate the drain unless it is pending */
+static void handoff_wake(prte_oob_tcp_io_t *io)
+{
+    int32_t armed = 0;
+
+    /* the head we published has to be seen before we look at armed */
+    PRTE_OOB_TCP_MB();
+    if (pmix_atomic_compare_exchange_strong_32(&io->armed, &armed, 1)) {
+        prte_event_active(&io->drain, PRTE_EV_WRITE, 1);
+    }
+}
+
+/* move held back messages into the ring, in order, as far as it
+ * has room - returns true if none are left */
+static bool handoff_fill(prte_oob_tcp_io_t *io)
+{
+    prte_oob_tcp_handoff_t *h;
+    uint32_t head = io->head;
+
+    while (!pmix_list_is_empty(&io->overflow) && head - io->tail <= io->mask) {
+        /* don't reuse the slot before the PRTE event base is done with it */
+        PRTE_OOB_TCP_MB();
+        h = (prte_oob_tcp_handoff_t *) pmix_list_remove_first(&io->overflow);
+        io->ring[head & io->mask] = h->slot;
+        ++head;
+        PMIX_RELEASE(h);
+    }
+    /* publish the slots before the head that covers them */
+    PRTE_OOB_TCP_MB();
+    io->head = head;
+    return pmix_list_is_empty(&io->overflow);
+}
+
+static void handoff_retry(int sd, short args, void *cbdata)
+{
+    prte_oob_tcp_io_t *io = (prte_oob_tcp_io_t *) cbdata;
+    struct timeval tv = {0, 1000};
+    PRTE_HIDE_UNUSED_PARAMS(sd, args);
+
+    io->retry_active = false;
+    if (!handoff_fill(io)) {
+        io->retry_active = true;
+        prte_event_evtimer_add(&io->retry, &tv);
+    }
+    handoff_wake(io);
+}
+
+void prte_oob_tcp_handoff(prte_oob_tcp_io_t *io, prte_rml_recv_t *recv, prte_rml_send_t *send)
+{
+    prte_oob_tcp_handoff_t *h;
+    prte_oob_tcp_slot_t *slot;
+    struct timeval tv = {0, 1000};
+
+    if (pmix_list_is_empty(&io->overflow) && io->head - io->tail <= io->mask) {
+        /* the tail we checked covers the slot we are about to reuse */
+        PRTE_OOB_TCP_MB();
+        slot = &io->ring[io->head & io->mask];
+        slot->recv = recv;
+        slot->send = send;
+        gettimeofday(&slot->queued, NULL);
+        PRTE_OOB_TCP_MB();
+        ++io->head;
+    } else {
+        /* the ring is full - keep it behind any others held back
+         * and move them along as the PRTE event base makes room */
+        h = PMIX_NEW(prte_oob_tcp_handoff_t);
+        h->slot.recv = recv;
+        h->slot.send = send;
+        gettimeofday(&h->slot.queued, NULL);
+        pmix_list_append(&io->overflow, &h->super);
+        ++io->held;
+        if (!handoff_fill(io) && !io->retry_active) {
+            io->retry_active = true;
+            prte_event_evtimer_add(&io->retry, &tv);
+        }
+    }
+    handoff_wake(io);
+}
+
+int prte_oob_tcp_io_start(prte_oob_tcp_io_t *io, int idx)
+{
+    uint32_t size = 1;
+
+    while (size < (uint32_t) prte_mca_oob_tcp_component.handoff_size) {
+        size <<= 1;
+    }
+    io->ring = (prte_oob_tcp_slot_t *) calloc(size, sizeof(prte_oob_tcp_slot_t));
+    if (NULL == io->ring) {
+        return PRTE_ERR_OUT_OF_RESOURCE;
+    }
+    io->mask = size - 1;
+
+    pmix_asprintf(&io->name, "PRTE-OOB-TCP-%d", idx);
+    io->ev_base = prte_progress_thread_init(io->name);
+    if (NULL == io->ev_base) {
+        return PRTE_ERR_OUT_OF_RESOURCE;
+    }
+    prte_event_set(prte_event_base, &io->drain, -1, PRTE_EV_WRITE, handoff_drain, io);
+    prte_event_set_priority(&io->drain, PRTE_MSG_PRI);
+    prte_event_evtimer_set(io->ev_base, &io->retry, handoff_retry, io);
+    return PRTE_SUCCESS;
+}
+
 static void snd_cons(prte_oob_tcp_send_t *ptr)
 {
     memset(&ptr->hdr, 0, sizeof(prte_oob_tcp_hdr_t));
+    memset(&ptr->xhdr, 0, sizeof(prte_oob_tcp_xhdr_t));
     ptr->msg = NULL;
     ptr->data = NULL;
     ptr->hdr_sent = false;
@@ -596,6 +911,8 @@ PMIX_CLASS_INSTANCE(prte_oob_tcp_send_t, pmix_list_item_t, snd_cons, snd_des);
 static void rcv_cons(prte_oob_tcp_recv_t *ptr)
 {
     memset(&ptr->hdr, 0, sizeof(prte_oob_tcp_hdr_t));
+    memset(&ptr->xhdr, 0, sizeof(prte_oob_tcp_xhdr_t));
+    ptr->xhdr_recvd = false;
     ptr->hdr_recvd = false;
     ptr->rdptr = NULL;
     ptr->rdbytes = 0;
@@ -608,3 +925,58 @@ static void err_cons(prte_oob_tcp_msg_error_t *ptr)
     ptr->snd = NULL;
 }
 PMIX_CLASS_INSTANCE(prte_oob_tcp_msg_error_t, pmix_object_t, err_cons, NULL);
+
+PMIX_CLASS_INSTANCE(prte_oob_tcp_handoff_t, pmix_list_item_t, NULL, NULL);
+
+/* drop a message that never made it to the PRTE event base */
+static void drop(prte_oob_tcp_slot_t *slot)
+{
+    if (NULL != slot->recv) {
+        PMIX_RELEASE(slot->recv);
+    } else if (NULL != slot->send) {
+        PMIX_RELEASE(slot->send);
+    }
+}
+
+static void io_cons(prte_oob_tcp_io_t *io)
+{
+    io->name = NULL;
+    io->ev_base = NULL;
+    io->ring = NULL;
+    io->mask = 0;
+    io->head = 0;
+    io->tail = 0;
+    io->armed = 0;
+    PMIX_CONSTRUCT(&io->overflow, pmix_list_t);
+    io->retry_active = false;
+    memset(&io->to_main, 0, sizeof(prte_oob_tcp_delay_t));
+    memset(&io->to_io, 0, sizeof(prte_oob_tcp_delay_t));
+    io->held = 0;
+}
+static void io_des(prte_oob_tcp_io_t *io)
+{
+    prte_oob_tcp_handoff_t *h;
+
+    if (NULL != io->ev_base) {
+        prte_event_del(&io->drain);
+        if (io->retry_active) {
+            prte_event_del(&io->retry);
+        }
+        prte_progress_thread_finalize(io->name);
+    }
+    for (; io->tail != io->head; io->tail++) {
+        drop(&io->ring[io->tail & io->mask]);
+    }
+    while (NULL != (h = (prte_oob_tcp_handoff_t *) pmix_list_remove_first(&io->overflow))) {
+        drop(&h->slot);
+        PMIX_RELEASE(h);
+    }
+    PMIX_DESTRUCT(&io->overflow);
+    if (NULL != io->ring) {
+        free(io->ring);
+    }
+    if (NULL != io->name) {
+        free(io->name);
+    }
+}
+PMIX_CLASS_INSTANCE(prte_oob_tcp_io_t, pmix_object_t, io_cons, io_des);
@@ -28,7 +28,12 @@
 
 #include "prte_config.h"
 
+#ifdef HAVE_SYS_TIME_H
+#    include <sys/time.h>
+#endif
+
 #include "src/class/pmix_list.h"
+#include "src/include/pmix_atomic.h"
 #include "src/util/pmix_string_copy.h"
 
 #include "oob_tcp.h"
@@ -46,12 +51,14 @@ typedef struct {
     struct prte_oob_tcp_peer_t *peer;
     bool activate;
     prte_oob_tcp_hdr_t hdr;
+    prte_oob_tcp_xhdr_t xhdr; // compact form of hdr, if negotiated with the peer
     prte_rml_send_t *msg;
     char *data;
     bool hdr_sent;
     int iovnum;
     char *sdptr;
     size_t sdbytes;
+    struct timeval queued; // when it was handed to the peer's event base
 } prte_oob_tcp_send_t;
 PMIX_CLASS_DECLARATION(prte_oob_tcp_send_t);
 
@@ -59,6 +66,8 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_send_t);
 typedef struct {
     pmix_list_item_t super;
     prte_oob_tcp_hdr_t hdr;
+    prte_oob_tcp_xhdr_t xhdr; // compact header as read from the wire
+    bool xhdr_recvd;          // compact header complete, extended procs pending
     bool hdr_recvd;
     char *data;
     char *rdptr;
@@ -66,6 +75,61 @@ typedef struct {
 } prte_oob_tcp_recv_t;
 PMIX_CLASS_DECLARATION(prte_oob_tcp_recv_t);
 
+/* time messages spent waiting to be picked up after a handoff
+ * between event bases */
+typedef struct {
+    uint64_t count;
+    uint64_t total; // usec
+    uint64_t max;   // usec
+} prte_oob_tcp_delay_t;
+
+/* a message on its way from a progress thread to the PRTE
+ * event base - either one for us to deliver, or a send that
+ * completed */
+typedef struct {
+    prte_rml_recv_t *recv;
+    prte_rml_send_t *send;
+    struct timeval queued;
+} prte_oob_tcp_slot_t;
+
+/* one held back because the ring was full */
+typedef struct {
+    pmix_list_item_t super;
+    prte_oob_tcp_slot_t slot;
+} prte_oob_tcp_handoff_t;
+PMIX_CLASS_DECLARATION(prte_oob_tcp_handoff_t);
+
+/* full barrier for the ring indices - the PMIx atomics only offer
+ * the read and write halves, and neither orders a load against a
+ * later store */
+#define PRTE_OOB_TCP_MB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* a progress thread dedicated to the I/O of a share of the peers.
+ * Messages it completes go to the PRTE event base through a ring
+ * that only the thread fills and only the PRTE event base drains,
+ * so passing them takes no lock - the thread advances head, the
+ * PRTE event base advances tail, and the drain event is only
+ * activated when it isn't already pending */
+typedef struct {
+    pmix_object_t super;
+    char *name;                  // name of the progress thread
+    prte_event_base_t *ev_base;  // its event base
+    prte_oob_tcp_slot_t *ring;
+    uint32_t mask;               // ring size - 1
+    volatile uint32_t head;      // next slot the thread fills
+    volatile uint32_t tail;      // next slot the PRTE event base drains
+    pmix_atomic_int32_t armed;   // drain is active and hasn't run yet
+    prte_event_t drain;          // empties the ring on the PRTE event base
+    pmix_list_t overflow;        // held back in order until the ring has room
+    prte_event_t retry;          // timer on the thread to move them in
+    bool retry_active;
+    /* instrumentation */
+    prte_oob_tcp_delay_t to_main; // thread -> PRTE event base, updated by the latter
+    prte_oob_tcp_delay_t to_io;   // PRTE event base -> thread, updated by the thread
+    uint64_t held;                // messages that found the ring full
+} prte_oob_tcp_io_t;
+PMIX_CLASS_DECLARATION(prte_oob_tcp_io_t);
+
 /* Queue a message to be sent to a specified peer. The macro
  * checks to see if a message is already in position to be
  * sent - if it is, then the message provided is simply added
@@ -86,7 +150,8 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_recv_t);
     do {                                                                              \
         (s)->peer = (struct prte_oob_tcp_peer_t *) (p);                               \
         (s)->activate = (f);                                                          \
-        PMIX_THREADSHIFT((s), prte_event_base, prte_oob_tcp_queue_msg, PRTE_MSG_PRI); \
+        gettimeofday(&(s)->queued, NULL);                                             \
+        PMIX_THREADSHIFT((s), (p)->ev_base, prte_oob_tcp_queue_msg, PRTE_MSG_PRI);    \
     } while (0)
 
 /* queue a message to be sent by one of our modules - must
@@ -111,7 +176,7 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_recv_t);
         /* point to the actual message */                                                      \
         _s->msg = (m);                                                                         \
         /* set the total number of bytes to be sent */                                         \
-        _s->hdr.nbytes = (m)->dbuf.bytes_used;                                                 \
+        _s->hdr.nbytes = PRTE_RML_SEND_SIZE(m);                                                \
         /* prep header for xmission */                                                         \
         MCA_OOB_TCP_HDR_HTON(&_s->hdr);                                                        \
         /* start the send with the header */                                                   \
@@ -143,7 +208,7 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_recv_t);
         /* point to the actual message */                                                         \
         _s->msg = (m);                                                                            \
         /* set the total number of bytes to be sent */                                            \
-        _s->hdr.nbytes = (m)->dbuf.bytes_used;                                                    \
+        _s->hdr.nbytes = PRTE_RML_SEND_SIZE(m);                                                   \
         /* prep header for xmission */                                                            \
         MCA_OOB_TCP_HDR_HTON(&_s->hdr);                                                           \
         /* start the send with the header */                                                      \
@@ -260,4 +325,16 @@ PMIX_CLASS_DECLARATION(prte_oob_tcp_msg_error_t);
         PMIX_THREADSHIFT(mop, prte_event_base, (c), PRTE_MSG_PRI);                                \
     } while (0)
 
+/* start the progress thread of an I/O object and set up its ring */
+PRTE_MODULE_EXPORT int prte_oob_tcp_io_start(prte_oob_tcp_io_t *io, int idx);
+
+/* hand a message for us, or a completed send, from the progress
+ * thread of io to the PRTE event base - must be called on that thread */
+PRTE_MODULE_EXPORT void prte_oob_tcp_handoff(prte_oob_tcp_io_t *io, prte_rml_recv_t *recv,
+                                             prte_rml_send_t *send);
+
+/* account for a message that waited since the given time */
+PRTE_MODULE_EXPORT void prte_oob_tcp_delay_record(prte_oob_tcp_delay_t *delay,
+                                                  struct timeval *since);
+
 #endif /* _MCA_OOB_TCP_SENDRECV_H_ */
@@ -1194,8 +1194,15 @@ void prte_plm_base_daemon_topology(int status, pmix_proc_t *sender,
     ptopo.topology = NULL;
     PMIX_TOPOLOGY_DESTRUCT(&ptopo);
     PMIX_DATA_BUFFER_DESTRUCT(data);
-    /* record the final topology */
-    t->topo = topo;
+    if (NULL != t->topo) {
+        /* another daemon with this signature already answered */
+        hwloc_topology_destroy(topo);
+        topo = t->topo;
+    } else {
+        /* record the final topology */
+        t->topo = topo;
+        prte_plm_base_topo_cache_store(t);
+    }
     /* update the node's available processors */
     if (NULL != daemon->node->available) {
         hwloc_bitmap_free(daemon->node->available);
@@ -1473,6 +1480,18 @@ void prte_plm_base_daemon_callback(int status, pmix_proc_t *sender, pmix_data_bu
             if (0 == strcmp(sig, mytopo->sig)) {
                 PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
                 topo = mytopo->topo;
+            } else if (0 == pbo.size) {
+                /* the daemon found its signature in the list of
+                 * topologies we loaded from our cache */
+                t = prte_plm_base_topo_cache_find(sig);
+                if (NULL == t) {
+                    pmix_output(0, "%s daemon %s did not send topology %s and it is not in the cache %s",
+                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&dname),
+                                sig, (NULL == prte_topo_cache_dir) ? "NULL" : prte_topo_cache_dir);
+                    prted_failed_launch = true;
+                    goto CLEANUP;
+                }
+                topo = t->topo;
             } else {
                 if (compressed) {
                     /* decompress the data */
@@ -1603,9 +1622,14 @@ void prte_plm_base_daemon_callback(int status, pmix_proc_t *sender, pmix_data_bu
                     if (1 == dname.rank) {
                         /* we will have received its topology */
                         t->topo = topo;
+                        prte_plm_base_topo_cache_store(t);
                     } else {
                         break;
                     }
+                } else if (NULL != topo && topo != t->topo) {
+                    /* daemon1 sent a topology we already hold */
+                    hwloc_topology_destroy(topo);
+                    topo = t->topo;
                 }
                 /* update the node's available processors */
                 if (NULL != daemon->node->available) {
@@ -1617,6 +1641,26 @@ void prte_plm_base_daemon_callback(int status, pmix_proc_t *sender, pmix_data_bu
             }
         }
 
+        if (!found) {
+            /* signature not found - record it */
+            PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
+                                 "%s NEW TOPOLOGY - ADDING SIGNATURE",
+                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
+            t = PMIX_NEW(prte_topology_t);
+            t->sig = sig;
+            t->index = pmix_pointer_array_add(prte_node_topologies, t);
+            daemon->node->topology = t;
+            if (1 == dname.rank) {
+                /* we received its topology */
+                t->topo = topo;
+                if (NULL != daemon->node->available) {
+                    hwloc_bitmap_free(daemon->node->available);
+                }
+                daemon->node->available = prte_hwloc_base_filter_cpus(topo);
+                prte_plm_base_topo_cache_store(t);
+            }
+        }
+
         if (1 == dname.rank) {
             /* process any cached daemons */
             PMIX_CONSTRUCT(&cachelist, pmix_list_t);
@@ -1625,7 +1669,7 @@ void prte_plm_base_daemon_callback(int status, pmix_proc_t *sender, pmix_data_bu
                                      "%s plm:base:prted_daemon_cback processing cached daemon %s",
                                      PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
                                      PRTE_NAME_PRINT(&dptr->name)));
-                if (0 == strcmp(dptr->node->topology->sig, sig)) {
+                if (0 == strcmp(dptr->node->topology->sig, t->sig)) {
                     dptr->node->topology = t;
                     dptr->node->available = prte_hwloc_base_filter_cpus(topo);
                     jdatorted->num_reported++;
@@ -1674,16 +1718,6 @@ void prte_plm_base_daemon_callback(int status, pmix_proc_t *sender, pmix_data_bu
             PMIX_DESTRUCT(&cachelist);
         }
 
-        if (!found) {
-            /* signature not found - record it */
-            PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
-                                 "%s NEW TOPOLOGY - ADDING SIGNATURE",
-                                 PRTE_NAME_PRINT(PRTE_PROC_MY_NAME)));
-            t = PMIX_NEW(prte_topology_t);
-            t->sig = sig;
-            t->index = pmix_pointer_array_add(prte_node_topologies, t);
-            daemon->node->topology = t;
-        }
         if (!prte_plm_globals.daemon1_has_reported) {
             if (NULL == daemon->node->topology->topo) {
                 /* if daemon1 has not reported and the topology is
@@ -1965,6 +1999,15 @@ int prte_plm_base_prted_append_basic_args(int *argc, char ***argv, char *ess, in
         pmix_argv_append(argc, argv, prte_xterm);
     }
 
+    /* tell the daemons which topologies we already have so
+     * they need not send them */
+    if (PRTE_PROC_IS_MASTER && NULL != (param = prte_plm_base_topo_cache_known())) {
+        pmix_argv_append(argc, argv, "--prtemca");
+        pmix_argv_append(argc, argv, "prte_known_topologies");
+        pmix_argv_append(argc, argv, param);
+        free(param);
+    }
+
     /* look for any envars that relate to us and pass
      * them along on the cmd line */
     offset = strlen("PRTE_MCA_");
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2021-2022 Nanook Consulting.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Persistent cache of the topologies reported by the daemons. Each
+ * topology is kept in its own file in the prte_topo_cache_dir
+ * directory, named by the hash of its signature:
+ *
+ *     PRTE-TOPOLOGY-CACHE 1
+ *     <signature>
+ *     <hash of the XML> <length of the XML>
+ *     <XML>
+ *
+ * An entry is only accepted if the XML matches its hash and the
+ * topology it describes regenerates the recorded signature.
+ */
+
+#include "prte_config.h"
+#include "constants.h"
+
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_SYS_STAT_H
+#    include <sys/stat.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#endif
+
+#include "src/hwloc/hwloc-internal.h"
+#include "src/mca/errmgr/errmgr.h"
+#include "src/runtime/prte_globals.h"
+#include "src/util/name_fns.h"
+#include "src/util/pmix_argv.h"
+#include "src/util/pmix_os_dirpath.h"
+#include "src/util/pmix_os_path.h"
+#include "src/util/pmix_output.h"
+#include "src/util/pmix_printf.h"
+#include "src/util/proc_info.h"
+
+#include "src/mca/plm/base/base.h"
+#include "src/mca/plm/base/plm_private.h"
+
+#define PRTE_TOPO_CACHE_MAGIC  "PRTE-TOPOLOGY-CACHE 1"
+#define PRTE_TOPO_CACHE_SUFFIX ".topo"
+
+static char *entry_name(const char *sig)
+{
+    char *name;
+
+    pmix_asprintf(&name, "%016" PRIx64 PRTE_TOPO_CACHE_SUFFIX,
+                  prte_hwloc_base_topo_hash(sig, strlen(sig)));
+    return name;
+}
+
+static prte_topology_t *find_sig(const char *sig)
+{
+    prte_topology_t *t;
+    int i;
+
+    for (i = 0; i < prte_node_topologies->size; i++) {
+        t = (prte_topology_t *) pmix_pointer_array_get_item(prte_node_topologies, i);
+        if (NULL != t && 0 == strcmp(sig, t->sig)) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+/* read the file and return the signature and an XML topology that
+ * matches its recorded hash */
+static int read_entry(const char *path, char **sig, char **xml, size_t *xmllen)
+{
+    FILE *fp;
+    char *buf = NULL, *line, *eol;
+    long size;
+    uint64_t hash;
+    size_t len;
+    int rc = PRTE_ERR_BAD_PARAM;
+
+    fp = fopen(path, "r");
+    if (NULL == fp) {
+        return PRTE_ERR_FILE_OPEN_FAILURE;
+    }
+    if (0 != fseek(fp, 0, SEEK_END) || 0 >= (size = ftell(fp)) || 0 != fseek(fp, 0, SEEK_SET)) {
+        goto done;
+    }
+    buf = (char *) malloc(size + 1);
+    if (NULL == buf || (size_t) size != fread(buf, 1, size, fp)) {
+        goto done;
+    }
+    buf[size] = '\0';
+
+    /* magic */
+    line = buf;
+    if (NULL == (eol = strchr(line, '\n'))) {
+        goto done;
+    }
+    *eol = '\0';
+    if (0 != strcmp(line, PRTE_TOPO_CACHE_MAGIC)) {
+        goto done;
+    }
+    /* signature */
+    line = eol + 1;
+    if (NULL == (eol = strchr(line, '\n'))) {
+        goto done;
+    }
+    *eol = '\0';
+    *sig = strdup(line);
+    /* hash and length of the XML */
+    line = eol + 1;
+    if (NULL == (eol = strchr(line, '\n'))) {
+        goto done;
+    }
+    *eol = '\0';
+    if (2 != sscanf(line, "%" SCNx64 " %zu", &hash, &len)) {
+        goto done;
+    }
+    line = eol + 1;
+    if (len != (size_t) (buf + size - line) || hash != prte_hwloc_base_topo_hash(line, len)) {
+        goto done;
+    }
+    *xml = strdup(line);
+    *xmllen = len;
+    rc = PRTE_SUCCESS;
+
+done:
+    fclose(fp);
+    if (NULL != buf) {
+        free(buf);
+    }
+    if (PRTE_SUCCESS != rc && NULL != *sig) {
+        free(*sig);
+        *sig = NULL;
+    }
+    return rc;
+}
+
+static int load_entry(const char *path)
+{
+    char *sig = NULL, *xml = NULL, *check;
+    size_t len;
+    hwloc_topology_t topo;
+    prte_topology_t *t;
+    int rc;
+
+    rc = read_entry(path, &sig, &xml, &len);
+    if (PRTE_SUCCESS != rc) {
+        PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
+                             "%s plm:base:topo_cache ignoring corrupt entry %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), path));
+        return rc;
+    }
+    if (NULL != find_sig(sig)) {
+        free(sig);
+        free(xml);
+        return PRTE_SUCCESS;
+    }
+
+    /* import it the way it is imported when reported by a daemon */
+    if (0 != hwloc_topology_init(&topo)) {
+        free(sig);
+        free(xml);
+        return PRTE_ERR_NOT_SUPPORTED;
+    }
+    if (0 != hwloc_topology_set_xmlbuffer(topo, xml, len + 1)
+        || 0 != prte_hwloc_base_topology_set_flags(topo, 0, true)
+        || 0 != hwloc_topology_load(topo)) {
+        PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
+                             "%s plm:base:topo_cache failed to load entry %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), path));
+        hwloc_topology_destroy(topo);
+        free(sig);
+        free(xml);
+        return PRTE_ERR_NOT_SUPPORTED;
+    }
+    free(xml);
+
+    /* the topology must still produce the signature it was filed
+     * under - e.g., a different hwloc may describe it differently */
+    check = prte_hwloc_base_get_topo_signature(topo);
+    if (0 != strcmp(check, sig)) {
+        PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
+                             "%s plm:base:topo_cache signature mismatch for entry %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), path));
+        hwloc_topology_destroy(topo);
+        free(check);
+        free(sig);
+        return PRTE_ERR_BAD_PARAM;
+    }
+    free(check);
+
+    t = PMIX_NEW(prte_topology_t);
+    t->sig = sig;
+    t->topo = topo;
+    t->index = pmix_pointer_array_add(prte_node_topologies, t);
+    PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
+                         "%s plm:base:topo_cache loaded topology %s",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), t->sig));
+    return PRTE_SUCCESS;
+}
+
+int prte_plm_base_topo_cache_load(void)
+{
+    DIR *dir;
+    struct dirent *ent;
+    size_t len, slen = strlen(PRTE_TOPO_CACHE_SUFFIX);
+    char *path;
+    int n = 0;
+
+    if (!PRTE_PROC_IS_MASTER || NULL == prte_topo_cache_dir) {
+        return PRTE_SUCCESS;
+    }
+    dir = opendir(prte_topo_cache_dir);
+    if (NULL == dir) {
+        /* nothing cached yet */
+        return PRTE_SUCCESS;
+    }
+    while (NULL != (ent = readdir(dir))) {
+        len = strlen(ent->d_name);
+        if (len <= slen || 0 != strcmp(ent->d_name + len - slen, PRTE_TOPO_CACHE_SUFFIX)) {
+            continue;
+        }
+        path = pmix_os_path(false, prte_topo_cache_dir, ent->d_name, NULL);
+        if (PRTE_SUCCESS == load_entry(path)) {
+            ++n;
+        }
+        free(path);
+    }
+    closedir(dir);
+
+    PMIX_OUTPUT_VERBOSE((2, prte_plm_base_framework.framework_output,
+                         "%s plm:base:topo_cache %d topologies loaded from %s",
+                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), n, prte_topo_cache_dir));
+    return PRTE_SUCCESS;
+}
+
+/* does the entry on disk already hold this XML for this signature? */
+static bool entry_current(const char *path, const char *sig, uint64_t hash, size_t len)
+{
+    char *esig = NULL, *exml = NULL;
+    size_t elen;
+    bool same;
+
+    if (PRTE_SUCCESS != read_entry(path, &esig, &exml, &elen)) {
+        return false;
+    }
+    same = (0 == strcmp(esig, sig) && elen == len
+            && hash == prte_hwloc_base_topo_hash(exml, elen));
+    free(esig);
+    free(exml);
+    return same;
+}
+
+void prte_plm_base_topo_cache_store(prte_topology_t *t)
+{
+    char *xml = NULL, *name, *path, *tmp;
+    uint64_t hash;
+    int len;
+    FILE *fp;
+    bool ok;
+
+    if (!PRTE_PROC_IS_MASTER || NULL == prte_topo_cache_dir || NULL == t->topo) {
+        return;
+    }
+    if (PMIX_SUCCESS != pmix_os_dirpath_create(prte_topo_cache_dir, S_IRWXU)) {
+        pmix_output(0, "%s could not create topology cache directory %s",
+                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), prte_topo_cache_dir);
+        return;
+    }
+    if (0 != prte_hwloc_base_topology_export_xmlbuffer(t->topo, &xml, &len) || len < 1) {
+        return;
+    }
+    /* the exported length includes the terminating NULL */
+    --len;
+
+    name = entry_name(t->sig);
+    path = pmix_os_path(false, prte_topo_cache_dir, name, NULL);
+    free(name);
+    /* only write on a miss or when the topology has changed */
+    hash = prte_hwloc_base_topo_hash(xml, len);
+    if (entry_current(path, t->sig, hash, len)) {
+        hwloc_free_xmlbuffer(t->topo, xml);
+        free(path);
+        return;
+    }
+    /* write a private copy and rename it into place so that a DVM
+     * starting concurrently never sees a partial entry */
+    pmix_asprintf(&tmp, "%s.%lu", path, (unsigned long) getpid());
+    fp = fopen(tmp, "w");
+    if (NULL == fp) {
+        hwloc_free_xmlbuffer(t->topo, xml);
+        free(tmp);
+        free(path);
+        return;
+    }
+    ok = (0 <= fprintf(fp, "%s\n%s\n%016" PRIx64 " %d\n", PRTE_TOPO_CACHE_MAGIC, t->sig,
+                       hash, len)
+          && (size_t) len == fwrite(xml, 1, len, fp));
+    ok = (0 == fclose(fp)) && ok;
+    hwloc_free_xmlbuffer(t->topo, xml);
+    if (!ok || 0 != rename(tmp, path)) {
+        unlink(tmp);
+    } else {
+        PMIX_OUTPUT_VERBOSE((5, prte_plm_base_framework.framework_output,
+                             "%s plm:base:topo_cache stored topology %s in %s",
+                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), t->sig, path));
+    }
+    free(tmp);
+    free(path);
+}
+
+char *prte_plm_base_topo_cache_known(void)
+{
+    prte_topology_t *t;
+    char **hashes = NULL, *tmp;
+    int i;
+
+    if (NULL == prte_topo_cache_dir) {
+        return NULL;
+    }
+    for (i = 0; i < prte_node_topologies->size; i++) {
+        t = (prte_topology_t *) pmix_pointer_array_get_item(prte_node_topologies, i);
+        if (NULL == t || NULL == t->topo) {
+            continue;
+        }
+        pmix_asprintf(&tmp, "%016" PRIx64, prte_hwloc_base_topo_hash(t->sig, strlen(t->sig)));
+        pmix_argv_append_nosize(&hashes, tmp);
+        free(tmp);
+    }
+    if (NULL == hashes) {
+        return NULL;
+    }
+    tmp = pmix_argv_join(hashes, ',');
+    pmix_argv_free(hashes);
+    return tmp;
+}
+
+prte_topology_t *prte_plm_base_topo_cache_find(const char *sig)
+{
+    prte_topology_t *t = find_sig(sig);
+
+    if (NULL == t || NULL == t->topo) {
+        return NULL;
+    }
+    return t;
+}
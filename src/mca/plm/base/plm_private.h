@@ -91,6 +91,16 @@ PRTE_EXPORT void prte_plm_base_daemon_topology(int status, pmix_proc_t *sender,
                                                pmix_data_buffer_t *buffer, prte_rml_tag_t tag,
                                                void *cbdata);
 
+/*
+ * Persistent topology cache - load the cached topologies into
+ * prte_node_topologies, save a newly reported one, and provide the
+ * hashes of the signatures whose topology need not be sent
+ */
+PRTE_EXPORT int prte_plm_base_topo_cache_load(void);
+PRTE_EXPORT void prte_plm_base_topo_cache_store(prte_topology_t *t);
+PRTE_EXPORT char *prte_plm_base_topo_cache_known(void);
+PRTE_EXPORT prte_topology_t *prte_plm_base_topo_cache_find(const char *sig);
+
 PRTE_EXPORT int prte_plm_base_create_jobid(prte_job_t *jdata);
 PRTE_EXPORT int prte_plm_base_set_hnp_name(void);
 PRTE_EXPORT void prte_plm_base_reset_job(prte_job_t *jdata);
@@ -133,7 +133,7 @@ int prte_ras_base_node_insert(pmix_list_t *nodes, prte_job_t *jdata)
             hnp_node->slots = node->slots;
             hnp_node->slots_max = node->slots_max;
             /* copy across any attributes */
-            PMIX_LIST_FOREACH(kv, &node->attributes, prte_attribute_t)
+            PMIX_LIST_FOREACH(kv, &node->attributes.super, prte_attribute_t)
             {
                 prte_set_attribute(&node->attributes, kv->key,
                                    PRTE_ATTR_LOCAL,
@@ -979,7 +979,7 @@ static int setup_fork(prte_job_t *jdata, prte_app_context_t *app)
      * ones as the app-specific ones can override them. We have to
      * process them in the order they were given to ensure we wind
      * up in the desired final state */
-    PMIX_LIST_FOREACH(attr, &jdata->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(attr, &jdata->attributes.super, prte_attribute_t)
     {
         if (PRTE_JOB_SET_ENVAR == attr->key) {
             pmix_setenv(attr->data.data.envar.envar, attr->data.data.envar.value, true, &app->env);
@@ -1043,7 +1043,7 @@ static int setup_fork(prte_job_t *jdata, prte_app_context_t *app)
     }
 
     /* now do the same thing for any app-level attributes */
-    PMIX_LIST_FOREACH(attr, &app->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(attr, &app->attributes.super, prte_attribute_t)
     {
         if (PRTE_APP_SET_ENVAR == attr->key) {
             pmix_setenv(attr->data.data.envar.envar, attr->data.data.envar.value, true, &app->env);
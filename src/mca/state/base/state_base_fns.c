@@ -410,47 +410,12 @@ void prte_state_base_report_progress(int fd, short argc, void *cbdata)
 
 void prte_state_base_notify_data_server(pmix_proc_t *target)
 {
-    pmix_data_buffer_t *buf;
-    int rc, room = -1;
-    uint8_t cmd = PRTE_PMIX_PURGE_PROC_CMD;
-
     /* if nobody local to us published anything, then we can ignore this */
     if (PMIX_NSPACE_INVALID(prte_pmix_server_globals.server.nspace)) {
         return;
     }
 
-    PMIX_DATA_BUFFER_CREATE(buf);
-
-    /* pack the room number */
-    rc = PMIx_Data_pack(NULL, buf, &room, 1, PMIX_INT);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        PMIX_DATA_BUFFER_RELEASE(buf);
-        return;
-    }
-
-    /* load the command */
-    rc = PMIx_Data_pack(NULL, buf, &cmd, 1, PMIX_UINT8);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        PMIX_DATA_BUFFER_RELEASE(buf);
-        return;
-    }
-
-    /* provide the target */
-    rc = PMIx_Data_pack(NULL, buf, target, 1, PMIX_PROC);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        PMIX_DATA_BUFFER_RELEASE(buf);
-        return;
-    }
-
-    /* send the request to the server */
-    PRTE_RML_SEND(rc, prte_pmix_server_globals.server.rank,
-                  buf, PRTE_RML_TAG_DATA_SERVER);
-    if (PRTE_SUCCESS != rc) {
-        PMIX_DATA_BUFFER_RELEASE(buf);
-    }
+    prte_data_server_purge(target, prte_pmix_server_globals.server.rank);
 }
 
 static void _send_notification(int status, prte_proc_state_t state, pmix_proc_t *proc,
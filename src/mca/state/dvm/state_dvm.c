@@ -510,8 +510,6 @@ static void check_complete(int fd, short args, void *cbdata)
     int32_t index;
     pmix_proc_t pname;
     prte_pmix_lock_t lock;
-    uint8_t command = PRTE_PMIX_PURGE_PROC_CMD;
-    pmix_data_buffer_t *buf;
     pmix_pointer_array_t procs;
     char *tmp;
     prte_timer_t *timer;
@@ -679,35 +677,8 @@ static void check_complete(int fd, short args, void *cbdata)
 
     if (NULL != prte_data_server_uri) {
         /* tell the data server to purge any data from this nspace */
-        PMIX_DATA_BUFFER_CREATE(buf);
-        /* room number is ignored, but has to be included for pack sequencing */
-        i = 0;
-        rc = PMIx_Data_pack(NULL, buf, &i, 1, PMIX_INT);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-            PMIX_DATA_BUFFER_RELEASE(buf);
-            goto release;
-        }
-        rc = PMIx_Data_pack(NULL, buf, &command, 1, PMIX_UINT8);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-            PMIX_DATA_BUFFER_RELEASE(buf);
-            goto release;
-        }
-        /* pack the nspace to be purged */
         pname.rank = PMIX_RANK_WILDCARD;
-        rc = PMIx_Data_pack(NULL, buf, &pname, 1, PMIX_PROC);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-            PMIX_DATA_BUFFER_RELEASE(buf);
-            goto release;
-        }
-        /* send it to the data server */
-        PRTE_RML_SEND(rc, PRTE_PROC_MY_NAME->rank, buf, PRTE_RML_TAG_DATA_SERVER);
-        if (PRTE_SUCCESS != rc) {
-            PRTE_ERROR_LOG(rc);
-            PMIX_DATA_BUFFER_RELEASE(buf);
-        }
+        prte_data_server_purge(&pname, PRTE_PROC_MY_NAME->rank);
     }
 
 release:
@@ -252,6 +252,20 @@ typedef struct {
 } prte_attribute_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_attribute_t);
 
+/* list of attributes that also keeps an open-addressed index of
+ * its entries by key. Add and remove entries only through the
+ * functions in src/util/attr.h so the index stays in step - the
+ * list itself (super) may be walked directly */
+typedef struct {
+    pmix_list_t super;
+    prte_attribute_t **slots; // first entry on the list for each key
+    uint32_t nslots;          // size of slots - zero or a power of two
+    uint32_t nused;           // number of occupied slots
+    size_t nindexed;          // length of the list when the index was last in sync
+    bool dups;                // some key appears on the list more than once
+} prte_attr_list_t;
+PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_attr_list_t);
+
 /* some helper functions */
 PRTE_EXPORT pmix_proc_state_t prte_pmix_convert_state(int state);
 PRTE_EXPORT int prte_pmix_convert_pstate(pmix_proc_state_t);
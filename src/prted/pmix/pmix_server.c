@@ -36,6 +36,9 @@
 #ifdef HAVE_SYS_TYPES_H
 #    include <sys/types.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#    include <sys/time.h>
+#endif
 #include <fcntl.h>
 #ifdef HAVE_NETINET_IN_H
 #    include <netinet/in.h>
@@ -49,6 +52,7 @@
 #include <ctype.h>
 
 #include "prte_stdint.h"
+#include "src/class/pmix_bitmap.h"
 #include "src/class/pmix_hotel.h"
 #include "src/class/pmix_list.h"
 #include "src/mca/base/pmix_mca_base_var.h"
@@ -64,6 +68,7 @@
 
 #include "src/mca/errmgr/errmgr.h"
 #include "src/mca/grpcomm/grpcomm.h"
+#include "src/mca/iof/base/base.h"
 #include "src/rml/rml_contact.h"
 #include "src/rml/rml.h"
 #include "src/runtime/prte_data_server.h"
@@ -337,6 +342,7 @@ static prte_regattr_input_t prte_attributes[] = {
 };
 
 static void send_error(int status, pmix_proc_t *idreq, pmix_proc_t *remote, int remote_room);
+static void track_lookups(pmix_rank_t dmn, int delta);
 static void _mdxresp(int sd, short args, void *cbdata);
 static void modex_resp(pmix_status_t status, char *data, size_t sz, void *cbdata);
 
@@ -413,6 +419,46 @@ void pmix_server_register_params(void)
         }
     }
 
+    /* whether or not to register the data for remote procs on demand */
+    prte_pmix_server_globals.lazy_proc_data = false;
+    (void) pmix_mca_base_var_register("prte", "pmix", NULL, "lazy_proc_data",
+                                      "Only give the PMIx server the device distances of local procs "
+                                      "when registering a job, providing those of a remote proc when "
+                                      "a local client first requests its data (default=false)",
+                                      PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                                      &prte_pmix_server_globals.lazy_proc_data);
+
+    /* how long to collect direct modex requests for a daemon */
+    prte_pmix_server_globals.dmdx_batch_window = 1000;
+    (void) pmix_mca_base_var_register("prte", "pmix", NULL, "dmdx_batch_window",
+                                      "Time (in microseconds) direct modex requests for another "
+                                      "daemon, and responses to one, may be held to be sent together "
+                                      "while earlier ones are still outstanding. Nothing is held when "
+                                      "there is nothing outstanding (default=1000, 0 = never hold)",
+                                      PMIX_MCA_BASE_VAR_TYPE_INT,
+                                      &prte_pmix_server_globals.dmdx_batch_window);
+    prte_pmix_server_globals.dmdx_batch_max = 1024;
+    (void) pmix_mca_base_var_register("prte", "pmix", NULL, "dmdx_batch_max",
+                                      "Maximum number of direct modex requests, or responses, sent "
+                                      "to a daemon in one message (default=1024)",
+                                      PMIX_MCA_BASE_VAR_TYPE_INT,
+                                      &prte_pmix_server_globals.dmdx_batch_max);
+
+    /* whether or not to send the data of co-located procs ahead */
+    prte_pmix_server_globals.dmdx_prefetch = false;
+    (void) pmix_mca_base_var_register("prte", "pmix", NULL, "dmdx_prefetch",
+                                      "When another daemon first asks for the data of one of our "
+                                      "procs, also send it that of our other procs in the job as "
+                                      "each has it (default=false)",
+                                      PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                                      &prte_pmix_server_globals.dmdx_prefetch);
+    prte_pmix_server_globals.dmdx_cache_max = 64 * 1024 * 1024;
+    (void) pmix_mca_base_var_register("prte", "pmix", NULL, "dmdx_cache_size",
+                                      "Maximum number of bytes of proc data sent ahead by other "
+                                      "daemons to hold until a local client asks for it - the oldest "
+                                      "is dropped beyond that (default=64M, 0 = keep none)",
+                                      PMIX_MCA_BASE_VAR_TYPE_SIZE_T,
+                                      &prte_pmix_server_globals.dmdx_cache_max);
 }
 
 static void eviction_cbfunc(struct pmix_hotel_t *hotel,
@@ -456,9 +502,11 @@ static void eviction_cbfunc(struct pmix_hotel_t *hotel,
                 if(PMIX_SUCCESS != prc) {
                   goto error_condition;
                 }
+                track_lookups(req->proxy.rank, 1);
                 prc = PMIx_server_dmodex_request(&req->tproc, modex_resp, req);
                 if (PMIX_SUCCESS != prc) {
                     PMIX_ERROR_LOG(prc);
+                    track_lookups(req->proxy.rank, -1);
                     send_error(rc, &req->tproc, &req->proxy, req->remote_room_num);
                     pmix_hotel_checkout(&prte_pmix_server_globals.reqs, req->room_num);
                     PMIX_RELEASE(req);
@@ -516,6 +564,10 @@ void prte_pmix_server_clear(pmix_proc_t *pname)
             }
         }
     }
+    /* the job is gone - so is any data held for it */
+    if (PMIX_RANK_WILDCARD == pname->rank) {
+        pmix_server_dmdx_purge(pname->nspace);
+    }
 }
 
 /* provide a callback function for lost connections to allow us
@@ -541,6 +593,11 @@ static void lost_connection_hdlr(size_t evhdlr_registration_id, pmix_status_t st
             pmix_list_remove_item(&prte_pmix_server_globals.tools, &tl->super);
             /* release it */
             PMIX_RELEASE(tl);
+            /* the IOF cannot tell the tools' requests for output apart,
+             * so they are dropped once none are left */
+            if (pmix_list_is_empty(&prte_pmix_server_globals.tools)) {
+                prte_iof_base_pull_purge();
+            }
             break;
         }
     }
@@ -588,6 +645,22 @@ int pmix_server_init(void)
     PMIX_CONSTRUCT(&prte_pmix_server_globals.tools, pmix_list_t);
     PMIX_CONSTRUCT(&prte_pmix_server_globals.local_reqs, pmix_pointer_array_t);
     pmix_pointer_array_init(&prte_pmix_server_globals.local_reqs, 128, INT_MAX, 2);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.localities, pmix_list_t);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.locality_index, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_pmix_server_globals.locality_index, 64);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.dmdx_reqs, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_pmix_server_globals.dmdx_reqs, 64);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.dmdx_resps, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_pmix_server_globals.dmdx_resps, 64);
+    memset(&prte_pmix_server_globals.dmdx_stats, 0, sizeof(pmix_server_dmdx_stats_t));
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.dmdx_cache, pmix_list_t);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.dmdx_cache_index, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_pmix_server_globals.dmdx_cache_index, 1024);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.dmdx_prefetched, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_pmix_server_globals.dmdx_prefetched, 64);
+    PMIX_CONSTRUCT(&prte_pmix_server_globals.dmdx_waiting, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_pmix_server_globals.dmdx_waiting, 1024);
+    prte_pmix_server_globals.dmdx_cache_bytes = 0;
 
     /* by the time we init the server, we should know how many nodes we
      * have in our environment - with the exception of mpirun. If the
@@ -908,8 +981,31 @@ void pmix_server_start(void)
     }
 }
 
+static void dmdx_release_batches(pmix_hash_table_t *batches)
+{
+    pmix_server_dmdx_batch_t *batch;
+    uint32_t key;
+    void *node;
+
+    if (PMIX_SUCCESS == pmix_hash_table_get_first_key_uint32(batches, &key,
+                                                             (void **) &batch, &node)) {
+        do {
+            PMIX_RELEASE(batch);
+        } while (PMIX_SUCCESS == pmix_hash_table_get_next_key_uint32(batches, &key,
+                                                                     (void **) &batch,
+                                                                     node, &node));
+    }
+    PMIX_DESTRUCT(batches);
+}
+
 void pmix_server_finalize(void)
 {
+    pmix_server_dmdx_stats_t *st;
+    pmix_bitmap_t *sent;
+    pmix_list_t *waiters;
+    void *key;
+    size_t size;
+
     if (!prte_pmix_server_globals.initialized) {
         return;
     }
@@ -942,6 +1038,40 @@ void pmix_server_finalize(void)
 
     PMIX_DESTRUCT(&prte_pmix_server_globals.reqs);
     PMIX_DESTRUCT(&prte_pmix_server_globals.local_reqs);
+
+    st = &prte_pmix_server_globals.dmdx_stats;
+    pmix_output_verbose(1, prte_pmix_server_globals.output,
+                        "%s dmdx: %" PRIu64 " requests in %" PRIu64 " messages, %" PRIu64
+                        " responses in %" PRIu64 " messages, latency avg %" PRIu64
+                        " max %" PRIu64 " usec",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), st->reqs, st->req_msgs, st->resps,
+                        st->resp_msgs, (0 == st->replies) ? 0 : st->latency / st->replies,
+                        st->max_latency);
+    pmix_output_verbose(1, prte_pmix_server_globals.output,
+                        "%s dmdx cache: %" PRIu64 " hits %" PRIu64 " misses, %" PRIu64
+                        " procs pushed, %" PRIu64 " cached %" PRIu64 " evicted",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), st->hits, st->misses, st->pushed,
+                        st->cached, st->evicted);
+    dmdx_release_batches(&prte_pmix_server_globals.dmdx_reqs);
+    dmdx_release_batches(&prte_pmix_server_globals.dmdx_resps);
+    for (void *_nptr = NULL;
+         PMIX_SUCCESS
+         == pmix_hash_table_get_next_key_ptr(&prte_pmix_server_globals.dmdx_prefetched, &key,
+                                             &size, (void **) &sent, _nptr, &_nptr);) {
+        PMIX_RELEASE(sent);
+    }
+    PMIX_DESTRUCT(&prte_pmix_server_globals.dmdx_prefetched);
+    for (void *_nptr = NULL;
+         PMIX_SUCCESS
+         == pmix_hash_table_get_next_key_ptr(&prte_pmix_server_globals.dmdx_waiting, &key,
+                                             &size, (void **) &waiters, _nptr, &_nptr);) {
+        PMIX_LIST_RELEASE(waiters);
+    }
+    PMIX_DESTRUCT(&prte_pmix_server_globals.dmdx_waiting);
+    PMIX_DESTRUCT(&prte_pmix_server_globals.dmdx_cache_index);
+    PMIX_LIST_DESTRUCT(&prte_pmix_server_globals.dmdx_cache);
+    PMIX_DESTRUCT(&prte_pmix_server_globals.locality_index);
+    PMIX_LIST_DESTRUCT(&prte_pmix_server_globals.localities);
     PMIX_LIST_DESTRUCT(&prte_pmix_server_globals.notifications);
     PMIX_LIST_DESTRUCT(&prte_pmix_server_globals.psets);
     PMIX_LIST_DESTRUCT(&prte_pmix_server_globals.groups);
@@ -952,44 +1082,36 @@ void pmix_server_finalize(void)
 
 static void send_error(int status, pmix_proc_t *idreq, pmix_proc_t *remote, int remote_room)
 {
-    pmix_data_buffer_t *reply;
-    pmix_status_t prc, pstatus;
+    pmix_server_dmdx_respond(remote->rank, prte_pmix_convert_rc(status), idreq, remote_room,
+                             NULL, 0);
+}
 
-    /* pack the status */
-    pstatus = prte_pmix_convert_rc(status);
-    PMIX_DATA_BUFFER_CREATE(reply);
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &pstatus, 1, PMIX_STATUS))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        return;
-    }
-    /* pack the id of the requested proc */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, idreq, 1, PMIX_PROC))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        return;
-    }
+/* tell the requesting daemon that we hold its request until we can
+ * answer it, so it does not hold its next requests to us meanwhile */
+static void send_parked(pmix_proc_t *idreq, pmix_proc_t *remote, int remote_room)
+{
+    pmix_server_dmdx_respond(remote->rank, PMIX_OPERATION_IN_PROGRESS, idreq, remote_room,
+                             NULL, 0);
+}
 
-    /* pack the remote daemon's request room number */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &remote_room, 1, PMIX_INT))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        return;
-    }
+/* count the lookups in our PMIx server whose answers are headed for
+ * a daemon - its batch of responses goes out when they are all done */
+static void track_lookups(pmix_rank_t dmn, int delta)
+{
+    pmix_server_dmdx_batch_t *batch;
 
-    /* send the response */
-    PRTE_RML_SEND(prc, remote->rank, reply, PRTE_RML_TAG_DIRECT_MODEX_RESP);
-    if (PRTE_SUCCESS != prc) {
-        PRTE_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
+    batch = pmix_server_dmdx_batch(&prte_pmix_server_globals.dmdx_resps, dmn,
+                                   PRTE_RML_TAG_DIRECT_MODEX_RESP);
+    batch->outstanding += delta;
+    if (0 >= batch->outstanding) {
+        batch->outstanding = 0;
+        pmix_server_dmdx_flush(batch);
     }
 }
 
 static void _mdxresp(int sd, short args, void *cbdata)
 {
     pmix_server_req_t *req = (pmix_server_req_t *) cbdata;
-    pmix_data_buffer_t *reply;
-    pmix_status_t prc;
     PRTE_HIDE_UNUSED_PARAMS(sd, args);
 
     PMIX_ACQUIRE_OBJECT(req);
@@ -999,57 +1121,35 @@ static void _mdxresp(int sd, short args, void *cbdata)
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
                         req->tproc.nspace, req->tproc.rank);
 
-    /* check us out of the hotel */
-    pmix_hotel_checkout(&prte_pmix_server_globals.reqs, req->room_num);
-
-    /* pack the status */
-    PMIX_DATA_BUFFER_CREATE(reply);
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &req->pstatus, 1, PMIX_STATUS))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        goto error;
-    }
-    /* pack the id of the requested proc */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &req->tproc, 1, PMIX_PROC))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        goto error;
-    }
-
-    /* pack the remote daemon's request room number */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &req->remote_room_num, 1, PMIX_INT))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        goto error;
-    }
-    if (PMIX_SUCCESS == req->pstatus) {
-        /* return any provided data */
-        if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &req->sz, 1, PMIX_SIZE))) {
-            PMIX_ERROR_LOG(prc);
-            PMIX_DATA_BUFFER_RELEASE(reply);
-            goto error;
+    if (0 > req->remote_room_num) {
+        /* data we send ahead - nobody waits for it, so there
+         * is nothing to say if we could not get it */
+        if (PMIX_SUCCESS == req->pstatus) {
+            pmix_server_dmdx_respond(req->proxy.rank, req->pstatus, &req->tproc, -1,
+                                     req->data, req->sz);
+            ++prte_pmix_server_globals.dmdx_stats.pushed;
         }
-        if (0 < req->sz) {
-            if (PMIX_SUCCESS
-                != (prc = PMIx_Data_pack(NULL, reply, req->data, req->sz, PMIX_BYTE))) {
-                PMIX_ERROR_LOG(prc);
-                PMIX_DATA_BUFFER_RELEASE(reply);
-                goto error;
-            }
+        if (NULL != req->data) {
             free(req->data);
+            req->data = NULL;
         }
+        PMIX_RELEASE(req);
+        return;
     }
 
-    /* send the response */
-    PRTE_RML_SEND(prc, req->proxy.rank, reply, PRTE_RML_TAG_DIRECT_MODEX_RESP);
-    if (PRTE_SUCCESS != prc) {
-        PRTE_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-    }
+    /* check us out of the hotel */
+    pmix_hotel_checkout(&prte_pmix_server_globals.reqs, req->room_num);
 
-error:
+    /* add the response to the others for that daemon - the
+     * batch goes out once this was the last lookup for it */
+    pmix_server_dmdx_respond(req->proxy.rank, req->pstatus, &req->tproc, req->remote_room_num,
+                             req->data, req->sz);
+    if (NULL != req->data) {
+        free(req->data);
+        req->data = NULL;
+    }
+    track_lookups(req->proxy.rank, -1);
     PMIX_RELEASE(req);
-    return;
 }
 /* the modex_resp function takes place in the local PMIx server's
  * progress thread - we must therefore thread-shift it so we can
@@ -1076,52 +1176,82 @@ static void modex_resp(pmix_status_t status, char *data, size_t sz, void *cbdata
     PMIX_POST_OBJECT(req);
     prte_event_active(&(req->ev), PRTE_EV_WRITE, 1);
 }
-static void pmix_server_dmdx_recv(int status, pmix_proc_t *sender,
-                                  pmix_data_buffer_t *buffer,
-                                  prte_rml_tag_t tg, void *cbdata)
+/* the first time a daemon asks for one of our procs in a job, get
+ * it the data of our other procs in that job too - it is sent as
+ * each of them provides it. The procs the daemon named in the same
+ * batch of requests are coming to it anyway, so they are left out */
+static void prefetch(pmix_proc_t *sender, prte_proc_t *proc, pmix_proc_t *named, int32_t nnamed)
 {
-    int rc, room_num;
-    int32_t cnt;
+    pmix_bitmap_t *sent = NULL;
+    pmix_bitmap_t skip;
+    prte_proc_t *pptr;
+    pmix_server_req_t *req;
+    size_t len = strlen(proc->name.nspace);
+    int32_t k;
+    int n;
+
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_pmix_server_globals.dmdx_prefetched,
+                                                      proc->name.nspace, len, (void **) &sent)) {
+        sent = PMIX_NEW(pmix_bitmap_t);
+        pmix_bitmap_init(sent, 64);
+        pmix_hash_table_set_value_ptr(&prte_pmix_server_globals.dmdx_prefetched,
+                                      proc->name.nspace, len, sent);
+    }
+    if (pmix_bitmap_is_set_bit(sent, sender->rank)) {
+        return;
+    }
+    pmix_bitmap_set_bit(sent, sender->rank);
+
+    PMIX_CONSTRUCT(&skip, pmix_bitmap_t);
+    pmix_bitmap_init(&skip, 64);
+    for (k = 0; k < nnamed; k++) {
+        if (PMIX_RANK_VALID >= named[k].rank &&
+            PMIX_CHECK_NSPACE(named[k].nspace, proc->name.nspace)) {
+            pmix_bitmap_set_bit(&skip, named[k].rank);
+        }
+    }
+
+    for (n = 0; n < proc->node->procs->size; n++) {
+        pptr = (prte_proc_t *) pmix_pointer_array_get_item(proc->node->procs, n);
+        if (NULL == pptr || pptr == proc ||
+            !PMIX_CHECK_NSPACE(pptr->name.nspace, proc->name.nspace) ||
+            pmix_bitmap_is_set_bit(&skip, pptr->name.rank)) {
+            continue;
+        }
+        req = PMIX_NEW(pmix_server_req_t);
+        pmix_asprintf(&req->operation, "DMDX PREFETCH: %s:%d", __FILE__, __LINE__);
+        req->proxy = *sender;
+        PMIX_LOAD_PROCID(&req->tproc, pptr->name.nspace, pptr->name.rank);
+        /* no room in the hotel, and none waiting for it */
+        req->room_num = -1;
+        req->remote_room_num = -1;
+        if (PMIX_SUCCESS != PMIx_server_dmodex_request(&req->tproc, modex_resp, req)) {
+            PMIX_RELEASE(req);
+        }
+    }
+    PMIX_DESTRUCT(&skip);
+}
+
+/* service one of the requests a daemon sent us - returns the proc
+ * when its data is now being looked up */
+static prte_proc_t *dmdx_request(pmix_proc_t *sender, pmix_proc_t *pp, int room_num,
+                                 pmix_info_t *info, size_t ninfo)
+{
+    int rc;
     prte_job_t *jdata;
     prte_proc_t *proc;
     pmix_server_req_t *req;
     pmix_proc_t pproc;
     pmix_status_t prc;
-    pmix_info_t *info = NULL;
-    size_t ninfo;
     char *key = NULL;
     size_t sz;
     pmix_value_t *pval = NULL;
-    PRTE_HIDE_UNUSED_PARAMS(status, tg, cbdata);
 
-    cnt = 1;
-    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &pproc, &cnt, PMIX_PROC))) {
-        PMIX_ERROR_LOG(prc);
-        return;
-    }
+    memcpy(&pproc, pp, sizeof(pmix_proc_t));
     pmix_output_verbose(2, prte_pmix_server_globals.output,
                         "%s dmdx:recv processing request from proc %s for proc %s:%u",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender), pproc.nspace,
                         pproc.rank);
-    /* and the remote daemon's tracking room number */
-    cnt = 1;
-    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &room_num, &cnt, PMIX_INT))) {
-        PMIX_ERROR_LOG(prc);
-        return;
-    }
-    cnt = 1;
-    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &ninfo, &cnt, PMIX_SIZE))) {
-        PMIX_ERROR_LOG(prc);
-        return;
-    }
-    if (0 < ninfo) {
-        PMIX_INFO_CREATE(info, ninfo);
-        cnt = ninfo;
-        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, info, &cnt, PMIX_INFO))) {
-            PMIX_ERROR_LOG(prc);
-            return;
-        }
-    }
 
     /* see if they want us to await a particular key before sending
      * the response */
@@ -1163,18 +1293,20 @@ static void pmix_server_dmdx_recv(int status, pmix_proc_t *sender,
             PMIX_RELEASE(req);
             rc = prte_pmix_convert_status(rc);
             send_error(rc, &pproc, sender, room_num);
+            return NULL;
         }
-        return;
+        send_parked(&pproc, sender, room_num);
+        return NULL;
     }
     if (NULL == (proc = (prte_proc_t *) pmix_pointer_array_get_item(jdata->procs, pproc.rank))) {
         /* this is truly an error, so notify the sender */
         send_error(PRTE_ERR_NOT_FOUND, &pproc, sender, room_num);
-        return;
+        return NULL;
     }
     if (!PRTE_FLAG_TEST(proc, PRTE_PROC_FLAG_LOCAL)) {
         /* send back an error - they obviously have made a mistake */
         send_error(PRTE_ERR_NOT_FOUND, &pproc, sender, room_num);
-        return;
+        return NULL;
     }
 
     if (NULL != key) {
@@ -1205,11 +1337,13 @@ static void pmix_server_dmdx_recv(int status, pmix_proc_t *sender,
                 PMIX_RELEASE(req);
                 rc = prte_pmix_convert_status(rc);
                 send_error(rc, &pproc, sender, room_num);
+                return NULL;
             }
             pmix_output_verbose(2, prte_pmix_server_globals.output,
                                 "%s:%d CHECKING REQ FOR KEY %s TO %d REMOTE ROOM %d", __FILE__,
                                 __LINE__, req->key, req->room_num, req->remote_room_num);
-            return;
+            send_parked(&pproc, sender, room_num);
+            return NULL;
         }
         /* we do already have it, so go get the payload */
         PMIX_VALUE_RELEASE(pval);
@@ -1237,18 +1371,98 @@ static void pmix_server_dmdx_recv(int status, pmix_proc_t *sender,
         PMIX_RELEASE(req);
         rc = prte_pmix_convert_status(rc);
         send_error(rc, &pproc, sender, room_num);
-        return;
+        return NULL;
     }
 
     /* ask our local pmix server for the data */
+    track_lookups(sender->rank, 1);
     if (PMIX_SUCCESS != (prc = PMIx_server_dmodex_request(&pproc, modex_resp, req))) {
         PMIX_ERROR_LOG(prc);
         pmix_hotel_checkout(&prte_pmix_server_globals.reqs, req->room_num);
         PMIX_RELEASE(req);
-        send_error(rc, &pproc, sender, room_num);
+        track_lookups(sender->rank, -1);
+        send_error(prte_pmix_convert_status(prc), &pproc, sender, room_num);
+        return NULL;
+    }
+    return proc;
+}
+
+static void pmix_server_dmdx_recv(int status, pmix_proc_t *sender,
+                                  pmix_data_buffer_t *buffer,
+                                  prte_rml_tag_t tg, void *cbdata)
+{
+    int room_num;
+    int32_t cnt, count, n, k;
+    pmix_proc_t *named = NULL;
+    prte_proc_t **served = NULL;
+    pmix_status_t prc;
+    pmix_info_t *info;
+    size_t ninfo;
+    PRTE_HIDE_UNUSED_PARAMS(status, tg, cbdata);
+
+    /* the requests come in batches */
+    cnt = 1;
+    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &count, &cnt, PMIX_INT32))) {
+        PMIX_ERROR_LOG(prc);
         return;
     }
-    return;
+    if (0 < count) {
+        PMIX_PROC_CREATE(named, count);
+        served = (prte_proc_t **) calloc(count, sizeof(prte_proc_t *));
+        if (NULL == named || NULL == served) {
+            PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+            if (NULL != named) {
+                PMIX_PROC_FREE(named, count);
+            }
+            free(served);
+            return;
+        }
+    }
+    /* hold the responses until we have seen them all */
+    track_lookups(sender->rank, 1);
+    for (n = 0; n < count; n++) {
+        cnt = 1;
+        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &named[n], &cnt, PMIX_PROC))) {
+            PMIX_ERROR_LOG(prc);
+            break;
+        }
+        /* and the remote daemon's tracking room number */
+        cnt = 1;
+        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &room_num, &cnt, PMIX_INT))) {
+            PMIX_ERROR_LOG(prc);
+            break;
+        }
+        cnt = 1;
+        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &ninfo, &cnt, PMIX_SIZE))) {
+            PMIX_ERROR_LOG(prc);
+            break;
+        }
+        info = NULL;
+        if (0 < ninfo) {
+            PMIX_INFO_CREATE(info, ninfo);
+            cnt = ninfo;
+            if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, info, &cnt, PMIX_INFO))) {
+                PMIX_ERROR_LOG(prc);
+                PMIX_INFO_FREE(info, ninfo);
+                break;
+            }
+        }
+        served[n] = dmdx_request(sender, &named[n], room_num, info, ninfo);
+    }
+    /* send the rest of their jobs ahead once we know all the
+     * procs the daemon asked for */
+    if (prte_pmix_server_globals.dmdx_prefetch) {
+        for (k = 0; k < n; k++) {
+            if (NULL != served[k]) {
+                prefetch(sender, served[k], named, n);
+            }
+        }
+    }
+    track_lookups(sender->rank, -1);
+    if (NULL != named) {
+        PMIX_PROC_FREE(named, count);
+    }
+    free(served);
 }
 
 typedef struct {
@@ -1278,17 +1492,54 @@ static void relcbfunc(void *relcbdata)
     PMIX_RELEASE(d);
 }
 
+/* should data sent ahead for the proc be kept? Not if a request
+ * for it is out, which will bring it, nor if our PMIx server was
+ * already given it */
+static bool wanted(pmix_proc_t *proc)
+{
+    prte_job_t *jdata;
+    prte_proc_t *pptr;
+
+    if (NULL != pmix_server_dmdx_waiters(proc)) {
+        return false;
+    }
+    if (NULL != (jdata = prte_get_job_data_object(proc->nspace)) &&
+        NULL != (pptr = (prte_proc_t *) pmix_pointer_array_get_item(jdata->procs, proc->rank)) &&
+        PRTE_FLAG_TEST(pptr, PRTE_PROC_FLAG_DATA_RECVD)) {
+        return false;
+    }
+    return true;
+}
+
+/* record that our PMIx server has been given the data of a proc */
+static void given(pmix_proc_t *proc)
+{
+    prte_job_t *jdata;
+    prte_proc_t *pptr;
+
+    if (NULL != (jdata = prte_get_job_data_object(proc->nspace)) &&
+        NULL != (pptr = (prte_proc_t *) pmix_pointer_array_get_item(jdata->procs, proc->rank))) {
+        PRTE_FLAG_SET(pptr, PRTE_PROC_FLAG_DATA_RECVD);
+    }
+}
+
 static void pmix_server_dmdx_resp(int status, pmix_proc_t *sender,
                                   pmix_data_buffer_t *buffer,
                                   prte_rml_tag_t tg, void *cbdata)
 {
-    int room_num, rnum;
-    int32_t cnt;
+    int room_num;
+    int32_t cnt, count, n, nanswered = 0;
     pmix_server_req_t *req;
+    pmix_server_dmdx_waiter_t *w;
+    pmix_list_t *waiters;
+    bool delivered;
+    pmix_server_dmdx_batch_t *batch;
     datacaddy_t *d;
     pmix_proc_t pproc;
     size_t psz;
     pmix_status_t prc, pret;
+    struct timeval now;
+    uint64_t usec;
     PRTE_HIDE_UNUSED_PARAMS(status, tg, cbdata);
 
     pmix_output_verbose(2, prte_pmix_server_globals.output,
@@ -1296,87 +1547,136 @@ static void pmix_server_dmdx_resp(int status, pmix_proc_t *sender,
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender),
                         (int) buffer->bytes_used);
 
-    d = PMIX_NEW(datacaddy_t);
-
-    /* unpack the status */
+    /* the responses come in batches */
     cnt = 1;
-    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &pret, &cnt, PMIX_STATUS))) {
+    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &count, &cnt, PMIX_INT32))) {
         PMIX_ERROR_LOG(prc);
-        PMIX_RELEASE(d);
         return;
     }
+    gettimeofday(&now, NULL);
 
-    /* unpack the id of the target whose info we just received */
-    cnt = 1;
-    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &pproc, &cnt, PMIX_PROC))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_RELEASE(d);
-        return;
-    }
+    for (n = 0; n < count; n++) {
+        d = PMIX_NEW(datacaddy_t);
 
-    /* unpack our tracking room number */
-    cnt = 1;
-    if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &room_num, &cnt, PMIX_INT))) {
-        PMIX_ERROR_LOG(prc);
-        PMIX_RELEASE(d);
-        return;
-    }
+        /* unpack the status */
+        cnt = 1;
+        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &pret, &cnt, PMIX_STATUS))) {
+            PMIX_ERROR_LOG(prc);
+            PMIX_RELEASE(d);
+            break;
+        }
 
-    /* unload the remainder of the buffer */
-    if (PMIX_SUCCESS == pret) {
+        /* unpack the id of the target whose info we just received */
         cnt = 1;
-        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &psz, &cnt, PMIX_SIZE))) {
+        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &pproc, &cnt, PMIX_PROC))) {
             PMIX_ERROR_LOG(prc);
             PMIX_RELEASE(d);
-            return;
+            break;
         }
-        if (0 < psz) {
-            d->ndata = psz;
-            d->data = (char *) malloc(psz);
-            if (NULL == d->data) {
-                PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
-            }
-            cnt = psz;
-            if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, d->data, &cnt, PMIX_BYTE))) {
+
+        /* unpack our tracking room number */
+        cnt = 1;
+        if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &room_num, &cnt, PMIX_INT))) {
+            PMIX_ERROR_LOG(prc);
+            PMIX_RELEASE(d);
+            break;
+        }
+
+        /* unload the data, if any */
+        if (PMIX_SUCCESS == pret) {
+            cnt = 1;
+            if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, &psz, &cnt, PMIX_SIZE))) {
                 PMIX_ERROR_LOG(prc);
                 PMIX_RELEASE(d);
-                return;
+                break;
+            }
+            if (0 < psz) {
+                d->ndata = psz;
+                d->data = (char *) malloc(psz);
+                if (NULL == d->data) {
+                    PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+                }
+                cnt = psz;
+                if (PMIX_SUCCESS != (prc = PMIx_Data_unpack(NULL, buffer, d->data, &cnt, PMIX_BYTE))) {
+                    PMIX_ERROR_LOG(prc);
+                    PMIX_RELEASE(d);
+                    break;
+                }
             }
         }
-    }
 
-    /* get the request out of the tracking array */
-    req = (pmix_server_req_t*)pmix_pointer_array_get_item(&prte_pmix_server_globals.local_reqs, room_num);
-    /* return the returned data to the requestor */
-    if (NULL != req) {
-        if (NULL != req->mdxcbfunc) {
-            PMIX_RETAIN(d);
-            req->mdxcbfunc(pret, d->data, d->ndata, req->cbdata, relcbfunc, d);
+        if (0 > room_num) {
+            /* sent ahead by the daemon hosting the proc */
+            if (PMIX_SUCCESS == pret && wanted(&pproc)) {
+                pmix_server_dmdx_cache_add(&pproc, d->data, d->ndata);
+            }
+            PMIX_RELEASE(d);
+            continue;
         }
-        pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
-        PMIX_RELEASE(req);
-    } else {
-        pmix_output_verbose(2, prte_pmix_server_globals.output,
-                            "REQ WAS NULL IN ROOM %d",
-                            room_num);
-    }
-
-    /* now see if anyone else was waiting for data from this target */
-    for (rnum = 0; rnum < prte_pmix_server_globals.local_reqs.size; rnum++) {
-        req = (pmix_server_req_t*)pmix_pointer_array_get_item(&prte_pmix_server_globals.local_reqs, rnum);
-        if (NULL == req) {
+        /* get the request out of the tracking array */
+        req = (pmix_server_req_t*)pmix_pointer_array_get_item(&prte_pmix_server_globals.local_reqs, room_num);
+        if (PMIX_OPERATION_IN_PROGRESS == pret) {
+            /* the daemon holds the request until it can answer it,
+             * so it no longer counts as outstanding */
+            if (NULL != req && !req->parked) {
+                req->parked = true;
+                ++nanswered;
+            }
+            PMIX_RELEASE(d);
             continue;
         }
-        if (PMIX_CHECK_PROCID(&req->tproc, &pproc)) {
+        if (NULL == req || !req->parked) {
+            ++nanswered;
+        }
+        delivered = false;
+
+        /* return the returned data to the requestor */
+        if (NULL != req) {
+            if (0 < req->start.tv_sec) {
+                usec = (now.tv_sec - req->start.tv_sec) * 1000000 + now.tv_usec - req->start.tv_usec;
+                prte_pmix_server_globals.dmdx_stats.latency += usec;
+                if (prte_pmix_server_globals.dmdx_stats.max_latency < usec) {
+                    prte_pmix_server_globals.dmdx_stats.max_latency = usec;
+                }
+                ++prte_pmix_server_globals.dmdx_stats.replies;
+            }
             if (NULL != req->mdxcbfunc) {
                 PMIX_RETAIN(d);
                 req->mdxcbfunc(pret, d->data, d->ndata, req->cbdata, relcbfunc, d);
+                delivered = true;
             }
-            pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, rnum, NULL);
+            pmix_server_dmdx_unwait(req);
             PMIX_RELEASE(req);
+        } else {
+            pmix_output_verbose(2, prte_pmix_server_globals.output,
+                                "REQ WAS NULL IN ROOM %d",
+                                room_num);
+        }
+
+        /* now see if anyone else was waiting for data from this target */
+        while (NULL != (waiters = pmix_server_dmdx_waiters(&pproc))) {
+            w = (pmix_server_dmdx_waiter_t *) pmix_list_get_first(waiters);
+            req = w->req;
+            if (NULL != req->mdxcbfunc) {
+                PMIX_RETAIN(d);
+                req->mdxcbfunc(pret, d->data, d->ndata, req->cbdata, relcbfunc, d);
+                delivered = true;
+            }
+            pmix_server_dmdx_unwait(req);
+            PMIX_RELEASE(req);
+        }
+        if (PMIX_SUCCESS == pret && delivered) {
+            given(&pproc);
         }
+        PMIX_RELEASE(d); // maintain accounting
     }
-    PMIX_RELEASE(d); // maintain accounting
+
+    /* the sender has answered these - anything we collected for it
+     * in the meantime can go now */
+    batch = pmix_server_dmdx_batch(&prte_pmix_server_globals.dmdx_reqs, sender->rank,
+                                   PRTE_RML_TAG_DIRECT_MODEX);
+    batch->outstanding -= (nanswered < batch->outstanding) ? nanswered : batch->outstanding;
+    pmix_server_dmdx_flush(batch);
 }
 
 
@@ -1583,6 +1883,7 @@ static void rqcon(pmix_server_req_t *p)
     p->key = NULL;
     p->flag = true;
     p->launcher = false;
+    p->parked = false;
     p->remote_room_num = -1;
     p->uid = 0;
     p->gid = 0;
@@ -1594,6 +1895,8 @@ static void rqcon(pmix_server_req_t *p)
     p->range = PMIX_RANGE_SESSION;
     p->proxy = *PRTE_NAME_INVALID;
     p->target = *PRTE_NAME_INVALID;
+    p->start.tv_sec = 0;
+    p->start.tv_usec = 0;
     p->jdata = NULL;
     PMIX_DATA_BUFFER_CONSTRUCT(&p->msg);
     p->timeout = prte_pmix_server_globals.timeout;
@@ -1644,6 +1947,39 @@ static void mddes(prte_pmix_mdx_caddy_t *p)
 }
 PMIX_CLASS_INSTANCE(prte_pmix_mdx_caddy_t, pmix_object_t, mdcon, mddes);
 
+static void dbcon(pmix_server_dmdx_batch_t *p)
+{
+    p->timer_active = false;
+    p->dmn = PMIX_RANK_INVALID;
+    p->tag = PRTE_RML_TAG_INVALID;
+    p->count = 0;
+    p->outstanding = 0;
+    PMIX_DATA_BUFFER_CONSTRUCT(&p->buf);
+}
+static void dbdes(pmix_server_dmdx_batch_t *p)
+{
+    if (p->timer_active) {
+        prte_event_evtimer_del(&p->ev);
+    }
+    PMIX_DATA_BUFFER_DESTRUCT(&p->buf);
+}
+PMIX_CLASS_INSTANCE(pmix_server_dmdx_batch_t, pmix_object_t, dbcon, dbdes);
+
+static void dmbcon(pmix_server_dmdx_blob_t *p)
+{
+    p->data = NULL;
+    p->sz = 0;
+}
+static void dmbdes(pmix_server_dmdx_blob_t *p)
+{
+    if (NULL != p->data) {
+        free(p->data);
+    }
+}
+PMIX_CLASS_INSTANCE(pmix_server_dmdx_blob_t, pmix_list_item_t, dmbcon, dmbdes);
+
+PMIX_CLASS_INSTANCE(pmix_server_dmdx_waiter_t, pmix_list_item_t, NULL, NULL);
+
 static void pscon(pmix_server_pset_t *p)
 {
     p->name = NULL;
@@ -32,7 +32,11 @@
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#    include <sys/time.h>
+#endif
 
+#include "src/class/pmix_bitmap.h"
 #include "src/pmix/pmix-internal.h"
 #include "src/util/pmix_output.h"
 
@@ -130,70 +134,412 @@ pmix_status_t pmix_server_fencenb_fn(const pmix_proc_t procs[], size_t nprocs,
     return PMIX_SUCCESS;
 }
 
-static void modex_resp(pmix_status_t status, char *data, size_t sz, void *cbdata)
+static void batch_timeout(int sd, short args, void *cbdata)
 {
-    pmix_server_req_t *req = (pmix_server_req_t *) cbdata;
-    pmix_data_buffer_t *reply;
+    pmix_server_dmdx_batch_t *batch = (pmix_server_dmdx_batch_t *) cbdata;
+    PRTE_HIDE_UNUSED_PARAMS(sd, args);
+
+    PMIX_ACQUIRE_OBJECT(batch);
+    batch->timer_active = false;
+    pmix_server_dmdx_flush(batch);
+}
+
+/* get the batch headed for a daemon, creating it if necessary */
+pmix_server_dmdx_batch_t *pmix_server_dmdx_batch(pmix_hash_table_t *batches,
+                                                 pmix_rank_t dmn, prte_rml_tag_t tag)
+{
+    pmix_server_dmdx_batch_t *batch = NULL;
+
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_uint32(batches, dmn, (void **) &batch) ||
+        NULL == batch) {
+        batch = PMIX_NEW(pmix_server_dmdx_batch_t);
+        batch->dmn = dmn;
+        batch->tag = tag;
+        pmix_hash_table_set_value_uint32(batches, dmn, batch);
+    }
+    return batch;
+}
+
+/* add a packed request or response to a batch - it goes out
+ * at once if nothing is outstanding with the daemon, as there
+ * is then nothing to wait for */
+void pmix_server_dmdx_add(pmix_server_dmdx_batch_t *batch, pmix_data_buffer_t *rec)
+{
+    struct timeval tv;
     pmix_status_t prc;
 
-    PMIX_ACQUIRE_OBJECT(req);
+    prc = PMIx_Data_copy_payload(&batch->buf, rec);
+    if (PMIX_SUCCESS != prc) {
+        PMIX_ERROR_LOG(prc);
+        return;
+    }
+    ++batch->count;
+
+    if (0 == batch->outstanding || 0 >= prte_pmix_server_globals.dmdx_batch_window ||
+        batch->count >= prte_pmix_server_globals.dmdx_batch_max) {
+        pmix_server_dmdx_flush(batch);
+        return;
+    }
+    if (!batch->timer_active) {
+        tv.tv_sec = prte_pmix_server_globals.dmdx_batch_window / 1000000;
+        tv.tv_usec = prte_pmix_server_globals.dmdx_batch_window % 1000000;
+        prte_event_evtimer_set(prte_event_base, &batch->ev, batch_timeout, batch);
+        prte_event_evtimer_add(&batch->ev, &tv);
+        batch->timer_active = true;
+    }
+}
 
+/* a batch of requests could not be sent - fail them */
+static void fail_requests(pmix_data_buffer_t *msg, pmix_status_t status)
+{
+    pmix_server_req_t *req;
+    pmix_proc_t pproc;
+    pmix_info_t *info;
+    int32_t cnt, n, count;
+    size_t ninfo;
+    int room;
+
+    cnt = 1;
+    if (PMIX_SUCCESS != PMIx_Data_unpack(NULL, msg, &count, &cnt, PMIX_INT32)) {
+        return;
+    }
+    for (n = 0; n < count; n++) {
+        cnt = 1;
+        if (PMIX_SUCCESS != PMIx_Data_unpack(NULL, msg, &pproc, &cnt, PMIX_PROC)) {
+            return;
+        }
+        cnt = 1;
+        if (PMIX_SUCCESS != PMIx_Data_unpack(NULL, msg, &room, &cnt, PMIX_INT)) {
+            return;
+        }
+        cnt = 1;
+        if (PMIX_SUCCESS != PMIx_Data_unpack(NULL, msg, &ninfo, &cnt, PMIX_SIZE)) {
+            return;
+        }
+        if (0 < ninfo) {
+            PMIX_INFO_CREATE(info, ninfo);
+            cnt = ninfo;
+            (void) PMIx_Data_unpack(NULL, msg, info, &cnt, PMIX_INFO);
+            PMIX_INFO_FREE(info, ninfo);
+        }
+        req = (pmix_server_req_t *) pmix_pointer_array_get_item(&prte_pmix_server_globals.local_reqs,
+                                                                room);
+        if (NULL == req) {
+            continue;
+        }
+        pmix_server_dmdx_unwait(req);
+        if (NULL != req->mdxcbfunc) {
+            req->mdxcbfunc(status, NULL, 0, req->cbdata, NULL, NULL);
+        }
+        PMIX_RELEASE(req);
+    }
+}
+
+/* send whatever the batch holds */
+void pmix_server_dmdx_flush(pmix_server_dmdx_batch_t *batch)
+{
+    pmix_data_buffer_t *msg;
+    pmix_status_t prc;
+    int32_t count;
+    int rc;
+
+    if (batch->timer_active) {
+        prte_event_evtimer_del(&batch->ev);
+        batch->timer_active = false;
+    }
+    if (0 == batch->count) {
+        return;
+    }
+
+    PMIX_DATA_BUFFER_CREATE(msg);
+    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, msg, &batch->count, 1, PMIX_INT32)) ||
+        PMIX_SUCCESS != (prc = PMIx_Data_copy_payload(msg, &batch->buf))) {
+        PMIX_ERROR_LOG(prc);
+        PMIX_DATA_BUFFER_RELEASE(msg);
+        return;
+    }
+    PMIX_DATA_BUFFER_DESTRUCT(&batch->buf);
+    PMIX_DATA_BUFFER_CONSTRUCT(&batch->buf);
+
+    pmix_output_verbose(2, prte_pmix_server_globals.output,
+                        "%s dmdx:batch sending %d %s to daemon %u",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), batch->count,
+                        (PRTE_RML_TAG_DIRECT_MODEX == batch->tag) ? "requests" : "responses",
+                        batch->dmn);
+    count = batch->count;
+    batch->count = 0;
+    if (PRTE_RML_TAG_DIRECT_MODEX == batch->tag) {
+        batch->outstanding += count;
+        ++prte_pmix_server_globals.dmdx_stats.req_msgs;
+    } else {
+        ++prte_pmix_server_globals.dmdx_stats.resp_msgs;
+    }
+
+    PRTE_RML_SEND(rc, batch->dmn, msg, batch->tag);
+    if (PRTE_SUCCESS != rc) {
+        PRTE_ERROR_LOG(rc);
+        if (PRTE_RML_TAG_DIRECT_MODEX == batch->tag) {
+            batch->outstanding -= count;
+            fail_requests(msg, prte_pmix_convert_rc(rc));
+        }
+        PMIX_DATA_BUFFER_RELEASE(msg);
+    }
+}
+
+/* return the data for a proc - or the reason we could not - to
+ * the daemon that requested it */
+void pmix_server_dmdx_respond(pmix_rank_t dmn, pmix_status_t status, const pmix_proc_t *tproc,
+                              int room, char *data, size_t sz)
+{
+    pmix_server_dmdx_batch_t *batch;
+    pmix_data_buffer_t rec;
+    pmix_status_t prc;
+
+    PMIX_DATA_BUFFER_CONSTRUCT(&rec);
     /* pack the status */
-    PMIX_DATA_BUFFER_CREATE(reply);
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &status, 1, PMIX_STATUS))) {
+    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, &status, 1, PMIX_STATUS))) {
         PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        goto error;
+        goto done;
     }
     /* pack the id of the requested proc */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &req->tproc, 1, PMIX_PROC))) {
+    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, (void *) tproc, 1, PMIX_PROC))) {
         PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        goto error;
+        goto done;
     }
-
     /* pack the remote daemon's request room number */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &req->remote_room_num, 1, PMIX_INT))) {
+    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, &room, 1, PMIX_INT))) {
         PMIX_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
-        goto error;
+        goto done;
     }
     if (PMIX_SUCCESS == status) {
         /* return any provided data */
-        if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, &sz, 1, PMIX_SIZE))) {
+        if (NULL == data) {
+            sz = 0;
+        }
+        if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, &sz, 1, PMIX_SIZE))) {
             PMIX_ERROR_LOG(prc);
-            PMIX_DATA_BUFFER_RELEASE(reply);
-            goto error;
+            goto done;
         }
         if (0 < sz) {
-            if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, reply, data, sz, PMIX_BYTE))) {
+            if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, data, sz, PMIX_BYTE))) {
                 PMIX_ERROR_LOG(prc);
-                PMIX_DATA_BUFFER_RELEASE(reply);
-                goto error;
+                goto done;
             }
         }
     }
 
-    /* send the response */
-    PRTE_RML_SEND(prc, req->proxy.rank, reply, PRTE_RML_TAG_DIRECT_MODEX_RESP);
-    if (PRTE_SUCCESS != prc) {
-        PRTE_ERROR_LOG(prc);
-        PMIX_DATA_BUFFER_RELEASE(reply);
+    batch = pmix_server_dmdx_batch(&prte_pmix_server_globals.dmdx_resps, dmn,
+                                   PRTE_RML_TAG_DIRECT_MODEX_RESP);
+    ++prte_pmix_server_globals.dmdx_stats.resps;
+    pmix_server_dmdx_add(batch, &rec);
+
+done:
+    PMIX_DATA_BUFFER_DESTRUCT(&rec);
+}
+
+void pmix_server_dmdx_query_stats(pmix_info_t *info)
+{
+    pmix_server_dmdx_stats_t *st = &prte_pmix_server_globals.dmdx_stats;
+    pmix_data_array_t *darray;
+    pmix_info_t *iptr;
+    uint64_t avg;
+
+    avg = (0 == st->replies) ? 0 : st->latency / st->replies;
+    PMIX_DATA_ARRAY_CREATE(darray, 12, PMIX_INFO);
+    iptr = (pmix_info_t *) darray->array;
+    PMIX_INFO_LOAD(&iptr[0], PRTE_DMDX_REQS, &st->reqs, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[1], PRTE_DMDX_REQ_MSGS, &st->req_msgs, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[2], PRTE_DMDX_RESPS, &st->resps, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[3], PRTE_DMDX_RESP_MSGS, &st->resp_msgs, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[4], PRTE_DMDX_AVG_LATENCY, &avg, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[5], PRTE_DMDX_MAX_LATENCY, &st->max_latency, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[6], PRTE_DMDX_CACHE_HITS, &st->hits, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[7], PRTE_DMDX_CACHE_MISSES, &st->misses, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[8], PRTE_DMDX_PUSHED, &st->pushed, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[9], PRTE_DMDX_CACHED, &st->cached, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[10], PRTE_DMDX_EVICTED, &st->evicted, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[11], PRTE_DMDX_CACHE_BYTES, &prte_pmix_server_globals.dmdx_cache_bytes,
+                   PMIX_SIZE);
+    PMIX_LOAD_KEY(info->key, PRTE_DMDX_QUERY_STATS);
+    info->value.type = PMIX_DATA_ARRAY;
+    info->value.data.darray = darray;
+}
+
+static pmix_server_dmdx_blob_t *cache_find(const pmix_proc_t *proc)
+{
+    pmix_server_dmdx_blob_t *blob = NULL;
+    pmix_proc_t key;
+
+    /* the key is the whole proc id, so clear what follows the nspace */
+    PMIX_LOAD_PROCID(&key, proc->nspace, proc->rank);
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_pmix_server_globals.dmdx_cache_index,
+                                                      &key, sizeof(key), (void **) &blob)) {
+        return NULL;
+    }
+    return blob;
+}
+
+/* take a blob out of the cache - the caller owns it then */
+static void cache_remove(pmix_server_dmdx_blob_t *blob)
+{
+    pmix_hash_table_remove_value_ptr(&prte_pmix_server_globals.dmdx_cache_index, &blob->proc,
+                                     sizeof(pmix_proc_t));
+    pmix_list_remove_item(&prte_pmix_server_globals.dmdx_cache, &blob->super);
+    prte_pmix_server_globals.dmdx_cache_bytes -= blob->sz;
+}
+
+/* keep the data another daemon sent ahead for one of its procs,
+ * dropping the oldest we hold if that is needed to stay within
+ * the limit */
+void pmix_server_dmdx_cache_add(const pmix_proc_t *proc, char *data, size_t sz)
+{
+    pmix_server_dmdx_blob_t *blob;
+
+    if (sz > prte_pmix_server_globals.dmdx_cache_max || NULL != cache_find(proc)) {
+        return;
+    }
+    while (prte_pmix_server_globals.dmdx_cache_bytes + sz > prte_pmix_server_globals.dmdx_cache_max) {
+        blob = (pmix_server_dmdx_blob_t *) pmix_list_get_first(&prte_pmix_server_globals.dmdx_cache);
+        cache_remove(blob);
+        PMIX_RELEASE(blob);
+        ++prte_pmix_server_globals.dmdx_stats.evicted;
+    }
+
+    blob = PMIX_NEW(pmix_server_dmdx_blob_t);
+    PMIX_LOAD_PROCID(&blob->proc, proc->nspace, proc->rank);
+    if (0 < sz) {
+        blob->data = (char *) malloc(sz);
+        if (NULL == blob->data) {
+            PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+            PMIX_RELEASE(blob);
+            return;
+        }
+        memcpy(blob->data, data, sz);
+        blob->sz = sz;
+    }
+    pmix_list_append(&prte_pmix_server_globals.dmdx_cache, &blob->super);
+    pmix_hash_table_set_value_ptr(&prte_pmix_server_globals.dmdx_cache_index, &blob->proc,
+                                  sizeof(pmix_proc_t), blob);
+    prte_pmix_server_globals.dmdx_cache_bytes += sz;
+    ++prte_pmix_server_globals.dmdx_stats.cached;
+}
+
+/* forget what we hold for, and have sent ahead from, a job */
+void pmix_server_dmdx_purge(const pmix_nspace_t nspace)
+{
+    pmix_server_dmdx_blob_t *blob, *next;
+    pmix_bitmap_t *sent;
+
+    PMIX_LIST_FOREACH_SAFE(blob, next, &prte_pmix_server_globals.dmdx_cache, pmix_server_dmdx_blob_t)
+    {
+        if (PMIX_CHECK_NSPACE(blob->proc.nspace, nspace)) {
+            cache_remove(blob);
+            PMIX_RELEASE(blob);
+        }
+    }
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&prte_pmix_server_globals.dmdx_prefetched,
+                                                      nspace, strlen(nspace), (void **) &sent)) {
+        pmix_hash_table_remove_value_ptr(&prte_pmix_server_globals.dmdx_prefetched, nspace,
+                                         strlen(nspace));
+        PMIX_RELEASE(sent);
+    }
+}
+
+/* save a direct modex request in local_reqs until its data is
+ * returned, and list it under the proc it is waiting for */
+void pmix_server_dmdx_wait(pmix_server_req_t *req)
+{
+    pmix_server_dmdx_waiter_t *w;
+    pmix_list_t *waiters = NULL;
+    pmix_proc_t key;
+
+    req->room_num = pmix_pointer_array_add(&prte_pmix_server_globals.local_reqs, req);
+    PMIX_LOAD_PROCID(&key, req->tproc.nspace, req->tproc.rank);
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_pmix_server_globals.dmdx_waiting,
+                                                      &key, sizeof(key), (void **) &waiters)) {
+        waiters = PMIX_NEW(pmix_list_t);
+        pmix_hash_table_set_value_ptr(&prte_pmix_server_globals.dmdx_waiting, &key, sizeof(key),
+                                      waiters);
+    }
+    w = PMIX_NEW(pmix_server_dmdx_waiter_t);
+    w->req = req;
+    pmix_list_append(waiters, &w->super);
+}
+
+/* take a direct modex request out of local_reqs - the caller
+ * still owns it */
+void pmix_server_dmdx_unwait(pmix_server_req_t *req)
+{
+    pmix_server_dmdx_waiter_t *w;
+    pmix_list_t *waiters = NULL;
+    pmix_proc_t key;
+
+    pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
+    PMIX_LOAD_PROCID(&key, req->tproc.nspace, req->tproc.rank);
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_pmix_server_globals.dmdx_waiting,
+                                                      &key, sizeof(key), (void **) &waiters)) {
+        return;
+    }
+    PMIX_LIST_FOREACH(w, waiters, pmix_server_dmdx_waiter_t)
+    {
+        if (w->req == req) {
+            pmix_list_remove_item(waiters, &w->super);
+            PMIX_RELEASE(w);
+            break;
+        }
+    }
+    if (pmix_list_is_empty(waiters)) {
+        pmix_hash_table_remove_value_ptr(&prte_pmix_server_globals.dmdx_waiting, &key,
+                                         sizeof(key));
+        PMIX_RELEASE(waiters);
+    }
+}
+
+/* the direct modex requests waiting for the data of a proc, or
+ * NULL if there are none */
+pmix_list_t *pmix_server_dmdx_waiters(const pmix_proc_t *proc)
+{
+    pmix_list_t *waiters = NULL;
+    pmix_proc_t key;
+
+    PMIX_LOAD_PROCID(&key, proc->nspace, proc->rank);
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_pmix_server_globals.dmdx_waiting,
+                                                      &key, sizeof(key), (void **) &waiters)) {
+        return NULL;
     }
+    return waiters;
+}
 
-error:
+static void blob_release(void *cbdata)
+{
+    pmix_server_dmdx_blob_t *blob = (pmix_server_dmdx_blob_t *) cbdata;
+
+    PMIX_RELEASE(blob);
+}
+
+static void modex_resp(pmix_status_t status, char *data, size_t sz, void *cbdata)
+{
+    pmix_server_req_t *req = (pmix_server_req_t *) cbdata;
+
+    PMIX_ACQUIRE_OBJECT(req);
+
+    /* the request is our own, so this comes straight back to us */
+    pmix_server_dmdx_respond(req->proxy.rank, status, &req->tproc, req->remote_room_num,
+                             data, sz);
     PMIX_RELEASE(req);
-    return;
 }
 
 static void dmodex_req(int sd, short args, void *cbdata)
 {
     pmix_server_req_t *req = (pmix_server_req_t *) cbdata;
-    pmix_server_req_t *r;
+    pmix_server_dmdx_waiter_t *w;
+    pmix_list_t *waiters;
     prte_job_t *jdata;
     prte_proc_t *proct, *dmn;
-    int rc, rnum;
-    pmix_data_buffer_t *buf;
+    int rc;
+    pmix_server_dmdx_batch_t *batch;
+    pmix_server_dmdx_blob_t *blob;
+    pmix_data_buffer_t rec;
     pmix_status_t prc = PMIX_ERROR;
     bool refresh_cache = false;
     pmix_value_t *pval;
@@ -235,7 +581,7 @@ static void dmodex_req(int sd, short args, void *cbdata)
             req->proxy = *PRTE_PROC_MY_NAME;
             /* save the request in the local_req array until the
              * data is returned */
-            req->room_num = pmix_pointer_array_add(&prte_pmix_server_globals.local_reqs, req);
+            pmix_server_dmdx_wait(req);
             /* set the "remote" room number to our own */
             req->remote_room_num = req->room_num;
             PMIX_RETAIN(req);
@@ -251,16 +597,15 @@ static void dmodex_req(int sd, short args, void *cbdata)
 
     /* has anyone already requested data for this target? If so,
      * then the data is already on its way */
-    for (rnum = 0; rnum < prte_pmix_server_globals.local_reqs.size; rnum++) {
-        r = (pmix_server_req_t*)pmix_pointer_array_get_item(&prte_pmix_server_globals.local_reqs, rnum);
-        if (NULL == r) {
-            continue;
-        }
-        if (PMIX_CHECK_PROCID(&r->target, &req->tproc)) {
-            /* save the request in the array until the
-             * data is returned */
-            req->room_num = pmix_pointer_array_add(&prte_pmix_server_globals.local_reqs, req);
-            return;
+    if (!refresh_cache && NULL != (waiters = pmix_server_dmdx_waiters(&req->tproc))) {
+        PMIX_LIST_FOREACH(w, waiters, pmix_server_dmdx_waiter_t)
+        {
+            if (0 < w->req->start.tv_sec) {
+                /* save the request in the array until the
+                 * data is returned */
+                pmix_server_dmdx_wait(req);
+                return;
+            }
         }
     }
 
@@ -270,7 +615,7 @@ static void dmodex_req(int sd, short args, void *cbdata)
          * condition where we are being asked about a process
          * that we don't know about yet. In this case, just
          * record the request and we will process it later */
-        req->room_num = pmix_pointer_array_add(&prte_pmix_server_globals.local_reqs, req);
+        pmix_server_dmdx_wait(req);
         return;
     }
     /* if this is a request for rank=WILDCARD, then they want the job-level data
@@ -308,12 +653,53 @@ static void dmodex_req(int sd, short args, void *cbdata)
         prc = PMIX_ERR_NOT_FOUND;
         goto callback;
     }
+
+    /* if the job was registered without the device distances of its
+     * remote procs, then provide them for this one now so they are
+     * available alongside the modex data when that arrives */
+    if (prte_pmix_server_globals.lazy_proc_data &&
+        prte_get_attribute(&jdata->attributes, PRTE_JOB_NSPACE_REGISTERED, NULL, PMIX_BOOL)) {
+        rc = prte_pmix_server_register_proc_data(jdata, proct);
+        if (PRTE_SUCCESS != rc) {
+            prc = prte_pmix_convert_rc(rc);
+            goto callback;
+        }
+        /* if they only wanted one of those values, then we are done */
+        if (NULL != req->key &&
+            PMIX_SUCCESS == PMIx_Get(&req->tproc, req->key, req->info, req->ninfo, &pval)) {
+            PMIX_VALUE_RELEASE(pval);
+            if (NULL != req->mdxcbfunc) {
+                req->mdxcbfunc(PMIX_SUCCESS, NULL, 0, req->cbdata, NULL, NULL);
+            }
+            PMIX_RELEASE(req);
+            return;
+        }
+    }
+
+    /* did the host daemon send the data ahead? Our PMIx server keeps
+     * it once given, so the copy is no longer needed after this */
+    if (NULL != (blob = cache_find(&req->tproc))) {
+        cache_remove(blob);
+        if (!refresh_cache) {
+            ++prte_pmix_server_globals.dmdx_stats.hits;
+            PRTE_FLAG_SET(proct, PRTE_PROC_FLAG_DATA_RECVD);
+            if (NULL != req->mdxcbfunc) {
+                req->mdxcbfunc(PMIX_SUCCESS, blob->data, blob->sz, req->cbdata, blob_release, blob);
+            } else {
+                PMIX_RELEASE(blob);
+            }
+            PMIX_RELEASE(req);
+            return;
+        }
+        PMIX_RELEASE(blob);
+    }
+
     /* point the request to the daemon that is hosting the
      * target process */
     req->proxy = dmn->name;
     /* track the request so we know the function and cbdata
      * to callback upon completion */
-    req->room_num = pmix_pointer_array_add(&prte_pmix_server_globals.local_reqs, req);
+    pmix_server_dmdx_wait(req);
     pmix_output_verbose(2, prte_pmix_server_globals.output,
                         "%s:%d MY REQ ROOM IS %d FOR KEY %s",
                         __FILE__, __LINE__, req->room_num,
@@ -324,46 +710,46 @@ static void dmodex_req(int sd, short args, void *cbdata)
         return;
     }
 
-    /* construct a request message */
-    PMIX_DATA_BUFFER_CREATE(buf);
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, buf, &req->tproc, 1, PMIX_PROC))) {
+    /* construct the request and add it to those headed for the
+     * host daemon */
+    PMIX_DATA_BUFFER_CONSTRUCT(&rec);
+    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, &req->tproc, 1, PMIX_PROC))) {
         PMIX_ERROR_LOG(prc);
-        pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
-        PMIX_DATA_BUFFER_RELEASE(buf);
+        pmix_server_dmdx_unwait(req);
+        PMIX_DATA_BUFFER_DESTRUCT(&rec);
         goto callback;
     }
     /* include the request room number for quick retrieval */
-    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, buf, &req->room_num, 1, PMIX_INT))) {
+    if (PMIX_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, &req->room_num, 1, PMIX_INT))) {
         PMIX_ERROR_LOG(prc);
-        pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
-        PMIX_DATA_BUFFER_RELEASE(buf);
+        pmix_server_dmdx_unwait(req);
+        PMIX_DATA_BUFFER_DESTRUCT(&rec);
         goto callback;
     }
     /* add any qualifiers */
-    if (PRTE_SUCCESS != (prc = PMIx_Data_pack(NULL, buf, &req->ninfo, 1, PMIX_SIZE))) {
+    if (PRTE_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, &req->ninfo, 1, PMIX_SIZE))) {
         PMIX_ERROR_LOG(prc);
-        pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
-        PMIX_DATA_BUFFER_RELEASE(buf);
+        pmix_server_dmdx_unwait(req);
+        PMIX_DATA_BUFFER_DESTRUCT(&rec);
         goto callback;
     }
     if (0 < req->ninfo) {
-        if (PRTE_SUCCESS != (prc = PMIx_Data_pack(NULL, buf, req->info, req->ninfo, PMIX_INFO))) {
+        if (PRTE_SUCCESS != (prc = PMIx_Data_pack(NULL, &rec, req->info, req->ninfo, PMIX_INFO))) {
             PMIX_ERROR_LOG(prc);
-            pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
-            PMIX_DATA_BUFFER_RELEASE(buf);
+            pmix_server_dmdx_unwait(req);
+            PMIX_DATA_BUFFER_DESTRUCT(&rec);
             goto callback;
         }
     }
 
-    /* send it to the host daemon */
-    PRTE_RML_SEND(rc, dmn->name.rank, buf, PRTE_RML_TAG_DIRECT_MODEX);
-    if (PRTE_SUCCESS != rc) {
-        PRTE_ERROR_LOG(rc);
-        pmix_pointer_array_set_item(&prte_pmix_server_globals.local_reqs, req->room_num, NULL);
-        PMIX_DATA_BUFFER_RELEASE(buf);
-        prc = prte_pmix_convert_rc(rc);
-        goto callback;
-    }
+    gettimeofday(&req->start, NULL);
+    ++prte_pmix_server_globals.dmdx_stats.reqs;
+    ++prte_pmix_server_globals.dmdx_stats.misses;
+    batch = pmix_server_dmdx_batch(&prte_pmix_server_globals.dmdx_reqs, dmn->name.rank,
+                                   PRTE_RML_TAG_DIRECT_MODEX);
+    /* this may send it, and fail it if that is not possible */
+    pmix_server_dmdx_add(batch, &rec);
+    PMIX_DATA_BUFFER_DESTRUCT(&rec);
     return;
 
 callback:
@@ -1087,6 +1087,8 @@ pmix_status_t pmix_server_iof_pull_fn(const pmix_proc_t procs[], size_t nprocs,
             }
         }
     }
+    /* output spliced into files is only copied while someone wants it */
+    prte_iof_base_pull(procs, nprocs, channels, stop);
     return PMIX_OPERATION_SUCCEEDED;
 }
 
@@ -1094,6 +1096,7 @@ static void pmix_server_stdin_push(int sd, short args, void *cbdata)
 {
     prte_pmix_server_op_caddy_t *cd = (prte_pmix_server_op_caddy_t *) cbdata;
     pmix_byte_object_t *bo = (pmix_byte_object_t *) cd->server_object;
+    bool held = false;
     size_t n;
 
     for (n = 0; n < cd->nprocs; n++) {
@@ -1102,12 +1105,16 @@ static void pmix_server_stdin_push(int sd, short args, void *cbdata)
                              PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
                              PRTE_NAME_PRINT(&cd->procs[n]),
                              bo->size));
-        prte_iof.push_stdin(&cd->procs[n], (uint8_t *) bo->bytes, bo->size);
+        if (PRTE_ERR_TEMP_OUT_OF_RESOURCE
+            == prte_iof.push_stdin(&cd->procs[n], (uint8_t *) bo->bytes, bo->size)) {
+            held = true;
+        }
     }
 
     if (NULL == bo->bytes || 0 == bo->size) {
         cd->cbfunc(PMIX_ERR_IOF_COMPLETE, cd->cbdata);
-    } else {
+    } else if (!held || !prte_iof_base_stdin_hold(cd->cbfunc, cd->cbdata)) {
+        /* otherwise the tool hears back once the sinks drain */
         cd->cbfunc(PMIX_SUCCESS, cd->cbdata);
     }
 
@@ -40,6 +40,7 @@
 #endif
 #include <pmix_server.h>
 
+#include "src/class/pmix_hash_table.h"
 #include "src/class/pmix_hotel.h"
 #include "src/event/event-internal.h"
 #include "src/mca/base/pmix_base.h"
@@ -91,6 +92,7 @@ typedef struct {
     int remote_room_num;
     bool flag;
     bool launcher;
+    bool parked;
     uid_t uid;
     gid_t gid;
     pid_t pid;
@@ -102,6 +104,7 @@ typedef struct {
     pmix_proc_t proxy;
     pmix_proc_t target;
     pmix_proc_t tproc;
+    struct timeval start;
     prte_job_t *jdata;
     pmix_data_buffer_t msg;
     pmix_op_cbfunc_t opcbfunc;
@@ -166,6 +169,73 @@ typedef struct {
 } prte_pmix_tool_t;
 PMIX_CLASS_DECLARATION(prte_pmix_tool_t);
 
+/* direct modex requests - or responses - headed for the same
+ * daemon, collected into one message. A batch goes out at once
+ * when nothing is outstanding with that daemon, and otherwise
+ * when it fills or its window expires */
+typedef struct {
+    pmix_object_t super;
+    prte_event_t ev;
+    bool timer_active;
+    pmix_rank_t dmn;
+    prte_rml_tag_t tag;
+    int32_t count;
+    /* requests: those sent to the daemon that it has neither
+     * answered nor parked until it can.
+     * responses: lookups for the daemon still in our PMIx server */
+    int outstanding;
+    pmix_data_buffer_t buf;
+} pmix_server_dmdx_batch_t;
+PMIX_CLASS_DECLARATION(pmix_server_dmdx_batch_t);
+
+/* the data of a remote proc that its daemon sent ahead of any
+ * request for it */
+typedef struct {
+    pmix_list_item_t super;
+    pmix_proc_t proc;
+    char *data;
+    size_t sz;
+} pmix_server_dmdx_blob_t;
+PMIX_CLASS_DECLARATION(pmix_server_dmdx_blob_t);
+
+/* a direct modex request in local_reqs, listed under the proc
+ * whose data it waits for */
+typedef struct {
+    pmix_list_item_t super;
+    pmix_server_req_t *req;
+} pmix_server_dmdx_waiter_t;
+PMIX_CLASS_DECLARATION(pmix_server_dmdx_waiter_t);
+
+typedef struct {
+    uint64_t reqs;        // procs requested from other daemons
+    uint64_t req_msgs;    // messages those requests went out in
+    uint64_t resps;       // procs answered for other daemons
+    uint64_t resp_msgs;   // messages those answers went out in
+    uint64_t replies;     // answers received to our requests
+    uint64_t latency;     // total usec from request to answer
+    uint64_t max_latency; // longest of them
+    uint64_t hits;        // requests served from the cache
+    uint64_t misses;      // requests that had to go to another daemon
+    uint64_t pushed;      // procs sent ahead to other daemons
+    uint64_t cached;      // procs sent ahead to us and kept
+    uint64_t evicted;     // of those, dropped to stay within the limit
+} pmix_server_dmdx_stats_t;
+
+/* query for the direct modex counters of the daemon, and its entries */
+#define PRTE_DMDX_QUERY_STATS  "prte.dmdx.stats"
+#define PRTE_DMDX_REQS         "prte.dmdx.reqs"        // uint64_t
+#define PRTE_DMDX_REQ_MSGS     "prte.dmdx.req_msgs"    // uint64_t
+#define PRTE_DMDX_RESPS        "prte.dmdx.resps"       // uint64_t
+#define PRTE_DMDX_RESP_MSGS    "prte.dmdx.resp_msgs"   // uint64_t
+#define PRTE_DMDX_AVG_LATENCY  "prte.dmdx.avg_latency" // uint64_t - usec
+#define PRTE_DMDX_MAX_LATENCY  "prte.dmdx.max_latency" // uint64_t - usec
+#define PRTE_DMDX_CACHE_HITS   "prte.dmdx.cache_hits"  // uint64_t
+#define PRTE_DMDX_CACHE_MISSES "prte.dmdx.cache_misses" // uint64_t
+#define PRTE_DMDX_PUSHED       "prte.dmdx.pushed"      // uint64_t
+#define PRTE_DMDX_CACHED       "prte.dmdx.cached"      // uint64_t
+#define PRTE_DMDX_EVICTED      "prte.dmdx.evicted"     // uint64_t
+#define PRTE_DMDX_CACHE_BYTES  "prte.dmdx.cache_bytes" // size_t - held now
+
 #define PRTE_IO_OP(t, nt, b, fn, cfn, cbd)                                         \
     do {                                                                           \
         prte_pmix_server_op_caddy_t *_cd;                                          \
@@ -350,8 +420,27 @@ PRTE_EXPORT extern void pmix_server_jobid_return(int status, pmix_proc_t *sender
 
 PRTE_EXPORT extern int prte_pmix_server_register_tool(pmix_nspace_t nspace);
 
+PRTE_EXPORT extern int prte_pmix_server_register_proc_data(prte_job_t *jdata, prte_proc_t *pptr);
+
 PRTE_EXPORT extern int pmix_server_cache_job_info(prte_job_t *jdata, pmix_info_t *info);
 
+/* batching of the direct modex traffic between daemons */
+PRTE_EXPORT extern pmix_server_dmdx_batch_t *pmix_server_dmdx_batch(pmix_hash_table_t *batches,
+                                                                    pmix_rank_t dmn,
+                                                                    prte_rml_tag_t tag);
+PRTE_EXPORT extern void pmix_server_dmdx_add(pmix_server_dmdx_batch_t *batch,
+                                             pmix_data_buffer_t *rec);
+PRTE_EXPORT extern void pmix_server_dmdx_flush(pmix_server_dmdx_batch_t *batch);
+PRTE_EXPORT extern void pmix_server_dmdx_respond(pmix_rank_t dmn, pmix_status_t status,
+                                                 const pmix_proc_t *tproc, int room,
+                                                 char *data, size_t sz);
+PRTE_EXPORT extern void pmix_server_dmdx_query_stats(pmix_info_t *info);
+PRTE_EXPORT extern void pmix_server_dmdx_cache_add(const pmix_proc_t *proc, char *data, size_t sz);
+PRTE_EXPORT extern void pmix_server_dmdx_purge(const pmix_nspace_t nspace);
+PRTE_EXPORT extern void pmix_server_dmdx_wait(pmix_server_req_t *req);
+PRTE_EXPORT extern void pmix_server_dmdx_unwait(pmix_server_req_t *req);
+PRTE_EXPORT extern pmix_list_t *pmix_server_dmdx_waiters(const pmix_proc_t *proc);
+
 /* exposed shared variables */
 typedef struct {
     pmix_list_item_t super;
@@ -378,6 +467,21 @@ typedef struct {
     char *report_uri;
     char *singleton;
     pmix_device_type_t generate_dist;
+    pmix_list_t localities;               // locality of each distinct binding
+    pmix_hash_table_t locality_index;     // ... by node and cpuset
+    bool lazy_proc_data;
+    int dmdx_batch_window;
+    int dmdx_batch_max;
+    pmix_hash_table_t dmdx_reqs;
+    pmix_hash_table_t dmdx_resps;
+    pmix_server_dmdx_stats_t dmdx_stats;
+    bool dmdx_prefetch;
+    size_t dmdx_cache_max;
+    size_t dmdx_cache_bytes;
+    pmix_list_t dmdx_cache;
+    pmix_hash_table_t dmdx_cache_index;
+    pmix_hash_table_t dmdx_prefetched;
+    pmix_hash_table_t dmdx_waiting;
     pmix_list_t tools;
     pmix_list_t psets;
     pmix_list_t groups;
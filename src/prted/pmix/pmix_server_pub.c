@@ -177,8 +177,15 @@ static void execute(int sd, short args, void *cbdata)
         goto callback;
     }
 
-    /* if the range is SESSION, then set the target to the global server */
-    if (PMIX_RANGE_SESSION == req->range) {
+    /* if the request is for one shard of the data, the target is
+     * already known - if the range is SESSION, then set the target
+     * to the global server */
+    if (PMIX_RANK_INVALID != req->target.rank) {
+        pmix_output_verbose(1, prte_pmix_server_globals.output,
+                            "%s orted:pmix:server shard %u",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), req->target.rank);
+        target = &req->target;
+    } else if (PMIX_RANGE_SESSION == req->range) {
         pmix_output_verbose(1, prte_pmix_server_globals.output,
                             "%s orted:pmix:server range SESSION",
                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
@@ -216,6 +223,302 @@ callback:
     PMIX_RELEASE(req);
 }
 
+/* when the data server keys are sharded across daemons, a request
+ * is split into one request per shard holding some of its keys, and
+ * the answers are combined here before the caller is told */
+typedef struct {
+    pmix_object_t super;
+    int pending;
+    pmix_status_t status;
+    bool partial;
+    pmix_pdata_t *pdata;
+    size_t npdata;
+    pmix_op_cbfunc_t opcbfunc;
+    pmix_lookup_cbfunc_t lkcbfunc;
+    void *cbdata;
+} prte_pubsub_split_t;
+static void spcon(prte_pubsub_split_t *p)
+{
+    p->pending = 0;
+    p->status = PMIX_SUCCESS;
+    p->partial = false;
+    p->pdata = NULL;
+    p->npdata = 0;
+    p->opcbfunc = NULL;
+    p->lkcbfunc = NULL;
+    p->cbdata = NULL;
+}
+static void spdes(prte_pubsub_split_t *p)
+{
+    if (NULL != p->pdata) {
+        PMIX_PDATA_FREE(p->pdata, p->npdata);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_pubsub_split_t, pmix_object_t, spcon, spdes);
+
+static void split_done(prte_pubsub_split_t *split)
+{
+    pmix_status_t rc;
+
+    if (0 < --split->pending) {
+        return;
+    }
+    if (NULL != split->opcbfunc) {
+        split->opcbfunc(split->status, split->cbdata);
+    } else if (NULL != split->lkcbfunc) {
+        rc = split->status;
+        if (PMIX_SUCCESS == rc || PMIX_ERR_NOT_FOUND == rc) {
+            if (0 == split->npdata) {
+                rc = PMIX_ERR_NOT_FOUND;
+            } else if (split->partial) {
+                rc = PMIX_QUERY_PARTIAL_SUCCESS;
+            } else {
+                rc = PMIX_SUCCESS;
+            }
+        }
+        split->lkcbfunc(rc, split->pdata, split->npdata, split->cbdata);
+    }
+    PMIX_RELEASE(split);
+}
+
+static void split_opcbfunc(pmix_status_t status, void *cbdata)
+{
+    prte_pubsub_split_t *split = (prte_pubsub_split_t *) cbdata;
+
+    if (PMIX_SUCCESS != status && PMIX_SUCCESS == split->status) {
+        split->status = status;
+    }
+    split_done(split);
+}
+
+static void split_lkcbfunc(pmix_status_t status, pmix_pdata_t pdata[], size_t ndata, void *cbdata)
+{
+    prte_pubsub_split_t *split = (prte_pubsub_split_t *) cbdata;
+    pmix_pdata_t *tmp;
+    size_t n;
+
+    if (PMIX_ERR_NOT_FOUND == status || PMIX_QUERY_PARTIAL_SUCCESS == status) {
+        /* some of the keys are missing */
+        split->partial = true;
+    } else if (PMIX_SUCCESS != status && PMIX_SUCCESS == split->status) {
+        split->status = status;
+    }
+    if (0 < ndata) {
+        /* the caller releases the answers it passed us */
+        PMIX_PDATA_CREATE(tmp, split->npdata + ndata);
+        if (NULL != split->pdata) {
+            memcpy(tmp, split->pdata, split->npdata * sizeof(pmix_pdata_t));
+            free(split->pdata);
+        }
+        for (n = 0; n < ndata; n++) {
+            memcpy(&tmp[split->npdata + n].proc, &pdata[n].proc, sizeof(pmix_proc_t));
+            PMIX_LOAD_KEY(tmp[split->npdata + n].key, pdata[n].key);
+            PMIx_Value_xfer(&tmp[split->npdata + n].value, &pdata[n].value);
+        }
+        split->pdata = tmp;
+        split->npdata += ndata;
+    }
+    split_done(split);
+}
+
+/* create the request for one shard, loaded with the command
+ * and the name of the proc making the request */
+static pmix_server_req_t *shard_req(uint8_t cmd, const pmix_proc_t *proc, pmix_rank_t shard,
+                                    prte_pubsub_split_t *split)
+{
+    pmix_server_req_t *req;
+    pmix_status_t rc;
+
+    req = PMIX_NEW(pmix_server_req_t);
+    pmix_asprintf(&req->operation, "SHARD %u: %s:%d", shard, __FILE__, __LINE__);
+    req->target.rank = shard;
+    if (NULL != split->opcbfunc) {
+        req->opcbfunc = split_opcbfunc;
+    } else {
+        req->lkcbfunc = split_lkcbfunc;
+    }
+    req->cbdata = split;
+
+    rc = PMIx_Data_pack(NULL, &req->msg, &cmd, 1, PMIX_UINT8);
+    if (PMIX_SUCCESS == rc) {
+        rc = PMIx_Data_pack(NULL, &req->msg, (pmix_proc_t *) proc, 1, PMIX_PROC);
+    }
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        PMIX_RELEASE(req);
+        return NULL;
+    }
+    return req;
+}
+
+static void shard_execute(pmix_server_req_t *req)
+{
+    /* thread-shift so we can store the tracker */
+    prte_event_set(prte_event_base, &(req->ev), -1, PRTE_EV_WRITE, execute, req);
+    prte_event_set_priority(&(req->ev), PRTE_MSG_PRI);
+    PMIX_POST_OBJECT(req);
+    prte_event_active(&(req->ev), PRTE_EV_WRITE, 1);
+}
+
+static bool is_directive(const pmix_info_t *info)
+{
+    return (PMIX_CHECK_KEY(info, PMIX_RANGE) || PMIX_CHECK_KEY(info, PMIX_PERSISTENCE)
+            || PMIX_CHECK_KEY(info, PMIX_USERID));
+}
+
+/* send each shard the values it holds, along with all the directives */
+static pmix_status_t shard_publish(const pmix_proc_t *proc, const pmix_info_t info[], size_t ninfo,
+                                   pmix_op_cbfunc_t cbfunc, void *cbdata)
+{
+    prte_pubsub_split_t *split;
+    pmix_server_req_t **reqs;
+    pmix_rank_t s, nshards = prte_data_server_nshards();
+    size_t n, ndirs = 0, *count;
+    pmix_status_t rc = PMIX_SUCCESS;
+
+    split = PMIX_NEW(prte_pubsub_split_t);
+    split->opcbfunc = cbfunc;
+    split->cbdata = cbdata;
+    reqs = (pmix_server_req_t **) calloc(nshards, sizeof(pmix_server_req_t *));
+    count = (size_t *) calloc(nshards, sizeof(size_t));
+
+    /* count the values for each shard */
+    for (n = 0; n < ninfo; n++) {
+        if (is_directive(&info[n])) {
+            ++ndirs;
+        } else {
+            ++count[prte_data_server_shard(info[n].key)];
+        }
+    }
+    for (s = 0; s < nshards && PMIX_SUCCESS == rc; s++) {
+        if (0 == count[s]) {
+            continue;
+        }
+        if (NULL == (reqs[s] = shard_req(PRTE_PMIX_PUBLISH_CMD, proc, s, split))) {
+            rc = PMIX_ERR_PACK_FAILURE;
+            break;
+        }
+        ++split->pending;
+        /* pack the number of infos */
+        count[s] += ndirs;
+        rc = PMIx_Data_pack(NULL, &reqs[s]->msg, &count[s], 1, PMIX_SIZE);
+        /* pack the infos */
+        for (n = 0; n < ninfo && PMIX_SUCCESS == rc; n++) {
+            if (is_directive(&info[n]) || s == prte_data_server_shard(info[n].key)) {
+                rc = PMIx_Data_pack(NULL, &reqs[s]->msg, (pmix_info_t *) &info[n], 1, PMIX_INFO);
+            }
+        }
+    }
+    if (PMIX_SUCCESS == rc && 0 == split->pending) {
+        /* nothing to publish */
+        rc = PMIX_ERR_BAD_PARAM;
+    }
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        for (s = 0; s < nshards; s++) {
+            if (NULL != reqs[s]) {
+                PMIX_RELEASE(reqs[s]);
+            }
+        }
+        PMIX_RELEASE(split);
+    } else {
+        for (s = 0; s < nshards; s++) {
+            if (NULL != reqs[s]) {
+                shard_execute(reqs[s]);
+            }
+        }
+    }
+    free(reqs);
+    free(count);
+    return rc;
+}
+
+/* send each shard the keys it holds, along with all the directives */
+static pmix_status_t shard_keys(uint8_t cmd, const pmix_proc_t *proc, char **keys,
+                                const pmix_info_t info[], size_t ninfo,
+                                pmix_op_cbfunc_t opcbfunc, pmix_lookup_cbfunc_t lkcbfunc,
+                                void *cbdata)
+{
+    prte_pubsub_split_t *split;
+    pmix_server_req_t **reqs;
+    pmix_rank_t s, nshards = prte_data_server_nshards();
+    size_t n, *count;
+    pmix_status_t rc = PMIX_SUCCESS;
+
+    split = PMIX_NEW(prte_pubsub_split_t);
+    split->opcbfunc = opcbfunc;
+    split->lkcbfunc = lkcbfunc;
+    split->cbdata = cbdata;
+    reqs = (pmix_server_req_t **) calloc(nshards, sizeof(pmix_server_req_t *));
+    count = (size_t *) calloc(nshards, sizeof(size_t));
+
+    /* count the keys for each shard */
+    for (n = 0; NULL != keys[n]; n++) {
+        ++count[prte_data_server_shard(keys[n])];
+    }
+    for (s = 0; s < nshards && PMIX_SUCCESS == rc; s++) {
+        if (0 == count[s]) {
+            continue;
+        }
+        if (NULL == (reqs[s] = shard_req(cmd, proc, s, split))) {
+            rc = PMIX_ERR_PACK_FAILURE;
+            break;
+        }
+        ++split->pending;
+        /* pack the number of keys */
+        rc = PMIx_Data_pack(NULL, &reqs[s]->msg, &count[s], 1, PMIX_SIZE);
+        /* pack the keys */
+        for (n = 0; NULL != keys[n] && PMIX_SUCCESS == rc; n++) {
+            if (s == prte_data_server_shard(keys[n])) {
+                rc = PMIx_Data_pack(NULL, &reqs[s]->msg, &keys[n], 1, PMIX_STRING);
+            }
+        }
+        /* pack the number of infos */
+        if (PMIX_SUCCESS == rc) {
+            rc = PMIx_Data_pack(NULL, &reqs[s]->msg, &ninfo, 1, PMIX_SIZE);
+        }
+        /* pack the infos */
+        if (PMIX_SUCCESS == rc && 0 < ninfo) {
+            rc = PMIx_Data_pack(NULL, &reqs[s]->msg, (pmix_info_t *) info, ninfo, PMIX_INFO);
+        }
+    }
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        for (s = 0; s < nshards; s++) {
+            if (NULL != reqs[s]) {
+                PMIX_RELEASE(reqs[s]);
+            }
+        }
+        PMIX_RELEASE(split);
+    } else {
+        for (s = 0; s < nshards; s++) {
+            if (NULL != reqs[s]) {
+                shard_execute(reqs[s]);
+            }
+        }
+    }
+    free(reqs);
+    free(count);
+    return rc;
+}
+
+/* the keys of requests beyond the local range are spread
+ * across shards if so configured */
+static bool sharded(const pmix_info_t info[], size_t ninfo)
+{
+    size_t n;
+
+    if (1 >= prte_data_server_nshards()) {
+        return false;
+    }
+    for (n = 0; n < ninfo; n++) {
+        if (PMIX_CHECK_KEY(&info[n], PMIX_RANGE)) {
+            return (PMIX_RANGE_LOCAL != info[n].value.data.range);
+        }
+    }
+    return true;
+}
+
 pmix_status_t pmix_server_publish_fn(const pmix_proc_t *proc, const pmix_info_t info[],
                                      size_t ninfo, pmix_op_cbfunc_t cbfunc, void *cbdata)
 {
@@ -228,6 +531,10 @@ pmix_status_t pmix_server_publish_fn(const pmix_proc_t *proc, const pmix_info_t
     pmix_output_verbose(1, prte_pmix_server_globals.output, "%s orted:pmix:server PUBLISH",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
 
+    if (sharded(info, ninfo)) {
+        return shard_publish(proc, info, ninfo, cbfunc, cbdata);
+    }
+
     /* create the caddy */
     req = PMIX_NEW(pmix_server_req_t);
     pmix_asprintf(&req->operation, "PUBLISH: %s:%d", __FILE__, __LINE__);
@@ -296,6 +603,10 @@ pmix_status_t pmix_server_lookup_fn(const pmix_proc_t *proc, char **keys, const
         return PMIX_ERR_BAD_PARAM;
     }
 
+    if (sharded(info, ninfo)) {
+        return shard_keys(cmd, proc, keys, info, ninfo, NULL, cbfunc, cbdata);
+    }
+
     /* create the caddy */
     req = PMIX_NEW(pmix_server_req_t);
     pmix_asprintf(&req->operation, "LOOKUP: %s:%d", __FILE__, __LINE__);
@@ -378,6 +689,10 @@ pmix_status_t pmix_server_unpublish_fn(const pmix_proc_t *proc, char **keys,
     size_t m, n;
     pmix_status_t rc;
 
+    if (NULL != keys && sharded(info, ninfo)) {
+        return shard_keys(cmd, proc, keys, info, ninfo, cbfunc, NULL, cbdata);
+    }
+
     /* create the caddy */
     req = PMIX_NEW(pmix_server_req_t);
     pmix_asprintf(&req->operation, "UNPUBLISH: %s:%d", __FILE__, __LINE__);
@@ -42,6 +42,7 @@
 #include "src/util/pmix_output.h"
 
 #include "src/mca/errmgr/errmgr.h"
+#include "src/mca/iof/base/base.h"
 #include "src/mca/iof/iof.h"
 #include "src/mca/plm/base/plm_private.h"
 #include "src/mca/plm/plm.h"
@@ -570,6 +571,30 @@ static void _query(int sd, short args, void *cbdata)
                 for (k = 0; k < grp->num_members; k++) {
                     PMIX_LOAD_PROCID(&proc[k], grp->members[k].nspace, grp->members[k].rank);
                 }
+            } else if (0 == strcmp(q->keys[n], PRTE_IOF_QUERY_OCCUPANCY)) {
+                /* the input held for each job - which of them is
+                 * applying back-pressure */
+                kv = PMIX_NEW(prte_info_item_t);
+                prte_iof_base_query_occupancy(&kv->info);
+                pmix_list_append(&results, &kv->super);
+            } else if (0 == strcmp(q->keys[n], PRTE_DMDX_QUERY_STATS)) {
+                /* how well this daemon batches its direct modex
+                 * traffic, and how long its requests take */
+                kv = PMIX_NEW(prte_info_item_t);
+                pmix_server_dmdx_query_stats(&kv->info);
+                pmix_list_append(&results, &kv->super);
+            } else if (0 == strcmp(q->keys[n], PRTE_RML_QUERY_TAG_STATS)) {
+                /* the traffic on each RML tag, and how many of its
+                 * messages are still waiting for a recv */
+                kv = PMIX_NEW(prte_info_item_t);
+                prte_rml_base_query_tag_stats(&kv->info);
+                pmix_list_append(&results, &kv->super);
+            } else if (0 == strcmp(q->keys[n], PRTE_RML_QUERY_PAYLOAD_STATS)) {
+                /* the bytes copied versus sent by the shared payloads
+                 * of our relays */
+                kv = PMIX_NEW(prte_info_item_t);
+                prte_rml_base_query_payload_stats(&kv->info);
+                pmix_list_append(&results, &kv->super);
             } else {
                 fprintf(stderr, "Query for unrecognized attribute: %s\n", q->keys[n]);
             }
@@ -37,8 +37,10 @@
 #include <pmix_server.h>
 
 #include "prte_stdint.h"
+#include "src/class/pmix_hash_table.h"
 #include "src/hwloc/hwloc-internal.h"
 #include "src/pmix/pmix-internal.h"
+#include "src/threads/pmix_threads.h"
 #include "src/util/pmix_argv.h"
 #include "src/util/error.h"
 #include "src/util/pmix_os_dirpath.h"
@@ -46,6 +48,7 @@
 #include "types.h"
 
 #include "src/mca/errmgr/errmgr.h"
+#include "src/mca/iof/base/base.h"
 #include "src/mca/rmaps/base/base.h"
 #include "src/runtime/prte_globals.h"
 #include "src/runtime/prte_wait.h"
@@ -56,6 +59,219 @@
 
 static void opcbfunc(pmix_status_t status, void *cbdata);
 
+/* The locality string and device distances of a proc depend only on
+ * its cpuset (and, for the distances, on the node it is on), and most
+ * procs share one of a few binding patterns. So compute them once per
+ * unique binding and keep them for the life of the server - the
+ * bindings a node's topology allows repeat from job to job */
+typedef struct {
+    pmix_list_item_t super;
+    char *cpuset;
+    prte_node_t *node;
+    pmix_status_t status;
+    char *locality;
+    pmix_device_distance_t *distances;
+    size_t ndist;
+} prte_pmix_locality_t;
+static void loccon(prte_pmix_locality_t *p)
+{
+    p->cpuset = NULL;
+    p->node = NULL;
+    p->status = PMIX_ERR_NOT_FOUND;
+    p->locality = NULL;
+    p->distances = NULL;
+    p->ndist = 0;
+}
+static void locdes(prte_pmix_locality_t *p)
+{
+    if (NULL != p->cpuset) {
+        free(p->cpuset);
+    }
+    if (NULL != p->locality) {
+        free(p->locality);
+    }
+    if (NULL != p->distances) {
+        PMIX_DEVICE_DIST_FREE(p->distances, p->ndist);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_pmix_locality_t, pmix_list_item_t, loccon, locdes);
+
+static void compute_locality(prte_pmix_locality_t *loc)
+{
+    pmix_cpuset_t cpuset;
+    pmix_topology_t topo;
+    pmix_info_t devinfo[2];
+    pmix_status_t ret;
+
+    PMIX_CPUSET_CONSTRUCT(&cpuset);
+    cpuset.source = "hwloc";
+    cpuset.bitmap = hwloc_bitmap_alloc();
+    hwloc_bitmap_list_sscanf(cpuset.bitmap, loc->cpuset);
+    loc->status = PMIx_server_generate_locality_string(&cpuset, &loc->locality);
+    if (PMIX_SUCCESS == loc->status && NULL != loc->node) {
+        /* compute the device distances for this binding */
+        topo.source = "hwloc";
+        topo.topology = loc->node->topology->topo;
+        PMIX_INFO_LOAD(&devinfo[0], PMIX_DEVICE_TYPE, &prte_pmix_server_globals.generate_dist, PMIX_DEVTYPE);
+        PMIX_INFO_LOAD(&devinfo[1], PMIX_HOSTNAME, loc->node->name, PMIX_STRING);
+        ret = PMIx_Compute_distances(&topo, &cpuset, devinfo, 2, &loc->distances, &loc->ndist);
+        if (PMIX_SUCCESS != ret) {
+            loc->distances = NULL;
+            loc->ndist = 0;
+        }
+        PMIX_INFO_DESTRUCT(&devinfo[0]);
+        PMIX_INFO_DESTRUCT(&devinfo[1]);
+    }
+    hwloc_bitmap_free(cpuset.bitmap);
+}
+
+/* find the entry for this proc's binding, computing it on first use.
+ * The device distances are only computed if requested
+ * This runs on the progress thread, as do all the PMIx calls made
+ * to compute it */
+static prte_pmix_locality_t *get_locality(prte_node_t *node, prte_proc_t *pptr, bool dist)
+{
+    pmix_hash_table_t *table = &prte_pmix_server_globals.locality_index;
+    prte_pmix_locality_t *loc = NULL;
+    char *key;
+    int idx = -1;
+
+    if (dist && 0 != prte_pmix_server_globals.generate_dist) {
+        idx = node->index;
+    }
+    if (0 > pmix_asprintf(&key, "%d:%s", idx, pptr->cpuset)) {
+        return NULL;
+    }
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(table, key, strlen(key), (void **) &loc)) {
+        loc = PMIX_NEW(prte_pmix_locality_t);
+        loc->cpuset = strdup(pptr->cpuset);
+        if (0 <= idx) {
+            loc->node = node;
+        }
+        compute_locality(loc);
+        pmix_hash_table_set_value_ptr(table, key, strlen(key), loc);
+        pmix_list_append(&prte_pmix_server_globals.localities, &loc->super);
+    }
+    free(key);
+    return loc;
+}
+
+/* add the data that varies by proc to the given info list. The
+ * locality must be given if the proc is bound */
+static int add_proc_data(prte_job_t *jdata, prte_node_t *node, prte_proc_t *pptr,
+                         pmix_proc_t *parentproc, prte_pmix_locality_t *loc, void *pmap)
+{
+    pmix_status_t ret;
+    pmix_data_array_t darray;
+    pmix_rank_t vpid;
+    uint32_t ui32;
+    char *tmp;
+    int rc;
+
+    /* must start with rank */
+    PMIX_INFO_LIST_ADD(ret, pmap, PMIX_RANK, &pptr->name.rank, PMIX_PROC_RANK);
+
+    /* location, for local procs */
+    if (NULL != pptr->cpuset) {
+        /* provide the cpuset string for this proc */
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_CPUSET, pptr->cpuset, PMIX_STRING);
+        if (NULL == loc || PMIX_SUCCESS != loc->status) {
+            ret = (NULL == loc) ? PMIX_ERR_NOT_FOUND : loc->status;
+            PMIX_ERROR_LOG(ret);
+            return prte_pmix_convert_status(ret);
+        }
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_LOCALITY_STRING, loc->locality, PMIX_STRING);
+        if (NULL != loc->distances) {
+            if (4 < pmix_output_get_verbosity(prte_pmix_server_globals.output)) {
+                size_t f;
+                for (f=0; f < loc->ndist; f++) {
+                    pmix_output(0, "UUID: %s OSNAME: %s TYPE: %s MIND: %u MAXD: %u",
+                                loc->distances[f].uuid, loc->distances[f].osname,
+                                PMIx_Device_type_string(loc->distances[f].type),
+                                loc->distances[f].mindist, loc->distances[f].maxdist);
+                }
+            }
+            darray.type = PMIX_DEVICE_DIST;
+            darray.array = loc->distances;
+            darray.size = loc->ndist;
+            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_DEVICE_DISTANCES, &darray, PMIX_DATA_ARRAY);
+        }
+    } else {
+        /* the proc is not bound */
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_LOCALITY_STRING, NULL, PMIX_STRING);
+    }
+    if (PRTE_PROC_MY_NAME->rank == node->daemon->name.rank) {
+        /* create and pass a proc-level session directory */
+        if (0 > pmix_asprintf(&tmp, "%s/%u/%u", prte_process_info.jobfam_session_dir,
+                              PRTE_LOCAL_JOBID(jdata->nspace), pptr->name.rank)) {
+            PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+            return PRTE_ERR_OUT_OF_RESOURCE;
+        }
+        if (PMIX_SUCCESS != (rc = pmix_os_dirpath_create(tmp, S_IRWXU))) {
+            PMIX_ERROR_LOG(rc);
+            free(tmp);
+            return prte_pmix_convert_status(rc);
+        }
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_PROCDIR, tmp, PMIX_STRING);
+        free(tmp);
+    }
+
+    /* global/univ rank */
+    vpid = pptr->name.rank + jdata->offset;
+    PMIX_INFO_LIST_ADD(ret, pmap, PMIX_GLOBAL_RANK, &vpid, PMIX_PROC_RANK);
+
+    /* parent ID, if we were spawned by a non-tool */
+    if (NULL != parentproc) {
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_PARENT_ID, parentproc, PMIX_PROC);
+    }
+
+    /* appnum */
+    PMIX_INFO_LIST_ADD(ret, pmap, PMIX_APPNUM, &pptr->app_idx, PMIX_UINT32);
+
+    /* app rank */
+    PMIX_INFO_LIST_ADD(ret, pmap, PMIX_APP_RANK, &pptr->app_rank, PMIX_PROC_RANK);
+
+    /* local rank */
+    if (PRTE_LOCAL_RANK_INVALID != pptr->local_rank) {
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_LOCAL_RANK, &pptr->local_rank, PMIX_UINT16);
+    }
+
+    /* node rank */
+    if (PRTE_NODE_RANK_INVALID != pptr->node_rank) {
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_NODE_RANK, &pptr->node_rank, PMIX_UINT16);
+    }
+
+    /* node ID */
+    PMIX_INFO_LIST_ADD(ret, pmap, PMIX_NODEID, &pptr->node->index, PMIX_UINT32);
+
+    /* reincarnation number */
+    ui32 = 0; // we are starting this proc for the first time
+    PMIX_INFO_LIST_ADD(ret, pmap, PMIX_REINCARNATION, &ui32, PMIX_UINT32);
+
+    if (jdata->map->num_nodes < prte_hostname_cutoff) {
+        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_HOSTNAME, pptr->node->name, PMIX_STRING);
+    }
+    return PRTE_SUCCESS;
+}
+
+/* get the parent job that spawned this one, if it wasn't us */
+static pmix_proc_t *get_parent(prte_job_t *jdata)
+{
+    pmix_proc_t *parentproc;
+    prte_job_t *parent;
+
+    if (!prte_get_attribute(&jdata->attributes, PRTE_JOB_LAUNCH_PROXY, (void **) &parentproc, PMIX_PROC)) {
+        return NULL;
+    }
+    parent = prte_get_job_data_object(parentproc->nspace);
+    if (NULL == parent || PMIX_CHECK_NSPACE(PRTE_PROC_MY_NAME->nspace, parent->nspace)) {
+        PMIX_PROC_RELEASE(parentproc);
+        return NULL;
+    }
+    return parentproc;
+}
+
+
 /* stuff proc attributes for sending back to a proc */
 int prte_pmix_server_register_nspace(prte_job_t *jdata)
 {
@@ -75,21 +291,17 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
     hwloc_obj_t machine;
     pmix_proc_t pproc, *parentproc;
     pmix_status_t ret;
-    pmix_info_t *pinfo, devinfo[2];
+    pmix_info_t *pinfo;
     size_t ninfo;
     prte_pmix_lock_t lock;
     pmix_list_t local_procs;
     prte_namelist_t *nm;
     size_t nmsize;
     pmix_server_pset_t *pset;
-    pmix_cpuset_t cpuset;
     uint32_t ui32;
-    prte_job_t *parent = NULL;
-    pmix_device_distance_t *distances;
-    size_t ndist;
-    pmix_topology_t topo;
     pmix_data_array_t darray, lparray;
-    bool flag, *fptr;
+    bool flag, *fptr, dist;
+    prte_pmix_locality_t *loc;
 
     pmix_output_verbose(2, prte_pmix_server_globals.output, "%s register nspace for %s",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_JOBID_PRINT(jdata->nspace));
@@ -98,7 +310,6 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
     PMIX_INFO_LIST_START(info);
     uid = geteuid();
     gid = getegid();
-    topo.source = "hwloc";
 
     /* pass our nspace/rank */
     PMIX_INFO_LIST_ADD(ret, info, PMIX_SERVER_NSPACE, prte_process_info.myproc.nspace, PMIX_STRING);
@@ -343,17 +554,20 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
     if (prte_get_attribute(&jdata->attributes, PRTE_JOB_XML_OUTPUT, (void**)&fptr, PMIX_BOOL)) {
         PMIX_INFO_LIST_ADD(ret, info, PMIX_IOF_XML_OUTPUT, &flag, PMIX_BOOL);
     }
-    tmp = NULL;
-    if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_FILE, (void **) &tmp, PMIX_STRING)
-        && NULL != tmp) {
-        PMIX_INFO_LIST_ADD(ret, info, PMIX_OUTPUT_TO_FILE, tmp, PMIX_STRING);
-        free(tmp);
-    }
-    tmp = NULL;
-    if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_DIRECTORY, (void **) &tmp, PMIX_STRING)
-        && NULL != tmp) {
-        PMIX_INFO_LIST_ADD(ret, info, PMIX_OUTPUT_TO_DIRECTORY, tmp, PMIX_STRING);
-        free(tmp);
+    /* when output is spliced, the daemons write the files themselves */
+    if (!prte_iof_base_splice_job(jdata)) {
+        tmp = NULL;
+        if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_FILE, (void **) &tmp, PMIX_STRING)
+            && NULL != tmp) {
+            PMIX_INFO_LIST_ADD(ret, info, PMIX_OUTPUT_TO_FILE, tmp, PMIX_STRING);
+            free(tmp);
+        }
+        tmp = NULL;
+        if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_TO_DIRECTORY, (void **) &tmp, PMIX_STRING)
+            && NULL != tmp) {
+            PMIX_INFO_LIST_ADD(ret, info, PMIX_OUTPUT_TO_DIRECTORY, tmp, PMIX_STRING);
+            free(tmp);
+        }
     }
     if (prte_get_attribute(&jdata->attributes, PRTE_JOB_OUTPUT_NOCOPY, (void**)&fptr, PMIX_BOOL)) {
         PMIX_INFO_LIST_ADD(ret, info, PMIX_OUTPUT_NOCOPY, &flag, PMIX_BOOL);
@@ -404,25 +618,21 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
     }
 
     /* get the parent job that spawned this one */
-    if (prte_get_attribute(&jdata->attributes, PRTE_JOB_LAUNCH_PROXY, (void **) &parentproc, PMIX_PROC)) {
-        parent = prte_get_job_data_object(parentproc->nspace);
-        if (NULL != parent && PMIX_CHECK_NSPACE(PRTE_PROC_MY_NAME->nspace, parent->nspace)) {
-            PMIX_PROC_RELEASE(parentproc);
-            parent = NULL;
-        }
-    }
+    parentproc = get_parent(jdata);
 
     /* for each proc in this job, create an object that
      * includes the info describing the proc so the recipient has a complete
      * picture. This allows procs to connect to each other without
      * any further info exchange, assuming the underlying transports
      * support it. We also pass all the proc-specific data here so
-     * that each proc can lookup info about every other proc in the job */
-    if (0 != prte_pmix_server_globals.generate_dist) {
-        PMIX_INFO_LOAD(&devinfo[0], PMIX_DEVICE_TYPE, &prte_pmix_server_globals.generate_dist, PMIX_DEVTYPE);
-        PMIX_INFO_LOAD(&devinfo[1], PMIX_HOSTNAME, NULL, PMIX_STRING);
-    }
-
+     * that each proc can lookup info about every other proc in the job.
+     * If lazy registration was requested, the device distances of
+     * remote procs are left out - our PMIx server answers requests
+     * for the other values of a registered job itself, so those must
+     * all be here. The distances of a remote proc are provided by
+     * prte_pmix_server_register_proc_data when a local client first
+     * asks us for that proc's data.
+     */
     for (n = 0; n < map->nodes->size; n++) {
         if (NULL == (node = (prte_node_t *) pmix_pointer_array_get_item(map->nodes, n))) {
             continue;
@@ -437,113 +647,26 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
             if (!PMIX_CHECK_NSPACE(pptr->name.nspace, jdata->nspace)) {
                 continue;
             }
+            /* remote distances are left for later if registering lazily */
+            dist = !prte_pmix_server_globals.lazy_proc_data ||
+                   PRTE_PROC_MY_NAME->rank == node->daemon->name.rank;
             /* setup the proc map object */
             PMIX_INFO_LIST_START(pmap);
-
-            /* must start with rank */
-            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_RANK, &pptr->name.rank, PMIX_PROC_RANK);
-
-            /* location, for local procs */
+            loc = NULL;
             if (NULL != pptr->cpuset) {
-                /* provide the cpuset string for this proc */
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_CPUSET, pptr->cpuset, PMIX_STRING);
-                /* let PMIx generate the locality string */
-                PMIX_CPUSET_CONSTRUCT(&cpuset);
-                cpuset.source = "hwloc";
-                cpuset.bitmap = hwloc_bitmap_alloc();
-                hwloc_bitmap_list_sscanf(cpuset.bitmap, pptr->cpuset);
-                ret = PMIx_server_generate_locality_string(&cpuset, &tmp);
-                if (PMIX_SUCCESS != ret) {
-                    PMIX_ERROR_LOG(ret);
-                    hwloc_bitmap_free(cpuset.bitmap);
-                    PMIX_INFO_LIST_RELEASE(info);
-                    PMIX_INFO_LIST_RELEASE(pmap);
-                    return prte_pmix_convert_status(ret);
-                }
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_LOCALITY_STRING, tmp, PMIX_STRING);
-                free(tmp);
-                if (0 != prte_pmix_server_globals.generate_dist) {
-                    /* compute the device distances for this proc */
-                    topo.topology = node->topology->topo;
-                    devinfo[1].value.data.string = node->name;
-                    ret = PMIx_Compute_distances(&topo, &cpuset,
-                                                 devinfo, 2, &distances, &ndist);
-                    devinfo[1].value.data.string = NULL;
-                    if (PMIX_SUCCESS == ret) {
-                        if (4 < pmix_output_get_verbosity(prte_pmix_server_globals.output)) {
-                            size_t f;
-                            for (f=0; f < ndist; f++) {
-                                pmix_output(0, "UUID: %s OSNAME: %s TYPE: %s MIND: %u MAXD: %u",
-                                            distances[f].uuid, distances[f].osname,
-                                            PMIx_Device_type_string(distances[f].type),
-                                            distances[f].mindist, distances[f].maxdist);
-                            }
-                        }
-                        darray.array = distances;
-                        darray.size = ndist;
-                        PMIX_INFO_LIST_ADD(ret, pmap, PMIX_DEVICE_DISTANCES, &darray, PMIX_DATA_ARRAY);
-                        PMIX_DEVICE_DIST_FREE(distances, ndist);
-                    }
-                }
-                hwloc_bitmap_free(cpuset.bitmap);
-            } else {
-                /* the proc is not bound */
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_LOCALITY_STRING, NULL, PMIX_STRING);
+                loc = get_locality(node, pptr, dist);
             }
-            if (PRTE_PROC_MY_NAME->rank == node->daemon->name.rank) {
-                /* create and pass a proc-level session directory */
-                if (0 > pmix_asprintf(&tmp, "%s/%u/%u", prte_process_info.jobfam_session_dir,
-                                      PRTE_LOCAL_JOBID(jdata->nspace), pptr->name.rank)) {
-                    PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
-                    PMIX_INFO_LIST_RELEASE(info);
-                    PMIX_INFO_LIST_RELEASE(pmap);
-                    return PRTE_ERR_OUT_OF_RESOURCE;
-                }
-                if (PMIX_SUCCESS != (rc = pmix_os_dirpath_create(tmp, S_IRWXU))) {
-                    PMIX_ERROR_LOG(rc);
-                    PMIX_INFO_LIST_RELEASE(info);
-                    PMIX_INFO_LIST_RELEASE(pmap);
-                    rc = prte_pmix_convert_status(rc);
-                    return rc;
+            rc = add_proc_data(jdata, node, pptr, parentproc, loc, pmap);
+            if (PRTE_SUCCESS != rc) {
+                PMIX_INFO_LIST_RELEASE(info);
+                PMIX_INFO_LIST_RELEASE(pmap);
+                if (NULL != parentproc) {
+                    PMIX_PROC_RELEASE(parentproc);
                 }
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_PROCDIR, tmp, PMIX_STRING);
-                free(tmp);
-            }
-
-            /* global/univ rank */
-            vpid = pptr->name.rank + jdata->offset;
-            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_GLOBAL_RANK, &vpid, PMIX_PROC_RANK);
-
-            /* parent ID, if we were spawned by a non-tool */
-            if (NULL != parent) {
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_PARENT_ID, parentproc, PMIX_PROC);
-            }
-
-            /* appnum */
-            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_APPNUM, &pptr->app_idx, PMIX_UINT32);
-
-            /* app rank */
-            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_APP_RANK, &pptr->app_rank, PMIX_PROC_RANK);
-
-            /* local rank */
-            if (PRTE_LOCAL_RANK_INVALID != pptr->local_rank) {
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_LOCAL_RANK, &pptr->local_rank, PMIX_UINT16);
-            }
-
-            /* node rank */
-            if (PRTE_NODE_RANK_INVALID != pptr->node_rank) {
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_NODE_RANK, &pptr->node_rank, PMIX_UINT16);
+                return rc;
             }
-
-            /* node ID */
-            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_NODEID, &pptr->node->index, PMIX_UINT32);
-
-            /* reincarnation number */
-            ui32 = 0; // we are starting this proc for the first time
-            PMIX_INFO_LIST_ADD(ret, pmap, PMIX_REINCARNATION, &ui32, PMIX_UINT32);
-
-            if (map->num_nodes < prte_hostname_cutoff) {
-                PMIX_INFO_LIST_ADD(ret, pmap, PMIX_HOSTNAME, pptr->node->name, PMIX_STRING);
+            if (dist) {
+                PRTE_FLAG_SET(pptr, PRTE_PROC_FLAG_DATA_REGISTERED);
             }
             PMIX_INFO_LIST_CONVERT(ret, pmap, &darray);
             PMIX_INFO_LIST_ADD(ret, info, PMIX_PROC_DATA, &darray, PMIX_DATA_ARRAY);
@@ -551,13 +674,9 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
             PMIX_INFO_LIST_RELEASE(pmap);
         }
     }
-    if (NULL != parent) {
+    if (NULL != parentproc) {
         PMIX_PROC_RELEASE(parentproc);
     }
-    if (0 != prte_pmix_server_globals.generate_dist) {
-        PMIX_INFO_DESTRUCT(&devinfo[0]);
-        PMIX_INFO_DESTRUCT(&devinfo[1]);
-    }
 
     /* mark the job as registered */
     prte_set_attribute(&jdata->attributes, PRTE_JOB_NSPACE_REGISTERED, PRTE_ATTR_LOCAL, NULL,
@@ -682,6 +801,51 @@ int prte_pmix_server_register_nspace(prte_job_t *jdata)
     return rc;
 }
 
+/* give the local PMIx server the device distances of a remote proc
+ * of a job that was registered lazily - everything else was included
+ * in the registration. They are only computed for the procs our
+ * clients actually ask about */
+int prte_pmix_server_register_proc_data(prte_job_t *jdata, prte_proc_t *pptr)
+{
+    prte_pmix_locality_t *loc;
+    pmix_data_array_t darray;
+    pmix_value_t val;
+    pmix_status_t ret;
+    PRTE_HIDE_UNUSED_PARAMS(jdata);
+
+    if (PRTE_FLAG_TEST(pptr, PRTE_PROC_FLAG_DATA_REGISTERED)) {
+        return PRTE_SUCCESS;
+    }
+    if (NULL == pptr->node || NULL == pptr->node->daemon) {
+        PRTE_ERROR_LOG(PRTE_ERR_NOT_FOUND);
+        return PRTE_ERR_NOT_FOUND;
+    }
+    PRTE_FLAG_SET(pptr, PRTE_PROC_FLAG_DATA_REGISTERED);
+    if (NULL == pptr->cpuset || 0 == prte_pmix_server_globals.generate_dist) {
+        return PRTE_SUCCESS;
+    }
+
+    pmix_output_verbose(2, prte_pmix_server_globals.output,
+                        "%s register device distances for %s",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&pptr->name));
+
+    loc = get_locality(pptr->node, pptr, true);
+    if (NULL == loc || NULL == loc->distances) {
+        return PRTE_SUCCESS;
+    }
+    darray.type = PMIX_DEVICE_DIST;
+    darray.array = loc->distances;
+    darray.size = loc->ndist;
+    PMIX_VALUE_LOAD(&val, &darray, PMIX_DATA_ARRAY);
+    ret = PMIx_Store_internal(&pptr->name, PMIX_DEVICE_DISTANCES, &val);
+    PMIX_VALUE_DESTRUCT(&val);
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PRTE_FLAG_UNSET(pptr, PRTE_PROC_FLAG_DATA_REGISTERED);
+    }
+    return prte_pmix_convert_status(ret);
+}
+
 static void opcbfunc(pmix_status_t status, void *cbdata)
 {
     prte_pmix_lock_t *lock = (prte_pmix_lock_t *) cbdata;
@@ -465,6 +465,8 @@ void prte_daemon_recv(int status, pmix_proc_t *sender,
         /* cleanup any pending server ops */
         PMIX_LOAD_PROCID(&pname, job, PMIX_RANK_WILDCARD);
         prte_pmix_server_clear(&pname);
+        /* forget the daemons its collectives ran over */
+        prte_grpcomm_base_purge_job(job);
         /* remove the session directory tree */
         if (0 > pmix_asprintf(&cmd_str, "%s/%d", prte_process_info.jobfam_session_dir,
                               PRTE_LOCAL_JOBID(jdata->nspace))) {
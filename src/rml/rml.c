@@ -34,16 +34,25 @@
 prte_rml_base_t prte_rml_base = {
     .rml_output = -1,
     .routed_output = -1,
-    .posted_recvs = PMIX_LIST_STATIC_INIT,
-    .unmatched_msgs = PMIX_LIST_STATIC_INIT,
+    .tags = NULL,
+    .tag_stats = false,
     .max_retries = 0,
     .lifeline = PMIX_RANK_INVALID,
     .children = PMIX_LIST_STATIC_INIT,
+    .routes = NULL,
+    .num_routes = 0,
+    .hops = NULL,
+    .num_hops = 0,
+    .routing = PRTE_RML_ROUTING_RADIX,
     .radix = 64,
-    .static_ports = false
+    .static_ports = false,
+    .payloads = 0,
+    .payload_copied = 0,
+    .payload_sent = 0
 };
 
 static int verbosity = 0;
+static char *routing = NULL;
 
 void prte_rml_register(void)
 {
@@ -78,13 +87,64 @@ void prte_rml_register(void)
                                "Radix to be used for routing tree",
                                PMIX_MCA_BASE_VAR_TYPE_INT,
                                &prte_rml_base.radix);
+
+    routing = "radix";
+    pmix_mca_base_var_register("prte", "rml", "base", "routing",
+                               "Layout of the daemon routing tree [radix (default) | knomial | binomial]. "
+                               "The radix param sets the fan-out of the radix tree and the k of the k-nomial tree",
+                               PMIX_MCA_BASE_VAR_TYPE_STRING,
+                               &routing);
+    if (NULL == routing || 0 == strcasecmp(routing, "radix")) {
+        prte_rml_base.routing = PRTE_RML_ROUTING_RADIX;
+    } else if (0 == strcasecmp(routing, "knomial")) {
+        prte_rml_base.routing = PRTE_RML_ROUTING_KNOMIAL;
+    } else if (0 == strcasecmp(routing, "binomial")) {
+        prte_rml_base.routing = PRTE_RML_ROUTING_BINOMIAL;
+    } else {
+        pmix_output(0, "Unknown routing layout \"%s\" - using radix", routing);
+        prte_rml_base.routing = PRTE_RML_ROUTING_RADIX;
+    }
+
+    prte_rml_base.tag_stats = false;
+    pmix_mca_base_var_register("prte", "rml", "base", "tag_stats",
+                               "Report the number of messages and bytes received on each tag, "
+                               "their rates, and the depth of the queue of unmatched messages "
+                               "when the RML is closed (they can be queried at any time with "
+                               "prte.rml.tag_stats)",
+                               PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                               &prte_rml_base.tag_stats);
 }
 
 void prte_rml_close(void)
 {
-    PMIX_LIST_DESTRUCT(&prte_rml_base.posted_recvs);
-    PMIX_LIST_DESTRUCT(&prte_rml_base.unmatched_msgs);
+    prte_rml_tag_queue_t *tq;
+    uint32_t key;
+    void *node;
+
+    if (NULL != prte_rml_base.tags) {
+        if (prte_rml_base.tag_stats) {
+            prte_rml_base_report_tag_stats(0);
+        }
+        if (PMIX_SUCCESS == pmix_hash_table_get_first_key_uint32(prte_rml_base.tags, &key,
+                                                                 (void **) &tq, &node)) {
+            do {
+                PMIX_RELEASE(tq);
+            } while (PMIX_SUCCESS == pmix_hash_table_get_next_key_uint32(prte_rml_base.tags, &key,
+                                                                         (void **) &tq,
+                                                                         node, &node));
+        }
+        PMIX_RELEASE(prte_rml_base.tags);
+        prte_rml_base.tags = NULL;
+    }
     PMIX_LIST_DESTRUCT(&prte_rml_base.children);
+    if (NULL != prte_rml_base.routes) {
+        free(prte_rml_base.routes);
+        prte_rml_base.routes = NULL;
+    }
+    if (NULL != prte_rml_base.hops) {
+        free(prte_rml_base.hops);
+        prte_rml_base.hops = NULL;
+    }
     if (0 <= prte_rml_base.rml_output) {
         pmix_output_close(prte_rml_base.rml_output);
     }
@@ -93,8 +153,9 @@ void prte_rml_close(void)
 void prte_rml_open(void)
 {
     /* construct object for holding the active plugin modules */
-    PMIX_CONSTRUCT(&prte_rml_base.posted_recvs, pmix_list_t);
-    PMIX_CONSTRUCT(&prte_rml_base.unmatched_msgs, pmix_list_t);
+    prte_rml_base.tags = PMIX_NEW(pmix_hash_table_t);
+    pmix_hash_table_init(prte_rml_base.tags, PRTE_RML_TAG_MAX);
+    gettimeofday(&prte_rml_base.start, NULL);
     PMIX_CONSTRUCT(&prte_rml_base.children, pmix_list_t);
     prte_rml_base.lifeline = PRTE_PROC_MY_PARENT->rank;
 
@@ -131,14 +192,32 @@ static void send_cons(prte_rml_send_t *ptr)
     ptr->retries = 0;
     ptr->cbdata = NULL;
     PMIX_DATA_BUFFER_CONSTRUCT(&ptr->dbuf);
+    ptr->payload = NULL;
     ptr->seq_num = 0xFFFFFFFF;
 }
 static void send_des(prte_rml_send_t *ptr)
 {
     PMIX_DATA_BUFFER_DESTRUCT(&ptr->dbuf);
+    if (NULL != ptr->payload) {
+        PMIX_RELEASE(ptr->payload);
+    }
 }
 PMIX_CLASS_INSTANCE(prte_rml_send_t, pmix_list_item_t, send_cons, send_des);
 
+static void pld_cons(prte_rml_payload_t *ptr)
+{
+    ptr->base = NULL;
+    ptr->bytes = NULL;
+    ptr->size = 0;
+}
+static void pld_des(prte_rml_payload_t *ptr)
+{
+    if (NULL != ptr->base) {
+        free(ptr->base);
+    }
+}
+PMIX_CLASS_INSTANCE(prte_rml_payload_t, pmix_object_t, pld_cons, pld_des);
+
 static void send_req_cons(prte_rml_send_request_t *ptr)
 {
     PMIX_CONSTRUCT(&ptr->send, prte_rml_send_t);
@@ -172,10 +251,27 @@ PMIX_CLASS_INSTANCE(prte_rml_recv_cb_t, pmix_object_t, rcv_cons, rcv_des);
 
 static void prcv_cons(prte_rml_posted_recv_t *ptr)
 {
+    ptr->wildcard = false;
     ptr->cbdata = NULL;
 }
 PMIX_CLASS_INSTANCE(prte_rml_posted_recv_t, pmix_list_item_t, prcv_cons, NULL);
 
+static void tq_cons(prte_rml_tag_queue_t *ptr)
+{
+    ptr->tag = PRTE_RML_TAG_INVALID;
+    PMIX_CONSTRUCT(&ptr->posted, pmix_list_t);
+    PMIX_CONSTRUCT(&ptr->unmatched, pmix_list_t);
+    ptr->msgs = 0;
+    ptr->bytes = 0;
+    ptr->max_unmatched = 0;
+}
+static void tq_des(prte_rml_tag_queue_t *ptr)
+{
+    PMIX_LIST_DESTRUCT(&ptr->posted);
+    PMIX_LIST_DESTRUCT(&ptr->unmatched);
+}
+PMIX_CLASS_INSTANCE(prte_rml_tag_queue_t, pmix_object_t, tq_cons, tq_des);
+
 static void prq_cons(prte_rml_recv_request_t *ptr)
 {
     ptr->cancel = false;
@@ -192,12 +288,7 @@ PMIX_CLASS_INSTANCE(prte_rml_recv_request_t, pmix_object_t, prq_cons, prq_des);
 static void rtcon(prte_routed_tree_t *rt)
 {
     rt->rank = PMIX_RANK_INVALID;
-    PMIX_CONSTRUCT(&rt->relatives, pmix_bitmap_t);
-}
-static void rtdes(prte_routed_tree_t *rt)
-{
-    PMIX_DESTRUCT(&rt->relatives);
 }
 PMIX_CLASS_INSTANCE(prte_routed_tree_t,
                     pmix_list_item_t,
-                    rtcon, rtdes);
+                    rtcon, NULL);
@@ -44,7 +44,11 @@
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#    include <sys/time.h>
+#endif
 
+#include "src/class/pmix_hash_table.h"
 #include "src/rml/rml_types.h"
 #include "src/pmix/pmix-internal.h"
 
@@ -84,6 +88,45 @@ PRTE_EXPORT int prte_rml_send_buffer_nb(pmix_rank_t rank,
         (_r) = prte_rml_send_buffer_nb(r, b, t);                \
     } while(0)
 
+/**
+ * Create a shareable payload from the unread portion of a buffer
+ *
+ * @param[in] buffer Buffer containing the data
+ * @param[in] copy   If true, the data is copied and the caller retains
+ *                   ownership of the buffer. Otherwise, the buffer's
+ *                   memory is transferred to the payload and the buffer
+ *                   is left empty
+ *
+ * @retval Pointer to the payload, or NULL on error. The caller
+ *         holds one reference to it.
+ */
+PRTE_EXPORT prte_rml_payload_t *prte_rml_payload_create(pmix_data_buffer_t *buffer, bool copy);
+
+/**
+ * Send a shared payload non-blocking message
+ *
+ * Send a refcounted payload to the specified peer without copying
+ * it. The RML retains the payload until the send completes, so the
+ * same payload can be passed to any number of sends and the caller
+ * simply releases its own reference when done.
+ *
+ * @param[in] peer    Rank of receiving daemon
+ * @param[in] payload Payload to be sent
+ * @param[in] tag     User defined tag for matching send/recv
+ */
+PRTE_EXPORT int prte_rml_send_payload_nb(pmix_rank_t rank,
+                                         prte_rml_payload_t *payload,
+                                         prte_rml_tag_t tag);
+
+#define PRTE_RML_SEND_PAYLOAD(_r, r, p, t)                      \
+    do {                                                        \
+        pmix_output_verbose(2, prte_rml_base.rml_output,        \
+                            "RML-SEND-PAYLOAD(%s:%d): %s:%s:%d", \
+                            PMIX_RANK_PRINT(r), t,              \
+                            __FILE__, __func__, __LINE__);      \
+        (_r) = prte_rml_send_payload_nb(r, p, t);               \
+    } while(0)
+
 /**
  * Purge the RML/OOB of contact info and pending messages
  * to/from a specified process. Used when a process aborts
@@ -142,18 +185,38 @@ PRTE_EXPORT void prte_rml_recv_cancel(pmix_proc_t *peer, prte_rml_tag_t tag);
         prte_rml_recv_cancel(p, t);                             \
     } while(0)
 
+/* layouts for the daemon routing tree */
+typedef enum {
+    PRTE_RML_ROUTING_RADIX,
+    PRTE_RML_ROUTING_KNOMIAL,
+    PRTE_RML_ROUTING_BINOMIAL
+} prte_rml_routing_t;
+
 typedef struct {
     int rml_output;
     int routed_output;
     int max_retries;
-    pmix_list_t posted_recvs;
-    pmix_list_t unmatched_msgs;
+    pmix_hash_table_t *tags;    // prte_rml_tag_queue_t for each tag seen, indexed by tag
+    bool tag_stats;
+    struct timeval start;       // when the RML was opened, for the rates in the tag stats
     pmix_rank_t lifeline;
     pmix_list_t children;
+    int *routes;            // next hop for each daemon: index into hops, or PRTE_RML_ROUTE_*
+    pmix_rank_t num_routes;
+    pmix_rank_t *hops;      // ranks of our direct children, indexed by routes
+    int num_hops;
+    prte_rml_routing_t routing;
     int radix;
     bool static_ports;
+    uint64_t payloads;          // shared payloads created
+    size_t payload_copied;      // bytes copied to build them, or out of them for local delivery
+    size_t payload_sent;        // bytes handed to the OOB from them
 } prte_rml_base_t;
 
+/* special values in the routes table */
+#define PRTE_RML_ROUTE_PARENT   -1
+#define PRTE_RML_ROUTE_SELF     -2
+
 PRTE_EXPORT extern prte_rml_base_t prte_rml_base;
 
 PRTE_EXPORT void prte_rml_register(void);
@@ -169,6 +232,27 @@ PRTE_EXPORT void prte_rml_compute_routing_tree(void);
 PRTE_EXPORT int prte_rml_get_num_contributors(pmix_rank_t *dmns, size_t ndmns);
 PRTE_EXPORT int prte_rml_route_lost(pmix_rank_t route);
 PRTE_EXPORT pmix_rank_t prte_rml_get_route(pmix_rank_t target);
+PRTE_EXPORT prte_rml_tag_queue_t *prte_rml_base_get_tag_queue(prte_rml_tag_t tag, bool create);
+PRTE_EXPORT void prte_rml_base_report_tag_stats(int output_id);
+PRTE_EXPORT void prte_rml_base_query_tag_stats(pmix_info_t *info);
+PRTE_EXPORT void prte_rml_base_query_payload_stats(pmix_info_t *info);
+
+/* query for the traffic on each tag seen since the RML was opened */
+#define PRTE_RML_QUERY_TAG_STATS  "prte.rml.tag_stats"
+#define PRTE_RML_ELAPSED          "prte.rml.elapsed"        // double - seconds since open
+#define PRTE_RML_RECVS            "prte.rml.recvs"          // uint32_t - posted recvs
+#define PRTE_RML_MSGS             "prte.rml.msgs"           // uint64_t
+#define PRTE_RML_BYTES            "prte.rml.bytes"          // uint64_t
+#define PRTE_RML_UNMATCHED        "prte.rml.unmatched"      // uint32_t - msgs waiting for a recv
+#define PRTE_RML_MAX_UNMATCHED    "prte.rml.max_unmatched"  // uint32_t
+
+/* query for the bytes copied versus sent through shared payloads
+ * since the RML was opened - sample it around a launch to see what
+ * the launch cost */
+#define PRTE_RML_QUERY_PAYLOAD_STATS  "prte.rml.payload_stats"
+#define PRTE_RML_PAYLOADS             "prte.rml.payloads"       // uint64_t
+#define PRTE_RML_PAYLOAD_COPIED       "prte.rml.payload_copied" // size_t - bytes
+#define PRTE_RML_PAYLOAD_SENT         "prte.rml.payload_sent"   // size_t - bytes
 
 #define PRTE_RML_POST_MESSAGE(p, t, s, b, l)                                                    \
     do {                                                                                        \
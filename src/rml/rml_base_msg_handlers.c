@@ -50,12 +50,29 @@
 #include "src/rml/rml_contact.h"
 #include "src/rml/rml.h"
 
-static void msg_match_recv(prte_rml_posted_recv_t *rcv, bool get_all);
+static void msg_match_recv(prte_rml_tag_queue_t *tq, prte_rml_posted_recv_t *rcv, bool get_all);
+
+prte_rml_tag_queue_t *prte_rml_base_get_tag_queue(prte_rml_tag_t tag, bool create)
+{
+    prte_rml_tag_queue_t *tq;
+
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_uint32(prte_rml_base.tags, tag, (void **) &tq)) {
+        return tq;
+    }
+    if (!create) {
+        return NULL;
+    }
+    tq = PMIX_NEW(prte_rml_tag_queue_t);
+    tq->tag = tag;
+    pmix_hash_table_set_value_uint32(prte_rml_base.tags, tag, tq);
+    return tq;
+}
 
 void prte_rml_base_post_recv(int sd, short args, void *cbdata)
 {
     prte_rml_recv_request_t *req = (prte_rml_recv_request_t *) cbdata;
     prte_rml_posted_recv_t *post, *recv;
+    prte_rml_tag_queue_t *tq;
     PRTE_HIDE_UNUSED_PARAMS(sd, args);
 
     PMIX_ACQUIRE_OBJECT(req);
@@ -74,30 +91,34 @@ void prte_rml_base_post_recv(int sd, short args, void *cbdata)
     post = req->post;
 
     /* if the request is to cancel a recv, then find the recv
-     * and remove it from our list
+     * and remove it from the list for its tag
      */
     if (req->cancel) {
-        PMIX_LIST_FOREACH(recv, &prte_rml_base.posted_recvs, prte_rml_posted_recv_t)
-        {
-            if (PMIX_CHECK_PROCID(&post->peer, &recv->peer) && post->tag == recv->tag) {
-                pmix_output_verbose(5, prte_rml_base.rml_output,
-                                    "%s canceling recv %d for peer %s",
-                                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), post->tag,
-                                    PRTE_NAME_PRINT(&recv->peer));
-                /* got a match - remove it */
-                pmix_list_remove_item(&prte_rml_base.posted_recvs, &recv->super);
-                PMIX_RELEASE(recv);
-                break;
+        tq = prte_rml_base_get_tag_queue(post->tag, false);
+        if (NULL != tq) {
+            PMIX_LIST_FOREACH(recv, &tq->posted, prte_rml_posted_recv_t)
+            {
+                if (PMIX_CHECK_PROCID(&post->peer, &recv->peer)) {
+                    pmix_output_verbose(5, prte_rml_base.rml_output,
+                                        "%s canceling recv %d for peer %s",
+                                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), post->tag,
+                                        PRTE_NAME_PRINT(&recv->peer));
+                    /* got a match - remove it */
+                    pmix_list_remove_item(&tq->posted, &recv->super);
+                    PMIX_RELEASE(recv);
+                    break;
+                }
             }
         }
         PMIX_RELEASE(req);
         return;
     }
 
+    tq = prte_rml_base_get_tag_queue(post->tag, true);
     /* bozo check - cannot have two receives for the same peer/tag combination */
-    PMIX_LIST_FOREACH(recv, &prte_rml_base.posted_recvs, prte_rml_posted_recv_t)
+    PMIX_LIST_FOREACH(recv, &tq->posted, prte_rml_posted_recv_t)
     {
-        if (PMIX_CHECK_PROCID(&post->peer, &recv->peer) && post->tag == recv->tag) {
+        if (PMIX_CHECK_PROCID(&post->peer, &recv->peer)) {
             pmix_output(0, "%s TWO RECEIVES WITH SAME PEER %s AND TAG %d - ABORTING",
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&post->peer),
                         post->tag);
@@ -110,29 +131,32 @@ void prte_rml_base_post_recv(int sd, short args, void *cbdata)
                         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
                         (post->persistent) ? "persistent" : "non-persistent", post->tag,
                         PRTE_NAME_PRINT(&post->peer));
-    /* add it to the list of recvs */
-    pmix_list_append(&prte_rml_base.posted_recvs, &post->super);
+    /* most recvs accept a message from anyone, so flag them
+     * to avoid comparing names when matching */
+    post->wildcard = PMIX_NSPACE_INVALID(post->peer.nspace) &&
+                     PMIX_RANK_WILDCARD == post->peer.rank;
+    /* add it to the list of recvs for this tag */
+    pmix_list_append(&tq->posted, &post->super);
     req->post = NULL;
     /* handle any messages that may have already arrived for this recv */
-    msg_match_recv(post, post->persistent);
+    if (0 < pmix_list_get_size(&tq->unmatched)) {
+        msg_match_recv(tq, post, post->persistent);
+    }
 
     /* cleanup */
     PMIX_RELEASE(req);
 }
 
-static void msg_match_recv(prte_rml_posted_recv_t *rcv, bool get_all)
+static void msg_match_recv(prte_rml_tag_queue_t *tq, prte_rml_posted_recv_t *rcv, bool get_all)
 {
-    pmix_list_item_t *item, *next;
-    prte_rml_recv_t *msg;
+    prte_rml_recv_t *msg, *next;
 
-    /* scan thru the list of unmatched recvd messages and
+    /* scan thru the unmatched recvd messages for this tag and
      * see if any matches this spec - if so, push the first
      * into the recvd msg queue and look no further
      */
-    item = pmix_list_get_first(&prte_rml_base.unmatched_msgs);
-    while (item != pmix_list_get_end(&prte_rml_base.unmatched_msgs)) {
-        next = pmix_list_get_next(item);
-        msg = (prte_rml_recv_t *) item;
+    PMIX_LIST_FOREACH_SAFE(msg, next, &tq->unmatched, prte_rml_recv_t)
+    {
         pmix_output_verbose(5, prte_rml_base.rml_output,
                             "%s checking recv for %s against unmatched msg from %s",
                             PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&rcv->peer),
@@ -141,21 +165,125 @@ static void msg_match_recv(prte_rml_posted_recv_t *rcv, bool get_all)
         /* since names could include wildcards, must use
          * the more generalized comparison function
          */
-        if (PMIX_CHECK_PROCID(&msg->sender, &rcv->peer) && msg->tag == rcv->tag) {
+        if (rcv->wildcard || PMIX_CHECK_PROCID(&msg->sender, &rcv->peer)) {
+            pmix_list_remove_item(&tq->unmatched, &msg->super);
+            /* the message will be counted again when it is processed */
+            --tq->msgs;
+            tq->bytes -= msg->dbuf.bytes_used;
             PRTE_RML_ACTIVATE_MESSAGE(msg);
-            pmix_list_remove_item(&prte_rml_base.unmatched_msgs, item);
             if (!get_all) {
                 break;
             }
         }
-        item = next;
     }
 }
 
+void prte_rml_base_report_tag_stats(int output_id)
+{
+    prte_rml_tag_queue_t *tq;
+    struct timeval now;
+    double elapsed;
+    uint32_t key;
+    void *node;
+
+    if (NULL == prte_rml_base.tags) {
+        return;
+    }
+    gettimeofday(&now, NULL);
+    elapsed = (double) (now.tv_sec - prte_rml_base.start.tv_sec)
+              + (double) (now.tv_usec - prte_rml_base.start.tv_usec) / 1000000.0;
+    if (elapsed <= 0.0) {
+        elapsed = 1.0e-6;
+    }
+
+    pmix_output(output_id, "%s RML TAG STATS over %.3f seconds\n"
+                "%8s %6s %12s %14s %12s %14s %9s %10s",
+                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), elapsed,
+                "TAG", "RECVS", "MSGS", "BYTES", "MSGS/SEC", "BYTES/SEC",
+                "UNMATCHED", "MAX_UNMTCH");
+    if (PMIX_SUCCESS != pmix_hash_table_get_first_key_uint32(prte_rml_base.tags, &key,
+                                                             (void **) &tq, &node)) {
+        return;
+    }
+    do {
+        pmix_output(output_id, "%8u %6u %12lu %14lu %12.1f %14.1f %9u %10u",
+                    (unsigned) tq->tag, (unsigned) pmix_list_get_size(&tq->posted),
+                    (unsigned long) tq->msgs, (unsigned long) tq->bytes,
+                    (double) tq->msgs / elapsed, (double) tq->bytes / elapsed,
+                    (unsigned) pmix_list_get_size(&tq->unmatched),
+                    (unsigned) tq->max_unmatched);
+    } while (PMIX_SUCCESS == pmix_hash_table_get_next_key_uint32(prte_rml_base.tags, &key,
+                                                                 (void **) &tq, node, &node));
+}
+
+void prte_rml_base_query_tag_stats(pmix_info_t *info)
+{
+    prte_rml_tag_queue_t *tq;
+    pmix_data_array_t *darray, *stats;
+    pmix_info_t *tags, *iptr;
+    struct timeval now;
+    double elapsed;
+    uint32_t key, u32;
+    void *node;
+    size_t n;
+
+    gettimeofday(&now, NULL);
+    elapsed = (double) (now.tv_sec - prte_rml_base.start.tv_sec)
+              + (double) (now.tv_usec - prte_rml_base.start.tv_usec) / 1000000.0;
+
+    /* the elapsed time first, then one entry per tag, named for it */
+    n = (NULL == prte_rml_base.tags) ? 0 : pmix_hash_table_get_size(prte_rml_base.tags);
+    PMIX_DATA_ARRAY_CREATE(darray, n + 1, PMIX_INFO);
+    tags = (pmix_info_t *) darray->array;
+    PMIX_INFO_LOAD(&tags[0], PRTE_RML_ELAPSED, &elapsed, PMIX_DOUBLE);
+    n = 1;
+    if (NULL != prte_rml_base.tags
+        && PMIX_SUCCESS == pmix_hash_table_get_first_key_uint32(prte_rml_base.tags, &key,
+                                                                (void **) &tq, &node)) {
+        do {
+            PMIX_DATA_ARRAY_CREATE(stats, 5, PMIX_INFO);
+            iptr = (pmix_info_t *) stats->array;
+            u32 = pmix_list_get_size(&tq->posted);
+            PMIX_INFO_LOAD(&iptr[0], PRTE_RML_RECVS, &u32, PMIX_UINT32);
+            PMIX_INFO_LOAD(&iptr[1], PRTE_RML_MSGS, &tq->msgs, PMIX_UINT64);
+            PMIX_INFO_LOAD(&iptr[2], PRTE_RML_BYTES, &tq->bytes, PMIX_UINT64);
+            u32 = pmix_list_get_size(&tq->unmatched);
+            PMIX_INFO_LOAD(&iptr[3], PRTE_RML_UNMATCHED, &u32, PMIX_UINT32);
+            u32 = tq->max_unmatched;
+            PMIX_INFO_LOAD(&iptr[4], PRTE_RML_MAX_UNMATCHED, &u32, PMIX_UINT32);
+            snprintf(tags[n].key, PMIX_MAX_KEYLEN, "%u", (unsigned) tq->tag);
+            tags[n].value.type = PMIX_DATA_ARRAY;
+            tags[n].value.data.darray = stats;
+            ++n;
+        } while (PMIX_SUCCESS == pmix_hash_table_get_next_key_uint32(prte_rml_base.tags, &key,
+                                                                     (void **) &tq, node, &node));
+    }
+    darray->size = n;
+    PMIX_LOAD_KEY(info->key, PRTE_RML_QUERY_TAG_STATS);
+    info->value.type = PMIX_DATA_ARRAY;
+    info->value.data.darray = darray;
+}
+
+void prte_rml_base_query_payload_stats(pmix_info_t *info)
+{
+    pmix_data_array_t *darray;
+    pmix_info_t *iptr;
+
+    PMIX_DATA_ARRAY_CREATE(darray, 3, PMIX_INFO);
+    iptr = (pmix_info_t *) darray->array;
+    PMIX_INFO_LOAD(&iptr[0], PRTE_RML_PAYLOADS, &prte_rml_base.payloads, PMIX_UINT64);
+    PMIX_INFO_LOAD(&iptr[1], PRTE_RML_PAYLOAD_COPIED, &prte_rml_base.payload_copied, PMIX_SIZE);
+    PMIX_INFO_LOAD(&iptr[2], PRTE_RML_PAYLOAD_SENT, &prte_rml_base.payload_sent, PMIX_SIZE);
+    PMIX_LOAD_KEY(info->key, PRTE_RML_QUERY_PAYLOAD_STATS);
+    info->value.type = PMIX_DATA_ARRAY;
+    info->value.data.darray = darray;
+}
+
 void prte_rml_base_process_msg(int fd, short flags, void *cbdata)
 {
     prte_rml_recv_t *msg = (prte_rml_recv_t *) cbdata;
     prte_rml_posted_recv_t *post;
+    prte_rml_tag_queue_t *tq;
     PRTE_HIDE_UNUSED_PARAMS(fd, flags);
 
     PMIX_ACQUIRE_OBJECT(msg);
@@ -191,13 +319,17 @@ void prte_rml_base_process_msg(int fd, short flags, void *cbdata)
         }
     }
 
+    tq = prte_rml_base_get_tag_queue(msg->tag, true);
+    ++tq->msgs;
+    tq->bytes += msg->dbuf.bytes_used;
+
     /* see if we have a waiting recv for this message */
-    PMIX_LIST_FOREACH(post, &prte_rml_base.posted_recvs, prte_rml_posted_recv_t)
+    PMIX_LIST_FOREACH(post, &tq->posted, prte_rml_posted_recv_t)
     {
         /* since names could include wildcards, must use
          * the more generalized comparison function
          */
-        if (PMIX_CHECK_PROCID(&msg->sender, &post->peer) && msg->tag == post->tag) {
+        if (post->wildcard || PMIX_CHECK_PROCID(&msg->sender, &post->peer)) {
             /* deliver the data to this location */
             post->cbfunc(PRTE_SUCCESS, &msg->sender, &msg->dbuf, msg->tag, post->cbdata);
             /* the user must have unloaded the buffer if they wanted
@@ -215,7 +347,7 @@ void prte_rml_base_process_msg(int fd, short flags, void *cbdata)
                                  PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), post->tag));
             /* if the recv is non-persistent, remove it */
             if (!post->persistent) {
-                pmix_list_remove_item(&prte_rml_base.posted_recvs, &post->super);
+                pmix_list_remove_item(&tq->posted, &post->super);
                 /*PMIX_OUTPUT_VERBOSE((5, prte_rml_base.rml_output,
                                      "%s non persistent recv %p remove success releasing now",
                                      PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
@@ -232,5 +364,8 @@ void prte_rml_base_process_msg(int fd, short flags, void *cbdata)
         (5, prte_rml_base.rml_output,
          "%s message received bytes from %s for tag %d Not Matched adding to unmatched msgs",
          PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(&msg->sender), msg->tag));
-    pmix_list_append(&prte_rml_base.unmatched_msgs, &msg->super);
+    pmix_list_append(&tq->unmatched, &msg->super);
+    if (tq->max_unmatched < pmix_list_get_size(&tq->unmatched)) {
+        tq->max_unmatched = pmix_list_get_size(&tq->unmatched);
+    }
 }
@@ -25,6 +25,8 @@
 #include "prte_config.h"
 #include "types.h"
 
+#include <string.h>
+
 #include "src/pmix/pmix-internal.h"
 #include "src/util/name_fns.h"
 #include "src/util/pmix_output.h"
@@ -102,3 +104,107 @@ int prte_rml_send_buffer_nb(pmix_rank_t rank,
 
     return PRTE_SUCCESS;
 }
+
+prte_rml_payload_t *prte_rml_payload_create(pmix_data_buffer_t *buffer, bool copy)
+{
+    prte_rml_payload_t *payload;
+    size_t size;
+
+    payload = PMIX_NEW(prte_rml_payload_t);
+    ++prte_rml_base.payloads;
+    if (NULL == buffer || NULL == buffer->base_ptr) {
+        return payload;
+    }
+    size = buffer->pack_ptr - buffer->unpack_ptr;
+
+    if (copy) {
+        if (0 < size) {
+            payload->base = (char *) malloc(size);
+            if (NULL == payload->base) {
+                PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+                PMIX_RELEASE(payload);
+                return NULL;
+            }
+            memcpy(payload->base, buffer->unpack_ptr, size);
+            prte_rml_base.payload_copied += size;
+        }
+        payload->bytes = payload->base;
+    } else {
+        /* take the memory from the buffer */
+        payload->base = buffer->base_ptr;
+        payload->bytes = buffer->unpack_ptr;
+        buffer->base_ptr = NULL;
+        buffer->pack_ptr = NULL;
+        buffer->unpack_ptr = NULL;
+        buffer->bytes_allocated = 0;
+        buffer->bytes_used = 0;
+    }
+    payload->size = size;
+    return payload;
+}
+
+int prte_rml_send_payload_nb(pmix_rank_t rank,
+                             prte_rml_payload_t *payload,
+                             prte_rml_tag_t tag)
+{
+    prte_rml_recv_t *rcv;
+    prte_rml_send_t *snd;
+    pmix_status_t rc;
+    pmix_byte_object_t bo;
+
+    PMIX_OUTPUT_VERBOSE((1, prte_rml_base.rml_output,
+         "%s rml_send_payload to peer %s at tag %d",
+         PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+         PMIX_RANK_PRINT(rank), tag));
+
+    if (PRTE_RML_TAG_INVALID == tag || NULL == payload) {
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        return PRTE_ERR_BAD_PARAM;
+    }
+    if (PMIX_RANK_INVALID == rank) {
+        /* cannot send to an invalid peer */
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        return PRTE_ERR_BAD_PARAM;
+    }
+
+    if (PRTE_PROC_MY_NAME->rank == rank) {
+        /* the recv consumes its buffer, so we have to copy
+         * the data for local delivery */
+        rcv = PMIX_NEW(prte_rml_recv_t);
+        PMIX_LOAD_PROCID(&rcv->sender, PRTE_PROC_MY_NAME->nspace, rank);
+        rcv->tag = tag;
+        if (0 < payload->size) {
+            bo.bytes = (char *) malloc(payload->size);
+            if (NULL == bo.bytes) {
+                PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+                PMIX_RELEASE(rcv);
+                return PRTE_ERR_OUT_OF_RESOURCE;
+            }
+            memcpy(bo.bytes, payload->bytes, payload->size);
+            prte_rml_base.payload_copied += payload->size;
+            bo.size = payload->size;
+            rc = PMIx_Data_load(&rcv->dbuf, &bo);
+            if (PMIX_SUCCESS != rc) {
+                PMIX_ERROR_LOG(rc);
+                PMIX_BYTE_OBJECT_DESTRUCT(&bo);
+                PMIX_RELEASE(rcv);
+                return prte_pmix_convert_status(rc);
+            }
+        }
+        PRTE_RML_ACTIVATE_MESSAGE(rcv);
+        return PRTE_SUCCESS;
+    }
+
+    snd = PMIX_NEW(prte_rml_send_t);
+    PMIX_LOAD_PROCID(&snd->dst, PRTE_PROC_MY_NAME->nspace, rank);
+    snd->origin = *PRTE_PROC_MY_NAME;
+    snd->tag = tag;
+    PMIX_RETAIN(payload);
+    snd->payload = payload;
+    prte_rml_base.payload_sent += payload->size;
+
+    /* activate the OOB send state */
+    PRTE_OOB_SEND(snd);
+
+    return PRTE_SUCCESS;
+}
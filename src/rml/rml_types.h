@@ -220,6 +220,15 @@ typedef void (*prte_rml_buffer_callback_fn_t)(int status, pmix_proc_t *peer,
 /* error propagate  */
 #define PRTE_RML_TAG_PROPAGATE 71
 
+/* segmented xcast relay */
+#define PRTE_RML_TAG_XCAST_SEGMENT 72
+
+/* window acks for streamed file pre-positioning */
+#define PRTE_RML_TAG_FILEM_WINDOW 73
+
+/* file pre-positioning chunks sent by xcast */
+#define PRTE_RML_TAG_FILEM_XCAST 74
+
 #define PRTE_RML_TAG_MAX 100
 
 #define PRTE_RML_TAG_NTOH(t) ntohl(t)
@@ -247,6 +256,18 @@ typedef struct {
 } prte_rml_recv_cb_t;
 PMIX_CLASS_DECLARATION(prte_rml_recv_cb_t);
 
+/* refcounted, immutable message payload that can be shared
+ * across any number of sends without copying it. The memory
+ * is released when the last reference to it is dropped - i.e.,
+ * when the last send using it has completed */
+typedef struct {
+    pmix_object_t super;
+    char *base;   // start of the allocated region
+    char *bytes;  // start of the payload within it
+    size_t size;  // number of payload bytes
+} prte_rml_payload_t;
+PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_rml_payload_t);
+
 /* structure to send RML messages - used internally */
 typedef struct {
     pmix_list_item_t super;
@@ -262,11 +283,19 @@ typedef struct {
 
     /* data buffer */
     pmix_data_buffer_t dbuf;
+    /* shared payload - if given, it is sent instead of dbuf */
+    prte_rml_payload_t *payload;
     /* msg seq number */
     uint32_t seq_num;
 } prte_rml_send_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_rml_send_t);
 
+/* location and size of the bytes to be transmitted for a send */
+#define PRTE_RML_SEND_DATA(m) \
+    ((NULL == (m)->payload) ? (m)->dbuf.base_ptr : (m)->payload->bytes)
+#define PRTE_RML_SEND_SIZE(m) \
+    ((NULL == (m)->payload) ? (m)->dbuf.bytes_used : (m)->payload->size)
+
 /* define an object for transferring send requests to the event lib */
 typedef struct {
     pmix_object_t super;
@@ -290,6 +319,7 @@ typedef struct {
     pmix_list_item_t super;
     bool buffer_data;
     pmix_proc_t peer;
+    bool wildcard;           // peer matches any sender
     prte_rml_tag_t tag;
     bool persistent;
     prte_rml_buffer_callback_fn_t cbfunc;
@@ -297,6 +327,19 @@ typedef struct {
 } prte_rml_posted_recv_t;
 PMIX_CLASS_DECLARATION(prte_rml_posted_recv_t);
 
+/* everything the RML holds for a given tag - used internally */
+typedef struct {
+    pmix_object_t super;
+    prte_rml_tag_t tag;
+    pmix_list_t posted;      // prte_rml_posted_recv_t, in the order they were posted
+    pmix_list_t unmatched;   // prte_rml_recv_t waiting for a recv to be posted
+    /* traffic counters */
+    uint64_t msgs;           // messages received
+    uint64_t bytes;          // bytes received
+    size_t max_unmatched;    // high-water mark of the unmatched queue
+} prte_rml_tag_queue_t;
+PMIX_CLASS_DECLARATION(prte_rml_tag_queue_t);
+
 /* define an object for transferring recv requests to the list of posted recvs */
 typedef struct {
     pmix_object_t super;
@@ -310,7 +353,6 @@ PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_rml_recv_request_t);
 typedef struct {
     pmix_list_item_t super;
     pmix_rank_t rank;
-    pmix_bitmap_t relatives;
 } prte_routed_tree_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_routed_tree_t);
 
@@ -23,7 +23,7 @@
 
 #include <stddef.h>
 
-#include "src/class/pmix_bitmap.h"
+#include "src/util/error.h"
 #include "src/util/pmix_output.h"
 
 #include "src/rml/rml.h"
@@ -33,7 +33,7 @@
 pmix_rank_t prte_rml_get_route(pmix_rank_t target)
 {
     pmix_rank_t ret;
-    prte_routed_tree_t *child;
+    int hop;
 
     /* if it is me, then the route is just direct */
     if (PRTE_PROC_MY_NAME->rank == target) {
@@ -52,27 +52,21 @@ pmix_rank_t prte_rml_get_route(pmix_rank_t target)
         goto found;
     }
 
-    /* search routing tree for next step to that daemon */
-    PMIX_LIST_FOREACH(child, &prte_rml_base.children, prte_routed_tree_t)
-    {
-        if (child->rank == target) {
-            /* the child is the target */
+    /* look up the next step to that daemon - anything not
+     * beneath one of our children goes up through our parent */
+    if (target < prte_rml_base.num_routes) {
+        hop = prte_rml_base.routes[target];
+        if (0 <= hop) {
+            ret = prte_rml_base.hops[hop];
+        } else if (PRTE_RML_ROUTE_SELF == hop) {
             ret = target;
-            goto found;
-        }
-        /* otherwise, see if the daemon we need is below the child */
-        if (pmix_bitmap_is_set_bit(&child->relatives, target)) {
-            /* yep - we need to step through this child */
-            ret = child->rank;
-            goto found;
+        } else {
+            ret = PRTE_PROC_MY_PARENT->rank;
         }
+    } else {
+        ret = PRTE_PROC_MY_PARENT->rank;
     }
 
-    /* if we get here, then the target daemon is not beneath
-     * any of our children, so we have to step up through our parent
-     */
-    ret = PRTE_PROC_MY_PARENT->rank;
-
 found:
     PMIX_OUTPUT_VERBOSE((1, prte_rml_base.routed_output,
                          "%s routed_radix_get(%s) --> %s",
@@ -86,6 +80,8 @@ found:
 int prte_rml_route_lost(pmix_rank_t route)
 {
     prte_routed_tree_t *child;
+    pmix_rank_t n;
+    int hop;
 
     PMIX_OUTPUT_VERBOSE((2, prte_rml_base.routed_output,
                          "%s route to %s lost",
@@ -105,12 +101,26 @@ int prte_rml_route_lost(pmix_rank_t route)
         return PRTE_ERR_FATAL;
     }
 
-    /* see if it is one of our children - if so, remove it */
+    /* see if it is one of our children - if so, remove it and
+     * send anything that would have gone through it to our parent */
     PMIX_LIST_FOREACH(child, &prte_rml_base.children, prte_routed_tree_t)
     {
         if (child->rank == route) {
             pmix_list_remove_item(&prte_rml_base.children, &child->super);
             PMIX_RELEASE(child);
+            for (hop = 0; hop < prte_rml_base.num_hops; hop++) {
+                if (prte_rml_base.hops[hop] == route) {
+                    break;
+                }
+            }
+            if (hop < prte_rml_base.num_hops) {
+                prte_rml_base.hops[hop] = PMIX_RANK_INVALID;
+                for (n = 0; n < prte_rml_base.num_routes; n++) {
+                    if (hop == prte_rml_base.routes[n]) {
+                        prte_rml_base.routes[n] = PRTE_RML_ROUTE_PARENT;
+                    }
+                }
+            }
             return PRTE_SUCCESS;
         }
     }
@@ -119,15 +129,13 @@ int prte_rml_route_lost(pmix_rank_t route)
     return PRTE_SUCCESS;
 }
 
-static void radix_tree(int rank,
-                       pmix_list_t *children,
-                       pmix_bitmap_t *relatives)
+/* parent of a daemon in the radix tree - daemons are laid out
+ * level by level, with each level radix times wider than the one
+ * above it and children interleaved across the previous level */
+static pmix_rank_t radix_parent(pmix_rank_t rank)
 {
-    int i, peer, Sum, NInLevel;
-    prte_routed_tree_t *child;
-    pmix_bitmap_t *relations;
+    pmix_rank_t Sum, NInLevel, NInPrevLevel;
 
-    /* compute how many procs are at my level */
     Sum = 1;
     NInLevel = 1;
 
@@ -135,73 +143,126 @@ static void radix_tree(int rank,
         NInLevel *= prte_rml_base.radix;
         Sum += NInLevel;
     }
+    Sum -= NInLevel;
 
-    /* our children start at our rank + num_in_level */
-    peer = rank + NInLevel;
-    for (i = 0; i < prte_rml_base.radix; i++) {
-        if (peer < (int) prte_process_info.num_daemons) {
-            child = PMIX_NEW(prte_routed_tree_t);
-            child->rank = peer;
-            if (NULL != children) {
-                /* this is a direct child - add it to my list */
-                pmix_list_append(children, &child->super);
-                /* setup the relatives bitmap */
-                pmix_bitmap_init(&child->relatives, prte_process_info.num_daemons);
-                /* point to the relatives */
-                relations = &child->relatives;
-            } else {
-                /* we are recording someone's relatives - set the bit */
-                if (PRTE_SUCCESS != pmix_bitmap_set_bit(relatives, peer)) {
-                    pmix_output(0, "%s Error: could not set relations bit!",
-                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
-                }
-                /* point to this relations */
-                relations = relatives;
-                PMIX_RELEASE(child);
-            }
-            /* search for this child's relatives */
-            radix_tree(peer, NULL, relations);
-        }
-        peer += NInLevel;
+    NInPrevLevel = NInLevel / prte_rml_base.radix;
+
+    return (rank - Sum) % NInPrevLevel + (Sum - NInPrevLevel);
+}
+
+/* parent of a daemon in a k-nomial tree - clear the most
+ * significant base-k digit of its rank. The binomial tree
+ * is the k = 2 case */
+static pmix_rank_t knomial_parent(pmix_rank_t rank, pmix_rank_t k)
+{
+    pmix_rank_t pw = 1;
+
+    if (k < 2) {
+        k = 2;
+    }
+    while (pw <= rank / k) {
+        pw *= k;
+    }
+    return rank % pw;
+}
+
+/* parent of a non-root daemon in the selected layout. All
+ * layouts give a parent a lower rank than its children */
+static pmix_rank_t tree_parent(pmix_rank_t rank)
+{
+    switch (prte_rml_base.routing) {
+    case PRTE_RML_ROUTING_KNOMIAL:
+        return knomial_parent(rank, prte_rml_base.radix);
+    case PRTE_RML_ROUTING_BINOMIAL:
+        return knomial_parent(rank, 2);
+    default:
+        return radix_parent(rank);
     }
 }
 
 void prte_rml_compute_routing_tree(void)
 {
     prte_routed_tree_t *child;
-    int j;
+    int i;
     pmix_list_item_t *item;
-    int Level, Sum, NInLevel, Ii;
-    int NInPrevLevel;
+    pmix_rank_t n, p, me, ndmns;
+    pmix_rank_t *hops;
     prte_job_t *dmns;
     prte_proc_t *d;
 
-    /* compute my parent */
-    Ii = PRTE_PROC_MY_NAME->rank;
-    Level = 0;
-    Sum = 1;
-    NInLevel = 1;
-
-    while (Sum < (Ii + 1)) {
-        Level++;
-        NInLevel *= prte_rml_base.radix;
-        Sum += NInLevel;
+    /* this is called again whenever the number of daemons
+     * changes, so start from a clean slate */
+    while (NULL != (item = pmix_list_remove_first(&prte_rml_base.children))) {
+        PMIX_RELEASE(item);
     }
-    Sum -= NInLevel;
-
-    NInPrevLevel = NInLevel / prte_rml_base.radix;
+    if (NULL != prte_rml_base.routes) {
+        free(prte_rml_base.routes);
+        prte_rml_base.routes = NULL;
+    }
+    if (NULL != prte_rml_base.hops) {
+        free(prte_rml_base.hops);
+        prte_rml_base.hops = NULL;
+    }
+    prte_rml_base.num_routes = 0;
+    prte_rml_base.num_hops = 0;
 
-    if (0 == Ii) {
+    /* compute my parent */
+    me = PRTE_PROC_MY_NAME->rank;
+    if (0 == me) {
         PRTE_PROC_MY_PARENT->rank = -1;
     } else {
-        PRTE_PROC_MY_PARENT->rank = (Ii - Sum) % NInPrevLevel;
-        PRTE_PROC_MY_PARENT->rank += (Sum - NInPrevLevel);
+        PRTE_PROC_MY_PARENT->rank = tree_parent(me);
     }
 
-    /* compute my direct children and the bitmap that shows which vpids
-     * lie underneath their branch
-     */
-    radix_tree(Ii, &prte_rml_base.children, NULL);
+    ndmns = prte_process_info.num_daemons;
+    if (0 == ndmns || me >= ndmns) {
+        /* nothing to route yet */
+        return;
+    }
+
+    /* setup the routing table - everything goes through our
+     * parent unless it lies beneath one of our children */
+    prte_rml_base.routes = (int *) malloc(ndmns * sizeof(int));
+    if (NULL == prte_rml_base.routes) {
+        PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    prte_rml_base.num_routes = ndmns;
+
+    /* parents always precede their children, so a single pass in
+     * rank order can inherit each daemon's route from its parent */
+    for (n = 0; n < ndmns; n++) {
+        if (n == me) {
+            prte_rml_base.routes[n] = PRTE_RML_ROUTE_SELF;
+            continue;
+        }
+        if (0 == n) {
+            prte_rml_base.routes[n] = PRTE_RML_ROUTE_PARENT;
+            continue;
+        }
+        p = tree_parent(n);
+        if (p != me) {
+            prte_rml_base.routes[n] = prte_rml_base.routes[p];
+            continue;
+        }
+        /* this is one of my direct children */
+        if (0 == (prte_rml_base.num_hops % 16)) {
+            hops = (pmix_rank_t *) realloc(prte_rml_base.hops,
+                                           (prte_rml_base.num_hops + 16) * sizeof(pmix_rank_t));
+            if (NULL == hops) {
+                PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+                prte_rml_base.num_routes = 0;
+                return;
+            }
+            prte_rml_base.hops = hops;
+        }
+        prte_rml_base.hops[prte_rml_base.num_hops] = n;
+        prte_rml_base.routes[n] = prte_rml_base.num_hops;
+        prte_rml_base.num_hops++;
+        child = PMIX_NEW(prte_routed_tree_t);
+        child->rank = n;
+        pmix_list_append(&prte_rml_base.children, &child->super);
+    }
 
     if (0 < pmix_output_get_verbosity(prte_rml_base.routed_output)) {
         pmix_output(0, "%s: parent %d num_children %d",
@@ -209,14 +270,13 @@ void prte_rml_compute_routing_tree(void)
                     PRTE_PROC_MY_PARENT->rank,
                     (int)pmix_list_get_size(&prte_rml_base.children));
         dmns = prte_get_job_data_object(PRTE_PROC_MY_NAME->nspace);
-        PMIX_LIST_FOREACH(child, &prte_rml_base.children, prte_routed_tree_t)
-        {
-            d = (prte_proc_t *) pmix_pointer_array_get_item(dmns->procs, child->rank);
+        for (i = 0; i < prte_rml_base.num_hops; i++) {
+            d = (prte_proc_t *) pmix_pointer_array_get_item(dmns->procs, prte_rml_base.hops[i]);
             pmix_output(0, "%s: \tchild %d node %s", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                        child->rank, d->node->name);
-            for (j = 0; j < (int) prte_process_info.num_daemons; j++) {
-                if (pmix_bitmap_is_set_bit(&child->relatives, j)) {
-                    pmix_output(0, "%s: \t\trelation %d", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), j);
+                        prte_rml_base.hops[i], d->node->name);
+            for (n = 0; n < prte_rml_base.num_routes; n++) {
+                if (i == prte_rml_base.routes[n]) {
+                    pmix_output(0, "%s: \t\trelation %d", PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), n);
                 }
             }
         }
@@ -225,26 +285,35 @@ void prte_rml_compute_routing_tree(void)
 
 int prte_rml_get_num_contributors(pmix_rank_t *dmns, size_t ndmns)
 {
-    int j, n;
-    prte_routed_tree_t *child;
+    size_t j;
+    int n, hop;
+    bool *seen;
 
     if (NULL == dmns) {
         return pmix_list_get_size(&prte_rml_base.children);
     }
+    if (0 == prte_rml_base.num_hops) {
+        return 0;
+    }
 
+    /* count the children that have at least one of the
+     * daemons at or beneath them */
+    seen = (bool *) calloc(prte_rml_base.num_hops, sizeof(bool));
+    if (NULL == seen) {
+        PRTE_ERROR_LOG(PRTE_ERR_OUT_OF_RESOURCE);
+        return 0;
+    }
     n = 0;
-    PMIX_LIST_FOREACH(child, &prte_rml_base.children, prte_routed_tree_t) {
-        for (j = 0; j < (int) ndmns; j++) {
-            /* if the child is one of the daemons, then take it */
-            if (dmns[j] == child->rank) {
-                n++;
-                break;
-            }
-            if (pmix_bitmap_is_set_bit(&child->relatives, dmns[j])) {
-                n++;
-                break;
-            }
+    for (j = 0; j < ndmns && n < prte_rml_base.num_hops; j++) {
+        if (dmns[j] >= prte_rml_base.num_routes) {
+            continue;
+        }
+        hop = prte_rml_base.routes[dmns[j]];
+        if (0 <= hop && !seen[hop]) {
+            seen[hop] = true;
+            n++;
         }
     }
+    free(seen);
     return n;
 }
@@ -80,7 +80,7 @@ int prte_proc_copy(prte_proc_t **dest, prte_proc_t *src)
  */
 int prte_app_copy(prte_app_context_t **dest, prte_app_context_t *src)
 {
-    prte_value_t *kv, *kvnew;
+    prte_attribute_t *kv, *kvnew;
     pmix_status_t rc;
 
     /* create the new object */
@@ -102,16 +102,18 @@ int prte_app_copy(prte_app_context_t **dest, prte_app_context_t *src)
         (*dest)->cwd = strdup(src->cwd);
     }
 
-    PMIX_LIST_FOREACH(kv, &src->attributes, prte_value_t)
+    PMIX_LIST_FOREACH(kv, &src->attributes.super, prte_attribute_t)
     {
-        kvnew = PMIX_NEW(prte_value_t);
-        PMIX_VALUE_XFER_DIRECT(rc, &kvnew->value, &kv->value);
+        kvnew = PMIX_NEW(prte_attribute_t);
+        kvnew->key = kv->key;
+        kvnew->local = kv->local;
+        PMIX_VALUE_XFER_DIRECT(rc, &kvnew->data, &kv->data);
         if (PMIX_SUCCESS != rc) {
             PMIX_ERROR_LOG(rc);
             PMIX_RELEASE(kvnew);
             return prte_pmix_convert_status(rc);
         }
-        pmix_list_append(&(*dest)->attributes, &kvnew->super);
+        prte_attr_list_append(&(*dest)->attributes, kvnew);
     }
 
     return PRTE_SUCCESS;
@@ -67,7 +67,7 @@ int prte_job_pack(pmix_data_buffer_t *bkt, prte_job_t *job)
 
     /* pack the attributes that need to be sent */
     count = 0;
-    PMIX_LIST_FOREACH(kv, &job->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(kv, &job->attributes.super, prte_attribute_t)
     {
         if (PRTE_ATTR_GLOBAL == kv->local) {
             ++count;
@@ -78,7 +78,7 @@ int prte_job_pack(pmix_data_buffer_t *bkt, prte_job_t *job)
         PMIX_ERROR_LOG(rc);
         return prte_pmix_convert_status(rc);
     }
-    PMIX_LIST_FOREACH(kv, &job->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(kv, &job->attributes.super, prte_attribute_t)
     {
         if (PRTE_ATTR_GLOBAL == kv->local) {
             rc = PMIx_Data_pack(NULL, bkt, (void *) &kv->key, 1, PMIX_UINT16);
@@ -303,7 +303,7 @@ int prte_node_pack(pmix_data_buffer_t *bkt, prte_node_t *node)
 
     /* pack any shared attributes */
     count = 0;
-    PMIX_LIST_FOREACH(kv, &node->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(kv, &node->attributes.super, prte_attribute_t)
     {
         if (PRTE_ATTR_GLOBAL == kv->local) {
             ++count;
@@ -315,7 +315,7 @@ int prte_node_pack(pmix_data_buffer_t *bkt, prte_node_t *node)
         return prte_pmix_convert_status(rc);
     }
     if (0 < count) {
-        PMIX_LIST_FOREACH(kv, &node->attributes, prte_attribute_t)
+        PMIX_LIST_FOREACH(kv, &node->attributes.super, prte_attribute_t)
         {
             if (PRTE_ATTR_GLOBAL == kv->local) {
                 rc = PMIx_Data_pack(NULL, bkt, (void *) &kv->key, 1, PMIX_UINT16);
@@ -400,7 +400,7 @@ int prte_proc_pack(pmix_data_buffer_t *bkt, prte_proc_t *proc)
 
     /* pack the attributes that will go */
     count = 0;
-    PMIX_LIST_FOREACH(kv, &proc->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(kv, &proc->attributes.super, prte_attribute_t)
     {
         if (PRTE_ATTR_GLOBAL == kv->local) {
             ++count;
@@ -412,7 +412,7 @@ int prte_proc_pack(pmix_data_buffer_t *bkt, prte_proc_t *proc)
         return prte_pmix_convert_status(rc);
     }
     if (0 < count) {
-        PMIX_LIST_FOREACH(kv, &proc->attributes, prte_attribute_t)
+        PMIX_LIST_FOREACH(kv, &proc->attributes.super, prte_attribute_t)
         {
             if (PRTE_ATTR_GLOBAL == kv->local) {
                 rc = PMIx_Data_pack(NULL, bkt, (void *) &kv->key, 1, PMIX_UINT16);
@@ -519,7 +519,7 @@ int prte_app_pack(pmix_data_buffer_t *bkt, prte_app_context_t *app)
 
     /* pack attributes */
     count = 0;
-    PMIX_LIST_FOREACH(kv, &app->attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(kv, &app->attributes.super, prte_attribute_t)
     {
         if (PRTE_ATTR_GLOBAL == kv->local) {
             ++count;
@@ -531,7 +531,7 @@ int prte_app_pack(pmix_data_buffer_t *bkt, prte_app_context_t *app)
         return prte_pmix_convert_status(rc);
     }
     if (0 < count) {
-        PMIX_LIST_FOREACH(kv, &app->attributes, prte_attribute_t)
+        PMIX_LIST_FOREACH(kv, &app->attributes.super, prte_attribute_t)
         {
             if (PRTE_ATTR_GLOBAL == kv->local) {
                 rc = PMIx_Data_pack(NULL, bkt, (void *) &kv->key, 1, PMIX_UINT16);
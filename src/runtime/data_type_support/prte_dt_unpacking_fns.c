@@ -105,7 +105,7 @@ int prte_job_unpack(pmix_data_buffer_t *bkt, prte_job_t **job)
             return prte_pmix_convert_status(rc);
         }
         kv->local = PRTE_ATTR_GLOBAL; // obviously not a local value
-        pmix_list_append(&jptr->attributes, &kv->super);
+        prte_attr_list_append(&jptr->attributes, kv);
     }
     /* unpack any job info */
     n = 1;
@@ -364,7 +364,7 @@ int prte_node_unpack(pmix_data_buffer_t *bkt, prte_node_t **nd)
             return prte_pmix_convert_status(rc);
         }
         kv->local = PRTE_ATTR_GLOBAL; // obviously not a local value
-        pmix_list_append(&node->attributes, &kv->super);
+        prte_attr_list_append(&node->attributes, kv);
     }
     *nd = node;
     return PRTE_SUCCESS;
@@ -485,7 +485,7 @@ int prte_proc_unpack(pmix_data_buffer_t *bkt, prte_proc_t **pc)
             return prte_pmix_convert_status(rc);
         }
         kv->local = PRTE_ATTR_GLOBAL; // obviously not a local value
-        pmix_list_append(&proc->attributes, &kv->super);
+        prte_attr_list_append(&proc->attributes, kv);
     }
     *pc = proc;
     return PRTE_SUCCESS;
@@ -627,7 +627,7 @@ int prte_app_unpack(pmix_data_buffer_t *bkt, prte_app_context_t **ap)
             return prte_pmix_convert_status(rc);
         }
         kv->local = PRTE_ATTR_GLOBAL; // obviously not a local value
-        pmix_list_append(&app->attributes, &kv->super);
+        prte_attr_list_append(&app->attributes, kv);
     }
     *ap = app;
     return PRTE_SUCCESS;
@@ -23,6 +23,7 @@
  * $HEADER$
  */
 
+
 #include "prte_config.h"
 #include "constants.h"
 #include "types.h"
@@ -33,6 +34,7 @@
 #    include <sys/time.h>
 #endif
 
+#include "src/class/pmix_hash_table.h"
 #include "src/class/pmix_pointer_array.h"
 #include "src/pmix/pmix-internal.h"
 #include "src/util/pmix_argv.h"
@@ -43,14 +45,17 @@
 #include "src/runtime/prte_globals.h"
 #include "src/runtime/prte_wait.h"
 #include "src/util/name_fns.h"
+#include "src/util/proc_info.h"
 
 #include "src/runtime/prte_data_server.h"
 
-/* define an object to hold data */
+/* define an object to hold a published value. Each key given
+ * to publish is stored as an object of its own, on the list
+ * of values for that key in the index */
 typedef struct {
     /* base object */
-    pmix_object_t super;
-    /* index of this object in the storage array */
+    pmix_list_item_t super;
+    /* index of this object in the array of its nspace */
     int32_t index;
     /* process that owns this data - only the
      * owner can remove it
@@ -62,10 +67,8 @@ typedef struct {
     /* characteristics */
     pmix_data_range_t range;
     pmix_persistence_t persistence;
-    /* and the values themselves */
-    pmix_info_t *info;
-    size_t ninfo;
-    /* the value itself */
+    /* the key and value */
+    pmix_info_t info;
 } prte_data_object_t;
 
 static void construct(prte_data_object_t *ptr)
@@ -75,18 +78,15 @@ static void construct(prte_data_object_t *ptr)
     ptr->uid = UINT32_MAX;
     ptr->range = PMIX_RANGE_SESSION;
     ptr->persistence = PMIX_PERSIST_SESSION;
-    ptr->info = NULL;
-    ptr->ninfo = 0;
+    PMIX_INFO_CONSTRUCT(&ptr->info);
 }
 
 static void destruct(prte_data_object_t *ptr)
 {
-    if (NULL != ptr->info) {
-        PMIX_INFO_FREE(ptr->info, ptr->ninfo);
-    }
+    PMIX_INFO_DESTRUCT(&ptr->info);
 }
 
-static PMIX_CLASS_INSTANCE(prte_data_object_t, pmix_object_t, construct, destruct);
+static PMIX_CLASS_INSTANCE(prte_data_object_t, pmix_list_item_t, construct, destruct);
 
 /* define a request object for delayed answers */
 typedef struct {
@@ -97,31 +97,103 @@ typedef struct {
     uint32_t uid;
     pmix_data_range_t range;
     char **keys;
-    pmix_list_t answers;
+    /* number of keys that must be found - 0 => all */
+    size_t nwait;
 } prte_data_req_t;
 static void rqcon(prte_data_req_t *p)
 {
     p->keys = NULL;
-    PMIX_CONSTRUCT(&p->answers, pmix_list_t);
+    p->nwait = 0;
 }
 static void rqdes(prte_data_req_t *p)
 {
     pmix_argv_free(p->keys);
-    PMIX_LIST_DESTRUCT(&p->answers);
 }
 static PMIX_CLASS_INSTANCE(prte_data_req_t, pmix_list_item_t, rqcon, rqdes);
 
+/* a request waiting for a key to be published */
+typedef struct {
+    pmix_list_item_t super;
+    prte_data_req_t *req;
+} prte_data_waiter_t;
+static void wtcon(prte_data_waiter_t *p)
+{
+    p->req = NULL;
+}
+static void wtdes(prte_data_waiter_t *p)
+{
+    if (NULL != p->req) {
+        PMIX_RELEASE(p->req);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_data_waiter_t, pmix_list_item_t, wtcon, wtdes);
+
+/* everything stored under one key, and the requests
+ * waiting for it to be published */
+typedef struct {
+    pmix_object_t super;
+    pmix_list_t data;
+    pmix_list_t waiters;
+} prte_data_key_t;
+static void kycon(prte_data_key_t *p)
+{
+    PMIX_CONSTRUCT(&p->data, pmix_list_t);
+    PMIX_CONSTRUCT(&p->waiters, pmix_list_t);
+}
+static void kydes(prte_data_key_t *p)
+{
+    PMIX_LIST_DESTRUCT(&p->data);
+    PMIX_LIST_DESTRUCT(&p->waiters);
+}
+static PMIX_CLASS_INSTANCE(prte_data_key_t, pmix_object_t, kycon, kydes);
+
+/* the data published by the procs of an nspace, so that
+ * it can be purged without searching the whole store */
+typedef struct {
+    pmix_object_t super;
+    pmix_pointer_array_t data;
+} prte_data_nspace_t;
+static void nscon(prte_data_nspace_t *p)
+{
+    PMIX_CONSTRUCT(&p->data, pmix_pointer_array_t);
+    pmix_pointer_array_init(&p->data, 8, INT_MAX, 8);
+}
+static void nsdes(prte_data_nspace_t *p)
+{
+    /* the objects themselves belong to the key index */
+    PMIX_DESTRUCT(&p->data);
+}
+static PMIX_CLASS_INSTANCE(prte_data_nspace_t, pmix_object_t, nscon, nsdes);
+
+/* an object included in an answer */
+typedef struct {
+    pmix_list_item_t super;
+    prte_data_object_t *data;
+} prte_data_answer_t;
+static void ancon(prte_data_answer_t *p)
+{
+    p->data = NULL;
+}
+static void andes(prte_data_answer_t *p)
+{
+    if (NULL != p->data) {
+        PMIX_RELEASE(p->data);
+    }
+}
+static PMIX_CLASS_INSTANCE(prte_data_answer_t, pmix_list_item_t, ancon, andes);
+
 /* local globals */
-static pmix_pointer_array_t prte_data_server_store;
+static pmix_hash_table_t prte_data_server_keys;
+static pmix_hash_table_t prte_data_server_nspaces;
 static pmix_list_t pending;
 static bool initialized = false;
 static int prte_data_server_output = -1;
 static int prte_data_server_verbosity = -1;
 
+int prte_data_server_shards = 0;
+
 int prte_data_server_init(void)
 {
-    int rc;
-
     if (initialized) {
         return PRTE_SUCCESS;
     }
@@ -138,11 +210,20 @@ int prte_data_server_init(void)
         pmix_output_set_verbosity(prte_data_server_output, prte_data_server_verbosity);
     }
 
-    PMIX_CONSTRUCT(&prte_data_server_store, pmix_pointer_array_t);
-    if (PRTE_SUCCESS != (rc = pmix_pointer_array_init(&prte_data_server_store, 1, INT_MAX, 1))) {
-        PRTE_ERROR_LOG(rc);
-        return rc;
-    }
+    prte_data_server_shards = 0;
+    (void) pmix_mca_base_var_register("prte", "prte", "data", "server_shards",
+                                      "Number of daemons to spread the keys published at "
+                                      "session and global range across, by hash of the key - "
+                                      "daemons 0 thru N-1 of the DVM each hold their share "
+                                      "of the keys (0 or 1 => all data is held by the HNP). "
+                                      "Ignored when an external data server is used",
+                                      PMIX_MCA_BASE_VAR_TYPE_INT,
+                                      &prte_data_server_shards);
+
+    PMIX_CONSTRUCT(&prte_data_server_keys, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_data_server_keys, 1024);
+    PMIX_CONSTRUCT(&prte_data_server_nspaces, pmix_hash_table_t);
+    pmix_hash_table_init(&prte_data_server_nspaces, 32);
 
     PMIX_CONSTRUCT(&pending, pmix_list_t);
 
@@ -152,688 +233,754 @@ int prte_data_server_init(void)
     return PRTE_SUCCESS;
 }
 
-void prte_data_server_finalize(void)
+static void release_all(pmix_hash_table_t *table)
 {
-    int32_t i;
-    prte_data_object_t *data;
+    void *key, *value, *node;
+    size_t keysize;
+    int rc;
+
+    rc = pmix_hash_table_get_first_key_ptr(table, &key, &keysize, &value, &node);
+    while (PMIX_SUCCESS == rc) {
+        PMIX_RELEASE(value);
+        rc = pmix_hash_table_get_next_key_ptr(table, &key, &keysize, &value, node, &node);
+    }
+    PMIX_DESTRUCT(table);
+}
 
+void prte_data_server_finalize(void)
+{
     if (!initialized) {
         return;
     }
     initialized = false;
 
-    for (i = 0; i < prte_data_server_store.size; i++) {
-        if (NULL
-            != (data = (prte_data_object_t *) pmix_pointer_array_get_item(&prte_data_server_store,
-                                                                          i))) {
-            PMIX_RELEASE(data);
+    release_all(&prte_data_server_nspaces);
+    release_all(&prte_data_server_keys);
+    PMIX_LIST_DESTRUCT(&pending);
+}
+
+pmix_rank_t prte_data_server_nshards(void)
+{
+    pmix_rank_t n;
+
+    if (NULL != prte_data_server_uri || 1 >= prte_data_server_shards) {
+        return 1;
+    }
+    n = prte_data_server_shards;
+    if (n > prte_process_info.num_daemons) {
+        n = prte_process_info.num_daemons;
+    }
+    return (0 == n) ? 1 : n;
+}
+
+pmix_rank_t prte_data_server_shard(const char *key)
+{
+    pmix_rank_t n = prte_data_server_nshards();
+    uint32_t hash = 2166136261u;
+    const char *c;
+
+    if (1 == n) {
+        return PRTE_PROC_MY_HNP->rank;
+    }
+    /* FNV-1a - the shard must not depend on anything
+     * but the key, as every daemon computes it */
+    for (c = key; '\0' != *c; c++) {
+        hash ^= (uint8_t) *c;
+        hash *= 16777619u;
+    }
+    return hash % n;
+}
+
+void prte_data_server_purge(const pmix_proc_t *target, pmix_rank_t server)
+{
+    pmix_data_buffer_t *buf;
+    pmix_rank_t n, nshards = 1;
+    int rc, room = -1;
+    uint8_t cmd = PRTE_PMIX_PURGE_PROC_CMD;
+
+    /* if the keys are sharded, every shard may hold some of
+     * the target's data */
+    if (server == PRTE_PROC_MY_HNP->rank) {
+        nshards = prte_data_server_nshards();
+    }
+
+    for (n = 0; n < nshards; n++) {
+        PMIX_DATA_BUFFER_CREATE(buf);
+        /* pack the room number */
+        rc = PMIx_Data_pack(NULL, buf, &room, 1, PMIX_INT);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
+            return;
+        }
+        /* load the command */
+        rc = PMIx_Data_pack(NULL, buf, &cmd, 1, PMIX_UINT8);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
+            return;
+        }
+        /* provide the target */
+        rc = PMIx_Data_pack(NULL, buf, (pmix_proc_t *) target, 1, PMIX_PROC);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
+            return;
+        }
+        /* send the request to the server */
+        PRTE_RML_SEND(rc, (1 == nshards) ? server : n, buf, PRTE_RML_TAG_DATA_SERVER);
+        if (PRTE_SUCCESS != rc) {
+            PRTE_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(buf);
         }
     }
-    PMIX_DESTRUCT(&prte_data_server_store);
-    PMIX_LIST_DESTRUCT(&pending);
 }
 
-void prte_data_server(int status, pmix_proc_t *sender,
-                      pmix_data_buffer_t *buffer,
-                      prte_rml_tag_t tag, void *cbdata)
+static prte_data_key_t *get_key(const char *key, bool create)
 {
-    uint8_t command;
-    int32_t count;
-    prte_data_object_t *data;
-    pmix_data_buffer_t *answer, *reply;
-    int rc, k;
-    uint32_t ninfo, i;
-    char **keys = NULL, *str;
-    bool wait = false;
-    int room_number;
-    uint32_t uid = UINT32_MAX;
-    pmix_data_range_t range;
-    prte_data_req_t *req, *rqnext;
-    pmix_data_buffer_t pbkt;
-    pmix_byte_object_t pbo;
-    pmix_status_t ret;
-    pmix_proc_t requestor;
-    prte_ds_info_t *rinfo;
-    size_t n, nanswers;
-    pmix_info_t *info;
-    pmix_list_t answers;
-    void *ilist;
-    pmix_data_array_t darray;
-    PRTE_HIDE_UNUSED_PARAMS(status, tag, cbdata);
+    prte_data_key_t *k = NULL;
 
-    pmix_output_verbose(1, prte_data_server_output, "%s data server got message from %s",
-                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender));
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&prte_data_server_keys, key, strlen(key),
+                                                      (void **) &k)) {
+        return k;
+    }
+    if (!create) {
+        return NULL;
+    }
+    k = PMIX_NEW(prte_data_key_t);
+    pmix_hash_table_set_value_ptr(&prte_data_server_keys, key, strlen(key), k);
+    return k;
+}
 
-    /* unpack the room number of the caller's request */
-    count = 1;
-    rc = PMIx_Data_unpack(NULL, buffer, &room_number, &count, PMIX_INT);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
+/* remove the index entry of a key once nothing is left
+ * under it - it may already have been removed */
+static void drop_key(const char *key, prte_data_key_t *k)
+{
+    prte_data_key_t *ptr;
+
+    if (!pmix_list_is_empty(&k->data) || !pmix_list_is_empty(&k->waiters)) {
         return;
     }
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&prte_data_server_keys, key, strlen(key),
+                                                      (void **) &ptr)
+        && ptr == k) {
+        pmix_hash_table_remove_value_ptr(&prte_data_server_keys, key, strlen(key));
+        PMIX_RELEASE(k);
+    }
+}
 
-    /* unpack the command */
-    count = 1;
-    rc = PMIx_Data_unpack(NULL, buffer, &command, &count, PMIX_UINT8);
+static void store(prte_data_object_t *data)
+{
+    prte_data_key_t *k;
+    prte_data_nspace_t *ns = NULL;
+    size_t len = strnlen(data->owner.nspace, PMIX_MAX_NSLEN);
+
+    k = get_key(data->info.key, true);
+    pmix_list_append(&k->data, &data->super);
+
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(&prte_data_server_nspaces,
+                                                      data->owner.nspace, len, (void **) &ns)) {
+        ns = PMIX_NEW(prte_data_nspace_t);
+        pmix_hash_table_set_value_ptr(&prte_data_server_nspaces, data->owner.nspace, len, ns);
+    }
+    data->index = pmix_pointer_array_add(&ns->data, data);
+}
+
+static void discard(prte_data_object_t *data)
+{
+    prte_data_key_t *k;
+    prte_data_nspace_t *ns;
+
+    if (0 > data->index) {
+        /* already gone */
+        return;
+    }
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&prte_data_server_nspaces,
+                                                      data->owner.nspace,
+                                                      strnlen(data->owner.nspace, PMIX_MAX_NSLEN),
+                                                      (void **) &ns)) {
+        pmix_pointer_array_set_item(&ns->data, data->index, NULL);
+    }
+    data->index = -1;
+    if (NULL != (k = get_key(data->info.key, false))) {
+        pmix_list_remove_item(&k->data, &data->super);
+        drop_key(data->info.key, k);
+    }
+    PMIX_RELEASE(data);
+}
+
+/* for security reasons, can only access data posted by the same
+ * user id - and if the published range is constrained to namespace,
+ * then only if the publisher is in the same namespace as the requestor */
+static bool visible(prte_data_object_t *data, uint32_t uid, const pmix_proc_t *requestor)
+{
+    if (uid != data->uid) {
+        pmix_output_verbose(10, prte_data_server_output, "%s\tMISMATCH UID %u %u",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (unsigned) uid,
+                            (unsigned) data->uid);
+        return false;
+    }
+    if (PMIX_RANGE_NAMESPACE == data->range
+        && !PMIX_CHECK_NSPACE(requestor->nspace, data->owner.nspace)) {
+        pmix_output_verbose(10, prte_data_server_output, "%s\tMISMATCH NSPACES %s %s",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), requestor->nspace,
+                            data->owner.nspace);
+        return false;
+    }
+    return true;
+}
+
+/* collect the data visible to the requestor for each of the
+ * keys, returning the number of keys for which some was found */
+static size_t find(char **keys, uint32_t uid, const pmix_proc_t *requestor, pmix_list_t *answers)
+{
+    prte_data_key_t *k;
+    prte_data_object_t *data;
+    prte_data_answer_t *ans;
+    size_t i, nfound = 0;
+    bool found;
+
+    for (i = 0; NULL != keys[i]; i++) {
+        pmix_output_verbose(10, prte_data_server_output, "%s data server: looking for %s",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), keys[i]);
+        if (NULL == (k = get_key(keys[i], false))) {
+            continue;
+        }
+        found = false;
+        PMIX_LIST_FOREACH(data, &k->data, prte_data_object_t)
+        {
+            if (!visible(data, uid, requestor)) {
+                continue;
+            }
+            ans = PMIX_NEW(prte_data_answer_t);
+            PMIX_RETAIN(data);
+            ans->data = data;
+            pmix_list_append(answers, &ans->super);
+            found = true;
+            pmix_output_verbose(1, prte_data_server_output,
+                                "%s data server: adding %s to data from %s",
+                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), data->info.key,
+                                PRTE_NAME_PRINT(&data->owner));
+        }
+        if (found) {
+            ++nfound;
+        }
+    }
+    return nfound;
+}
+
+/* send the result of a lookup - the answers are packed into a byte
+ * object after the status, and any that were to persist only until
+ * read are removed from the store */
+static void send_lookup(pmix_rank_t proxy, int room_number, int status, pmix_list_t *answers)
+{
+    pmix_data_buffer_t *reply, pbkt;
+    pmix_byte_object_t pbo;
+    prte_data_answer_t *ans;
+    uint8_t command = PRTE_PMIX_LOOKUP_CMD;
+    size_t nanswers;
+    int rc;
+
+    PMIX_DATA_BUFFER_CREATE(reply);
+    /* start with their room number */
+    rc = PMIx_Data_pack(NULL, reply, &room_number, 1, PMIX_INT);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(reply);
         return;
     }
-
-    PMIX_DATA_BUFFER_CREATE(answer);
-    /* pack the room number as this must lead any response */
-    rc = PMIx_Data_pack(NULL, answer, &room_number, 1, PMIX_INT);
+    /* we are responding to a lookup cmd */
+    rc = PMIx_Data_pack(NULL, reply, &command, 1, PMIX_UINT8);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        PMIX_DATA_BUFFER_RELEASE(answer);
+        PMIX_DATA_BUFFER_RELEASE(reply);
         return;
     }
-    /* and the command */
-    rc = PMIx_Data_pack(NULL, answer, &command, 1, PMIX_UINT8);
+    /* return the status */
+    rc = PMIx_Data_pack(NULL, reply, &status, 1, PMIX_INT);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        PMIX_DATA_BUFFER_RELEASE(answer);
+        PMIX_DATA_BUFFER_RELEASE(reply);
         return;
     }
 
-    switch (command) {
-    case PRTE_PMIX_PUBLISH_CMD:
-        data = PMIX_NEW(prte_data_object_t);
-
-        /* unpack the publisher */
-        count = 1;
-        if (PMIX_SUCCESS
-            != (ret = PMIx_Data_unpack(NULL, buffer, &data->owner, &count, PMIX_PROC))) {
-            PMIX_ERROR_LOG(ret);
-            PMIX_RELEASE(data);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
+    if (0 < (nanswers = pmix_list_get_size(answers))) {
+        /* pack the rest into a pmix_data_buffer_t */
+        PMIX_DATA_BUFFER_CONSTRUCT(&pbkt);
+        /* pack the number of data items found */
+        rc = PMIx_Data_pack(NULL, &pbkt, &nanswers, 1, PMIX_SIZE);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
+            PMIX_DATA_BUFFER_RELEASE(reply);
+            return;
         }
-
-        pmix_output_verbose(1, prte_data_server_output,
-                            "%s data server: publishing data from %s:%d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), data->owner.nspace,
-                            data->owner.rank);
-
-        /* unpack the number of infos and directives they sent */
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &ninfo, &count, PMIX_SIZE))) {
-            PMIX_ERROR_LOG(ret);
-            PMIX_RELEASE(data);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
+        /* loop thru and pack the individual responses - this is somewhat less
+         * efficient than packing an info array, but avoids another malloc
+         * operation just to assemble all the return values into a contiguous
+         * array */
+        PMIX_LIST_FOREACH(ans, answers, prte_data_answer_t)
+        {
+            /* pack the data owner */
+            rc = PMIx_Data_pack(NULL, &pbkt, &ans->data->owner, 1, PMIX_PROC);
+            if (PMIX_SUCCESS != rc) {
+                PMIX_ERROR_LOG(rc);
+                PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
+                PMIX_DATA_BUFFER_RELEASE(reply);
+                return;
+            }
+            /* pack the data */
+            rc = PMIx_Data_pack(NULL, &pbkt, &ans->data->info, 1, PMIX_INFO);
+            if (PMIX_SUCCESS != rc) {
+                PMIX_ERROR_LOG(rc);
+                PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
+                PMIX_DATA_BUFFER_RELEASE(reply);
+                return;
+            }
         }
-
-        /* if it isn't at least one, then that's an error */
-        if (1 > ninfo) {
-            ret = PMIX_ERR_BAD_PARAM;
-            PMIX_ERROR_LOG(ret);
-            PMIX_RELEASE(data);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
+        /* unload the pmix buffer */
+        rc = PMIx_Data_unload(&pbkt, &pbo);
+        /* pack it into our reply */
+        rc = PMIx_Data_pack(NULL, reply, &pbo, 1, PMIX_BYTE_OBJECT);
+        PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            PMIX_DATA_BUFFER_RELEASE(reply);
+            return;
+        }
+        /* the data has been read */
+        PMIX_LIST_FOREACH(ans, answers, prte_data_answer_t)
+        {
+            if (PMIX_PERSIST_FIRST_READ == ans->data->persistence) {
+                pmix_output_verbose(1, prte_data_server_output,
+                                    "%s REMOVING DATA FROM %s FOR KEY %s",
+                                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
+                                    PRTE_NAME_PRINT(&ans->data->owner), ans->data->info.key);
+                discard(ans->data);
+            }
         }
+    }
+
+    PRTE_RML_SEND(rc, proxy, reply, PRTE_RML_TAG_DATA_CLIENT);
+    if (PRTE_SUCCESS != rc) {
+        PRTE_ERROR_LOG(rc);
+        PMIX_DATA_BUFFER_RELEASE(reply);
+    }
+}
 
-        /* create the space */
-        PMIX_INFO_CREATE(info, ninfo);
+/* remove a request from the pending list and the index */
+static void cancel(prte_data_req_t *req)
+{
+    prte_data_key_t *k;
+    prte_data_waiter_t *w;
+    size_t i;
 
-        /* unpack into it */
-        count = ninfo;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, info, &count, PMIX_INFO))) {
-            PMIX_ERROR_LOG(ret);
-            PMIX_RELEASE(data);
-            PMIX_INFO_FREE(info, ninfo);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
+    for (i = 0; NULL != req->keys[i]; i++) {
+        if (NULL == (k = get_key(req->keys[i], false))) {
+            continue;
         }
-
-        PMIX_INFO_LIST_START(ilist);
-        /* check for directives */
-        for (n = 0; n < ninfo; n++) {
-            if (0 == strcmp(info[n].key, PMIX_RANGE)) {
-                data->range = info[n].value.data.range;
-            } else if (0 == strcmp(info[n].key, PMIX_PERSISTENCE)) {
-                data->persistence = info[n].value.data.persist;
-            } else if (0 == strcmp(info[n].key, PMIX_USERID)) {
-                data->uid = info[n].value.data.uint32;
-            } else {
-                /* add it to the list */
-                PMIX_INFO_LIST_XFER(ret, ilist, &info[n]);
-                if (PMIX_SUCCESS != ret) {
-                    PMIX_ERROR_LOG(ret);
-                    PMIX_RELEASE(data);
-                    rc = PRTE_ERR_UNPACK_FAILURE;
-                    PMIX_INFO_LIST_RELEASE(ilist);
-                    PMIX_INFO_FREE(info, ninfo);
-                    goto SEND_ERROR;
-                }
+        PMIX_LIST_FOREACH(w, &k->waiters, prte_data_waiter_t)
+        {
+            if (w->req == req) {
+                pmix_list_remove_item(&k->waiters, &w->super);
+                PMIX_RELEASE(w);
+                break;
             }
         }
-        PMIX_INFO_FREE(info, ninfo); // done with the array
-        PMIX_INFO_LIST_CONVERT(ret, ilist, &darray);
-        data->info = (pmix_info_t *) darray.array;
-        data->ninfo = darray.size;
-        PMIX_INFO_LIST_RELEASE(ilist);
+        drop_key(req->keys[i], k);
+    }
+    pmix_list_remove_item(&pending, &req->super);
+    PMIX_RELEASE(req);
+}
 
-        /* store this object */
-        data->index = pmix_pointer_array_add(&prte_data_server_store, data);
+/* check if a pending request can now be answered */
+static void wakeup(prte_data_req_t *req)
+{
+    pmix_list_t answers;
+    size_t nkeys, nfound;
 
-        pmix_output_verbose(1, prte_data_server_output,
-                            "%s data server: checking for pending requests",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
+    nkeys = pmix_argv_count(req->keys);
+    PMIX_CONSTRUCT(&answers, pmix_list_t);
+    nfound = find(req->keys, req->uid, &req->requestor, &answers);
+    if (nfound < nkeys && (0 == req->nwait || nfound < req->nwait)) {
+        PMIX_LIST_DESTRUCT(&answers);
+        return;
+    }
 
-        /* check for pending requests that match this data */
-        reply = NULL;
-        PMIX_LIST_FOREACH_SAFE(req, rqnext, &pending, prte_data_req_t)
-        {
-            if (req->uid != data->uid) {
-                continue;
-            }
-            /* if the published range is constrained to namespace, then only
-             * consider this data if the publisher is
-             * in the same namespace as the requestor */
-            if (PMIX_RANGE_NAMESPACE == data->range) {
-                if (0 != strncmp(req->requestor.nspace, data->owner.nspace, PMIX_MAX_NSLEN)) {
-                    continue;
-                }
-            }
-            for (i = 0; NULL != req->keys[i]; i++) {
-                /* cycle thru the data keys for matches */
-                for (n = 0; n < data->ninfo; n++) {
-                    pmix_output_verbose(10, prte_data_server_output, "%s\tCHECKING %s TO %s",
-                                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), data->info[n].key,
-                                        req->keys[i]);
-                    if (0 == strncmp(data->info[n].key, req->keys[i], PMIX_MAX_KEYLEN)) {
-                        pmix_output_verbose(10, prte_data_server_output,
-                                            "%s data server: packaging return",
-                                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
-                        /* track this response */
-                        pmix_output_verbose(
-                            10, prte_data_server_output,
-                            "%s data server: adding %s data %s from %s:%d to response",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), data->info[n].key,
-                            PMIx_Data_type_string(data->info[n].value.type), data->owner.nspace,
-                            data->owner.rank);
-                        rinfo = PMIX_NEW(prte_ds_info_t);
-                        memcpy(&rinfo->source, &data->owner, sizeof(pmix_proc_t));
-                        rinfo->info = &data->info[n];
-                        pmix_list_append(&req->answers, &rinfo->super);
-                        break; // a key can only occur once
-                    }
-                }
-            }
-            if (0 < (n = pmix_list_get_size(&req->answers))) {
-                /* send it back to the requestor */
-                pmix_output_verbose(1, prte_data_server_output,
-                                    "%s data server: returning data to %s:%d",
-                                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), req->requestor.nspace,
-                                    req->requestor.rank);
-
-                PMIX_DATA_BUFFER_CREATE(reply);
-                /* start with their room number */
-                rc = PMIx_Data_pack(NULL, reply, &req->room_number, 1, PMIX_INT);
-                if (PMIX_SUCCESS != rc) {
-                    PMIX_ERROR_LOG(rc);
-                    PMIX_DATA_BUFFER_RELEASE(reply);
-                    goto SEND_ERROR;
-                }
-                /* we are responding to a lookup cmd */
-                command = PRTE_PMIX_LOOKUP_CMD;
-                rc = PMIx_Data_pack(NULL, reply, &command, 1, PMIX_UINT8);
-                if (PMIX_SUCCESS != rc) {
-                    PMIX_ERROR_LOG(rc);
-                    PMIX_DATA_BUFFER_RELEASE(reply);
-                    goto SEND_ERROR;
-                }
-                /* if we found all of the requested keys, then indicate so */
-                if (n == (size_t) pmix_argv_count(req->keys)) {
-                    i = PRTE_SUCCESS;
-                } else {
-                    i = (uint32_t) PRTE_ERR_PARTIAL_SUCCESS;
-                }
-                /* return the status */
-                rc = PMIx_Data_pack(NULL, reply, &i, 1, PMIX_INT);
-                if (PMIX_SUCCESS != rc) {
-                    PMIX_ERROR_LOG(rc);
-                    PMIX_DATA_BUFFER_RELEASE(reply);
-                    goto SEND_ERROR;
-                }
+    /* send it back to the requestor */
+    pmix_output_verbose(1, prte_data_server_output, "%s data server: returning data to %s:%d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), req->requestor.nspace,
+                        req->requestor.rank);
+    send_lookup(req->proxy.rank, req->room_number,
+                (nfound == nkeys) ? PRTE_SUCCESS : PRTE_ERR_PARTIAL_SUCCESS, &answers);
+    PMIX_LIST_DESTRUCT(&answers);
+    cancel(req);
+}
 
-                /* pack the rest into a pmix_data_buffer_t */
-                PMIX_DATA_BUFFER_CONSTRUCT(&pbkt);
+static int publish(pmix_data_buffer_t *buffer)
+{
+    prte_data_object_t *proto, *data;
+    prte_data_key_t *k;
+    prte_data_waiter_t *w, *wnext;
+    pmix_info_t *info;
+    char **keys = NULL;
+    size_t n, ninfo;
+    int32_t count;
+    pmix_status_t ret;
 
-                /* pack the number of returned info's */
-                if (PMIX_SUCCESS != (ret = PMIx_Data_pack(NULL, &pbkt, &n, 1, PMIX_SIZE))) {
-                    PMIX_ERROR_LOG(ret);
-                    PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
-                    rc = PRTE_ERR_PACK_FAILURE;
-                    PMIX_DATA_BUFFER_RELEASE(reply);
-                    goto SEND_ERROR;
-                }
-                /* loop thru and pack the individual responses - this is somewhat less
-                 * efficient than packing an info array, but avoids another malloc
-                 * operation just to assemble all the return values into a contiguous
-                 * array */
-                while (NULL != (rinfo = (prte_ds_info_t *) pmix_list_remove_first(&req->answers))) {
-                    /* pack the data owner */
-                    if (PMIX_SUCCESS
-                        != (ret = PMIx_Data_pack(NULL, &pbkt, &rinfo->source, 1, PMIX_PROC))) {
-                        PMIX_ERROR_LOG(ret);
-                        PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
-                        rc = PRTE_ERR_PACK_FAILURE;
-                        PMIX_DATA_BUFFER_RELEASE(reply);
-                        goto SEND_ERROR;
-                    }
-                    /* pack the data */
-                    if (PMIX_SUCCESS
-                        != (ret = PMIx_Data_pack(NULL, &pbkt, rinfo->info, 1, PMIX_INFO))) {
-                        PMIX_ERROR_LOG(ret);
-                        PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
-                        rc = PRTE_ERR_PACK_FAILURE;
-                        PMIX_DATA_BUFFER_RELEASE(reply);
-                        goto SEND_ERROR;
-                    }
-                }
-                PMIX_LIST_DESTRUCT(&req->answers);
-                PMIX_CONSTRUCT(&req->answers, pmix_list_t);
-
-                /* unload the pmix buffer */
-                rc = PMIx_Data_unload(&pbkt, &pbo);
-
-                /* pack it into our reply */
-                rc = PMIx_Data_pack(NULL, reply, &pbo, 1, PMIX_BYTE_OBJECT);
-                PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-                if (PMIX_SUCCESS != rc) {
-                    PMIX_ERROR_LOG(rc);
-                    PMIX_DATA_BUFFER_RELEASE(reply);
-                    goto SEND_ERROR;
-                }
-                PRTE_RML_SEND(rc, req->proxy.rank, reply, PRTE_RML_TAG_DATA_CLIENT);
-                if (PRTE_SUCCESS != rc) {
-                    PRTE_ERROR_LOG(rc);
-                    PMIX_DATA_BUFFER_RELEASE(reply);
-                }
-            }
+    /* the characteristics shared by all the values */
+    proto = PMIX_NEW(prte_data_object_t);
+
+    /* unpack the publisher */
+    count = 1;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &proto->owner, &count, PMIX_PROC))) {
+        PMIX_ERROR_LOG(ret);
+        PMIX_RELEASE(proto);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+
+    pmix_output_verbose(1, prte_data_server_output, "%s data server: publishing data from %s:%d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), proto->owner.nspace,
+                        proto->owner.rank);
+
+    /* unpack the number of infos and directives they sent */
+    count = 1;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &ninfo, &count, PMIX_SIZE))) {
+        PMIX_ERROR_LOG(ret);
+        PMIX_RELEASE(proto);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+
+    /* if it isn't at least one, then that's an error */
+    if (1 > ninfo) {
+        PMIX_ERROR_LOG(PMIX_ERR_BAD_PARAM);
+        PMIX_RELEASE(proto);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+
+    /* create the space */
+    PMIX_INFO_CREATE(info, ninfo);
+
+    /* unpack into it */
+    count = ninfo;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, info, &count, PMIX_INFO))) {
+        PMIX_ERROR_LOG(ret);
+        PMIX_RELEASE(proto);
+        PMIX_INFO_FREE(info, ninfo);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+
+    /* check for directives */
+    for (n = 0; n < ninfo; n++) {
+        if (0 == strcmp(info[n].key, PMIX_RANGE)) {
+            proto->range = info[n].value.data.range;
+        } else if (0 == strcmp(info[n].key, PMIX_PERSISTENCE)) {
+            proto->persistence = info[n].value.data.persist;
+        } else if (0 == strcmp(info[n].key, PMIX_USERID)) {
+            proto->uid = info[n].value.data.uint32;
         }
+    }
 
-        /* tell the user it was wonderful... */
-        rc = PRTE_SUCCESS;
-        rc = PMIx_Data_pack(NULL, answer, &rc, 1, PMIX_INT);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
+    /* store each value under its key */
+    for (n = 0; n < ninfo; n++) {
+        if (0 == strcmp(info[n].key, PMIX_RANGE) || 0 == strcmp(info[n].key, PMIX_PERSISTENCE)
+            || 0 == strcmp(info[n].key, PMIX_USERID)) {
+            continue;
         }
-        goto SEND_ANSWER;
+        data = PMIX_NEW(prte_data_object_t);
+        memcpy(&data->owner, &proto->owner, sizeof(pmix_proc_t));
+        data->uid = proto->uid;
+        data->range = proto->range;
+        data->persistence = proto->persistence;
+        PMIX_INFO_XFER(&data->info, &info[n]);
+        store(data);
+        pmix_argv_append_unique_nosize(&keys, info[n].key);
+    }
+    PMIX_INFO_FREE(info, ninfo); // done with the array
+    PMIX_RELEASE(proto);
+
+    pmix_output_verbose(1, prte_data_server_output,
+                        "%s data server: checking for pending requests",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
+
+    /* only the requests waiting for one of these keys can be
+     * answered now - keep the index entry while we walk its
+     * waiters, as answering them can empty it */
+    for (n = 0; NULL != keys && NULL != keys[n]; n++) {
+        if (NULL == (k = get_key(keys[n], false))) {
+            continue;
+        }
+        PMIX_RETAIN(k);
+        PMIX_LIST_FOREACH_SAFE(w, wnext, &k->waiters, prte_data_waiter_t)
+        {
+            wakeup(w->req);
+        }
+        drop_key(keys[n], k);
+        PMIX_RELEASE(k);
+    }
+    pmix_argv_free(keys);
 
-    case PRTE_PMIX_LOOKUP_CMD:
-        pmix_output_verbose(1, prte_data_server_output, "%s data server: lookup data from %s",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender));
+    return PRTE_SUCCESS;
+}
+
+static int unpack_keys(pmix_data_buffer_t *buffer, pmix_proc_t *requestor, char ***keys,
+                       pmix_info_t **info, size_t *ninfo)
+{
+    size_t n, nkeys;
+    int32_t count;
+    char *str;
+    pmix_status_t ret;
+
+    /* unpack the requestor */
+    count = 1;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, requestor, &count, PMIX_PROC))) {
+        PMIX_ERROR_LOG(ret);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
 
-        /* unpack the requestor */
+    /* unpack the number of keys */
+    count = 1;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &nkeys, &count, PMIX_SIZE))) {
+        PMIX_ERROR_LOG(ret);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+    if (0 == nkeys) {
+        /* they forgot to send us the keys?? */
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        return PRTE_ERR_BAD_PARAM;
+    }
+
+    /* unpack the keys */
+    for (n = 0; n < nkeys; n++) {
         count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &requestor, &count, PMIX_PROC))) {
+        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &str, &count, PMIX_STRING))) {
             PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
+            pmix_argv_free(*keys);
+            *keys = NULL;
+            return PRTE_ERR_UNPACK_FAILURE;
         }
+        pmix_argv_append_nosize(keys, str);
+        free(str);
+    }
 
-        /* unpack the number of keys */
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &ninfo, &count, PMIX_SIZE))) {
+    /* unpack the number of directives, if any */
+    count = 1;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, ninfo, &count, PMIX_SIZE))) {
+        PMIX_ERROR_LOG(ret);
+        pmix_argv_free(*keys);
+        *keys = NULL;
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+    if (0 < *ninfo) {
+        PMIX_INFO_CREATE(*info, *ninfo);
+        count = *ninfo;
+        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, *info, &count, PMIX_INFO))) {
             PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
-        }
-        if (0 == ninfo) {
-            /* they forgot to send us the keys?? */
-            PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
-            rc = PRTE_ERR_BAD_PARAM;
-            goto SEND_ERROR;
+            PMIX_INFO_FREE(*info, *ninfo);
+            pmix_argv_free(*keys);
+            *keys = NULL;
+            return PRTE_ERR_UNPACK_FAILURE;
         }
+    }
+    return PRTE_SUCCESS;
+}
 
-        /* unpack the keys */
-        for (n = 0; n < ninfo; n++) {
-            count = 1;
-            if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &str, &count, PMIX_STRING))) {
-                PMIX_ERROR_LOG(ret);
-                rc = PRTE_ERR_UNPACK_FAILURE;
-                pmix_argv_free(keys);
-                goto SEND_ERROR;
-            }
-            pmix_argv_append_nosize(&keys, str);
-            free(str);
-        }
+/* returns PRTE_SUCCESS if the answer has been sent or the
+ * request is waiting for the data */
+static int lookup(pmix_proc_t *sender, int room_number, pmix_data_buffer_t *buffer)
+{
+    pmix_proc_t requestor;
+    pmix_info_t *info = NULL;
+    pmix_list_t answers;
+    prte_data_req_t *req;
+    prte_data_key_t *k;
+    prte_data_waiter_t *w;
+    char **keys = NULL;
+    size_t n, ninfo = 0, nkeys, nfound, nwait = 0;
+    uint32_t uid = UINT32_MAX;
+    pmix_data_range_t range = PMIX_RANGE_SESSION;
+    bool wait = false;
+    int rc;
 
-        /* unpack the number of directives, if any */
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &ninfo, &count, PMIX_SIZE))) {
-            PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
-        }
-        if (0 < ninfo) {
-            PMIX_INFO_CREATE(info, ninfo);
-            count = ninfo;
-            if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, info, &count, PMIX_INFO))) {
-                PMIX_ERROR_LOG(ret);
-                PMIX_INFO_FREE(info, ninfo);
-                rc = PRTE_ERR_UNPACK_FAILURE;
-                goto SEND_ERROR;
-            }
-            /* scan the directives for things we care about */
-            for (n = 0; n < ninfo; n++) {
-                if (0 == strncmp(info[n].key, PMIX_USERID, PMIX_MAX_KEYLEN)) {
-                    uid = info[n].value.data.uint32;
-                } else if (0 == strncmp(info[n].key, PMIX_WAIT, PMIX_MAX_KEYLEN)) {
-                    /* flag that we wait until the data is present */
-                    wait = true;
-                } else if (0 == strcmp(info[n].key, PMIX_RANGE)) {
-                    range = info[n].value.data.range;
-                }
+    pmix_output_verbose(1, prte_data_server_output, "%s data server: lookup data from %s",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender));
+
+    rc = unpack_keys(buffer, &requestor, &keys, &info, &ninfo);
+    if (PRTE_SUCCESS != rc) {
+        return rc;
+    }
+    /* scan the directives for things we care about */
+    for (n = 0; n < ninfo; n++) {
+        if (0 == strncmp(info[n].key, PMIX_USERID, PMIX_MAX_KEYLEN)) {
+            uid = info[n].value.data.uint32;
+        } else if (0 == strncmp(info[n].key, PMIX_WAIT, PMIX_MAX_KEYLEN)) {
+            /* flag that we wait until the data is present - an
+             * integer value is the number of keys to wait for */
+            wait = true;
+            if (PMIX_INT == info[n].value.type && 0 < info[n].value.data.integer) {
+                nwait = info[n].value.data.integer;
             }
-            /* ignore anything else for now */
-            PMIX_INFO_FREE(info, ninfo);
+        } else if (0 == strcmp(info[n].key, PMIX_RANGE)) {
+            range = info[n].value.data.range;
         }
+    }
+    /* ignore anything else for now */
+    if (NULL != info) {
+        PMIX_INFO_FREE(info, ninfo);
+    }
 
-        /* cycle across the provided keys */
-        PMIX_DATA_BUFFER_CONSTRUCT(&pbkt);
-        PMIX_CONSTRUCT(&answers, pmix_list_t);
-
-        for (i = 0; NULL != keys[i]; i++) {
-            pmix_output_verbose(10, prte_data_server_output, "%s data server: looking for %s",
-                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), keys[i]);
-            /* cycle across the stored data, looking for a match */
-            for (k = 0; k < prte_data_server_store.size; k++) {
-                data = (prte_data_object_t *) pmix_pointer_array_get_item(&prte_data_server_store,
-                                                                          k);
-                if (NULL == data) {
-                    continue;
-                }
-                /* for security reasons, can only access data posted by the same user id */
-                if (uid != data->uid) {
-                    pmix_output_verbose(10, prte_data_server_output, "%s\tMISMATCH UID %u %u",
-                                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (unsigned) uid,
-                                        (unsigned) data->uid);
-                    continue;
-                }
-                /* if the published range is constrained to namespace, then only
-                 * consider this data if the publisher is
-                 * in the same namespace as the requestor */
-                if (PMIX_RANGE_NAMESPACE == data->range) {
-                    if (0 != strncmp(requestor.nspace, data->owner.nspace, PMIX_MAX_NSLEN)) {
-                        pmix_output_verbose(10, prte_data_server_output,
-                                            "%s\tMISMATCH NSPACES %s %s",
-                                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), requestor.nspace,
-                                            data->owner.nspace);
-                        continue;
-                    }
-                }
-                /* see if we have this key */
-                for (n = 0; n < data->ninfo; n++) {
-                    pmix_output_verbose(10, prte_data_server_output, "%s COMPARING %s %s",
-                                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), keys[i],
-                                        data->info[n].key);
-                    if (PMIX_CHECK_KEY(&data->info[n], keys[i])) {
-                        rinfo = PMIX_NEW(prte_ds_info_t);
-                        memcpy(&rinfo->source, &data->owner, sizeof(pmix_proc_t));
-                        rinfo->info = &data->info[n];
-                        rinfo->persistence = data->persistence;
-                        pmix_list_append(&answers, &rinfo->super);
-                        pmix_output_verbose(1, prte_data_server_output,
-                                            "%s data server: adding %s to data from %s",
-                                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), data->info[n].key,
-                                            PRTE_NAME_PRINT(&data->owner));
+    nkeys = pmix_argv_count(keys);
+    PMIX_CONSTRUCT(&answers, pmix_list_t);
+    nfound = find(keys, uid, &requestor, &answers);
+
+    if (nfound < nkeys) {
+        pmix_output_verbose(1, prte_data_server_output,
+                            "%s data server:lookup: at least some data not found %d vs %d",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (int) nfound, (int) nkeys);
+
+        /* if we were told to wait for the data, then queue this up
+         * for later processing */
+        if (wait && (0 == nwait || nfound < nwait)) {
+            pmix_output_verbose(1, prte_data_server_output,
+                                "%s data server:lookup: pushing request to wait",
+                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
+            /* drop the partial response we have - we'll build it when everything
+             * becomes available */
+            PMIX_LIST_DESTRUCT(&answers);
+            req = PMIX_NEW(prte_data_req_t);
+            req->room_number = room_number;
+            req->proxy = *sender;
+            memcpy(&req->requestor, &requestor, sizeof(pmix_proc_t));
+            req->uid = uid;
+            req->range = range;
+            req->keys = keys;
+            req->nwait = nwait;
+            pmix_list_append(&pending, &req->super);
+            /* index it by each of the keys it needs */
+            for (n = 0; NULL != keys[n]; n++) {
+                k = get_key(keys[n], true);
+                PMIX_LIST_FOREACH(w, &k->waiters, prte_data_waiter_t)
+                {
+                    if (w->req == req) {
+                        break;
                     }
                 }
-            } // loop over stored data
-        }     // loop over keys
-
-        if (0 < (nanswers = pmix_list_get_size(&answers))) {
-            /* pack the number of data items found */
-            if (PMIX_SUCCESS != (ret = PMIx_Data_pack(NULL, &pbkt, &nanswers, 1, PMIX_SIZE))) {
-                PMIX_ERROR_LOG(ret);
-                rc = PRTE_ERR_PACK_FAILURE;
-                PMIX_LIST_DESTRUCT(&answers);
-                pmix_argv_free(keys);
-                goto SEND_ERROR;
-            }
-            /* loop thru and pack the individual responses - this is somewhat less
-             * efficient than packing an info array, but avoids another malloc
-             * operation just to assemble all the return values into a contiguous
-             * array */
-            PMIX_LIST_FOREACH(rinfo, &answers, prte_ds_info_t)
-            {
-                /* pack the data owner */
-                if (PMIX_SUCCESS
-                    != (ret = PMIx_Data_pack(NULL, &pbkt, &rinfo->source, 1, PMIX_PROC))) {
-                    PMIX_ERROR_LOG(ret);
-                    rc = PRTE_ERR_PACK_FAILURE;
-                    PMIX_LIST_DESTRUCT(&answers);
-                    pmix_argv_free(keys);
-                    goto SEND_ERROR;
-                }
-                if (PMIX_SUCCESS
-                    != (ret = PMIx_Data_pack(NULL, &pbkt, rinfo->info, 1, PMIX_INFO))) {
-                    PMIX_ERROR_LOG(ret);
-                    rc = PRTE_ERR_PACK_FAILURE;
-                    PMIX_LIST_DESTRUCT(&answers);
-                    pmix_argv_free(keys);
-                    goto SEND_ERROR;
-                }
-                if (PMIX_PERSIST_FIRST_READ == rinfo->persistence) {
-                    pmix_output_verbose(1, prte_data_server_output,
-                                        "%s REMOVING DATA FROM %s FOR KEY %s",
-                                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME),
-                                        PRTE_NAME_PRINT(&rinfo->source), rinfo->info->key);
-                    memset(rinfo->info->key, 0, PMIX_MAX_KEYLEN + 1);
+                if (&w->super == pmix_list_get_end(&k->waiters)) {
+                    w = PMIX_NEW(prte_data_waiter_t);
+                    PMIX_RETAIN(req);
+                    w->req = req;
+                    pmix_list_append(&k->waiters, &w->super);
                 }
             }
+            return PRTE_SUCCESS;
         }
-        PMIX_LIST_DESTRUCT(&answers);
-
-        if (nanswers == (size_t) pmix_argv_count(keys)) {
-            rc = PRTE_SUCCESS;
-        } else {
-            pmix_output_verbose(1, prte_data_server_output,
-                                "%s data server:lookup: at least some data not found %d vs %d",
-                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), (int) nanswers,
-                                (int) pmix_argv_count(keys));
-
-            /* if we were told to wait for the data, then queue this up
-             * for later processing */
-            if (wait) {
-                pmix_output_verbose(1, prte_data_server_output,
-                                    "%s data server:lookup: pushing request to wait",
-                                    PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
-                PMIX_DATA_BUFFER_RELEASE(answer);
-                req = PMIX_NEW(prte_data_req_t);
-                req->room_number = room_number;
-                req->proxy = *sender;
-                memcpy(&req->requestor, &requestor, sizeof(pmix_proc_t));
-                req->uid = uid;
-                req->range = range;
-                req->keys = keys;
-                pmix_list_append(&pending, &req->super);
-                /* drop the partial response we have - we'll build it when everything
-                 * becomes available */
-                PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
-                return;
-            }
-            if (0 == nanswers) {
-                /* nothing was found - indicate that situation */
-                rc = PRTE_ERR_NOT_FOUND;
-                pmix_argv_free(keys);
-                PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
-                goto SEND_ERROR;
-            } else {
-                rc = PRTE_ERR_PARTIAL_SUCCESS;
-            }
-        }
-        pmix_argv_free(keys);
-        pmix_output_verbose(1, prte_data_server_output, "%s data server:lookup: data found",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
-        /* pack the status */
-        rc = PMIx_Data_pack(NULL, answer, &rc, 1, PMIX_INT);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-            PMIX_DATA_BUFFER_RELEASE(answer);
-            PMIX_DATA_BUFFER_DESTRUCT(&pbkt);
-            return;
+        if (0 == nfound) {
+            /* nothing was found - indicate that situation */
+            PMIX_LIST_DESTRUCT(&answers);
+            pmix_argv_free(keys);
+            return PRTE_ERR_NOT_FOUND;
         }
-        /* unload the packed values */
-        rc = PMIx_Data_unload(&pbkt, &pbo);
+    }
+    pmix_argv_free(keys);
 
-        /* pack it into our reply */
-        rc = PMIx_Data_pack(NULL, answer, &pbo, 1, PMIX_BYTE_OBJECT);
-        PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-            PMIX_DATA_BUFFER_RELEASE(answer);
-            goto SEND_ERROR;
-        }
-        goto SEND_ANSWER;
+    pmix_output_verbose(1, prte_data_server_output, "%s data server:lookup: data found",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
+    send_lookup(sender->rank, room_number,
+                (nfound == nkeys) ? PRTE_SUCCESS : PRTE_ERR_PARTIAL_SUCCESS, &answers);
+    PMIX_LIST_DESTRUCT(&answers);
+    return PRTE_SUCCESS;
+}
 
-    case PRTE_PMIX_UNPUBLISH_CMD:
-        /* unpack the requestor */
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &requestor, &count, PMIX_PROC))) {
-            PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
-        }
+static int unpublish(pmix_data_buffer_t *buffer)
+{
+    pmix_proc_t requestor;
+    pmix_info_t *info = NULL;
+    prte_data_key_t *k;
+    prte_data_object_t *data, *dnext;
+    char **keys = NULL;
+    size_t n, ninfo = 0;
+    uint32_t uid = UINT32_MAX;
+    pmix_data_range_t range = PMIX_RANGE_SESSION; // default
+    int rc;
 
-        pmix_output_verbose(1, prte_data_server_output, "%s data server: unpublish data from %s:%d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), requestor.nspace, requestor.rank);
+    rc = unpack_keys(buffer, &requestor, &keys, &info, &ninfo);
+    if (PRTE_SUCCESS != rc) {
+        return rc;
+    }
 
-        /* unpack the number of keys */
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &ninfo, &count, PMIX_SIZE))) {
-            PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
-        }
-        if (0 == ninfo) {
-            /* they forgot to send us the keys?? */
-            PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
-            rc = PRTE_ERR_BAD_PARAM;
-            goto SEND_ERROR;
-        }
+    pmix_output_verbose(1, prte_data_server_output, "%s data server: unpublish data from %s:%d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), requestor.nspace, requestor.rank);
 
-        /* unpack the keys */
-        for (n = 0; n < ninfo; n++) {
-            count = 1;
-            if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &str, &count, PMIX_STRING))) {
-                PMIX_ERROR_LOG(ret);
-                rc = PRTE_ERR_UNPACK_FAILURE;
-                pmix_argv_free(keys);
-                goto SEND_ERROR;
-            }
-            pmix_argv_append_nosize(&keys, str);
-            free(str);
+    /* scan the directives for things we care about */
+    for (n = 0; n < ninfo; n++) {
+        if (0 == strncmp(info[n].key, PMIX_USERID, PMIX_MAX_KEYLEN)) {
+            uid = info[n].value.data.uint32;
+        } else if (0 == strncmp(info[n].key, PMIX_RANGE, PMIX_MAX_KEYLEN)) {
+            range = info[n].value.data.range;
         }
+    }
+    /* ignore anything else for now */
+    if (NULL != info) {
+        PMIX_INFO_FREE(info, ninfo);
+    }
 
-        /* unpack the number of directives, if any */
-        range = PMIX_RANGE_SESSION; // default
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &ninfo, &count, PMIX_SIZE))) {
-            PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
+    /* cycle across the provided keys */
+    for (n = 0; NULL != keys[n]; n++) {
+        if (NULL == (k = get_key(keys[n], false))) {
+            continue;
         }
-        if (0 < ninfo) {
-            PMIX_INFO_CREATE(info, ninfo);
-            count = ninfo;
-            if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, info, &count, PMIX_INFO))) {
-                PMIX_ERROR_LOG(ret);
-                PMIX_INFO_FREE(info, ninfo);
-                rc = PRTE_ERR_UNPACK_FAILURE;
-                goto SEND_ERROR;
-            }
-            /* scan the directives for things we care about */
-            for (n = 0; n < ninfo; n++) {
-                if (0 == strncmp(info[n].key, PMIX_USERID, PMIX_MAX_KEYLEN)) {
-                    uid = info[n].value.data.uint32;
-                } else if (0 == strncmp(info[n].key, PMIX_RANGE, PMIX_MAX_KEYLEN)) {
-                    range = info[n].value.data.range;
-                }
+        PMIX_RETAIN(k);
+        PMIX_LIST_FOREACH_SAFE(data, dnext, &k->data, prte_data_object_t)
+        {
+            /* can only access data posted by the same user id
+             * and process for the same range */
+            if (uid != data->uid || !PMIX_CHECK_NSPACE(requestor.nspace, data->owner.nspace)
+                || requestor.rank != data->owner.rank || range != data->range) {
+                continue;
             }
-            /* ignore anything else for now */
-            PMIX_INFO_FREE(info, ninfo);
+            discard(data);
         }
+        drop_key(keys[n], k);
+        PMIX_RELEASE(k);
+    }
+    pmix_argv_free(keys);
 
-        /* cycle across the provided keys */
-        for (i = 0; NULL != keys[i]; i++) {
-            /* cycle across the stored data, looking for a match */
-            for (k = 0; k < prte_data_server_store.size; k++) {
-                data = (prte_data_object_t *) pmix_pointer_array_get_item(&prte_data_server_store,
-                                                                          k);
-                if (NULL == data) {
-                    continue;
-                }
-                /* can only access data posted by the same user id */
-                if (uid != data->uid) {
-                    continue;
-                }
-                /* can only access data posted by the same process */
-                if (0 != strncmp(requestor.nspace, data->owner.nspace, PMIX_MAX_NSLEN)
-                    || requestor.rank != data->owner.rank) {
-                    continue;
-                }
-                /* can only access data posted for the same range */
-                if (range != data->range) {
-                    continue;
-                }
-                /* see if we have this key */
-                nanswers = 0;
-                for (n = 0; n < data->ninfo; n++) {
-                    if (0 == strlen(data->info[n].key)) {
-                        ++nanswers;
-                        continue;
-                    }
-                    if (0 == strncmp(data->info[n].key, keys[i], PMIX_MAX_KEYLEN)) {
-                        /* found it -  delete the object from the data store */
-                        memset(data->info[n].key, 0, PMIX_MAX_KEYLEN + 1);
-                        ++nanswers;
-                    }
-                }
-                /* if all the data has been removed, then remove the object */
-                if (nanswers == data->ninfo) {
-                    pmix_pointer_array_set_item(&prte_data_server_store, k, NULL);
-                    PMIX_RELEASE(data);
-                }
-            }
-        }
-        pmix_argv_free(keys);
+    return PRTE_SUCCESS;
+}
 
-        /* tell the sender this succeeded */
-        ret = PRTE_SUCCESS;
-        rc = PMIx_Data_pack(NULL, answer, &ret, 1, PMIX_INT);
-        if (PMIX_SUCCESS != rc) {
-            PMIX_ERROR_LOG(rc);
-        }
-        goto SEND_ANSWER;
+static int purge(pmix_data_buffer_t *buffer)
+{
+    pmix_proc_t requestor;
+    prte_data_nspace_t *ns;
+    prte_data_object_t *data;
+    prte_data_req_t *req, *rqnext;
+    int32_t count, k;
+    size_t len;
+    pmix_status_t ret;
 
-    case PRTE_PMIX_PURGE_PROC_CMD:
-        /* unpack the proc whose data is to be purged - session
-         * data is purged by providing a requestor whose rank
-         * is wildcard */
-        count = 1;
-        if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &requestor, &count, PMIX_PROC))) {
-            PMIX_ERROR_LOG(ret);
-            rc = PRTE_ERR_UNPACK_FAILURE;
-            goto SEND_ERROR;
-        }
+    /* unpack the proc whose data is to be purged - session
+     * data is purged by providing a requestor whose rank
+     * is wildcard */
+    count = 1;
+    if (PMIX_SUCCESS != (ret = PMIx_Data_unpack(NULL, buffer, &requestor, &count, PMIX_PROC))) {
+        PMIX_ERROR_LOG(ret);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
 
-        pmix_output_verbose(1, prte_data_server_output, "%s data server: purge data from %s:%d",
-                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), requestor.nspace, requestor.rank);
+    pmix_output_verbose(1, prte_data_server_output, "%s data server: purge data from %s:%d",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), requestor.nspace, requestor.rank);
 
-        /* cycle across the stored data, looking for a match */
-        for (k = 0; k < prte_data_server_store.size; k++) {
-            data = (prte_data_object_t *) pmix_pointer_array_get_item(&prte_data_server_store, k);
+    /* only the data published by procs of the nspace needs to be checked */
+    len = strnlen(requestor.nspace, PMIX_MAX_NSLEN);
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_ptr(&prte_data_server_nspaces,
+                                                      requestor.nspace, len, (void **) &ns)) {
+        for (k = 0; k < ns->data.size; k++) {
+            data = (prte_data_object_t *) pmix_pointer_array_get_item(&ns->data, k);
             if (NULL == data) {
                 continue;
             }
             /* check if data posted by the specified process */
-            if (0 != strncmp(requestor.nspace, data->owner.nspace, PMIX_MAX_NSLEN)
-                || (PMIX_RANK_WILDCARD != requestor.rank && requestor.rank != data->owner.rank)) {
+            if (PMIX_RANK_WILDCARD != requestor.rank && requestor.rank != data->owner.rank) {
                 continue;
             }
             /* check persistence - if it is intended to persist beyond the
@@ -843,11 +990,75 @@ void prte_data_server(int status, pmix_proc_t *sender,
                 continue;
             }
             /* remove the object */
-            pmix_pointer_array_set_item(&prte_data_server_store, k, NULL);
-            PMIX_RELEASE(data);
+            discard(data);
+        }
+        if (PMIX_RANK_WILDCARD == requestor.rank) {
+            pmix_hash_table_remove_value_ptr(&prte_data_server_nspaces, requestor.nspace, len);
+            PMIX_RELEASE(ns);
+        }
+    }
+
+    /* nobody is left to answer the requests of the purged procs */
+    PMIX_LIST_FOREACH_SAFE(req, rqnext, &pending, prte_data_req_t)
+    {
+        if (PMIX_CHECK_PROCID(&requestor, &req->requestor)) {
+            cancel(req);
+        }
+    }
+
+    return PRTE_SUCCESS;
+}
+
+void prte_data_server(int status, pmix_proc_t *sender,
+                      pmix_data_buffer_t *buffer,
+                      prte_rml_tag_t tag, void *cbdata)
+{
+    uint8_t command;
+    int32_t count;
+    pmix_data_buffer_t *answer;
+    int rc, room_number;
+    pmix_status_t ret;
+    PRTE_HIDE_UNUSED_PARAMS(status, tag, cbdata);
+
+    pmix_output_verbose(1, prte_data_server_output, "%s data server got message from %s",
+                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_NAME_PRINT(sender));
+
+    /* unpack the room number of the caller's request */
+    count = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &room_number, &count, PMIX_INT);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+
+    /* unpack the command */
+    count = 1;
+    rc = PMIx_Data_unpack(NULL, buffer, &command, &count, PMIX_UINT8);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return;
+    }
+
+    switch (command) {
+    case PRTE_PMIX_PUBLISH_CMD:
+        rc = publish(buffer);
+        break;
+
+    case PRTE_PMIX_LOOKUP_CMD:
+        rc = lookup(sender, room_number, buffer);
+        if (PRTE_SUCCESS == rc) {
+            /* answered, or waiting for the data */
+            return;
         }
+        break;
+
+    case PRTE_PMIX_UNPUBLISH_CMD:
+        rc = unpublish(buffer);
+        break;
+
+    case PRTE_PMIX_PURGE_PROC_CMD:
+        (void) purge(buffer);
         /* no response is required */
-        PMIX_RELEASE(answer);
         return;
 
     default:
@@ -856,16 +1067,28 @@ void prte_data_server(int status, pmix_proc_t *sender,
         break;
     }
 
-SEND_ERROR:
-    pmix_output_verbose(1, prte_data_server_output, "%s data server: sending error %s",
-                        PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_ERROR_NAME(rc));
-    /* pack the error code */
-    rc = PMIx_Data_pack(NULL, answer, &rc, 1, PMIX_INT);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
+    if (PRTE_SUCCESS != rc) {
+        pmix_output_verbose(1, prte_data_server_output, "%s data server: sending error %s",
+                            PRTE_NAME_PRINT(PRTE_PROC_MY_NAME), PRTE_ERROR_NAME(rc));
+    }
+
+    PMIX_DATA_BUFFER_CREATE(answer);
+    /* pack the room number as this must lead any response */
+    ret = PMIx_Data_pack(NULL, answer, &room_number, 1, PMIX_INT);
+    if (PMIX_SUCCESS == ret) {
+        /* and the command */
+        ret = PMIx_Data_pack(NULL, answer, &command, 1, PMIX_UINT8);
+    }
+    if (PMIX_SUCCESS == ret) {
+        /* and the status */
+        ret = PMIx_Data_pack(NULL, answer, &rc, 1, PMIX_INT);
+    }
+    if (PMIX_SUCCESS != ret) {
+        PMIX_ERROR_LOG(ret);
+        PMIX_DATA_BUFFER_RELEASE(answer);
+        return;
     }
 
-SEND_ANSWER:
     PRTE_RML_SEND(rc, sender->rank, answer, PRTE_RML_TAG_DATA_CLIENT);
     if (PRTE_SUCCESS != rc) {
         PRTE_ERROR_LOG(rc);
@@ -41,6 +41,10 @@ BEGIN_C_DECLS
 #define PRTE_PMIX_UNPUBLISH_CMD  0x03
 #define PRTE_PMIX_PURGE_PROC_CMD 0x04
 
+/* number of daemons the keys published at session and global
+ * range are spread across (0 or 1 => all are held by the HNP) */
+PRTE_EXPORT extern int prte_data_server_shards;
+
 /* provide hooks to startup and finalize the data server */
 PRTE_EXPORT int prte_data_server_init(void);
 PRTE_EXPORT void prte_data_server_finalize(void);
@@ -49,6 +53,16 @@ PRTE_EXPORT void prte_data_server_finalize(void);
 PRTE_EXPORT void prte_data_server(int status, pmix_proc_t *sender, pmix_data_buffer_t *buffer,
                                   prte_rml_tag_t tag, void *cbdata);
 
+/* the number of shards in use, and the rank of the daemon
+ * holding a key - the HNP unless the keys are sharded */
+PRTE_EXPORT pmix_rank_t prte_data_server_nshards(void);
+PRTE_EXPORT pmix_rank_t prte_data_server_shard(const char *key);
+
+/* purge the data published by the target (all of its nspace if
+ * the rank is wildcard) from the data server at the given rank -
+ * from every shard if that is the HNP and the keys are sharded */
+PRTE_EXPORT void prte_data_server_purge(const pmix_proc_t *target, pmix_rank_t server);
+
 END_C_DECLS
 
 #endif /* PRTE_DATA_SERVER_H */
@@ -96,6 +96,7 @@ int prte_finalize(void)
         PMIX_RELEASE(jdata);
     }
     PMIX_RELEASE(prte_job_data);
+    PMIX_RELEASE(prte_job_index);
 
     {
         pmix_pointer_array_t *array = prte_node_topologies;
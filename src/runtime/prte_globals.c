@@ -72,6 +72,7 @@ pmix_pointer_array_t *prte_cache = NULL;
 bool prte_persistent = true;
 bool prte_add_pid_to_session_dirname = false;
 bool prte_allow_run_as_root = false;
+bool prte_wait_pidfd = false;
 bool prte_show_launch_progress = false;
 
 /* PRTE OOB port flags */
@@ -120,12 +121,15 @@ int prte_stack_trace_wait_timeout = 30;
 
 /* global arrays for data storage */
 pmix_pointer_array_t *prte_job_data = NULL;
+pmix_hash_table_t *prte_job_index = NULL;
 pmix_pointer_array_t *prte_node_pool = NULL;
 pmix_pointer_array_t *prte_node_topologies = NULL;
 pmix_pointer_array_t *prte_local_children = NULL;
 pmix_rank_t prte_total_procs = 0;
 char *prte_base_compute_node_sig = NULL;
 bool prte_hetero_nodes = false;
+char *prte_topo_cache_dir = NULL;
+char *prte_known_topologies = NULL;
 
 /* IOF controls */
 /* generate new xterm windows to display output from specified ranks */
@@ -196,37 +200,45 @@ int prte_dt_init(void)
     return PRTE_SUCCESS;
 }
 
-prte_job_t *prte_get_job_data_object(const pmix_nspace_t job)
+/* look up the position of a job in prte_job_data. Entries
+ * can go stale if a job is removed from the array without
+ * being released, so check the slot still holds that job */
+static prte_job_t *lookup_job(const char *nspace)
 {
     prte_job_t *jptr;
-    int i;
+    void *idx;
+    size_t len = strnlen(nspace, PMIX_MAX_NSLEN);
+
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_ptr(prte_job_index, nspace, len, &idx)) {
+        return NULL;
+    }
+    jptr = (prte_job_t *) pmix_pointer_array_get_item(prte_job_data, (int) (intptr_t) idx);
+    if (NULL == jptr || !PMIX_CHECK_NSPACE(jptr->nspace, nspace)) {
+        pmix_hash_table_remove_value_ptr(prte_job_index, nspace, len);
+        return NULL;
+    }
+    return jptr;
+}
 
+prte_job_t *prte_get_job_data_object(const pmix_nspace_t job)
+{
     /* if the job data wasn't setup, we cannot provide the data */
-    if (NULL == prte_job_data) {
+    if (NULL == prte_job_data || NULL == prte_job_index) {
         return NULL;
     }
     /* if the nspace is invalid, then reject it */
     if (PMIX_NSPACE_INVALID(job)) {
         return NULL;
     }
-    for (i = 0; i < prte_job_data->size; i++) {
-        if (NULL == (jptr = (prte_job_t *) pmix_pointer_array_get_item(prte_job_data, i))) {
-            continue;
-        }
-        if (PMIX_CHECK_NSPACE(jptr->nspace, job)) {
-            return jptr;
-        }
-    }
-    return NULL;
+    return lookup_job(job);
 }
 
 int prte_set_job_data_object(prte_job_t *jdata)
 {
-    prte_job_t *jptr;
-    int i, save = -1;
+    int rc;
 
     /* if the job data wasn't setup, we cannot set the data */
-    if (NULL == prte_job_data) {
+    if (NULL == prte_job_data || NULL == prte_job_index) {
         return PRTE_ERROR;
     }
     /* if the nspace is invalid, then that's an error */
@@ -234,27 +246,23 @@ int prte_set_job_data_object(prte_job_t *jdata)
         return PRTE_ERROR;
     }
     /* verify that we don't already have this object */
-    for (i = 0; i < prte_job_data->size; i++) {
-        if (NULL == (jptr = (prte_job_t *) pmix_pointer_array_get_item(prte_job_data, i))) {
-            if (0 > save) {
-                save = i;
-            }
-            continue;
-        }
-        if (PMIX_CHECK_NSPACE(jptr->nspace, jdata->nspace)) {
-            return PRTE_EXISTS;
-        }
+    if (NULL != lookup_job(jdata->nspace)) {
+        return PRTE_EXISTS;
     }
 
-    if (-1 == save) {
-        jdata->index = pmix_pointer_array_add(prte_job_data, jdata);
-    } else {
-        jdata->index = save;
-        pmix_pointer_array_set_item(prte_job_data, save, jdata);
-    }
+    /* the pointer array fills the lowest free slot */
+    jdata->index = pmix_pointer_array_add(prte_job_data, jdata);
     if (0 > jdata->index) {
         return PRTE_ERROR;
     }
+    rc = pmix_hash_table_set_value_ptr(prte_job_index, jdata->nspace,
+                                       strnlen(jdata->nspace, PMIX_MAX_NSLEN),
+                                       (void *) (intptr_t) jdata->index);
+    if (PMIX_SUCCESS != rc) {
+        pmix_pointer_array_set_item(prte_job_data, jdata->index, NULL);
+        jdata->index = -1;
+        return PRTE_ERROR;
+    }
     return PRTE_SUCCESS;
 }
 
@@ -419,7 +427,7 @@ static void prte_app_context_construct(prte_app_context_t *app_context)
     app_context->env = NULL;
     app_context->cwd = NULL;
     app_context->flags = 0;
-    PMIX_CONSTRUCT(&app_context->attributes, pmix_list_t);
+    PMIX_CONSTRUCT(&app_context->attributes, prte_attr_list_t);
     PMIX_CONSTRUCT(&app_context->cli, pmix_cli_result_t);
 }
 
@@ -456,7 +464,7 @@ static void prte_app_context_destructor(prte_app_context_t *app_context)
         app_context->cwd = NULL;
     }
 
-    PMIX_LIST_DESTRUCT(&app_context->attributes);
+    PMIX_LIST_DESTRUCT(&app_context->attributes.super);
     PMIX_DESTRUCT(&app_context->cli);
 }
 
@@ -497,7 +505,7 @@ static void prte_job_construct(prte_job_t *job)
     job->flags = 0;
     PRTE_FLAG_SET(job, PRTE_JOB_FLAG_FORWARD_OUTPUT);
 
-    PMIX_CONSTRUCT(&job->attributes, pmix_list_t);
+    PMIX_CONSTRUCT(&job->attributes, prte_attr_list_t);
     PMIX_DATA_BUFFER_CONSTRUCT(&job->launch_msg);
     PMIX_CONSTRUCT(&job->children, pmix_list_t);
     PMIX_LOAD_NSPACE(job->launcher, NULL);
@@ -571,7 +579,7 @@ static void prte_job_destruct(prte_job_t *job)
     PMIX_RELEASE(job->procs);
 
     /* release the attributes */
-    PMIX_LIST_DESTRUCT(&job->attributes);
+    PMIX_LIST_DESTRUCT(&job->attributes.super);
 
     PMIX_DATA_BUFFER_DESTRUCT(&job->launch_msg);
 
@@ -584,8 +592,14 @@ static void prte_job_destruct(prte_job_t *job)
     PMIX_LIST_DESTRUCT(&job->children);
 
     if (NULL != prte_job_data && 0 <= job->index) {
-        /* remove the job from the global array */
-        pmix_pointer_array_set_item(prte_job_data, job->index, NULL);
+        /* remove the job from the global array and its index, unless
+         * the slot has already been handed to someone else */
+        if (job == pmix_pointer_array_get_item(prte_job_data, job->index)) {
+            pmix_pointer_array_set_item(prte_job_data, job->index, NULL);
+        }
+        if (NULL != prte_job_index && !PMIX_NSPACE_INVALID(job->nspace)) {
+            (void) lookup_job(job->nspace);
+        }
     }
     if (NULL != job->traces) {
         pmix_argv_free(job->traces);
@@ -621,7 +635,7 @@ static void prte_node_construct(prte_node_t *node)
     node->topology = NULL;
 
     node->flags = 0;
-    PMIX_CONSTRUCT(&node->attributes, pmix_list_t);
+    PMIX_CONSTRUCT(&node->attributes, prte_attr_list_t);
 }
 
 static void prte_node_destruct(prte_node_t *node)
@@ -660,7 +674,7 @@ static void prte_node_destruct(prte_node_t *node)
     /* do NOT destroy the topology */
 
     /* release the attributes */
-    PMIX_LIST_DESTRUCT(&node->attributes);
+    PMIX_LIST_DESTRUCT(&node->attributes.super);
 }
 
 PMIX_CLASS_INSTANCE(prte_node_t, pmix_list_item_t, prte_node_construct, prte_node_destruct);
@@ -685,7 +699,7 @@ static void prte_proc_construct(prte_proc_t *proc)
     proc->exit_code = 0; /* Assume we won't fail unless otherwise notified */
     proc->rml_uri = NULL;
     proc->flags = 0;
-    PMIX_CONSTRUCT(&proc->attributes, pmix_list_t);
+    PMIX_CONSTRUCT(&proc->attributes, prte_attr_list_t);
 }
 
 static void prte_proc_destruct(prte_proc_t *proc)
@@ -703,7 +717,7 @@ static void prte_proc_destruct(prte_proc_t *proc)
         proc->rml_uri = NULL;
     }
 
-    PMIX_LIST_DESTRUCT(&proc->attributes);
+    PMIX_LIST_DESTRUCT(&proc->attributes.super);
 }
 
 PMIX_CLASS_INSTANCE(prte_proc_t, pmix_list_item_t, prte_proc_construct, prte_proc_destruct);
@@ -758,6 +772,22 @@ static void prte_attr_des(prte_attribute_t *p)
 }
 PMIX_CLASS_INSTANCE(prte_attribute_t, pmix_list_item_t, prte_attr_cons, prte_attr_des);
 
+static void prte_attr_list_cons(prte_attr_list_t *p)
+{
+    p->slots = NULL;
+    p->nslots = 0;
+    p->nused = 0;
+    p->nindexed = 0;
+    p->dups = false;
+}
+static void prte_attr_list_des(prte_attr_list_t *p)
+{
+    if (NULL != p->slots) {
+        free(p->slots);
+    }
+}
+PMIX_CLASS_INSTANCE(prte_attr_list_t, pmix_list_t, prte_attr_list_cons, prte_attr_list_des);
+
 static void tcon(prte_topology_t *t)
 {
     t->topo = NULL;
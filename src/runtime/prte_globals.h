@@ -248,9 +248,10 @@ typedef struct {
      * of having a continually-expanding list of fixed-use values.
      * This is a list of prte_value_t's, with the intent of providing
      * flexibility without constantly expanding the memory footprint
-     * every time we want some new (rarely used) option
+     * every time we want some new (rarely used) option. It is
+     * indexed by key, so only change it through src/util/attr.h
      */
-    pmix_list_t attributes;
+    prte_attr_list_t attributes;
     // store the result of parsing this app's cmd line
     pmix_cli_result_t cli;
 } prte_app_context_t;
@@ -306,8 +307,8 @@ typedef struct {
     prte_topology_t *topology;
     /* flags */
     prte_node_flags_t flags;
-    /* list of prte_attribute_t */
-    pmix_list_t attributes;
+    /* list of prte_attribute_t, indexed by key */
+    prte_attr_list_t attributes;
 } prte_node_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_node_t);
 
@@ -365,8 +366,8 @@ typedef struct {
     pmix_rank_t num_local_procs;
     /* flags */
     prte_job_flags_t flags;
-    /* attributes */
-    pmix_list_t attributes;
+    /* attributes, indexed by key */
+    prte_attr_list_t attributes;
     /* launch msg buffer */
     pmix_data_buffer_t launch_msg;
     /* track children of this job */
@@ -434,8 +435,8 @@ struct prte_proc_t {
     char *rml_uri;
     /* some boolean flags */
     prte_proc_flags_t flags;
-    /* list of prte_value_t attributes */
-    pmix_list_t attributes;
+    /* list of prte_attribute_t, indexed by key */
+    prte_attr_list_t attributes;
 };
 typedef struct prte_proc_t prte_proc_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_proc_t);
@@ -516,6 +517,7 @@ PRTE_EXPORT extern pmix_pointer_array_t *prte_cache;
 PRTE_EXPORT extern bool prte_persistent;
 PRTE_EXPORT extern bool prte_add_pid_to_session_dirname;
 PRTE_EXPORT extern bool prte_allow_run_as_root;
+PRTE_EXPORT extern bool prte_wait_pidfd;
 
 /* PRTE OOB port flags */
 PRTE_EXPORT extern bool prte_static_ports;
@@ -564,12 +566,15 @@ PRTE_EXPORT extern prte_timer_t *prte_mpiexec_timeout;
 
 /* global arrays for data storage */
 PRTE_EXPORT extern pmix_pointer_array_t *prte_job_data;
+PRTE_EXPORT extern pmix_hash_table_t *prte_job_index; // nspace -> position in prte_job_data
 PRTE_EXPORT extern pmix_pointer_array_t *prte_node_pool;
 PRTE_EXPORT extern pmix_pointer_array_t *prte_node_topologies;
 PRTE_EXPORT extern pmix_pointer_array_t *prte_local_children;
 PRTE_EXPORT extern pmix_rank_t prte_total_procs;
 PRTE_EXPORT extern char *prte_base_compute_node_sig;
 PRTE_EXPORT extern bool prte_hetero_nodes;
+PRTE_EXPORT extern char *prte_topo_cache_dir;
+PRTE_EXPORT extern char *prte_known_topologies;
 
 /* IOF controls */
 /* generate new xterm windows to display output from specified ranks */
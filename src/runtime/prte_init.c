@@ -286,6 +286,8 @@ int prte_init(int *pargc, char ***pargv, prte_proc_type_t flags)
         error = "setup job array";
         goto error;
     }
+    prte_job_index = PMIX_NEW(pmix_hash_table_t);
+    pmix_hash_table_init(prte_job_index, PRTE_GLOBAL_ARRAY_BLOCK_SIZE);
     prte_node_pool = PMIX_NEW(pmix_pointer_array_t);
     if (PRTE_SUCCESS
         != (ret = pmix_pointer_array_init(prte_node_pool, PRTE_GLOBAL_ARRAY_BLOCK_SIZE,
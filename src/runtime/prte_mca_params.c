@@ -408,6 +408,14 @@ int prte_register_params(void)
                                       PMIX_MCA_BASE_VAR_TYPE_STRING,
                                       &prte_fork_agent_string);
 
+    prte_wait_pidfd = false;
+    (void) pmix_mca_base_var_register("prte", "prte", NULL, "wait_pidfd",
+                                      "Collect the exit status of each local child on the event base "
+                                      "handling that child via a pidfd instead of waiting for the "
+                                      "SIGCHLD handler (Linux only) [default: no]",
+                                      PMIX_MCA_BASE_VAR_TYPE_BOOL,
+                                      &prte_wait_pidfd);
+
     /* whether or not to require RM allocation */
     prte_allocation_required = false;
     (void) pmix_mca_base_var_register("prte", "prte", NULL, "allocation_required",
@@ -465,6 +473,21 @@ int prte_register_params(void)
                                       PMIX_MCA_BASE_VAR_TYPE_STRING,
                                       &prte_set_slots);
 
+    prte_topo_cache_dir = NULL;
+    (void) pmix_mca_base_var_register("prte", "prte", NULL, "topo_cache_dir",
+                                      "Directory in which the DVM controller keeps the topologies reported "
+                                      "by its daemons across restarts. Daemons whose topology signature is "
+                                      "found in the cache do not send their topology (default: no cache)",
+                                      PMIX_MCA_BASE_VAR_TYPE_STRING,
+                                      &prte_topo_cache_dir);
+
+    prte_known_topologies = NULL;
+    (void) pmix_mca_base_var_register("prte", "prte", NULL, "known_topologies",
+                                      "Comma-delimited list of hashes of the topology signatures already "
+                                      "known to the DVM controller (set internally for daemons)",
+                                      PMIX_MCA_BASE_VAR_TYPE_STRING,
+                                      &prte_known_topologies);
+
     /* allow specification of the cores to be used by daemons */
     prte_daemon_cores = NULL;
     (void) pmix_mca_base_var_register("prte", "prte", NULL, "daemon_cores",
@@ -50,7 +50,11 @@
 #ifdef HAVE_SYS_WAIT_H
 #    include <sys/wait.h>
 #endif
+#ifdef __linux__
+#    include <sys/syscall.h>
+#endif
 
+#include "src/class/pmix_hash_table.h"
 #include "src/class/pmix_list.h"
 #include "src/class/pmix_object.h"
 #include "src/event/event-internal.h"
@@ -77,23 +81,43 @@ static void timer_dest(prte_timer_t *tm)
 }
 PMIX_CLASS_INSTANCE(prte_timer_t, pmix_object_t, timer_const, timer_dest);
 
+#if defined(__linux__) && defined(SYS_pidfd_open) && HAVE_DECL_P_PIDFD
+#    define PRTE_WAIT_HAVE_PIDFD 1
+#else
+#    define PRTE_WAIT_HAVE_PIDFD 0
+#endif
+
 static void wccon(prte_wait_tracker_t *p)
 {
     p->child = NULL;
     p->cbfunc = NULL;
     p->cbdata = NULL;
+    p->pid = 0;
+    p->tracked = false;
+    p->fired = false;
+    p->pidfd = -1;
 }
 static void wcdes(prte_wait_tracker_t *p)
 {
     if (NULL != p->child) {
         PMIX_RELEASE(p->child);
     }
+    if (0 <= p->pidfd) {
+        close(p->pidfd);
+    }
 }
 PMIX_CLASS_INSTANCE(prte_wait_tracker_t, pmix_list_item_t, wccon, wcdes);
 
 /* Local Variables */
 static prte_event_t handler;
+/* trackers for procs whose pid is known, indexed by that pid */
+static pmix_hash_table_t pid_index;
+/* trackers registered before their proc was forked */
 static pmix_list_t pending_cbs;
+/* protects the fired flag of the trackers - only contended
+ * when children are reaped on their own event base */
+static pmix_mutex_t fired_lock = PMIX_MUTEX_STATIC_INIT;
+static bool use_pidfd = false;
 
 /* Local Function Prototypes */
 static void wait_signal_callback(int fd, short event, void *arg);
@@ -113,6 +137,24 @@ void prte_wait_enable(void)
 int prte_wait_init(void)
 {
     PMIX_CONSTRUCT(&pending_cbs, pmix_list_t);
+    PMIX_CONSTRUCT(&pid_index, pmix_hash_table_t);
+    pmix_hash_table_init(&pid_index, 256);
+
+    use_pidfd = false;
+    if (prte_wait_pidfd) {
+#if PRTE_WAIT_HAVE_PIDFD
+        int fd = syscall(SYS_pidfd_open, getpid(), 0);
+        if (0 <= fd) {
+            close(fd);
+            use_pidfd = true;
+        }
+#endif
+        if (!use_pidfd) {
+            pmix_output_verbose(1, prte_debug_output,
+                                "%s wait: pidfd support not available - using SIGCHLD only",
+                                PRTE_NAME_PRINT(PRTE_PROC_MY_NAME));
+        }
+    }
 
     prte_event_set(prte_event_base, &handler, SIGCHLD, PRTE_EV_SIGNAL | PRTE_EV_PERSIST,
                    wait_signal_callback, &handler);
@@ -124,14 +166,235 @@ int prte_wait_init(void)
 
 int prte_wait_finalize(void)
 {
+    prte_wait_tracker_t *t2;
+    uint32_t key;
+    void *node;
+
     prte_event_del(&handler);
 
     /* clear out the pending cbs */
     PMIX_LIST_DESTRUCT(&pending_cbs);
+    if (PMIX_SUCCESS == pmix_hash_table_get_first_key_uint32(&pid_index, &key,
+                                                             (void **) &t2, &node)) {
+        do {
+            PMIX_RELEASE(t2);
+        } while (PMIX_SUCCESS == pmix_hash_table_get_next_key_uint32(&pid_index, &key,
+                                                                     (void **) &t2,
+                                                                     node, &node));
+    }
+    PMIX_DESTRUCT(&pid_index);
 
     return PRTE_SUCCESS;
 }
 
+/* the following helpers must be called from within
+ * an event in the prte_event_base */
+static void index_tracker(prte_wait_tracker_t *t2)
+{
+    prte_wait_tracker_t *old;
+
+    t2->pid = t2->child->pid;
+    if (PMIX_SUCCESS == pmix_hash_table_get_value_uint32(&pid_index, (uint32_t) t2->pid,
+                                                         (void **) &old)
+        && old != t2) {
+        old->pid = 0;
+        if (old->child->pid == t2->pid) {
+            /* the pid was reused before we heard about the
+             * exit of the proc it belonged to */
+            old->tracked = false;
+            PMIX_RELEASE(old);
+        } else {
+            /* the proc has since been given a new pid - park
+             * the tracker until we see that pid */
+            pmix_list_append(&pending_cbs, &old->super);
+        }
+    }
+    pmix_hash_table_set_value_uint32(&pid_index, (uint32_t) t2->pid, t2);
+    t2->tracked = true;
+}
+
+static void untrack(prte_wait_tracker_t *t2)
+{
+    if (!t2->tracked) {
+        return;
+    }
+    if (0 < t2->pid) {
+        pmix_hash_table_remove_value_uint32(&pid_index, (uint32_t) t2->pid);
+    } else {
+        pmix_list_remove_item(&pending_cbs, &t2->super);
+    }
+    t2->tracked = false;
+}
+
+/* move the pending trackers whose procs have been forked since
+ * they were registered into the index */
+static void index_pending(void)
+{
+    prte_wait_tracker_t *t2, *next;
+
+    PMIX_LIST_FOREACH_SAFE(t2, next, &pending_cbs, prte_wait_tracker_t)
+    {
+        if (0 < t2->child->pid) {
+            pmix_list_remove_item(&pending_cbs, &t2->super);
+            index_tracker(t2);
+        }
+    }
+}
+
+static prte_wait_tracker_t *find_pid(pid_t pid)
+{
+    prte_wait_tracker_t *t2;
+
+    if (PMIX_SUCCESS != pmix_hash_table_get_value_uint32(&pid_index, (uint32_t) pid,
+                                                         (void **) &t2)) {
+        if (0 == pmix_list_get_size(&pending_cbs)) {
+            return NULL;
+        }
+        index_pending();
+        if (PMIX_SUCCESS != pmix_hash_table_get_value_uint32(&pid_index, (uint32_t) pid,
+                                                             (void **) &t2)) {
+            return NULL;
+        }
+    }
+    return t2;
+}
+
+static prte_wait_tracker_t *find_child(prte_proc_t *child)
+{
+    prte_wait_tracker_t *t2;
+
+    if (0 < child->pid
+        && PMIX_SUCCESS == pmix_hash_table_get_value_uint32(&pid_index, (uint32_t) child->pid,
+                                                            (void **) &t2)
+        && t2->child == child) {
+        return t2;
+    }
+    PMIX_LIST_FOREACH(t2, &pending_cbs, prte_wait_tracker_t)
+    {
+        if (t2->child == child) {
+            return t2;
+        }
+    }
+    return NULL;
+}
+
+/* only one of the SIGCHLD handler, the pidfd handler and
+ * a cancellation gets to act on a given tracker */
+static bool claim(prte_wait_tracker_t *t2)
+{
+    bool ret;
+
+    pmix_mutex_lock(&fired_lock);
+    ret = !t2->fired;
+    t2->fired = true;
+    pmix_mutex_unlock(&fired_lock);
+    return ret;
+}
+
+static void deliver(prte_wait_tracker_t *t2)
+{
+    if (NULL != t2->cbfunc) {
+        prte_event_set(t2->evb, &t2->ev, -1, PRTE_EV_WRITE, t2->cbfunc, t2);
+        prte_event_set_priority(&t2->ev, PRTE_MSG_PRI);
+        prte_event_active(&t2->ev, PRTE_EV_WRITE, 1);
+    } else {
+        PMIX_RELEASE(t2);
+    }
+}
+
+#if PRTE_WAIT_HAVE_PIDFD
+static void forget_callback(int fd, short args, void *cbdata)
+{
+    prte_wait_tracker_t *trk = (prte_wait_tracker_t *) cbdata;
+    prte_wait_tracker_t *t2 = (prte_wait_tracker_t *) trk->cbdata;
+    PRTE_HIDE_UNUSED_PARAMS(fd, args);
+
+    PMIX_ACQUIRE_OBJECT(trk);
+
+    /* drop the reference held by the index, if the
+     * SIGCHLD handler hasn't already done so */
+    if (t2->tracked) {
+        untrack(t2);
+        PMIX_RELEASE(t2);
+    }
+    PMIX_RELEASE(t2);
+    PMIX_RELEASE(trk);
+}
+
+/* executes in the event base the tracker was registered with */
+static void pidfd_callback(int fd, short args, void *cbdata)
+{
+    prte_wait_tracker_t *t2 = (prte_wait_tracker_t *) cbdata;
+    prte_wait_tracker_t *trk;
+    siginfo_t info, reaped;
+    int rc;
+
+    /* look at the exit without reaping it - if we don't get to
+     * deliver it, the child must be left for the SIGCHLD handler */
+    memset(&info, 0, sizeof(info));
+    do {
+        rc = waitid(P_PIDFD, (id_t) fd, &info, WEXITED | WNOHANG | WNOWAIT);
+    } while (-1 == rc && EINTR == errno);
+
+    if (0 != rc || 0 == info.si_pid || !claim(t2)) {
+        /* either the SIGCHLD handler reaped it first and will
+         * deliver the exit, or the wait was cancelled */
+        PMIX_RELEASE(t2);
+        return;
+    }
+
+    /* it is ours - reap it. The SIGCHLD handler may beat us to
+     * it, but it will find the tracker claimed and drop it */
+    do {
+        rc = waitid(P_PIDFD, (id_t) fd, &reaped, WEXITED | WNOHANG);
+    } while (-1 == rc && EINTR == errno);
+
+    /* record the status the way waitpid would have reported it */
+    switch (info.si_code) {
+    case CLD_EXITED:
+        t2->child->exit_code = (info.si_status & 0xff) << 8;
+        break;
+    case CLD_DUMPED:
+        t2->child->exit_code = (info.si_status & 0x7f) | 0x80;
+        break;
+    default:
+        t2->child->exit_code = info.si_status & 0x7f;
+        break;
+    }
+
+    /* have the prte_event_base drop this tracker from its index */
+    trk = PMIX_NEW(prte_wait_tracker_t);
+    PMIX_RETAIN(t2);
+    trk->cbdata = t2;
+    PMIX_THREADSHIFT(trk, prte_event_base, forget_callback, PRTE_SYS_PRI);
+
+    /* the reference held by this event passes to the callback */
+    deliver(t2);
+}
+#endif
+
+static void arm_tracker(prte_wait_tracker_t *t2)
+{
+#if PRTE_WAIT_HAVE_PIDFD
+    /* nothing to gain if the proc is handled by the prte_event_base */
+    if (!use_pidfd || t2->evb == prte_event_base || 0 <= t2->pidfd || t2->pid <= 0) {
+        return;
+    }
+    t2->pidfd = syscall(SYS_pidfd_open, t2->pid, 0);
+    if (t2->pidfd < 0) {
+        /* leave it to the SIGCHLD handler */
+        return;
+    }
+    PMIX_RETAIN(t2);
+    prte_event_set(t2->evb, &t2->pidev, t2->pidfd, PRTE_EV_READ, pidfd_callback, t2);
+    prte_event_set_priority(&t2->pidev, PRTE_MSG_PRI);
+    PMIX_POST_OBJECT(t2);
+    prte_event_add(&t2->pidev, NULL);
+#else
+    PRTE_HIDE_UNUSED_PARAMS(t2);
+#endif
+}
+
 /* this function *must* always be called from
  * within an event in the prte_event_base */
 void prte_wait_cb(prte_proc_t *child, prte_wait_cbfunc_t callback, prte_event_base_t *evb,
@@ -163,13 +426,11 @@ void prte_wait_cb(prte_proc_t *child, prte_wait_cbfunc_t callback, prte_event_ba
     }
 
     /* we just override any existing registration */
-    PMIX_LIST_FOREACH(t2, &pending_cbs, prte_wait_tracker_t)
-    {
-        if (t2->child == child) {
-            t2->cbfunc = callback;
-            t2->cbdata = data;
-            return;
-        }
+    t2 = find_child(child);
+    if (NULL != t2) {
+        t2->cbfunc = callback;
+        t2->cbdata = data;
+        return;
     }
     /* get here if this is a new registration */
     t2 = PMIX_NEW(prte_wait_tracker_t);
@@ -178,10 +439,17 @@ void prte_wait_cb(prte_proc_t *child, prte_wait_cbfunc_t callback, prte_event_ba
     t2->evb = evb;
     t2->cbfunc = callback;
     t2->cbdata = data;
-    pmix_list_append(&pending_cbs, &t2->super);
+    if (0 < child->pid) {
+        index_tracker(t2);
+        arm_tracker(t2);
+    } else {
+        /* not forked yet */
+        pmix_list_append(&pending_cbs, &t2->super);
+        t2->tracked = true;
+    }
 }
 
-static void cancel_callback(int fd, short args, void *cbdata)
+static void started_callback(int fd, short args, void *cbdata)
 {
     prte_wait_tracker_t *trk = (prte_wait_tracker_t *) cbdata;
     prte_wait_tracker_t *t2;
@@ -189,14 +457,48 @@ static void cancel_callback(int fd, short args, void *cbdata)
 
     PMIX_ACQUIRE_OBJECT(trk);
 
-    PMIX_LIST_FOREACH(t2, &pending_cbs, prte_wait_tracker_t)
-    {
-        if (t2->child == trk->child) {
-            pmix_list_remove_item(&pending_cbs, &t2->super);
-            PMIX_RELEASE(t2);
-            PMIX_RELEASE(trk);
-            return;
+    t2 = find_child(trk->child);
+    if (NULL != t2 && 0 < trk->child->pid) {
+        if (t2->pid != trk->child->pid) {
+            untrack(t2);
+            index_tracker(t2);
         }
+        arm_tracker(t2);
+    }
+    PMIX_RELEASE(trk);
+}
+
+void prte_wait_cb_started(prte_proc_t *child)
+{
+    prte_wait_tracker_t *trk;
+
+    if (NULL == child) {
+        /* bozo protection */
+        PRTE_ERROR_LOG(PRTE_ERR_BAD_PARAM);
+        return;
+    }
+
+    /* push this into the event library for handling */
+    trk = PMIX_NEW(prte_wait_tracker_t);
+    PMIX_RETAIN(child); // protect against race conditions
+    trk->child = child;
+    PMIX_THREADSHIFT(trk, prte_event_base, started_callback, PRTE_SYS_PRI);
+}
+
+static void cancel_callback(int fd, short args, void *cbdata)
+{
+    prte_wait_tracker_t *trk = (prte_wait_tracker_t *) cbdata;
+    prte_wait_tracker_t *t2;
+    PRTE_HIDE_UNUSED_PARAMS(fd, args);
+
+    PMIX_ACQUIRE_OBJECT(trk);
+
+    t2 = find_child(trk->child);
+    if (NULL != t2) {
+        untrack(t2);
+        /* ensure a pending pidfd event doesn't fire the callback */
+        (void) claim(t2);
+        PMIX_RELEASE(t2);
     }
 
     PMIX_RELEASE(trk);
@@ -248,22 +550,30 @@ static void wait_signal_callback(int fd, short event, void *arg)
             return;
         }
 
-        /* we are already in an event, so it is safe to access the list */
-        PMIX_LIST_FOREACH(t2, &pending_cbs, prte_wait_tracker_t)
-        {
-            if (pid == t2->child->pid) {
-                /* found it! */
-                t2->child->exit_code = status;
-                pmix_list_remove_item(&pending_cbs, &t2->super);
-                if (NULL != t2->cbfunc) {
-                    prte_event_set(t2->evb, &t2->ev, -1, PRTE_EV_WRITE, t2->cbfunc, t2);
-                    prte_event_set_priority(&t2->ev, PRTE_MSG_PRI);
-                    prte_event_active(&t2->ev, PRTE_EV_WRITE, 1);
-                } else {
-                    PMIX_RELEASE(t2);
-                }
-                break;
+        /* we are already in an event, so it is safe to access the index */
+        t2 = find_pid(pid);
+        if (NULL == t2) {
+            continue;
+        }
+        untrack(t2);
+        if (t2->child->pid != pid) {
+            /* the proc has since been given a new pid */
+            if (0 < t2->child->pid) {
+                index_tracker(t2);
+            } else {
+                t2->pid = 0;
+                pmix_list_append(&pending_cbs, &t2->super);
+                t2->tracked = true;
             }
+            continue;
+        }
+        if (!claim(t2)) {
+            /* already delivered via its pidfd */
+            PMIX_RELEASE(t2);
+            continue;
         }
+        /* found it! */
+        t2->child->exit_code = status;
+        deliver(t2);
     }
 }
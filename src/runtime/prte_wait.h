@@ -67,6 +67,16 @@ typedef struct {
     prte_proc_t *child;
     prte_wait_cbfunc_t cbfunc;
     void *cbdata;
+    /* the remaining fields are internal to the wait system */
+    /* pid this tracker is indexed under - 0 if not yet known */
+    pid_t pid;
+    /* held in either the pid index or the pending list */
+    bool tracked;
+    /* the exit has been delivered or the wait was cancelled */
+    bool fired;
+    /* pidfd used to reap the child on its own event base */
+    int pidfd;
+    prte_event_t pidev;
 } prte_wait_tracker_t;
 PRTE_EXPORT PMIX_CLASS_DECLARATION(prte_wait_tracker_t);
 
@@ -91,6 +101,15 @@ PRTE_EXPORT void prte_wait_cb(prte_proc_t *proc, prte_wait_cbfunc_t callback,
 
 PRTE_EXPORT void prte_wait_cb_cancel(prte_proc_t *proc);
 
+/**
+ * Notify the wait system that a proc registered with \c prte_wait_cb
+ * before it was forked now has a pid. Reaping works without this call,
+ * but it lets the proc be indexed right away and, if prte_wait_pidfd
+ * is set, lets its exit be collected directly on the event base given
+ * to \c prte_wait_cb. May be called from any thread.
+ */
+PRTE_EXPORT void prte_wait_cb_started(prte_proc_t *proc);
+
 /* In a few places, we need to barrier until something happens
  * that changes a flag to indicate we can release - e.g., waiting
  * for a specific message to arrive. If no progress thread is running,
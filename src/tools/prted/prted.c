@@ -47,6 +47,7 @@
 #endif
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <signal.h>
 #ifdef HAVE_SYS_TIME_H
 #    include <sys/time.h>
@@ -157,6 +158,29 @@ static void infocbfunc(pmix_status_t status, pmix_info_t *info, size_t ninfo, vo
     PRTE_PMIX_WAKEUP_THREAD(&xfer->lock);
 }
 
+/* see if prte told us it already has a topology with our signature */
+static bool topology_is_known(void)
+{
+    char **hashes, mine[32];
+    bool known = false;
+    int n;
+
+    if (NULL == prte_known_topologies || NULL == prte_topo_signature) {
+        return false;
+    }
+    snprintf(mine, sizeof(mine), "%016" PRIx64,
+             prte_hwloc_base_topo_hash(prte_topo_signature, strlen(prte_topo_signature)));
+    hashes = pmix_argv_split(prte_known_topologies, ',');
+    for (n = 0; NULL != hashes && NULL != hashes[n]; n++) {
+        if (0 == strcmp(hashes[n], mine)) {
+            known = true;
+            break;
+        }
+    }
+    pmix_argv_free(hashes);
+    return known;
+}
+
 static int wait_pipe[2];
 
 static int wait_dvm(pid_t pid)
@@ -588,7 +612,21 @@ int main(int argc, char *argv[])
 
     /* if we are rank=1, then send our topology back - otherwise, prte
      * will request it if necessary */
-    if (1 == PRTE_PROC_MY_NAME->rank) {
+    if (1 == PRTE_PROC_MY_NAME->rank && topology_is_known()) {
+        /* prte already has our topology - send an empty payload */
+        bool compressed = false;
+
+        PMIX_BYTE_OBJECT_CONSTRUCT(&pbo);
+        prc = PMIx_Data_pack(NULL, &buffer, &compressed, 1, PMIX_BOOL);
+        if (PMIX_SUCCESS == prc) {
+            prc = PMIx_Data_pack(NULL, &buffer, &pbo, 1, PMIX_BYTE_OBJECT);
+        }
+        if (PMIX_SUCCESS != prc) {
+            PMIX_ERROR_LOG(prc);
+            PMIX_DATA_BUFFER_DESTRUCT(&buffer);
+            goto DONE;
+        }
+    } else if (1 == PRTE_PROC_MY_NAME->rank) {
         pmix_data_buffer_t data;
         pmix_topology_t ptopo;
         bool compressed;
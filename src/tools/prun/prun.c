@@ -456,6 +456,8 @@ int prun(int argc, char *argv[])
         PRTE_ERROR_LOG(ret);
         return rc;
     }
+    prte_job_index = PMIX_NEW(pmix_hash_table_t);
+    pmix_hash_table_init(prte_job_index, PRTE_GLOBAL_ARRAY_BLOCK_SIZE);
 
     /* setup options */
     PMIX_INFO_LIST_START(tinfo);
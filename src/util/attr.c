@@ -41,49 +41,187 @@ typedef struct {
 /* all default to NULL */
 static prte_attr_converter_t converters[MAX_CONVERTERS];
 
-bool prte_get_attribute(pmix_list_t *attributes, prte_attribute_key_t key, void **data,
-                        pmix_data_type_t type)
+/* return the attribute list's index after bringing it up to
+ * date with the list contents, or NULL if it could not be built.
+ * All changes to the list go through the functions below, which
+ * keep the index in step. The length check is only a backstop
+ * for code that modifies the list behind their back */
+static prte_attr_list_t *attr_index(prte_attr_list_t *al)
 {
+    prte_attribute_t *kv, **slots;
+    size_t len;
+    uint32_t n, nslots, mask;
+
+    len = pmix_list_get_size(&al->super);
+    if (len == al->nindexed && 2 * al->nused <= al->nslots) {
+        return al;
+    }
+
+    /* rebuild, keeping the table at most half full */
+    nslots = (0 == al->nslots) ? 8 : al->nslots;
+    while (nslots < 2 * (len + 1)) {
+        nslots *= 2;
+    }
+    if (nslots != al->nslots) {
+        slots = (prte_attribute_t **) realloc(al->slots, nslots * sizeof(prte_attribute_t *));
+        if (NULL == slots) {
+            al->nindexed = SIZE_MAX;
+            return NULL;
+        }
+        al->slots = slots;
+        al->nslots = nslots;
+    }
+    memset(al->slots, 0, al->nslots * sizeof(prte_attribute_t *));
+    al->nused = 0;
+    al->dups = false;
+    mask = al->nslots - 1;
+    PMIX_LIST_FOREACH(kv, &al->super, prte_attribute_t)
+    {
+        for (n = kv->key & mask; NULL != al->slots[n]; n = (n + 1) & mask) {
+            if (al->slots[n]->key == kv->key) {
+                break;
+            }
+        }
+        if (NULL == al->slots[n]) {
+            al->slots[n] = kv;
+            al->nused++;
+        } else {
+            /* the first one on the list wins */
+            al->dups = true;
+        }
+    }
+    al->nindexed = len;
+    return al;
+}
+
+/* find the slot for a key - either the one holding it,
+ * or the empty one where it would go */
+static uint32_t attr_slot(prte_attr_list_t *al, prte_attribute_key_t key)
+{
+    uint32_t n, mask = al->nslots - 1;
+
+    for (n = key & mask; NULL != al->slots[n]; n = (n + 1) & mask) {
+        if (al->slots[n]->key == key) {
+            break;
+        }
+    }
+    return n;
+}
+
+static prte_attribute_t *attr_find(prte_attr_list_t *attributes, prte_attribute_key_t key)
+{
+    prte_attr_list_t *al;
     prte_attribute_t *kv;
-    int rc;
 
-    PMIX_LIST_FOREACH(kv, attributes, prte_attribute_t)
+    if (NULL != (al = attr_index(attributes))) {
+        if (0 == al->nused) {
+            return NULL;
+        }
+        return al->slots[attr_slot(al, key)];
+    }
+
+    /* no memory for the index - fall back to a scan */
+    PMIX_LIST_FOREACH(kv, &attributes->super, prte_attribute_t)
     {
         if (key == kv->key) {
-            if (kv->data.type != type) {
-                PRTE_ERROR_LOG(PRTE_ERR_TYPE_MISMATCH);
-                pmix_output(0, "KV %s TYPE %s", PMIx_Data_type_string(kv->data.type), PMIx_Data_type_string(type));
-                return false;
-            }
-            if (NULL != data) {
-                if (PRTE_SUCCESS != (rc = prte_attr_unload(kv, data, type))) {
-                    PRTE_ERROR_LOG(rc);
-                }
-            }
-            return true;
+            return kv;
         }
     }
-    /* not found */
-    return false;
+    return NULL;
 }
 
-int prte_set_attribute(pmix_list_t *attributes, prte_attribute_key_t key, bool local, void *data,
+/* record an attribute that was just added to the list. If it
+ * went to the front, it shadows any existing entry for its key */
+static void attr_added(prte_attr_list_t *al, prte_attribute_t *kv, bool front)
+{
+    uint32_t n;
+
+    if (al->nindexed + 1 != pmix_list_get_size(&al->super)
+        || 2 * (al->nused + 1) > al->nslots) {
+        /* let the next lookup rebuild it */
+        al->nindexed = SIZE_MAX;
+        return;
+    }
+    n = attr_slot(al, kv->key);
+    if (NULL == al->slots[n]) {
+        al->slots[n] = kv;
+        al->nused++;
+    } else {
+        al->dups = true;
+        if (front) {
+            al->slots[n] = kv;
+        }
+    }
+    al->nindexed++;
+}
+
+/* drop the index entry for an attribute that is being removed */
+static void attr_removed(prte_attr_list_t *al, prte_attribute_t *kv)
+{
+    uint32_t n, j, k, mask;
+
+    if (al->dups || al->nindexed != pmix_list_get_size(&al->super) + 1) {
+        /* another entry may need to take its place */
+        al->nindexed = SIZE_MAX;
+        return;
+    }
+    n = attr_slot(al, kv->key);
+    if (al->slots[n] != kv) {
+        al->nindexed = SIZE_MAX;
+        return;
+    }
+    /* remove it and shift back any entries that probed past it */
+    mask = al->nslots - 1;
+    al->slots[n] = NULL;
+    al->nused--;
+    for (j = (n + 1) & mask; NULL != al->slots[j]; j = (j + 1) & mask) {
+        k = al->slots[j]->key & mask;
+        if ((j > n && (k <= n || k > j)) || (j < n && (k <= n && k > j))) {
+            al->slots[n] = al->slots[j];
+            al->slots[j] = NULL;
+            n = j;
+        }
+    }
+    al->nindexed--;
+}
+
+bool prte_get_attribute(prte_attr_list_t *attributes, prte_attribute_key_t key, void **data,
+                        pmix_data_type_t type)
+{
+    prte_attribute_t *kv;
+    int rc;
+
+    if (NULL == (kv = attr_find(attributes, key))) {
+        /* not found */
+        return false;
+    }
+    if (kv->data.type != type) {
+        PRTE_ERROR_LOG(PRTE_ERR_TYPE_MISMATCH);
+        pmix_output(0, "KV %s TYPE %s", PMIx_Data_type_string(kv->data.type), PMIx_Data_type_string(type));
+        return false;
+    }
+    if (NULL != data) {
+        if (PRTE_SUCCESS != (rc = prte_attr_unload(kv, data, type))) {
+            PRTE_ERROR_LOG(rc);
+        }
+    }
+    return true;
+}
+
+int prte_set_attribute(prte_attr_list_t *attributes, prte_attribute_key_t key, bool local, void *data,
                        pmix_data_type_t type)
 {
     prte_attribute_t *kv;
     int rc;
 
-    PMIX_LIST_FOREACH(kv, attributes, prte_attribute_t)
-    {
-        if (key == kv->key) {
-            if (kv->data.type != type) {
-                return PRTE_ERR_TYPE_MISMATCH;
-            }
-            if (PRTE_SUCCESS != (rc = prte_attr_load(kv, data, type))) {
-                PRTE_ERROR_LOG(rc);
-            }
-            return rc;
+    if (NULL != (kv = attr_find(attributes, key))) {
+        if (kv->data.type != type) {
+            return PRTE_ERR_TYPE_MISMATCH;
+        }
+        if (PRTE_SUCCESS != (rc = prte_attr_load(kv, data, type))) {
+            PRTE_ERROR_LOG(rc);
         }
+        return rc;
     }
     /* not found - add it */
     kv = PMIX_NEW(prte_attribute_t);
@@ -93,30 +231,30 @@ int prte_set_attribute(pmix_list_t *attributes, prte_attribute_key_t key, bool l
         PMIX_RELEASE(kv);
         return rc;
     }
-    pmix_list_append(attributes, &kv->super);
+    pmix_list_append(&attributes->super, &kv->super);
+    attr_added(attributes, kv, false);
     return PRTE_SUCCESS;
 }
 
-prte_attribute_t *prte_fetch_attribute(pmix_list_t *attributes, prte_attribute_t *prev,
+void prte_attr_list_append(prte_attr_list_t *attributes, prte_attribute_t *kv)
+{
+    pmix_list_append(&attributes->super, &kv->super);
+    attr_added(attributes, kv, false);
+}
+
+prte_attribute_t *prte_fetch_attribute(prte_attr_list_t *attributes, prte_attribute_t *prev,
                                        prte_attribute_key_t key)
 {
-    prte_attribute_t *kv, *end, *next;
+    prte_attribute_t *end, *next;
 
     /* if prev is NULL, then find the first attr on the list
      * that matches the key */
     if (NULL == prev) {
-        PMIX_LIST_FOREACH(kv, attributes, prte_attribute_t)
-        {
-            if (key == kv->key) {
-                return kv;
-            }
-        }
-        /* if we get, then the key isn't on the list */
-        return NULL;
+        return attr_find(attributes, key);
     }
 
     /* if we are at the end of the list, then nothing to do */
-    end = (prte_attribute_t *) pmix_list_get_end(attributes);
+    end = (prte_attribute_t *) pmix_list_get_end(&attributes->super);
     if (prev == end || end == (prte_attribute_t *) pmix_list_get_next(&prev->super)
         || NULL == pmix_list_get_next(&prev->super)) {
         return NULL;
@@ -136,7 +274,7 @@ prte_attribute_t *prte_fetch_attribute(pmix_list_t *attributes, prte_attribute_t
     return NULL;
 }
 
-int prte_prepend_attribute(pmix_list_t *attributes, prte_attribute_key_t key, bool local,
+int prte_prepend_attribute(prte_attr_list_t *attributes, prte_attribute_key_t key, bool local,
                            void *data, pmix_data_type_t type)
 {
     prte_attribute_t *kv;
@@ -149,21 +287,19 @@ int prte_prepend_attribute(pmix_list_t *attributes, prte_attribute_key_t key, bo
         PMIX_RELEASE(kv);
         return rc;
     }
-    pmix_list_prepend(attributes, &kv->super);
+    pmix_list_prepend(&attributes->super, &kv->super);
+    attr_added(attributes, kv, true);
     return PRTE_SUCCESS;
 }
 
-void prte_remove_attribute(pmix_list_t *attributes, prte_attribute_key_t key)
+void prte_remove_attribute(prte_attr_list_t *attributes, prte_attribute_key_t key)
 {
     prte_attribute_t *kv;
 
-    PMIX_LIST_FOREACH(kv, attributes, prte_attribute_t)
-    {
-        if (key == kv->key) {
-            pmix_list_remove_item(attributes, &kv->super);
-            PMIX_RELEASE(kv);
-            return;
-        }
+    if (NULL != (kv = attr_find(attributes, key))) {
+        pmix_list_remove_item(&attributes->super, &kv->super);
+        attr_removed(attributes, kv);
+        PMIX_RELEASE(kv);
     }
 }
 
@@ -187,12 +323,12 @@ int prte_attr_register(const char *project, prte_attribute_key_t key_base,
     return PRTE_ERR_OUT_OF_RESOURCE;
 }
 
-char *prte_attr_print_list(pmix_list_t *attributes)
+char *prte_attr_print_list(prte_attr_list_t *attributes)
 {
     char *out1, **cache = NULL;
     prte_attribute_t *attr;
 
-    PMIX_LIST_FOREACH(attr, attributes, prte_attribute_t)
+    PMIX_LIST_FOREACH(attr, &attributes->super, prte_attribute_t)
     {
         pmix_argv_append_nosize(&cache, prte_attr_key_to_str(attr->key));
     }
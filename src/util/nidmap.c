@@ -32,94 +32,142 @@
 
 #include "src/util/nidmap.h"
 
-int prte_util_nidmap_create(pmix_pointer_array_t *pool, pmix_data_buffer_t *buffer)
-{
-    char *raw = NULL;
-    pmix_rank_t *vpids = NULL;
-    uint8_t u8;
-    int n, m, ndaemons, nbytes;
-    bool compressed;
-    char **names = NULL;
-    char **aliases = NULL, **als;
-    prte_node_t *nptr;
-    pmix_byte_object_t bo;
-    size_t sz;
-    pmix_status_t rc;
 
-    /* pack a flag indicating if the HNP was included in the allocation */
-    if (prte_hnp_is_allocated) {
-        u8 = 1;
+/* The node names and daemon vpids are sent in one of two formats.
+ * Regular allocations (e.g., node0001..node4096 with daemons 0..N-1)
+ * are described by hostname ranges and vpid runs, so the encoded
+ * size depends on the number of ranges and not on the number of
+ * nodes. Anything else falls back to the compressed strings. */
+#define PRTE_NIDMAP_LEGACY  0
+#define PRTE_NIDMAP_RANGES  1
+
+/* use the legacy format if there are more than one range (or vpid
+ * run) for every this many nodes */
+#define PRTE_NIDMAP_RANGE_RATIO 4
+
+/* locate the trailing run of digits in a hostname. The width is
+ * the number of digits if the number is zero-padded, or zero */
+static bool name_number(const char *name, size_t *pos, size_t *ndigits,
+                        uint32_t *num, int *width)
+{
+    size_t len, n, end;
+
+    len = strlen(name);
+    for (end = len; 0 < end && !isdigit((unsigned char) name[end - 1]); end--);
+    if (0 == end) {
+        return false;
+    }
+    for (n = end; 0 < n && isdigit((unsigned char) name[n - 1]); n--);
+    /* keep within a uint32 */
+    if (9 < end - n) {
+        return false;
+    }
+    *pos = n;
+    *ndigits = end - n;
+    *num = strtoul(&name[n], NULL, 10);
+    if ('0' == name[n] && 1 < *ndigits) {
+        *width = *ndigits;
     } else {
-        u8 = 0;
-    }
-    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &u8, 1, PMIX_UINT8);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        return rc;
+        *width = 0;
     }
+    return true;
+}
 
-    /* pack a flag indicating if we are in a managed allocation */
-    if (prte_managed_allocation) {
-        u8 = 1;
-    } else {
-        u8 = 0;
+/* advance the number in a hostname by one, in place. The name
+ * must have room for the number to grow */
+static void next_name(char *name, size_t pos, size_t *ndigits, size_t *len)
+{
+    size_t n = pos + *ndigits;
+
+    while (pos < n && '9' == name[n - 1]) {
+        name[n - 1] = '0';
+        --n;
     }
-    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &u8, 1, PMIX_UINT8);
-    if (PMIX_SUCCESS != rc) {
-        PMIX_ERROR_LOG(rc);
-        return rc;
+    if (pos < n) {
+        name[n - 1]++;
+        return;
     }
+    /* carried out of the leading digit - only unpadded numbers get here */
+    memmove(&name[pos + 1], &name[pos], *len - pos + 1);
+    name[pos] = '1';
+    ++(*ndigits);
+    ++(*len);
+}
 
-    /* daemon vpids start from 0 and increase linearly by one
-     * up to the number of nodes in the system. The vpid is
-     * a 32-bit value. We don't know how many of the nodes
-     * in the system have daemons - we may not be using them
-     * all just yet. However, even the largest systems won't
-     * have more than a million nodes for quite some time,
-     * so for now we'll just allocate enough space to hold
-     * them all. Someone can optimize this further later */
-    nbytes = prte_process_info.num_daemons * sizeof(pmix_rank_t);
-    vpids = (pmix_rank_t *) malloc(nbytes);
-
-    ndaemons = 0;
-    for (n = 0; n < pool->size; n++) {
-        if (NULL == (nptr = (prte_node_t *) pmix_pointer_array_get_item(pool, n))) {
+/* group the node names into ranges of consecutive numbers sharing
+ * the same prefix, suffix and padding. Returns the number of ranges,
+ * or -1 if there are more than maxranges of them */
+static int find_ranges(prte_node_t **nodes, int nnodes, int maxranges,
+                       char **firsts, int32_t *counts)
+{
+    int n, nranges = 0;
+    size_t fpos = 0, fnd = 0, pos, nd;
+    uint32_t fnum = 0, num;
+    int fwidth = 0, width;
+    bool numbered = false;
+    const char *first = NULL, *name;
+
+    for (n = 0; n < nnodes; n++) {
+        name = nodes[n]->name;
+        if (numbered && name_number(name, &pos, &nd, &num, &width)
+            && pos == fpos && num == fnum + (uint32_t) counts[nranges - 1]
+            && (0 < fwidth ? nd == (size_t) fwidth : 0 == width)
+            && 0 == strncmp(name, first, pos)
+            && 0 == strcmp(&name[pos + nd], &first[fpos + fnd])) {
+            counts[nranges - 1]++;
             continue;
         }
-        /* add the hostname to the argv */
-        pmix_argv_append_nosize(&names, nptr->name);
-        als = NULL;
-        if (NULL != nptr->aliases) {
-            for (m=0; NULL != nptr->aliases[m]; m++) {
-                pmix_argv_append_nosize(&als, nptr->aliases[m]);
+        /* start a new range */
+        if (nranges == maxranges) {
+            return -1;
+        }
+        first = name;
+        firsts[nranges] = (char *) name;
+        counts[nranges] = 1;
+        ++nranges;
+        numbered = name_number(name, &fpos, &fnd, &fnum, &fwidth);
+    }
+    return nranges;
+}
+
+/* run-length encode the vpids as runs of consecutive ranks or of
+ * nodes without a daemon. Returns the number of runs, or -1 if
+ * there are more than maxruns of them */
+static int find_runs(pmix_rank_t *vpids, int nnodes, int maxruns,
+                     pmix_rank_t *starts, int32_t *counts)
+{
+    int n, nruns = 0;
+
+    for (n = 0; n < nnodes; n++) {
+        if (0 < nruns) {
+            if (PMIX_RANK_INVALID == starts[nruns - 1]) {
+                if (PMIX_RANK_INVALID == vpids[n]) {
+                    counts[nruns - 1]++;
+                    continue;
+                }
+            } else if (vpids[n] == starts[nruns - 1] + (pmix_rank_t) counts[nruns - 1]) {
+                counts[nruns - 1]++;
+                continue;
             }
-            raw = pmix_argv_join(als, ',');
-            pmix_argv_free(als);
-            pmix_argv_append_nosize(&aliases, raw);
-            free(raw);
-        } else {
-            pmix_argv_append_nosize(&aliases, "PRTENONE");
         }
-        /* store the vpid */
-        if (NULL == nptr->daemon) {
-            vpids[ndaemons] = PMIX_RANK_INVALID;
-        } else {
-            vpids[ndaemons] = nptr->daemon->name.rank;
+        if (nruns == maxruns) {
+            return -1;
         }
-        ++ndaemons;
+        starts[nruns] = vpids[n];
+        counts[nruns] = 1;
+        ++nruns;
     }
+    return nruns;
+}
 
-    /* little protection */
-    if (NULL == names || NULL == aliases) {
-        PRTE_ERROR_LOG(PRTE_ERR_NOT_FOUND);
-        free(vpids);
-        return PRTE_ERR_NOT_FOUND;
-    }
+static int pack_compressed(pmix_data_buffer_t *buffer, char *raw, size_t size)
+{
+    pmix_byte_object_t bo;
+    bool compressed;
+    size_t sz;
+    pmix_status_t rc;
 
-    /* construct the string of node names for compression */
-    raw = pmix_argv_join(names, ',');
-    pmix_argv_free(names);
-    if (PMIx_Data_compress((uint8_t *) raw, strlen(raw) + 1, (uint8_t **) &bo.bytes, &sz)) {
+    if (PMIx_Data_compress((uint8_t *) raw, size, (uint8_t **) &bo.bytes, &sz)) {
         /* mark that this was compressed */
         compressed = true;
         bo.size = sz;
@@ -127,228 +175,550 @@ int prte_util_nidmap_create(pmix_pointer_array_t *pool, pmix_data_buffer_t *buff
     } else {
         /* mark that this was not compressed */
         compressed = false;
-        bo.bytes = (char *) raw;
-        bo.size = strlen(raw) + 1;
+        bo.bytes = raw;
+        bo.size = size;
     }
     /* indicate compression */
     rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &compressed, 1, PMIX_BOOL);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         free(bo.bytes);
-        free(vpids);
         return rc;
     }
     /* add the object */
     rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &bo, 1, PMIX_BYTE_OBJECT);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        free(bo.bytes);
-        free(vpids);
-        return rc;
     }
     free(bo.bytes);
+    return rc;
+}
+
+static int pack_legacy(prte_node_t **nodes, pmix_rank_t *vpids, int nnodes,
+                       pmix_data_buffer_t *buffer)
+{
+    char **names = NULL, **aliases = NULL, *raw;
+    int n;
+    pmix_status_t rc;
+
+    for (n = 0; n < nnodes; n++) {
+        pmix_argv_append_nosize(&names, nodes[n]->name);
+        if (NULL != nodes[n]->aliases && NULL != nodes[n]->aliases[0]) {
+            raw = pmix_argv_join(nodes[n]->aliases, ',');
+            pmix_argv_append_nosize(&aliases, raw);
+            free(raw);
+        } else {
+            pmix_argv_append_nosize(&aliases, "PRTENONE");
+        }
+    }
+
+    /* construct the string of node names for compression */
+    raw = pmix_argv_join(names, ',');
+    pmix_argv_free(names);
+    rc = pack_compressed(buffer, raw, strlen(raw) + 1);
+    if (PMIX_SUCCESS != rc) {
+        pmix_argv_free(aliases);
+        return rc;
+    }
 
     /* construct the string of aliases for compression */
     raw = pmix_argv_join(aliases, ';');
     pmix_argv_free(aliases);
-    if (PMIx_Data_compress((uint8_t *) raw, strlen(raw) + 1, (uint8_t **) &bo.bytes, &sz)) {
-        /* mark that this was compressed */
-        compressed = true;
-        bo.size = sz;
-        free(raw);
-    } else {
-        /* mark that this was not compressed */
-        compressed = false;
-        bo.bytes = (char *) raw;
-        bo.size = strlen(raw) + 1;
+    rc = pack_compressed(buffer, raw, strlen(raw) + 1);
+    if (PMIX_SUCCESS != rc) {
+        return rc;
     }
-    /* indicate compression */
-    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &compressed, 1, PMIX_BOOL);
+
+    /* compress the vpids - the buffer is ours to give away */
+    raw = (char *) malloc(nnodes * sizeof(pmix_rank_t));
+    memcpy(raw, vpids, nnodes * sizeof(pmix_rank_t));
+    return pack_compressed(buffer, raw, nnodes * sizeof(pmix_rank_t));
+}
+
+static int pack_ranges(prte_node_t **nodes, int nnodes,
+                       char **firsts, int32_t *rcounts, int32_t nranges,
+                       pmix_rank_t *starts, int32_t *vcounts, int32_t nruns,
+                       pmix_data_buffer_t *buffer)
+{
+    int32_t n, naliased = 0;
+    char *raw;
+    pmix_status_t rc;
+
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &nnodes, 1, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        free(bo.bytes);
-        free(vpids);
         return rc;
     }
-    /* add the object */
-    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &bo, 1, PMIX_BYTE_OBJECT);
+
+    /* the hostname ranges - each is given by its first name
+     * and the number of names in it */
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &nranges, 1, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        free(bo.bytes);
-        free(vpids);
         return rc;
     }
-    free(bo.bytes);
-
-    /* compress the vpids */
-    if (PMIx_Data_compress((uint8_t *) vpids, nbytes, (uint8_t **) &bo.bytes, &sz)) {
-        /* mark that this was compressed */
-        compressed = true;
-        bo.size = sz;
-        free(vpids);
-    } else {
-        /* mark that this was not compressed */
-        compressed = false;
-        bo.bytes = (char *) vpids;
-        bo.size = ndaemons * sizeof(pmix_rank_t);
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, firsts, nranges, PMIX_STRING);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
     }
-    /* indicate compression */
-    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &compressed, 1, PMIX_BOOL);
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, rcounts, nranges, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        free(bo.bytes);
         return rc;
     }
-    /* add the object */
-    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &bo, 1, PMIX_BYTE_OBJECT);
+
+    /* aliases are rare, so only send them for the nodes that have them */
+    for (n = 0; n < nnodes; n++) {
+        if (NULL != nodes[n]->aliases && NULL != nodes[n]->aliases[0]) {
+            ++naliased;
+        }
+    }
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &naliased, 1, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        free(bo.bytes);
         return rc;
     }
-    free(bo.bytes);
+    for (n = 0; n < nnodes && 0 < naliased; n++) {
+        if (NULL == nodes[n]->aliases || NULL == nodes[n]->aliases[0]) {
+            continue;
+        }
+        rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &n, 1, PMIX_INT32);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            return rc;
+        }
+        raw = pmix_argv_join(nodes[n]->aliases, ',');
+        rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &raw, 1, PMIX_STRING);
+        free(raw);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            return rc;
+        }
+        --naliased;
+    }
 
+    /* the vpid runs */
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &nruns, 1, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
+    }
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, starts, nruns, PMIX_PROC_RANK);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
+    }
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, vcounts, nruns, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+    }
     return rc;
 }
 
-int prte_util_decode_nidmap(pmix_data_buffer_t *buf)
+int prte_util_nidmap_create(pmix_pointer_array_t *pool, pmix_data_buffer_t *buffer)
 {
+    pmix_rank_t *vpids = NULL, *starts = NULL;
+    prte_node_t **nodes = NULL, *nptr;
+    char **firsts = NULL;
+    int32_t *rcounts = NULL, *vcounts = NULL;
+    int n, nnodes, maxranges, nranges = -1, nruns = -1;
     uint8_t u8;
-    pmix_rank_t *vpid = NULL;
-    int cnt, n;
-    bool compressed;
-    size_t sz;
-    pmix_byte_object_t pbo;
-    char *raw = NULL, **names = NULL, **aliases = NULL;
-    prte_node_t *nd;
-    prte_job_t *daemons;
-    prte_proc_t *proc;
-    prte_topology_t *t = NULL;
     pmix_status_t rc;
 
-    /* unpack the flag indicating if HNP is in allocation */
-    cnt = 1;
-    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &u8, &cnt, PMIX_UINT8);
+    /* pack a flag indicating if the HNP was included in the allocation */
+    if (prte_hnp_is_allocated) {
+        u8 = 1;
+    } else {
+        u8 = 0;
+    }
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &u8, 1, PMIX_UINT8);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        goto cleanup;
+        return rc;
     }
-    if (1 == u8) {
-        prte_hnp_is_allocated = true;
+
+    /* pack a flag indicating if we are in a managed allocation */
+    if (prte_managed_allocation) {
+        u8 = 1;
     } else {
-        prte_hnp_is_allocated = false;
+        u8 = 0;
+    }
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &u8, 1, PMIX_UINT8);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
     }
 
-    /* unpack the flag indicating if we are in managed allocation */
-    cnt = 1;
-    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &u8, &cnt, PMIX_UINT8);
+    /* collect the nodes and the vpids of their daemons */
+    nodes = (prte_node_t **) malloc(pool->size * sizeof(prte_node_t *));
+    vpids = (pmix_rank_t *) malloc(pool->size * sizeof(pmix_rank_t));
+    nnodes = 0;
+    for (n = 0; n < pool->size; n++) {
+        if (NULL == (nptr = (prte_node_t *) pmix_pointer_array_get_item(pool, n))) {
+            continue;
+        }
+        nodes[nnodes] = nptr;
+        if (NULL == nptr->daemon) {
+            vpids[nnodes] = PMIX_RANK_INVALID;
+        } else {
+            vpids[nnodes] = nptr->daemon->name.rank;
+        }
+        ++nnodes;
+    }
+
+    /* little protection */
+    if (0 == nnodes) {
+        PRTE_ERROR_LOG(PRTE_ERR_NOT_FOUND);
+        rc = PRTE_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    /* see if the allocation is regular enough to describe by ranges */
+    maxranges = nnodes / PRTE_NIDMAP_RANGE_RATIO;
+    if (0 == maxranges) {
+        maxranges = 1;
+    }
+    firsts = (char **) malloc(maxranges * sizeof(char *));
+    rcounts = (int32_t *) malloc(maxranges * sizeof(int32_t));
+    nranges = find_ranges(nodes, nnodes, maxranges, firsts, rcounts);
+    if (0 < nranges) {
+        starts = (pmix_rank_t *) malloc(maxranges * sizeof(pmix_rank_t));
+        vcounts = (int32_t *) malloc(maxranges * sizeof(int32_t));
+        nruns = find_runs(vpids, nnodes, maxranges, starts, vcounts);
+    }
+
+    if (0 < nranges && 0 < nruns) {
+        u8 = PRTE_NIDMAP_RANGES;
+    } else {
+        u8 = PRTE_NIDMAP_LEGACY;
+    }
+    rc = PMIx_Data_pack(PRTE_PROC_MY_NAME, buffer, &u8, 1, PMIX_UINT8);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         goto cleanup;
     }
-    if (1 == u8) {
-        prte_managed_allocation = true;
+    if (PRTE_NIDMAP_RANGES == u8) {
+        rc = pack_ranges(nodes, nnodes, firsts, rcounts, nranges,
+                         starts, vcounts, nruns, buffer);
     } else {
-        prte_managed_allocation = false;
+        rc = pack_legacy(nodes, vpids, nnodes, buffer);
+    }
+
+cleanup:
+    free(nodes);
+    free(vpids);
+    if (NULL != firsts) {
+        free(firsts);
+        free(rcounts);
+    }
+    if (NULL != starts) {
+        free(starts);
+        free(vcounts);
     }
+    return rc;
+}
+
+static int unpack_compressed(pmix_data_buffer_t *buf, char **raw, size_t *size)
+{
+    pmix_byte_object_t pbo;
+    bool compressed;
+    int cnt;
+    pmix_status_t rc;
 
-    /* unpack compression flag for node names */
+    /* unpack compression flag */
     cnt = 1;
     rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &compressed, &cnt, PMIX_BOOL);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        goto cleanup;
+        return rc;
     }
 
-    /* unpack the nodename object */
+    /* unpack the object */
     cnt = 1;
     rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &pbo, &cnt, PMIX_BYTE_OBJECT);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
-        goto cleanup;
+        return rc;
     }
 
     /* if compressed, decompress */
     if (compressed) {
-        if (!PMIx_Data_decompress((uint8_t *) pbo.bytes, pbo.size, (uint8_t **) &raw, &sz)) {
+        if (!PMIx_Data_decompress((uint8_t *) pbo.bytes, pbo.size, (uint8_t **) raw, size)) {
             PRTE_ERROR_LOG(PRTE_ERROR);
             PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-            rc = PRTE_ERROR;
-            goto cleanup;
+            return PRTE_ERROR;
         }
     } else {
-        raw = (char *) pbo.bytes;
+        *raw = pbo.bytes;
+        *size = pbo.size;
         pbo.bytes = NULL; // protect the data
         pbo.size = 0;
     }
     PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-    names = pmix_argv_split(raw, ',');
+    return PRTE_SUCCESS;
+}
+
+static int unpack_legacy(pmix_data_buffer_t *buf, int *nnodes, char ***names,
+                         char ***aliases, pmix_rank_t **vpid)
+{
+    char *raw = NULL;
+    size_t sz;
+    int n;
+    pmix_status_t rc;
+
+    rc = unpack_compressed(buf, &raw, &sz);
+    if (PRTE_SUCCESS != rc) {
+        return rc;
+    }
+    *names = pmix_argv_split(raw, ',');
     free(raw);
+    *nnodes = pmix_argv_count(*names);
+
+    rc = unpack_compressed(buf, &raw, &sz);
+    if (PRTE_SUCCESS != rc) {
+        return rc;
+    }
+    *aliases = pmix_argv_split(raw, ';');
+    free(raw);
+    if (pmix_argv_count(*aliases) != *nnodes) {
+        PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+    for (n = 0; n < *nnodes; n++) {
+        if (0 == strcmp((*aliases)[n], "PRTENONE")) {
+            free((*aliases)[n]);
+            (*aliases)[n] = NULL;
+        }
+    }
+
+    rc = unpack_compressed(buf, &raw, &sz);
+    if (PRTE_SUCCESS != rc) {
+        return rc;
+    }
+    *vpid = (pmix_rank_t *) raw;
+    if (sz < *nnodes * sizeof(pmix_rank_t)) {
+        PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+        return PRTE_ERR_UNPACK_FAILURE;
+    }
+    return PRTE_SUCCESS;
+}
+
+/* expand the ranges and runs straight into arrays sized from the
+ * node count. The names are only expanded if they will be used */
+static int unpack_ranges(pmix_data_buffer_t *buf, bool expand, int *nnodes,
+                         char ***names, char ***aliases, pmix_rank_t **vpid)
+{
+    char **firsts = NULL, *raw, *tmpl;
+    pmix_rank_t *starts = NULL;
+    int32_t *counts = NULL, nranges = 0, nruns, naliased, idx;
+    int cnt, n, m, k, width;
+    size_t pos, nd, len;
+    uint32_t num;
+    pmix_status_t rc;
 
-    /* unpack compression flag for node aliases */
     cnt = 1;
-    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &compressed, &cnt, PMIX_BOOL);
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, nnodes, &cnt, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
+    }
+    *names = (char **) calloc(*nnodes + 1, sizeof(char *));
+    *aliases = (char **) calloc(*nnodes + 1, sizeof(char *));
+    *vpid = (pmix_rank_t *) malloc(*nnodes * sizeof(pmix_rank_t));
+
+    /* the hostname ranges */
+    cnt = 1;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &nranges, &cnt, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        return rc;
+    }
+    firsts = (char **) calloc(nranges, sizeof(char *));
+    counts = (int32_t *) malloc(nranges * sizeof(int32_t));
+    cnt = nranges;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, firsts, &cnt, PMIX_STRING);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    cnt = nranges;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, counts, &cnt, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         goto cleanup;
     }
+    if (expand) {
+        k = 0;
+        for (n = 0; n < nranges; n++) {
+            if (*nnodes - k < counts[n]) {
+                PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+                rc = PRTE_ERR_UNPACK_FAILURE;
+                goto cleanup;
+            }
+            if (1 == counts[n] || !name_number(firsts[n], &pos, &nd, &num, &width)) {
+                (*names)[k++] = firsts[n];
+                firsts[n] = NULL;
+                continue;
+            }
+            /* step the number in place rather than printing each name */
+            len = strlen(firsts[n]);
+            tmpl = (char *) malloc(len + 11);
+            memcpy(tmpl, firsts[n], len + 1);
+            for (m = 0; m < counts[n]; m++) {
+                (*names)[k] = (char *) malloc(len + 1);
+                memcpy((*names)[k], tmpl, len + 1);
+                ++k;
+                next_name(tmpl, pos, &nd, &len);
+            }
+            free(tmpl);
+        }
+        if (k != *nnodes) {
+            PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+            rc = PRTE_ERR_UNPACK_FAILURE;
+            goto cleanup;
+        }
+    }
 
-    /* unpack the aliases object */
+    /* the aliases */
     cnt = 1;
-    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &pbo, &cnt, PMIX_BYTE_OBJECT);
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &naliased, &cnt, PMIX_INT32);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         goto cleanup;
     }
+    for (n = 0; n < naliased; n++) {
+        cnt = 1;
+        rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &idx, &cnt, PMIX_INT32);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            goto cleanup;
+        }
+        cnt = 1;
+        rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &raw, &cnt, PMIX_STRING);
+        if (PMIX_SUCCESS != rc) {
+            PMIX_ERROR_LOG(rc);
+            goto cleanup;
+        }
+        if (0 > idx || *nnodes <= idx) {
+            free(raw);
+            PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+            rc = PRTE_ERR_UNPACK_FAILURE;
+            goto cleanup;
+        }
+        (*aliases)[idx] = raw;
+    }
 
-    /* if compressed, decompress */
-    if (compressed) {
-        if (!PMIx_Data_decompress((uint8_t *) pbo.bytes, pbo.size, (uint8_t **) &raw, &sz)) {
-            PRTE_ERROR_LOG(PRTE_ERROR);
-            PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-            rc = PRTE_ERROR;
+    /* the vpid runs - reuse the range arrays */
+    cnt = 1;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &nruns, &cnt, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    starts = (pmix_rank_t *) malloc(nruns * sizeof(pmix_rank_t));
+    if (nranges < nruns) {
+        counts = (int32_t *) realloc(counts, nruns * sizeof(int32_t));
+    }
+    cnt = nruns;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, starts, &cnt, PMIX_PROC_RANK);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    cnt = nruns;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, counts, &cnt, PMIX_INT32);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    k = 0;
+    for (n = 0; n < nruns; n++) {
+        if (*nnodes - k < counts[n]) {
+            PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+            rc = PRTE_ERR_UNPACK_FAILURE;
             goto cleanup;
         }
-    } else {
-        raw = (char *) pbo.bytes;
-        pbo.bytes = NULL; // protect the data
-        pbo.size = 0;
+        for (m = 0; m < counts[n]; m++) {
+            if (PMIX_RANK_INVALID == starts[n]) {
+                (*vpid)[k++] = PMIX_RANK_INVALID;
+            } else {
+                (*vpid)[k++] = starts[n] + m;
+            }
+        }
     }
-    PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-    aliases = pmix_argv_split(raw, ';');
-    free(raw);
+    if (k != *nnodes) {
+        PRTE_ERROR_LOG(PRTE_ERR_UNPACK_FAILURE);
+        rc = PRTE_ERR_UNPACK_FAILURE;
+    }
+
+cleanup:
+    for (n = 0; n < nranges; n++) {
+        if (NULL != firsts[n]) {
+            free(firsts[n]);
+        }
+    }
+    free(firsts);
+    free(counts);
+    if (NULL != starts) {
+        free(starts);
+    }
+    return rc;
+}
 
-    /* unpack compression flag for daemon vpids */
+int prte_util_decode_nidmap(pmix_data_buffer_t *buf)
+{
+    uint8_t u8;
+    pmix_rank_t *vpid = NULL;
+    int cnt, n, nnodes = 0;
+    char **names = NULL, **aliases = NULL;
+    prte_node_t *nd;
+    prte_job_t *daemons;
+    prte_proc_t *proc;
+    prte_topology_t *t = NULL;
+    pmix_status_t rc;
+
+    /* unpack the flag indicating if HNP is in allocation */
     cnt = 1;
-    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &compressed, &cnt, PMIX_BOOL);
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &u8, &cnt, PMIX_UINT8);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         goto cleanup;
     }
+    if (1 == u8) {
+        prte_hnp_is_allocated = true;
+    } else {
+        prte_hnp_is_allocated = false;
+    }
 
-    /* unpack the vpid object */
+    /* unpack the flag indicating if we are in managed allocation */
     cnt = 1;
-    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &pbo, &cnt, PMIX_BYTE_OBJECT);
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &u8, &cnt, PMIX_UINT8);
     if (PMIX_SUCCESS != rc) {
         PMIX_ERROR_LOG(rc);
         goto cleanup;
     }
+    if (1 == u8) {
+        prte_managed_allocation = true;
+    } else {
+        prte_managed_allocation = false;
+    }
 
-    /* if compressed, decompress */
-    if (compressed) {
-        if (!PMIx_Data_decompress((uint8_t *) pbo.bytes, pbo.size, (uint8_t **) &vpid, &sz)) {
-            PRTE_ERROR_LOG(PRTE_ERROR);
-            PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
-            rc = PRTE_ERROR;
-            goto cleanup;
-        }
+    /* unpack the format of the node map */
+    cnt = 1;
+    rc = PMIx_Data_unpack(PRTE_PROC_MY_NAME, buf, &u8, &cnt, PMIX_UINT8);
+    if (PMIX_SUCCESS != rc) {
+        PMIX_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    if (PRTE_NIDMAP_RANGES == u8) {
+        rc = unpack_ranges(buf, !PRTE_PROC_IS_MASTER, &nnodes, &names, &aliases, &vpid);
     } else {
-        vpid = (pmix_rank_t *) pbo.bytes;
-        sz = pbo.size;
-        pbo.bytes = NULL;
-        pbo.size = 0;
+        rc = unpack_legacy(buf, &nnodes, &names, &aliases, &vpid);
+    }
+    if (PRTE_SUCCESS != rc) {
+        goto cleanup;
     }
-    PMIX_BYTE_OBJECT_DESTRUCT(&pbo);
 
     /* if we are the HNP, we don't need any of this stuff */
     if (PRTE_PROC_IS_MASTER) {
@@ -367,18 +737,28 @@ int prte_util_decode_nidmap(pmix_data_buffer_t *buf)
         rc = PRTE_ERR_NOT_FOUND;
         goto cleanup;
     }
+
+    /* size the arrays once instead of growing them node by node */
+    if (prte_node_pool->size < nnodes) {
+        pmix_pointer_array_set_size(prte_node_pool, nnodes);
+    }
+    if (daemons->procs->size < nnodes) {
+        pmix_pointer_array_set_size(daemons->procs, nnodes);
+    }
+
     /* create the node pool array - this will include
      * _all_ nodes known to the allocation */
-    for (n = 0; NULL != names[n]; n++) {
+    for (n = 0; n < nnodes; n++) {
         /* do we already have this node? */
         nd = (prte_node_t*)pmix_pointer_array_get_item(prte_node_pool, n);
         if (NULL != nd) {
             /* check the name */
             if (0 != strcmp(nd->name, names[n])) {
                 free(nd->name);
-                nd->name = strdup(names[n]);
+                nd->name = names[n];
+                names[n] = NULL;
             }
-            if (0 != strcmp(aliases[n], "PRTENONE")) {
+            if (NULL != aliases[n]) {
                 if (NULL != nd->aliases) {
                     pmix_argv_free(nd->aliases);
                 }
@@ -388,11 +768,12 @@ int prte_util_decode_nidmap(pmix_data_buffer_t *buf)
         }
         /* add this name to the pool */
         nd = PMIX_NEW(prte_node_t);
-        nd->name = strdup(names[n]);
+        nd->name = names[n];
+        names[n] = NULL;
         nd->index = n;
         pmix_pointer_array_set_item(prte_node_pool, n, nd);
         /* add any aliases */
-        if (0 != strcmp(aliases[n], "PRTENONE")) {
+        if (NULL != aliases[n]) {
             nd->aliases = pmix_argv_split(aliases[n], ',');
         }
         /* set the topology - always default to homogeneous
@@ -426,8 +807,22 @@ cleanup:
     if (NULL != vpid) {
         free(vpid);
     }
+    /* any names we took have been NULL'd, so don't stop at the first hole */
     if (NULL != names) {
-        pmix_argv_free(names);
+        for (n = 0; n < nnodes; n++) {
+            if (NULL != names[n]) {
+                free(names[n]);
+            }
+        }
+        free(names);
+    }
+    if (NULL != aliases) {
+        for (n = 0; n < nnodes; n++) {
+            if (NULL != aliases[n]) {
+                free(aliases[n]);
+            }
+        }
+        free(aliases);
     }
     return rc;
 }